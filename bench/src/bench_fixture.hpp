@@ -0,0 +1,111 @@
+#ifndef CPP_HTTP_BENCH_FIXTURE_HPP
+#define CPP_HTTP_BENCH_FIXTURE_HPP
+
+// Temporary resources directory holding every file the request corpus asks for, shared by the
+// benchmarks that serve it.
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpServer.hpp"
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdlib.h>
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/************************************/
+
+/***************************************/
+/********** Fixture types **************/
+/***************************************/
+
+typedef struct
+{
+    std::string                 root        ;   // Resources directory.
+    std::vector<std::string>    directories ;   // Created below it, in creation order.
+    std::vector<std::string>    files       ;   // Every file or link created for the benchmark (also outside root).
+} BENCH_FIXTURE;
+
+/***************************************/
+
+/***************************************/
+/********** Fixture functions **********/
+/***************************************/
+
+inline int BenchFixtureWriteFile(BENCH_FIXTURE& fixture, const std::string& path, size_t length, char fill)
+{
+    std::ofstream file(path, std::ios::binary);
+    file << std::string(length, fill);
+
+    fixture.files.push_back(path);
+
+    return file.good() ? 0 : -1;
+}
+
+inline int BenchFixtureWriteText(BENCH_FIXTURE& fixture, const std::string& path, const char* text)
+{
+    std::ofstream file(path, std::ios::binary);
+    file << text;
+
+    fixture.files.push_back(path);
+
+    return file.good() ? 0 : -1;
+}
+
+inline int BenchFixtureMakeDirectory(BENCH_FIXTURE& fixture, const std::string& path)
+{
+    if(mkdir(path.c_str(), 0755) < 0)
+        return -1;
+
+    fixture.directories.push_back(path);
+
+    return 0;
+}
+
+// Create a directory from path_template (mkdtemp) holding the pages of the corpus and the 404 page.
+inline int BenchFixtureCreate(const char* path_template, BENCH_FIXTURE& fixture)
+{
+    std::vector<char> root(path_template, path_template + strlen(path_template) + 1);
+
+    if(mkdtemp(root.data()) == nullptr)
+        return -1;
+
+    fixture.root = root.data();
+
+    if( BenchFixtureMakeDirectory(fixture, fixture.root + "/css")                                                                       < 0 ||
+        BenchFixtureMakeDirectory(fixture, fixture.root + "/images")                                                                    < 0 ||
+        BenchFixtureWriteFile(fixture, fixture.root + "/index.html"      , 6144, 'a')                                                   < 0 ||
+        BenchFixtureWriteFile(fixture, fixture.root + "/css/style.css"   , 3072, 'b')                                                   < 0 ||
+        BenchFixtureWriteFile(fixture, fixture.root + "/images/logo.png" , 4096, 'c')                                                   < 0 ||
+        BenchFixtureWriteText(fixture, fixture.root + HTTP_SERVER_DEFAULT_ERROR_404_PAGE_PATH, HTTP_SERVER_DEFAULT_ERROR_404_PAGE)      < 0)
+        return -1;
+
+    return 0;
+}
+
+// Remove everything the fixture holds (whatever got created, if BenchFixtureCreate failed halfway).
+inline void BenchFixtureRemove(BENCH_FIXTURE& fixture)
+{
+    for(std::vector<std::string>::reverse_iterator it = fixture.files.rbegin(); it != fixture.files.rend(); it++)
+        unlink(it->c_str());
+
+    for(std::vector<std::string>::reverse_iterator it = fixture.directories.rbegin(); it != fixture.directories.rend(); it++)
+        rmdir(it->c_str());
+
+    if(!fixture.root.empty())
+        rmdir(fixture.root.c_str());
+
+    fixture.files.clear();
+    fixture.directories.clear();
+    fixture.root.clear();
+}
+
+/***************************************/
+
+#endif
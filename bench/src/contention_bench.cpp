@@ -0,0 +1,325 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpServer.hpp"
+#include "HttpFileCache.hpp"
+#include "SeverityLog_api.h"
+#include "request_corpus.hpp"
+#include "bench_fixture.hpp"
+
+#include <unistd.h>
+#include <getopt.h>
+#include <signal.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/************************************/
+
+/***************************************/
+/********** Private constants **********/
+/***************************************/
+
+#define CONTENTION_BENCH_LOG_BUFFER_SIZE    10000
+#define CONTENTION_BENCH_LOG_MASK           ( (0x01 << 4) | 0x0F )  // Errors only: anything else would be logged per request.
+
+#define CONTENTION_BENCH_DEFAULT_DURATION   1000        // Milliseconds measured per thread count.
+#define CONTENTION_BENCH_HOT_FILES          32          // Files looked up over and over by every thread.
+#define CONTENTION_BENCH_HOT_FILE_LEN       4096
+#define CONTENTION_BENCH_BATCH              64          // Operations between checks of the stop flag.
+
+/***************************************/
+
+/***************************************/
+/********** Private types **************/
+/***************************************/
+
+typedef struct
+{
+    int     threads     ;
+    double  ops         ;
+    double  seconds     ;
+    bool    ok          ;
+} CONTENTION_BENCH_POINT;
+
+// Work done by a single thread until told to stop, counting the operations done. Returns false if
+// any of them fails.
+typedef std::function<bool(int thread_index, const std::atomic<bool>& stop, unsigned long& ops)> CONTENTION_BENCH_WORKER;
+
+/***************************************/
+
+/***************************************/
+/********** Private functions **********/
+/***************************************/
+
+// Whether an entry evicted while a reader only holds it is freed as soon as that reader is
+// released: load path into a cache with room for a single file, look it up, then evict it by
+// loading other_path.
+static bool CheckReleasedReader(const std::string& path, const std::string& other_path)
+{
+    HttpFileCache file_cache(CONTENTION_BENCH_HOT_FILE_LEN, CONTENTION_BENCH_HOT_FILE_LEN);
+    HttpFileCache::Reader reader;
+    std::shared_ptr<const std::string> body;
+    struct stat file_stat;
+
+    if(file_cache.Load(path, body) < 0)
+        return false;
+
+    std::weak_ptr<const std::string> loaded_body = body;
+    body.reset();
+
+    if(!file_cache.Lookup(path, body, file_stat, reader) || file_cache.Load(other_path, body) < 0)
+        return false;
+
+    // Still in use until the reader is released, gone right after.
+    if(loaded_body.expired())
+        return false;
+
+    reader.Release();
+
+    return loaded_body.expired();
+}
+
+// Run worker on threads threads at once for duration_ms, all of them released together.
+static CONTENTION_BENCH_POINT Measure(int threads, int duration_ms, const CONTENTION_BENCH_WORKER& worker)
+{
+    std::atomic<int>    ready(0);
+    std::atomic<bool>   start(false);
+    std::atomic<bool>   stop(false);
+    std::atomic<bool>   ok(true);
+    std::vector<unsigned long>  ops(threads, 0);
+    std::vector<std::thread>    workers;
+
+    for(int i = 0; i < threads; i++)
+    {
+        workers.emplace_back([&, i]()
+        {
+            ready.fetch_add(1);
+            while(!start.load(std::memory_order_acquire))
+                std::this_thread::yield();
+
+            unsigned long thread_ops = 0;
+            if(!worker(i, stop, thread_ops))
+                ok.store(false);
+
+            ops[i] = thread_ops;
+        });
+    }
+
+    while(ready.load() < threads)
+        std::this_thread::yield();
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+    stop.store(true, std::memory_order_relaxed);
+
+    for(std::thread& worker_thread : workers)
+        worker_thread.join();
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    CONTENTION_BENCH_POINT point = {threads, 0.0, std::chrono::duration<double>(end - begin).count(), ok.load()};
+    for(unsigned long thread_ops : ops)
+        point.ops += (double)thread_ops;
+
+    return point;
+}
+
+// Efficiency is the throughput reached against threads times the single-thread one (1.0: linear).
+static void PrintScenario(const char* name, const std::vector<CONTENTION_BENCH_POINT>& points, unsigned int cpus, bool last)
+{
+    double single_thread_rate = points[0].ops / points[0].seconds;
+
+    printf("    {\"name\": \"%s\", \"points\": [\n", name);
+
+    for(size_t i = 0; i < points.size(); i++)
+    {
+        double rate = points[i].ops / points[i].seconds;
+
+        printf("      {\"threads\": %d, \"ops_per_s\": %.0f, \"ops_per_s_per_thread\": %.0f, \"scaling_efficiency\": %.3f, \"oversubscribed\": %s}%s\n",
+               points[i].threads, rate, rate / points[i].threads, rate / (single_thread_rate * points[i].threads),
+               ((unsigned int)points[i].threads > cpus) ? "true" : "false", (i + 1 < points.size()) ? "," : "");
+    }
+
+    printf("    ]}%s\n", last ? "" : ",");
+}
+
+static void PrintUsage(const char* program)
+{
+    fprintf(stderr, "Usage: %s [--max-threads N] [--duration MS]\n", program);
+}
+
+/***************************************/
+
+/*
+@brief Measure how lookups in the process-wide file cache, and whole requests carried by an
+in-memory transport (every server sharing that cache and the other process-wide tables), scale
+with the number of threads doing them at once: 1, 2, 4... up to max-threads (the number of online
+CPUs by default). Reports operations per second and scaling efficiency as JSON. Thread counts
+beyond the number of CPUs are flagged as oversubscribed: they cannot scale. Fails first if a
+released reader keeps an evicted file alive.
+*/
+int main(int argc, char** argv)
+{
+    unsigned int    cpus        = std::max(std::thread::hardware_concurrency(), 1U);
+    int             max_threads = (int)cpus;
+    int             duration_ms = CONTENTION_BENCH_DEFAULT_DURATION;
+
+    static const struct option options[] =
+    {
+        {"max-threads"  , required_argument , nullptr, 't'},
+        {"duration"     , required_argument , nullptr, 'd'},
+        {nullptr        , 0                 , nullptr, 0  },
+    };
+
+    for(int option; (option = getopt_long(argc, argv, "t:d:", options, nullptr)) != -1; )
+    {
+        switch(option)
+        {
+            case 't': max_threads = atoi(optarg);   break;
+            case 'd': duration_ms = atoi(optarg);   break;
+            default : PrintUsage(argv[0]);  return 1;
+        }
+    }
+
+    if(max_threads <= 0 || duration_ms <= 0)
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    SeverityLogInitWithMask(CONTENTION_BENCH_LOG_BUFFER_SIZE, CONTENTION_BENCH_LOG_MASK);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Every resource the corpus asks for, plus the hot files.
+    BENCH_FIXTURE fixture;
+    bool written = (BenchFixtureCreate("/tmp/http_contention_bench.XXXXXX", fixture) == 0);
+
+    std::string root = fixture.root;
+    std::vector<std::string> hot_paths;
+
+    for(int i = 0; i < CONTENTION_BENCH_HOT_FILES && written; i++)
+    {
+        hot_paths.push_back(root + "/hot_" + std::to_string(i) + ".html");
+        written = (BenchFixtureWriteFile(fixture, hot_paths.back(), CONTENTION_BENCH_HOT_FILE_LEN, 'a' + (i % 26)) == 0);
+    }
+
+    if(!written)
+    {
+        fprintf(stderr, "Could not write the resources to %s\n", root.c_str());
+        BenchFixtureRemove(fixture);
+        return 1;
+    }
+
+    if(!CheckReleasedReader(hot_paths[0], hot_paths[1]))
+    {
+        fprintf(stderr, "A released reader kept an evicted file alive\n");
+        BenchFixtureRemove(fixture);
+        return 1;
+    }
+
+    std::vector<std::string> corpus(std::begin(request_corpus), std::end(request_corpus));
+    HttpFileCache& file_cache = HttpFileCache::GetInstance();
+
+    // Hot files loaded once, so that every lookup is a hit.
+    std::shared_ptr<const std::string> preload;
+    for(const std::string& path : hot_paths)
+        file_cache.Load(path, preload);
+
+    // Each thread reads through copies of the index of its own, as every connection does.
+    CONTENTION_BENCH_WORKER lookup_worker = [&](int thread_index, const std::atomic<bool>& stop, unsigned long& ops)
+    {
+        HttpFileCache::Reader reader;
+        std::shared_ptr<const std::string> body;
+        struct stat file_stat;
+        size_t next = thread_index;
+
+        while(!stop.load(std::memory_order_relaxed))
+        {
+            for(int i = 0; i < CONTENTION_BENCH_BATCH; i++)
+            {
+                if(!file_cache.Lookup(hot_paths[next++ % hot_paths.size()], body, file_stat, reader))
+                    return false;
+            }
+
+            ops += CONTENTION_BENCH_BATCH;
+            reader.Release();
+        }
+
+        return true;
+    };
+
+    // A server per thread (as a connection per thread would have), over the completion engine.
+    CONTENTION_BENCH_WORKER request_worker = [&](int thread_index, const std::atomic<bool>& stop, unsigned long& ops)
+    {
+        HttpServer server(root, false, HTTP_SERVER_DEFAULT_MAX_REQUEST_LEN, HTTP_SERVER_IO_COMPLETION);
+        server.SetKeepAlive(HTTP_SERVER_DEFAULT_KEEP_ALIVE_TIMEOUT, 0);
+
+        int memory_socket = -1;
+        std::vector<HTTP_TX_SEGMENT> segments;
+        size_t next = thread_index;
+
+        while(!stop.load(std::memory_order_relaxed))
+        {
+            const std::string& request = corpus[next++ % corpus.size()];
+
+            if(server.FeedData(request.data(), request.size()) < 0 || server.Resume(memory_socket) != HTTP_SERVER_IO_WAIT_WRITE)
+                return false;
+
+            server.GetTxSegments(segments);
+            server.CompleteWrite();
+
+            if(server.Resume(memory_socket) != HTTP_SERVER_IO_WAIT_READ)
+                return false;
+
+            ops++;
+        }
+
+        return true;
+    };
+
+    std::vector<int> thread_counts;
+    for(int threads = 1; threads < max_threads; threads *= 2)
+        thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+
+    // Fill the caches up (compressed variants included) before measuring anything.
+    bool ok = Measure(1, duration_ms / 4 + 1, request_worker).ok;
+
+    std::vector<CONTENTION_BENCH_POINT> lookup_points, request_points;
+
+    for(int threads : thread_counts)
+    {
+        lookup_points.push_back(Measure(threads, duration_ms, lookup_worker));
+        request_points.push_back(Measure(threads, duration_ms, request_worker));
+
+        ok = ok && lookup_points.back().ok && request_points.back().ok;
+    }
+
+    BenchFixtureRemove(fixture);
+
+    if(!ok)
+    {
+        fprintf(stderr, "A lookup or a request failed\n");
+        return 1;
+    }
+
+    printf("{\n  \"config\": {\"cpus\": %u, \"max_threads\": %d, \"duration_ms\": %d, \"hot_files\": %d},\n", cpus, max_threads, duration_ms, CONTENTION_BENCH_HOT_FILES);
+    printf("  \"scenarios\": [\n");
+    PrintScenario("file_cache_lookup"   , lookup_points , cpus, false   );
+    PrintScenario("in_memory_request"   , request_points, cpus, true    );
+    printf("  ]\n}\n");
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpHeaderScan.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+/************************************/
+
+/***************************************/
+/********** Private constants **********/
+/***************************************/
+
+#define HEADER_SCAN_BENCH_ITERATIONS    20000
+#define HEADER_SCAN_BENCH_SEGMENT_LEN   1448    // Typical TCP payload per read.
+#define HEADER_SCAN_BENCH_FUZZ_ROUNDS   200000
+
+/***************************************/
+
+/***************************************/
+/********** Private functions **********/
+/***************************************/
+
+// Request head carrying cookie_bytes of cookies, as sent by sites with many trackers.
+static std::string BuildCookieRequest(size_t cookie_bytes)
+{
+    std::string request =   "GET /index.html HTTP/1.1\r\n"
+                            "Host: www.example.com\r\n"
+                            "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/124.0.0.0 Safari/537.36\r\n"
+                            "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+                            "Accept-Encoding: gzip, deflate, br\r\n"
+                            "Cookie: ";
+
+    for(int i = 0; request.size() < cookie_bytes; i++)
+        request += "_tracker" + std::to_string(i) + "=6f1c2b3a4d5e6f708192a3b4c5d6e7f8; ";
+
+    request += "consent=yes\r\n\r\n";
+
+    return request;
+}
+
+// Former behaviour: the whole buffer is searched again every time a segment is appended.
+static size_t RescanOnEveryRead(const std::string& request)
+{
+    std::string buffer;
+    size_t found = std::string::npos;
+
+    for(size_t offset = 0; offset < request.size() && found == std::string::npos; offset += HEADER_SCAN_BENCH_SEGMENT_LEN)
+    {
+        buffer.append(request, offset, HEADER_SCAN_BENCH_SEGMENT_LEN);
+        found = buffer.find("\r\n\r\n");
+    }
+
+    return found + 4;
+}
+
+// Current behaviour: every search resumes where the previous one stopped.
+static size_t ResumeOnEveryRead(const std::string& request)
+{
+    std::string buffer;
+    size_t scan_offset = 0;
+    size_t found = HTTP_HEADER_SCAN_NOT_FOUND;
+
+    for(size_t offset = 0; offset < request.size() && found == HTTP_HEADER_SCAN_NOT_FOUND; offset += HEADER_SCAN_BENCH_SEGMENT_LEN)
+    {
+        buffer.append(request, offset, HEADER_SCAN_BENCH_SEGMENT_LEN);
+        found = HttpFindHeaderEnd(buffer.data(), buffer.size(), scan_offset);
+        scan_offset = HttpHeaderScanResumeOffset(buffer.size(), scan_offset);
+    }
+
+    return found;
+}
+
+// Compare the selected kernel against std::string::find over random CR/LF-heavy buffers.
+static int CheckAgainstReference(void)
+{
+    static const char alphabet[] = "\r\n\r\na";
+    std::string buffer;
+
+    srand(12345);
+
+    for(int round = 0; round < HEADER_SCAN_BENCH_FUZZ_ROUNDS; round++)
+    {
+        buffer.resize(rand() % 200);
+        for(char& c : buffer)
+            c = alphabet[rand() % (sizeof(alphabet) - 1)];
+
+        size_t from = buffer.empty() ? 0 : rand() % buffer.size();
+        size_t expected = buffer.find("\r\n\r\n", from);
+        expected = (expected == std::string::npos) ? HTTP_HEADER_SCAN_NOT_FOUND : expected + 4;
+
+        if(HttpFindHeaderEnd(buffer.data(), buffer.size(), from) != expected)
+            return -1;
+    }
+
+    return 0;
+}
+
+/***************************************/
+
+/*
+@brief Time the end-of-headers search for requests of growing cookie size, read in TCP-sized segments.
+*/
+int main(void)
+{
+    if(CheckAgainstReference() < 0)
+    {
+        fprintf(stderr, "Header scan kernel does not match std::string::find.\n");
+        return 1;
+    }
+
+    static const size_t cookie_sizes[] = {512, 4096, 16384, 32768};
+    volatile size_t sink = 0;
+
+    printf("[\n");
+
+    for(size_t i = 0; i < sizeof(cookie_sizes) / sizeof(cookie_sizes[0]); i++)
+    {
+        std::string request = BuildCookieRequest(cookie_sizes[i]);
+
+        if(RescanOnEveryRead(request) != ResumeOnEveryRead(request) || ResumeOnEveryRead(request) != request.size())
+        {
+            fprintf(stderr, "Header block length mismatch.\n");
+            return 1;
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(int j = 0; j < HEADER_SCAN_BENCH_ITERATIONS; j++)
+            sink = sink + RescanOnEveryRead(request);
+        std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+        for(int j = 0; j < HEADER_SCAN_BENCH_ITERATIONS; j++)
+            sink = sink + ResumeOnEveryRead(request);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        double rescan_ns = std::chrono::duration<double, std::nano>(middle - start).count() / HEADER_SCAN_BENCH_ITERATIONS;
+        double resume_ns = std::chrono::duration<double, std::nano>(end - middle).count() / HEADER_SCAN_BENCH_ITERATIONS;
+
+        printf("  {\"header_bytes\": %zu, \"rescan_ns\": %.1f, \"resume_ns\": %.1f, \"speedup\": %.2f}%s\n",
+               request.size(), rescan_ns, resume_ns, rescan_ns / resume_ns,
+               (i + 1 < sizeof(cookie_sizes) / sizeof(cookie_sizes[0])) ? "," : "");
+    }
+
+    printf("]\n");
+
+    return 0;
+}
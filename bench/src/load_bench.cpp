@@ -0,0 +1,613 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpServer_api.hpp"
+#include "HttpReactorPool.hpp"
+#include "ServerSocket_api.h"
+#include "SeverityLog_api.h"
+
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <signal.h>
+#include <time.h>
+#include <openssl/ssl.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/************************************/
+
+/***************************************/
+/********** Private constants **********/
+/***************************************/
+
+#define LOAD_BENCH_LOG_BUFFER_SIZE      10000
+#define LOAD_BENCH_LOG_MASK             ( (0x01 << 4) | 0x0F )  // Errors only: anything else would be logged per request.
+
+#define LOAD_BENCH_DEFAULT_PORT         58080       // Plaintext reactors; TLS is served on the next port.
+#define LOAD_BENCH_DEFAULT_CONNECTIONS  8           // One client thread per connection.
+#define LOAD_BENCH_DEFAULT_DURATION     3           // Seconds measured per scenario.
+#define LOAD_BENCH_DEFAULT_WARMUP       1           // Seconds run before measuring.
+#define LOAD_BENCH_DEFAULT_REACTORS     1
+#define LOAD_BENCH_DEFAULT_LARGE_MIB    8
+#define LOAD_BENCH_PIPELINE_DEPTH       16          // Requests sent at once by the pipelined scenario.
+#define LOAD_BENCH_SMALL_FILE_LEN       2048
+#define LOAD_BENCH_LEN_RX_CHUNK         65536
+#define LOAD_BENCH_CONNECT_RETRIES      200         // 10 ms apart: the server may still be starting.
+#define LOAD_BENCH_TLS_TIMEOUT_S        5
+#define LOAD_BENCH_REQUEST_TIMEOUT_S    1           // Request timeout of the loop checked without keep-alive (served two ports after).
+
+/***************************************/
+
+/***************************************/
+/********** Private types **************/
+/***************************************/
+
+typedef struct
+{
+    const char* name            ;
+    const char* method          ;
+    const char* target          ;
+    int         expected_status ;
+    bool        keep_alive      ;   // false: a new connection per request ("Connection: close").
+    int         pipeline_depth  ;   // Requests sent before reading their responses.
+    bool        tls             ;
+} LOAD_BENCH_SCENARIO;
+
+typedef struct
+{
+    int         fd  ;
+    SSL*        ssl ;
+    std::string rx  ;   // Received bytes past the responses parsed so far.
+} LOAD_BENCH_CONNECTION;
+
+typedef struct
+{
+    std::vector<uint64_t>   latencies_ns    ;
+    unsigned long           errors          ;
+    uint64_t                cpu_ns          ;   // Thread CPU time while measuring.
+} LOAD_BENCH_WORKER;
+
+typedef struct
+{
+    int             port            ;
+    int             connections     ;
+    int             duration_s      ;
+    int             warmup_s        ;
+    SSL_CTX*        tls_context     ;   // nullptr: TLS scenarios are skipped.
+} LOAD_BENCH_CONFIG;
+
+static const LOAD_BENCH_SCENARIO scenarios[] =
+{
+    {"small_keep_alive"     , "GET" , "/small.html"     , 200, true , 1                         , false },
+    {"large_keep_alive"     , "GET" , "/large.bin"      , 200, true , 1                         , false },
+    {"not_found"            , "GET" , "/missing.html"   , 404, true , 1                         , false },
+    {"head"                 , "HEAD", "/small.html"     , 200, true , 1                         , false },
+    {"small_new_connection" , "GET" , "/small.html"     , 200, false, 1                         , false },
+    {"small_pipelined"      , "GET" , "/small.html"     , 200, true , LOAD_BENCH_PIPELINE_DEPTH , false },
+    {"tls_keep_alive"       , "GET" , "/small.html"     , 200, true , 1                         , true  },
+    {"tls_new_connection"   , "GET" , "/small.html"     , 200, false, 1                         , true  },
+};
+
+/***************************************/
+
+/***************************************/
+/********** Private functions **********/
+/***************************************/
+
+static uint64_t GetClockNs(clockid_t clock)
+{
+    struct timespec now;
+    clock_gettime(clock, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+// User and system time of the whole process (server and client threads).
+static uint64_t GetProcessCpuNs(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    return ((uint64_t)usage.ru_utime.tv_sec + (uint64_t)usage.ru_stime.tv_sec) * 1000000000ULL +
+           ((uint64_t)usage.ru_utime.tv_usec + (uint64_t)usage.ru_stime.tv_usec) * 1000ULL;
+}
+
+static int WriteFile(const std::string& path, size_t length, char fill)
+{
+    std::ofstream file(path, std::ios::binary);
+    std::string chunk(LOAD_BENCH_LEN_RX_CHUNK, fill);
+
+    for(size_t written = 0; written < length; written += chunk.size())
+        file.write(chunk.data(), std::min(chunk.size(), length - written));
+
+    return file.good() ? 0 : -1;
+}
+
+static int WriteText(const std::string& path, const char* text)
+{
+    std::ofstream file(path, std::ios::binary);
+    file << text;
+
+    return file.good() ? 0 : -1;
+}
+
+static void Disconnect(LOAD_BENCH_CONNECTION& connection)
+{
+    if(connection.ssl != nullptr)
+    {
+        SSL_shutdown(connection.ssl);
+        SSL_free(connection.ssl);
+    }
+
+    if(connection.fd >= 0)
+        close(connection.fd);
+
+    connection.fd   = -1;
+    connection.ssl  = nullptr;
+    connection.rx.clear();
+}
+
+static int Connect(int port, SSL_CTX* tls_context, LOAD_BENCH_CONNECTION& connection)
+{
+    struct sockaddr_in address = {};
+    address.sin_family      = AF_INET;
+    address.sin_port        = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    connection.fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(connection.fd < 0)
+        return -1;
+
+    int enable = 1;
+    setsockopt(connection.fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+    if(connect(connection.fd, (struct sockaddr*)&address, sizeof(address)) < 0)
+    {
+        Disconnect(connection);
+        return -1;
+    }
+
+    if(tls_context == nullptr)
+        return 0;
+
+    connection.ssl = SSL_new(tls_context);
+    SSL_set_fd(connection.ssl, connection.fd);
+
+    if(SSL_connect(connection.ssl) != 1)
+    {
+        Disconnect(connection);
+        return -1;
+    }
+
+    return 0;
+}
+
+static bool SendAll(LOAD_BENCH_CONNECTION& connection, const std::string& data)
+{
+    for(size_t sent = 0; sent < data.size(); )
+    {
+        long int result;
+
+        if(connection.ssl != nullptr)
+            result = SSL_write(connection.ssl, data.data() + sent, (int)(data.size() - sent));
+        else
+            result = send(connection.fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+
+        if(result <= 0)
+            return false;
+
+        sent += result;
+    }
+
+    return true;
+}
+
+static long int Receive(LOAD_BENCH_CONNECTION& connection, char* buffer, size_t length)
+{
+    if(connection.ssl != nullptr)
+        return SSL_read(connection.ssl, buffer, (int)length);
+
+    return recv(connection.fd, buffer, length, 0);
+}
+
+// Value of a header field within a header block, or an empty string (names are case-insensitive).
+static std::string FindHeader(const std::string& head, const char* name)
+{
+    size_t name_len = strlen(name);
+
+    for(size_t line = head.find("\r\n"); line != std::string::npos && line + 2 < head.size(); line = head.find("\r\n", line + 2))
+    {
+        if(strncasecmp(head.c_str() + line + 2, name, name_len) != 0 || head[line + 2 + name_len] != ':')
+            continue;
+
+        size_t value_begin  = head.find_first_not_of(' ', line + 3 + name_len);
+        size_t value_end    = head.find("\r\n", value_begin);
+
+        return head.substr(value_begin, value_end - value_begin);
+    }
+
+    return "";
+}
+
+// Read one response, discarding its body. Returns its status code (-1 on errors); closed tells
+// whether the server is closing the connection afterwards.
+static int ReadResponse(LOAD_BENCH_CONNECTION& connection, bool head_request, bool& closed, std::vector<char>& chunk)
+{
+    size_t head_end;
+
+    while((head_end = connection.rx.find("\r\n\r\n")) == std::string::npos)
+    {
+        long int received = Receive(connection, chunk.data(), chunk.size());
+        if(received <= 0)
+            return -1;
+
+        connection.rx.append(chunk.data(), received);
+    }
+
+    std::string head = connection.rx.substr(0, head_end + 2);
+    connection.rx.erase(0, head_end + 4);
+
+    if(head.size() < 12)
+        return -1;
+
+    int     status      = atoi(head.c_str() + 9);
+    size_t  body_left   = head_request ? 0 : strtoul(FindHeader(head, "Content-Length").c_str(), nullptr, 10);
+
+    closed = (strcasecmp(FindHeader(head, "Connection").c_str(), "close") == 0);
+
+    // Bytes already buffered first; the rest is read into the chunk and dropped, so that large
+    // bodies are never held in memory. Whatever follows the body (pipelining) is kept.
+    size_t buffered = std::min(body_left, connection.rx.size());
+    connection.rx.erase(0, buffered);
+    body_left -= buffered;
+
+    while(body_left > 0)
+    {
+        long int received = Receive(connection, chunk.data(), chunk.size());
+        if(received <= 0)
+            return -1;
+
+        if((size_t)received > body_left)
+            connection.rx.append(chunk.data() + body_left, received - body_left);
+
+        body_left -= std::min((size_t)received, body_left);
+    }
+
+    return status;
+}
+
+// Closed loop: every connection sends its next request (or batch) as soon as the previous one
+// has been answered. Only requests completed while measuring are accounted.
+static void RunWorker(const LOAD_BENCH_SCENARIO& scenario, const LOAD_BENCH_CONFIG& config, std::atomic<bool>& running, std::atomic<bool>& measuring, LOAD_BENCH_WORKER& worker)
+{
+    LOAD_BENCH_CONNECTION   connection  = {-1, nullptr, ""};
+    SSL_CTX*                tls_context = scenario.tls ? config.tls_context : nullptr;
+    int                     port        = scenario.tls ? config.port + 1 : config.port;
+    bool                    head        = (strcmp(scenario.method, "HEAD") == 0);
+    uint64_t                cpu_begin   = 0;
+    bool                    measured    = false;
+    std::vector<char>       chunk(LOAD_BENCH_LEN_RX_CHUNK);
+    std::string             batch;
+
+    std::string request = std::string(scenario.method) + " " + scenario.target + " HTTP/1.1\r\nHost: localhost\r\n" +
+                          (scenario.keep_alive ? "" : "Connection: close\r\n") + "\r\n";
+
+    for(int i = 0; i < scenario.pipeline_depth; i++)
+        batch += request;
+
+    while(running.load(std::memory_order_relaxed))
+    {
+        if(!measured && measuring.load(std::memory_order_relaxed))
+        {
+            cpu_begin   = GetClockNs(CLOCK_THREAD_CPUTIME_ID);
+            measured    = true;
+        }
+
+        uint64_t batch_begin = GetClockNs(CLOCK_MONOTONIC);
+
+        if(connection.fd < 0 && Connect(port, tls_context, connection) < 0)
+        {
+            worker.errors += measured ? 1 : 0;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        if(!SendAll(connection, batch))
+        {
+            worker.errors += measured ? 1 : 0;
+            Disconnect(connection);
+            continue;
+        }
+
+        for(int i = 0; i < scenario.pipeline_depth; i++)
+        {
+            bool closed = false;
+            int status  = ReadResponse(connection, head, closed, chunk);
+
+            // Requests completed after the measuring window would inflate the rate.
+            if(measured && running.load(std::memory_order_relaxed))
+            {
+                if(status == scenario.expected_status)
+                    worker.latencies_ns.push_back(GetClockNs(CLOCK_MONOTONIC) - batch_begin);
+                else
+                    worker.errors++;
+            }
+
+            if(status < 0 || closed)
+            {
+                Disconnect(connection);
+                break;
+            }
+        }
+    }
+
+    if(measured)
+        worker.cpu_ns = GetClockNs(CLOCK_THREAD_CPUTIME_ID) - cpu_begin;
+
+    Disconnect(connection);
+}
+
+static uint64_t GetPercentile(const std::vector<uint64_t>& sorted, double percentile)
+{
+    if(sorted.empty())
+        return 0;
+
+    size_t rank = (size_t)std::ceil(percentile * (double)sorted.size());
+
+    return sorted[std::max(rank, (size_t)1) - 1];
+}
+
+static void RunScenario(const LOAD_BENCH_SCENARIO& scenario, const LOAD_BENCH_CONFIG& config, bool first)
+{
+    std::atomic<bool>               running(true);
+    std::atomic<bool>               measuring(false);
+    std::vector<LOAD_BENCH_WORKER>  workers(config.connections, {{}, 0, 0});
+    std::vector<std::thread>        threads;
+
+    for(int i = 0; i < config.connections; i++)
+        threads.emplace_back(RunWorker, std::cref(scenario), std::cref(config), std::ref(running), std::ref(measuring), std::ref(workers[i]));
+
+    std::this_thread::sleep_for(std::chrono::seconds(config.warmup_s));
+
+    uint64_t cpu_begin  = GetProcessCpuNs();
+    uint64_t begin      = GetClockNs(CLOCK_MONOTONIC);
+    measuring.store(true);
+
+    std::this_thread::sleep_for(std::chrono::seconds(config.duration_s));
+
+    running.store(false);
+    uint64_t elapsed = GetClockNs(CLOCK_MONOTONIC) - begin;
+
+    for(std::thread& thread : threads)
+        thread.join();
+
+    uint64_t                cpu_total   = GetProcessCpuNs() - cpu_begin;
+    uint64_t                cpu_clients = 0;
+    unsigned long           errors      = 0;
+    std::vector<uint64_t>   latencies;
+
+    for(LOAD_BENCH_WORKER& worker : workers)
+    {
+        latencies.insert(latencies.end(), worker.latencies_ns.begin(), worker.latencies_ns.end());
+        cpu_clients += worker.cpu_ns;
+        errors      += worker.errors;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    // The server runs in this very process: its CPU time is whatever the clients did not use.
+    double requests     = (double)latencies.size();
+    double cpu_server   = (double)(cpu_total > cpu_clients ? cpu_total - cpu_clients : 0);
+    double per_request  = (requests > 0) ? requests : 1;
+
+    printf("%s    {\"name\": \"%s\", \"requests\": %.0f, \"errors\": %lu, \"rps\": %.1f, ", first ? "" : ",\n", scenario.name, requests, errors, requests * 1e9 / (double)elapsed);
+    printf("\"latency_us\": {\"p50\": %.1f, \"p99\": %.1f, \"p999\": %.1f, \"max\": %.1f}, ",
+           GetPercentile(latencies, 0.5) / 1e3, GetPercentile(latencies, 0.99) / 1e3, GetPercentile(latencies, 0.999) / 1e3, GetPercentile(latencies, 1.0) / 1e3);
+    printf("\"server_cpu_us_per_request\": %.2f, \"client_cpu_us_per_request\": %.2f}", cpu_server / per_request / 1e3, (double)cpu_clients / per_request / 1e3);
+    fflush(stdout);
+}
+
+// Whether a loop without keep-alive closes a connection that never sends a request once its
+// request timeout expires (and not much later).
+static bool CheckRequestTimeout(const char* docroot, const HTTP_EVENT_LOOP_CONFIG& base_config)
+{
+    HTTP_EVENT_LOOP_CONFIG loop_config = base_config;
+    loop_config.server_port         = base_config.server_port + 2;
+    loop_config.keep_alive_timeout  = 0;
+    loop_config.request_timeout     = LOAD_BENCH_REQUEST_TIMEOUT_S;
+
+    HttpReactorPool reactor_pool(docroot, loop_config, 1, {});
+    std::thread     reactor_thread([&reactor_pool](){ reactor_pool.Run(); });
+
+    LOAD_BENCH_CONNECTION connection = {-1, nullptr, ""};
+    for(int i = 0; i < LOAD_BENCH_CONNECT_RETRIES && Connect(loop_config.server_port, nullptr, connection) < 0; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    bool closed = false;
+
+    if(connection.fd >= 0)
+    {
+        struct timeval timeout = {LOAD_BENCH_REQUEST_TIMEOUT_S * 3, 0};
+        setsockopt(connection.fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        char byte;
+        closed = (recv(connection.fd, &byte, sizeof(byte), 0) == 0);
+    }
+
+    Disconnect(connection);
+
+    reactor_pool.Stop();
+    reactor_thread.join();
+
+    return closed;
+}
+
+static void PrintUsage(const char* program)
+{
+    fprintf(stderr, "Usage: %s [--port P] [--connections N] [--duration S] [--warmup S] [--reactors N] [--io-uring]\n"
+                    "          [--large-mib M] [--scenario NAME] [--cert FILE --key FILE]\n", program);
+}
+
+/***************************************/
+
+/*
+@brief Serve a generated set of files from this very process and load it through every scenario.
+Then check that connections which never send a request are closed even without keep-alive.
+*/
+int main(int argc, char** argv)
+{
+    LOAD_BENCH_CONFIG config = {LOAD_BENCH_DEFAULT_PORT, LOAD_BENCH_DEFAULT_CONNECTIONS, LOAD_BENCH_DEFAULT_DURATION, LOAD_BENCH_DEFAULT_WARMUP, nullptr};
+    int         reactors    = LOAD_BENCH_DEFAULT_REACTORS;
+    bool        io_uring    = false;
+    long int    large_mib   = LOAD_BENCH_DEFAULT_LARGE_MIB;
+    std::string only_scenario;
+    std::string path_cert;
+    std::string path_pkey;
+
+    static const struct option options[] =
+    {
+        {"port"         , required_argument , nullptr, 'p'},
+        {"connections"  , required_argument , nullptr, 'c'},
+        {"duration"     , required_argument , nullptr, 'd'},
+        {"warmup"       , required_argument , nullptr, 'w'},
+        {"reactors"     , required_argument , nullptr, 'r'},
+        {"io-uring"     , no_argument       , nullptr, 'q'},
+        {"large-mib"    , required_argument , nullptr, 'l'},
+        {"scenario"     , required_argument , nullptr, 's'},
+        {"cert"         , required_argument , nullptr, 'C'},
+        {"key"          , required_argument , nullptr, 'K'},
+        {nullptr        , 0                 , nullptr, 0  },
+    };
+
+    for(int option; (option = getopt_long(argc, argv, "p:c:d:w:r:ql:s:C:K:", options, nullptr)) != -1; )
+    {
+        switch(option)
+        {
+            case 'p': config.port           = atoi(optarg); break;
+            case 'c': config.connections    = atoi(optarg); break;
+            case 'd': config.duration_s     = atoi(optarg); break;
+            case 'w': config.warmup_s       = atoi(optarg); break;
+            case 'r': reactors              = atoi(optarg); break;
+            case 'q': io_uring              = true;         break;
+            case 'l': large_mib             = atol(optarg); break;
+            case 's': only_scenario         = optarg;       break;
+            case 'C': path_cert             = optarg;       break;
+            case 'K': path_pkey             = optarg;       break;
+            default : PrintUsage(argv[0]);  return 1;
+        }
+    }
+
+    if(config.connections <= 0 || config.duration_s <= 0 || config.warmup_s < 0 || reactors <= 0 || large_mib <= 0)
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    SeverityLogInitWithMask(LOAD_BENCH_LOG_BUFFER_SIZE, LOAD_BENCH_LOG_MASK);
+    // Peers closing first (new connection scenarios, TLS shutdowns) must not kill the process.
+    signal(SIGPIPE, SIG_IGN);
+
+    char docroot[] = "/tmp/http_load_bench.XXXXXX";
+    if(mkdtemp(docroot) == nullptr)
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    std::string path_small  = std::string(docroot) + "/small.html";
+    std::string path_large  = std::string(docroot) + "/large.bin";
+    std::string path_404    = std::string(docroot) + HTTP_SERVER_DEFAULT_ERROR_404_PAGE_PATH;
+    size_t      large_bytes = (size_t)large_mib * 1024 * 1024;
+
+    if(WriteFile(path_small, LOAD_BENCH_SMALL_FILE_LEN, 'a') < 0 || WriteFile(path_large, large_bytes, 'b') < 0 || WriteText(path_404, HTTP_SERVER_DEFAULT_ERROR_404_PAGE) < 0)
+    {
+        fprintf(stderr, "Could not create the files to be served in %s.\n", docroot);
+        return 1;
+    }
+
+    // Connections carry any number of requests, so that keep-alive scenarios never reconnect.
+    HTTP_EVENT_LOOP_CONFIG loop_config = {};
+    loop_config.server_port         = config.port;
+    loop_config.max_connections     = config.connections * 4 + 64;
+    loop_config.max_request_len     = HTTP_SERVER_DEFAULT_MAX_REQUEST_LEN;
+    loop_config.io_uring            = io_uring;
+    loop_config.keep_alive_timeout  = HTTP_SERVER_DEFAULT_KEEP_ALIVE_TIMEOUT;
+    loop_config.keep_alive_requests = 0;
+
+    HttpReactorPool reactor_pool(docroot, loop_config, reactors, {});
+    std::thread     reactor_thread([&reactor_pool](){ reactor_pool.Run(); });
+
+    // TLS is provided by C_Server_Socket, which serves until the process exits.
+    if(!path_cert.empty() && !path_pkey.empty())
+    {
+        HttpInteract::SetPathToResources(docroot);
+        HttpInteract::SetSecureConnection(true);
+        HttpInteract::SetKeepAlive(HTTP_SERVER_DEFAULT_KEEP_ALIVE_TIMEOUT, 0);
+
+        std::thread([&config, path_cert, path_pkey]()
+        {
+            ServerSocketRun(config.port + 1, config.connections * 4 + 64, true, false, true, false,
+                            LOAD_BENCH_TLS_TIMEOUT_S, 0, LOAD_BENCH_TLS_TIMEOUT_S, 0, true, path_cert.c_str(), path_pkey.c_str(), HttpInteract::InteractFn);
+        }).detach();
+
+        config.tls_context = SSL_CTX_new(TLS_client_method());
+        SSL_CTX_set_verify(config.tls_context, SSL_VERIFY_NONE, nullptr);
+    }
+
+    // Wait for the reactors to listen.
+    LOAD_BENCH_CONNECTION probe = {-1, nullptr, ""};
+    for(int i = 0; i < LOAD_BENCH_CONNECT_RETRIES && Connect(config.port, nullptr, probe) < 0; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    Disconnect(probe);
+
+    printf("{\n  \"config\": {\"connections\": %d, \"duration_s\": %d, \"warmup_s\": %d, \"reactors\": %d, \"io_uring\": %s, \"large_file_bytes\": %zu, \"cpus\": %u},\n",
+           config.connections, config.duration_s, config.warmup_s, reactors, io_uring ? "true" : "false", large_bytes, std::thread::hardware_concurrency());
+    printf("  \"scenarios\": [\n");
+
+    bool first = true;
+
+    for(const LOAD_BENCH_SCENARIO& scenario : scenarios)
+    {
+        if(!only_scenario.empty() && only_scenario != scenario.name)
+            continue;
+
+        if(scenario.tls && config.tls_context == nullptr)
+            continue;
+
+        RunScenario(scenario, config, first);
+        first = false;
+    }
+
+    printf("\n  ]\n}\n");
+
+    reactor_pool.Stop();
+    reactor_thread.join();
+
+    bool request_timeout_ok = CheckRequestTimeout(docroot, loop_config);
+    if(!request_timeout_ok)
+        fprintf(stderr, "A silent connection was not closed without keep-alive.\n");
+
+    unlink(path_small.c_str());
+    unlink(path_large.c_str());
+    unlink(path_404.c_str());
+    rmdir(docroot);
+
+    return request_timeout_ok ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpRequestParser.hpp"
+#include "request_corpus.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/************************************/
+
+/***************************************/
+/********** Private constants **********/
+/***************************************/
+
+#define PARSER_BENCH_ITERATIONS     200000
+
+/***************************************/
+
+/***************************************/
+/********* Legacy implementation *******/
+/***************************************/
+
+// Copy of the istringstream based pipeline previously found in HttpServer::ProcessRequest.
+// Logging of unknown fields has been left out, which makes it look slightly better than it was.
+static std::map<const std::string, std::string> legacy_request_fields =
+{
+    {"Method", ""}, {"Requested resource", ""}, {"Protocol", ""}, {"Host", ""}, {"Connection", ""},
+    {"Cache-Control", ""}, {"Upgrade-Insecure-Requests", ""}, {"User-Agent", ""}, {"Accept", ""},
+    {"Content-Length", ""}, {"Referer", ""}, {"Accept-Encoding", ""}, {"Accept-Language", ""},
+    {"Purpose", ""}, {"Sec-Purpose", ""}, {"sec-ch-ua", ""}, {"sec-ch-ua-mobile", ""},
+    {"sec-ch-ua-platform", ""}, {"Sec-Fetch-Site", ""}, {"Sec-Fetch-Mode", ""}, {"Sec-Fetch-User", ""},
+    {"Sec-Fetch-Dest", ""},
+};
+
+static std::vector<std::string> LegacyExtractWordsFromReqLine(const std::string& input)
+{
+    std::vector<std::string> words;
+    std::istringstream iss(input);
+    std::string word;
+
+    while (iss >> word)
+        words.push_back(word);
+
+    return words;
+}
+
+static int LegacyProcessRequest(const std::string& read_from_client)
+{
+    std::string line;
+    std::istringstream iss(read_from_client);
+
+    std::getline(iss, line);
+    if(!line.empty() && line[line.size() - 1] == '\r')
+        line.erase(line.size() - 1);
+
+    for(std::pair<const std::string, std::string>& p : legacy_request_fields)
+        p.second = "";
+
+    std::vector<std::string> words_from_req_line = LegacyExtractWordsFromReqLine(line);
+
+    legacy_request_fields.at("Method")             = words_from_req_line[0];
+    legacy_request_fields.at("Requested resource") = words_from_req_line[1];
+    legacy_request_fields.at("Protocol")           = words_from_req_line[2];
+
+    int unknown_fields = 0;
+
+    while(std::getline(iss, line))
+    {
+        size_t pos = line.find(": ");
+        std::string key;
+        std::string value;
+
+        if(!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+
+        if(line.empty())
+            continue;
+
+        if (pos != std::string::npos)
+        {
+            key     = line.substr(0, pos);
+            value   = line.substr(pos + 2);
+        }
+
+        if(legacy_request_fields.count(key) != 0)
+            legacy_request_fields.at(key) = value;
+        else
+            unknown_fields++;
+    }
+
+    return unknown_fields;
+}
+
+/***************************************/
+
+/*
+@brief Parse every request of the corpus PARSER_BENCH_ITERATIONS times with both implementations.
+*/
+int main(void)
+{
+    std::vector<std::string> corpus(std::begin(request_corpus), std::end(request_corpus));
+    size_t corpus_bytes = 0;
+    for(const std::string& request : corpus)
+        corpus_bytes += request.size();
+
+    HttpRequestParser parser;
+    volatile size_t sink = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int i = 0; i < PARSER_BENCH_ITERATIONS; i++)
+        for(const std::string& request : corpus)
+            sink = sink + LegacyProcessRequest(request);
+    std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+    for(int i = 0; i < PARSER_BENCH_ITERATIONS; i++)
+        for(const std::string& request : corpus)
+        {
+            parser.Reset();
+            sink = sink + parser.Parse(request) + parser.GetHeader(HTTP_HDR_CONNECTION).size();
+        }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    double requests     = (double)PARSER_BENCH_ITERATIONS * corpus.size();
+    double bytes        = (double)PARSER_BENCH_ITERATIONS * corpus_bytes;
+    double legacy_ns    = std::chrono::duration<double, std::nano>(middle - start).count();
+    double parser_ns    = std::chrono::duration<double, std::nano>(end - middle).count();
+
+    printf("{\n");
+    printf("  \"requests\": %.0f,\n", requests);
+    printf("  \"legacy\": {\"ns_per_request\": %.1f, \"MB_per_s\": %.1f},\n", legacy_ns / requests, bytes / legacy_ns * 1000.0);
+    printf("  \"parser\": {\"ns_per_request\": %.1f, \"MB_per_s\": %.1f},\n", parser_ns / requests, bytes / parser_ns * 1000.0);
+    printf("  \"speedup\": %.2f\n", legacy_ns / parser_ns);
+    printf("}\n");
+
+    return 0;
+}
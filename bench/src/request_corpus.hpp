@@ -0,0 +1,58 @@
+#ifndef CPP_HTTP_BENCH_REQUEST_CORPUS_HPP
+#define CPP_HTTP_BENCH_REQUEST_CORPUS_HPP
+
+// Request heads as sent by real clients, shared by the benchmarks.
+
+/***************************************/
+/************ Request corpus ***********/
+/***************************************/
+
+static const char* const request_corpus[] =
+{
+    // Chrome, top-level navigation.
+    "GET /index.html HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "Connection: keep-alive\r\n"
+    "Cache-Control: max-age=0\r\n"
+    "sec-ch-ua: \"Chromium\";v=\"124\", \"Google Chrome\";v=\"124\", \"Not-A.Brand\";v=\"99\"\r\n"
+    "sec-ch-ua-mobile: ?0\r\n"
+    "sec-ch-ua-platform: \"Linux\"\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/124.0.0.0 Safari/537.36\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,image/apng,*/*;q=0.8\r\n"
+    "Sec-Fetch-Site: none\r\n"
+    "Sec-Fetch-Mode: navigate\r\n"
+    "Sec-Fetch-User: ?1\r\n"
+    "Sec-Fetch-Dest: document\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Accept-Language: en-US,en;q=0.9,es;q=0.8\r\n"
+    "Cookie: _ga=GA1.1.123456789.1700000000; session=6f1c2b3a4d5e6f708192a3b4c5d6e7f8; theme=dark; consent=yes\r\n"
+    "\r\n",
+
+    // Firefox, stylesheet.
+    "GET /css/style.css HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:125.0) Gecko/20100101 Firefox/125.0\r\n"
+    "Accept: text/css,*/*;q=0.1\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Referer: https://www.example.com/index.html\r\n"
+    "Connection: keep-alive\r\n"
+    "Sec-Fetch-Dest: style\r\n"
+    "Sec-Fetch-Mode: no-cors\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "If-Modified-Since: Tue, 14 May 2024 09:12:44 GMT\r\n"
+    "If-None-Match: \"3f2a-1715677964\"\r\n"
+    "\r\n",
+
+    // curl.
+    "GET /images/logo.png HTTP/1.1\r\n"
+    "Host: localhost:50000\r\n"
+    "User-Agent: curl/8.5.0\r\n"
+    "Accept: */*\r\n"
+    "\r\n",
+};
+
+/***************************************/
+
+#endif
@@ -0,0 +1,401 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpServer.hpp"
+#include "HttpStaticTables.hpp"
+#include "HttpAccessLog.hpp"
+#include "HttpResourceManifest.hpp"
+#include "SeverityLog_api.h"
+#include "request_corpus.hpp"
+#include "bench_fixture.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <signal.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/************************************/
+
+/***************************************/
+/********** Private constants **********/
+/***************************************/
+
+#define SERVER_BENCH_LOG_BUFFER_SIZE    10000
+#define SERVER_BENCH_LOG_MASK           ( (0x01 << 4) | 0x0F )  // Errors only: anything else would be logged per request.
+
+#define SERVER_BENCH_STAGE_ITERATIONS   100000      // Per request of the corpus.
+#define SERVER_BENCH_IO_ITERATIONS      20000       // Per request of the corpus, whole request over a transport.
+#define SERVER_BENCH_WARMUP_ITERATIONS  1000
+#define SERVER_BENCH_WARMUP_WAIT_MS     200         // Compressed variants are built in the background.
+#define SERVER_BENCH_LEN_RX_CHUNK       65536
+
+/***************************************/
+
+/***************************************/
+/********** Private types **************/
+/***************************************/
+
+typedef struct
+{
+    double ns           ;
+    double allocations  ;
+    double requests     ;
+} SERVER_BENCH_RESULT;
+
+/***************************************/
+
+/***************************************/
+/********** Allocation count ***********/
+/***************************************/
+
+// Every allocation made by the benchmarked thread (background compression jobs are left out).
+static thread_local unsigned long allocation_count = 0;
+
+void* operator new(size_t size)
+{
+    allocation_count++;
+
+    void* ptr = malloc(size > 0 ? size : 1);
+    if(ptr == nullptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+/***************************************/
+
+/***************************************/
+/************* Test seam ***************/
+/***************************************/
+
+// Befriended by HttpServer: reaches the private stages that HttpServer::Resume goes through.
+class HttpServerBench
+{
+public:
+    // Request received and parsed, as done by the READ and PROCESS_REQUEST steps.
+    static int Parse(HttpServer& server, const std::string& request)
+    {
+        server.Reset();
+
+        if(server.FeedData(request.data(), request.size()) < 0 || !server.CheckRequestEnd())
+            return -1;
+
+        return server.ProcessRequest();
+    }
+
+    // Response to the request last parsed, released right away.
+    static long int Generate(HttpServer& server)
+    {
+        long int response_size = server.GenerateResponse();
+        server.ClearResponses();
+
+        return response_size;
+    }
+
+    static std::string_view LookupMIME(HttpServer& server, const std::string& path)
+    {
+        return extension_to_content_type.Find(server.ParseFileExtension(path), "");
+    }
+
+    // Requested file found on disk and its contents taken from the file cache.
+    static int LookupFile(HttpServer& server, std::shared_ptr<const std::string>& body)
+    {
+        std::string path = server.GetPathToRequestedResource();
+
+        if(server.GetRequestedResourceSize(path) < 0)
+            return -1;
+
+        return server.CopyFileToString(path, body);
+    }
+};
+
+/***************************************/
+
+/***************************************/
+/********** Private functions **********/
+/***************************************/
+
+// Run step over every request of the corpus, iterations times. Returns false if any step fails.
+static bool Measure(size_t corpus_size, int iterations, const std::function<bool(size_t)>& step, SERVER_BENCH_RESULT& result)
+{
+    bool ok = true;
+
+    unsigned long allocations_before = allocation_count;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for(int i = 0; i < iterations && ok; i++)
+        for(size_t request = 0; request < corpus_size && ok; request++)
+            ok = step(request);
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    result.ns           = std::chrono::duration<double, std::nano>(end - start).count();
+    result.allocations  = (double)(allocation_count - allocations_before);
+    result.requests     = (double)iterations * corpus_size;
+
+    return ok;
+}
+
+static void PrintResult(const char* name, const SERVER_BENCH_RESULT& result, bool last)
+{
+    printf("  \"%s\": {\"ns_per_request\": %.1f, \"allocs_per_request\": %.2f}%s\n",
+           name, result.ns / result.requests, result.allocations / result.requests, last ? "" : ",");
+}
+
+/***************************************/
+
+/*
+@brief Time the stages of HttpServer (parsing, response generation, MIME and file lookups) and
+whole requests carried by an in-memory transport and by a socketpair, for every request of the
+corpus, then the in-memory transport for a file that does not exist, again with the access log
+enabled, and file lookups and the in-memory transport with the resource manifest built. Reports
+nanoseconds and allocations per request as JSON. Fails if a symbolic link leading outside the
+resources directory is served, with or without the manifest.
+*/
+int main(void)
+{
+    SeverityLogInitWithMask(SERVER_BENCH_LOG_BUFFER_SIZE, SERVER_BENCH_LOG_MASK);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Every resource the corpus asks for, plus a file outside of the resources directory and a
+    // symbolic link to it.
+    BENCH_FIXTURE fixture;
+    bool written =  BenchFixtureCreate("/tmp/http_server_bench.XXXXXX", fixture)                    == 0    &&
+                    BenchFixtureWriteFile(fixture, fixture.root + "_outside.html", 1024, 'd')       == 0;
+
+    std::string root = fixture.root;
+
+    if(written)
+    {
+        written = (symlink((root + "_outside.html").c_str(), (root + "/escape.html").c_str()) == 0);
+        fixture.files.push_back(root + "/escape.html");
+    }
+
+    if(!written)
+    {
+        fprintf(stderr, "Could not write the resources to %s\n", root.c_str());
+        BenchFixtureRemove(fixture);
+        return 1;
+    }
+
+    std::vector<std::string> corpus(std::begin(request_corpus), std::end(request_corpus));
+
+    // One server per request for the stages, so that each one keeps its request parsed.
+    std::vector<std::unique_ptr<HttpServer>> stage_servers;
+    for(size_t i = 0; i < corpus.size(); i++)
+    {
+        stage_servers.push_back(std::make_unique<HttpServer>(root, false, HTTP_SERVER_DEFAULT_MAX_REQUEST_LEN, HTTP_SERVER_IO_COMPLETION));
+        stage_servers[i]->SetKeepAlive(HTTP_SERVER_DEFAULT_KEEP_ALIVE_TIMEOUT, 0);
+    }
+
+    HttpServer memory_server(root, false, HTTP_SERVER_DEFAULT_MAX_REQUEST_LEN, HTTP_SERVER_IO_COMPLETION);
+    HttpServer socket_server(root, false, HTTP_SERVER_DEFAULT_MAX_REQUEST_LEN, HTTP_SERVER_IO_NON_BLOCKING);
+    memory_server.SetKeepAlive(HTTP_SERVER_DEFAULT_KEEP_ALIVE_TIMEOUT, 0);
+    socket_server.SetKeepAlive(HTTP_SERVER_DEFAULT_KEEP_ALIVE_TIMEOUT, 0);
+
+    int sockets[2];
+    if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sockets) < 0)
+    {
+        perror("socketpair");
+        BenchFixtureRemove(fixture);
+        return 1;
+    }
+
+    int memory_socket = -1;
+    std::vector<HTTP_TX_SEGMENT> segments;
+    std::vector<char> rx_chunk(SERVER_BENCH_LEN_RX_CHUNK);
+    std::shared_ptr<const std::string> body;
+    volatile size_t sink = 0;
+
+    std::function<bool(size_t)> parse_step = [&](size_t request)
+    {
+        return (HttpServerBench::Parse(*stage_servers[request], corpus[request]) == 0);
+    };
+
+    std::function<bool(size_t)> generate_step = [&](size_t request)
+    {
+        return (HttpServerBench::Generate(*stage_servers[request]) >= 0);
+    };
+
+    std::function<bool(size_t)> mime_step = [&](size_t request)
+    {
+        static const std::string paths[] = {"/index.html", "/css/style.css", "/images/logo.png"};
+        sink = sink + HttpServerBench::LookupMIME(*stage_servers[request], paths[request % std::size(paths)]).size();
+        return true;
+    };
+
+    std::function<bool(size_t)> file_step = [&](size_t request)
+    {
+        bool found = (HttpServerBench::LookupFile(*stage_servers[request], body) == 0);
+        sink = sink + body->size();
+        return found;
+    };
+
+    // Completion engine without any socket: request fed, response taken from its segments.
+    std::function<bool(size_t)> memory_step = [&](size_t request)
+    {
+        if(memory_server.FeedData(corpus[request].data(), corpus[request].size()) < 0 || memory_server.Resume(memory_socket) != HTTP_SERVER_IO_WAIT_WRITE)
+            return false;
+
+        memory_server.GetTxSegments(segments);
+        for(const HTTP_TX_SEGMENT& segment : segments)
+            sink = sink + segment.length;
+
+        memory_server.CompleteWrite();
+
+        return (memory_server.Resume(memory_socket) == HTTP_SERVER_IO_WAIT_READ);
+    };
+
+    // Same transport, for files that do not exist (as scanners ask for): answered with the 404 page.
+    static const std::string missing_request = "GET /wp-login.php?redirect=%2Fadmin HTTP/1.1\r\nHost: www.example.com\r\n\r\n";
+
+    std::function<bool(size_t)> missing_step = [&](size_t)
+    {
+        if(memory_server.FeedData(missing_request.data(), missing_request.size()) < 0 || memory_server.Resume(memory_socket) != HTTP_SERVER_IO_WAIT_WRITE)
+            return false;
+
+        memory_server.GetTxSegments(segments);
+        for(const HTTP_TX_SEGMENT& segment : segments)
+            sink = sink + segment.length;
+
+        memory_server.CompleteWrite();
+
+        return (memory_server.Resume(memory_socket) == HTTP_SERVER_IO_WAIT_READ);
+    };
+
+    // A symbolic link leading outside the resources directory, which must never be served.
+    static const std::string escape_request = "GET /escape.html HTTP/1.1\r\nHost: www.example.com\r\n\r\n";
+
+    std::function<bool(size_t)> escape_step = [&](size_t)
+    {
+        if(memory_server.FeedData(escape_request.data(), escape_request.size()) < 0 || memory_server.Resume(memory_socket) != HTTP_SERVER_IO_WAIT_WRITE)
+            return false;
+
+        memory_server.GetTxSegments(segments);
+        bool refused = (!segments.empty() && segments[0].data != nullptr && std::string_view(segments[0].data, segments[0].length).substr(0, 12) == "HTTP/1.1 404");
+
+        memory_server.CompleteWrite();
+
+        return (memory_server.Resume(memory_socket) == HTTP_SERVER_IO_WAIT_READ && refused);
+    };
+
+    // Non-blocking mode over a socketpair: the whole response fits within the socket buffer, so
+    // it has been written by the time Resume asks to wait for the next request.
+    std::function<bool(size_t)> socket_step = [&](size_t request)
+    {
+        if(send(sockets[1], corpus[request].data(), corpus[request].size(), 0) != (ssize_t)corpus[request].size())
+            return false;
+
+        if(socket_server.Resume(sockets[0]) != HTTP_SERVER_IO_WAIT_READ)
+            return false;
+
+        long int received = 0;
+        long int read_now;
+        while((read_now = recv(sockets[1], rx_chunk.data(), rx_chunk.size(), 0)) > 0)
+            received += read_now;
+
+        sink = sink + received;
+
+        return (received > 0);
+    };
+
+    // Parse once so that the other stages have a request to work on, fill the caches up and let
+    // the compressed variants be built before measuring anything.
+    SERVER_BENCH_RESULT warmup;
+    bool ok =   Measure(corpus.size(), 1                                , parse_step    , warmup) &&
+                Measure(corpus.size(), SERVER_BENCH_WARMUP_ITERATIONS   , generate_step , warmup) &&
+                Measure(corpus.size(), SERVER_BENCH_WARMUP_ITERATIONS   , memory_step   , warmup) &&
+                Measure(corpus.size(), SERVER_BENCH_WARMUP_ITERATIONS   , socket_step   , warmup);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(SERVER_BENCH_WARMUP_WAIT_MS));
+
+    SERVER_BENCH_RESULT parse_result, generate_result, mime_result, file_result, memory_result, socket_result, missing_result, access_log_result;
+    SERVER_BENCH_RESULT manifest_file_result, manifest_memory_result, escape_result;
+
+    ok = ok &&  Measure(1            , 1                            , escape_step   , escape_result     ) &&
+                Measure(corpus.size(), SERVER_BENCH_STAGE_ITERATIONS, generate_step , generate_result   ) &&
+                Measure(corpus.size(), SERVER_BENCH_STAGE_ITERATIONS, mime_step     , mime_result       ) &&
+                Measure(corpus.size(), SERVER_BENCH_STAGE_ITERATIONS, file_step     , file_result       ) &&
+                Measure(corpus.size(), SERVER_BENCH_STAGE_ITERATIONS, parse_step    , parse_result      ) &&
+                Measure(corpus.size(), SERVER_BENCH_IO_ITERATIONS   , memory_step   , memory_result     ) &&
+                Measure(corpus.size(), SERVER_BENCH_IO_ITERATIONS   , socket_step   , socket_result     ) &&
+                Measure(corpus.size(), SERVER_BENCH_IO_ITERATIONS   , missing_step  , missing_result    );
+
+    // The same requests again, with every one of them written to the access log.
+    fixture.files.push_back(root + "/access.log");
+
+    ok = ok && HttpAccessLog::GetInstance().SetFile((root + "/access.log").c_str(), HTTP_ACCESS_LOG_DEFAULT_FLUSH_MS, 0, 0) == 0 &&
+                Measure(corpus.size(), SERVER_BENCH_IO_ITERATIONS   , memory_step   , access_log_result );
+
+    HttpAccessLog::GetInstance().SetFile(nullptr, 0, 0, 0);
+
+    // And with the files known to the resource manifest, which spares every stat call.
+    ok = ok && HttpResourceManifest::GetInstance().Build(root, HTTP_RESOURCE_MANIFEST_DEFAULT_PRELOAD_BYTES, HttpFileCache::GetInstance().GetMaxEntryBytes()) > 0 &&
+                Measure(1            , 1                            , escape_step   , escape_result         ) &&
+                Measure(corpus.size(), SERVER_BENCH_STAGE_ITERATIONS, file_step     , manifest_file_result  ) &&
+                Measure(corpus.size(), SERVER_BENCH_IO_ITERATIONS   , memory_step   , manifest_memory_result);
+
+    HttpResourceManifest::GetInstance().Clear();
+
+    close(sockets[0]);
+    close(sockets[1]);
+    BenchFixtureRemove(fixture);
+
+    if(!ok)
+    {
+        fprintf(stderr, "A request could not be served\n");
+        return 1;
+    }
+
+    printf("{\n");
+    printf("  \"requests\": %.0f,\n", (double)SERVER_BENCH_STAGE_ITERATIONS * corpus.size());
+    PrintResult("parse"                        , parse_result             , false );
+    PrintResult("generate_response"            , generate_result          , false );
+    PrintResult("mime_lookup"                  , mime_result              , false );
+    PrintResult("file_lookup"                  , file_result              , false );
+    PrintResult("in_memory_transport"          , memory_result            , false );
+    PrintResult("socketpair_transport"         , socket_result            , false );
+    PrintResult("in_memory_transport_missing"  , missing_result           , false );
+    PrintResult("access_log"                   , access_log_result        , false );
+    PrintResult("file_lookup_manifest"         , manifest_file_result     , false );
+    PrintResult("in_memory_transport_manifest" , manifest_memory_result   , true  );
+    printf("}\n");
+
+    return 0;
+}
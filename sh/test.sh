@@ -18,5 +18,11 @@ echo "Testing 'main' executable file."
 echo "*******************************"
 # # HTTP
 # ./test/exe/main -r ${DEFAULT_USER_PORT} -t 1800 -y 1800 -p -m 10 -e ~/Desktop/scripts/HTML/HTML_tutorial
+# # HTTP, single-threaded event loop
+# ./test/exe/main -r ${DEFAULT_USER_PORT} -l -m 10000 -e ~/Desktop/scripts/HTML/HTML_tutorial
+# # HTTP, one reactor per core
+# ./test/exe/main -r ${DEFAULT_USER_PORT} -w 4 -o 0-3 -m 10000 -e ~/Desktop/scripts/HTML/HTML_tutorial
+# # HTTP, one io_uring reactor per core
+# ./test/exe/main -r ${DEFAULT_USER_PORT} -w 4 -o 0-3 -q -m 10000 -e ~/Desktop/scripts/HTML/HTML_tutorial
 # # HTTPS
 ./test/exe/main -r ${DEFAULT_USER_PORT} -t 1800 -p -m 10 -s -c ~/Desktop/scripts/certificate_test/certificate.crt -k ~/Desktop/scripts/certificate_test/private.key -e ~/Desktop/scripts/HTML/HTML_tutorial
@@ -0,0 +1,324 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpAccessLog.hpp"
+#include "HttpLog.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+
+/*************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+HttpAccessLog::HttpAccessLog(void):
+    enqueue_pos(0)                                          ,
+    dropped(0)                                              ,
+    dequeue_pos(0)                                          ,
+    enabled(false)                                          ,
+    running(false)                                          ,
+    flush_interval_ms(HTTP_ACCESS_LOG_DEFAULT_FLUSH_MS)     ,
+    max_file_size(HTTP_ACCESS_LOG_DEFAULT_MAX_FILE_SIZE)    ,
+    max_files(HTTP_ACCESS_LOG_DEFAULT_MAX_FILES)            ,
+    fd(-1)                                                  ,
+    file_size(0)                                            ,
+    formatted_time(0)                                       ,
+    time_text()
+{}
+
+HttpAccessLog::~HttpAccessLog(void)
+{
+    // Whatever is still pending is written before leaving.
+    std::lock_guard<std::mutex> lock(this->config_mutex);
+    this->Stop();
+}
+
+HttpAccessLog& HttpAccessLog::GetInstance(void)
+{
+    static HttpAccessLog instance;
+
+    return instance;
+}
+
+void HttpAccessLog::SetField(char* dest, size_t size, std::string_view value)
+{
+    if(value.empty())
+        value = "-";
+
+    size_t length = std::min(value.size(), size - 1);
+
+    memcpy(dest, value.data(), length);
+    dest[length] = '\0';
+}
+
+void HttpAccessLog::Submit(const HTTP_ACCESS_LOG_RECORD& record)
+{
+    HttpAccessLog& access_log = GetInstance();
+    uint64_t position = access_log.enqueue_pos.load(std::memory_order_relaxed);
+    HTTP_ACCESS_LOG_SLOT* slot;
+
+    // Claim the slot at the enqueue position, unless another thread got there first.
+    while(true)
+    {
+        slot = &access_log.slots[position & (HTTP_ACCESS_LOG_QUEUE_SLOTS - 1)];
+        int64_t lag = (int64_t)(slot->sequence.load(std::memory_order_acquire) - position);
+
+        if(lag == 0)
+        {
+            if(access_log.enqueue_pos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        // Still holding a record from the previous lap: the queue is full.
+        else if(lag < 0)
+        {
+            access_log.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+            position = access_log.enqueue_pos.load(std::memory_order_relaxed);
+    }
+
+    slot->record = record;
+    slot->sequence.store(position + 1, std::memory_order_release);
+}
+
+int HttpAccessLog::SetFile(const char* path, unsigned int flush_interval_ms, unsigned long max_file_size, unsigned int max_files)
+{
+    std::lock_guard<std::mutex> lock(this->config_mutex);
+
+    // Records pending for the former file are written to it first.
+    this->Stop();
+
+    if(path == nullptr || path[0] == '\0')
+        return 0;
+
+    this->path              = path;
+    this->flush_interval_ms = flush_interval_ms;
+    this->max_file_size     = max_file_size;
+    this->max_files         = max_files;
+
+    if(this->OpenFile() < 0)
+        return HTTP_ACCESS_LOG_ERR_OPEN;
+
+    if(this->slots == nullptr)
+    {
+        this->slots = std::make_unique<HTTP_ACCESS_LOG_SLOT[]>(HTTP_ACCESS_LOG_QUEUE_SLOTS);
+
+        for(uint64_t i = 0; i < HTTP_ACCESS_LOG_QUEUE_SLOTS; i++)
+            this->slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    this->running.store(true, std::memory_order_relaxed);
+    this->writer_thread = std::thread(&HttpAccessLog::WriterLoop, this);
+    // Publishes the queue as well.
+    this->enabled.store(true, std::memory_order_release);
+
+    return 0;
+}
+
+void HttpAccessLog::Stop(void)
+{
+    this->enabled.store(false, std::memory_order_relaxed);
+    this->running.store(false, std::memory_order_relaxed);
+
+    if(this->writer_thread.joinable())
+        this->writer_thread.join();
+
+    this->Drain();
+    this->Flush();
+    this->CloseFile();
+}
+
+int HttpAccessLog::OpenFile(void)
+{
+    this->fd = open(this->path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+    if(this->fd < 0)
+    {
+        HTTP_LOG_ERR(HTTP_ACCESS_LOG_MSG_OPEN_ERROR, this->path.c_str(), errno);
+        return -1;
+    }
+
+    struct stat file_stat;
+    this->file_size = (fstat(this->fd, &file_stat) == 0) ? file_stat.st_size : 0;
+
+    return 0;
+}
+
+void HttpAccessLog::CloseFile(void)
+{
+    if(this->fd >= 0)
+        close(this->fd);
+
+    this->fd = -1;
+}
+
+void HttpAccessLog::Rotate(void)
+{
+    this->CloseFile();
+
+    // path.N is dropped, every other one moves one place up, and path becomes path.1.
+    if(this->max_files == 0)
+        unlink(this->path.c_str());
+    else
+    {
+        for(unsigned int i = this->max_files - 1; i > 0; i--)
+            rename((this->path + "." + std::to_string(i)).c_str(), (this->path + "." + std::to_string(i + 1)).c_str());
+
+        rename(this->path.c_str(), (this->path + ".1").c_str());
+    }
+
+    this->OpenFile();
+}
+
+void HttpAccessLog::AppendField(std::string& line, const char* field, bool quoted)
+{
+    static const char hex_digits[] = "0123456789abcdef";
+
+    if(quoted)
+        line.push_back('"');
+
+    // Fields come from the client: quotes, backslashes and control characters are escaped so
+    // that every record is kept within a single, parseable line.
+    for(const char* c = field; *c != '\0'; c++)
+    {
+        unsigned char byte = (unsigned char)*c;
+
+        if(byte == '"' || byte == '\\')
+        {
+            line.push_back('\\');
+            line.push_back(*c);
+        }
+        else if(byte < 0x20 || byte >= 0x7F)
+        {
+            line.append("\\x");
+            line.push_back(hex_digits[byte >> 4]);
+            line.push_back(hex_digits[byte & 0x0F]);
+        }
+        else
+            line.push_back(*c);
+    }
+
+    if(quoted)
+        line.push_back('"');
+}
+
+void HttpAccessLog::Format(const HTTP_ACCESS_LOG_RECORD& record)
+{
+    if(record.time != this->formatted_time)
+    {
+        struct tm time_fields;
+        gmtime_r(&record.time, &time_fields);
+        strftime(this->time_text, sizeof(this->time_text), "%d/%b/%Y:%H:%M:%S +0000", &time_fields);
+
+        this->formatted_time = record.time;
+    }
+
+    char number[24];
+    std::string& line = this->batch;
+
+    line.append(record.client_ip);
+    line.append(" - - [");
+    line.append(this->time_text);
+    line.append("] \"");
+    AppendField(line, record.method, false);
+    line.push_back(' ');
+    AppendField(line, record.target, false);
+    line.push_back(' ');
+    AppendField(line, record.protocol, false);
+    line.append("\" ");
+    line.append(HttpGetStatusCode(record.status));
+    line.push_back(' ');
+    line.append(number, std::to_chars(number, number + sizeof(number), record.bytes).ptr);
+    line.push_back(' ');
+    AppendField(line, record.referer, true);
+    line.push_back(' ');
+    AppendField(line, record.user_agent, true);
+    line.push_back(' ');
+    line.append(number, std::to_chars(number, number + sizeof(number), record.duration_us).ptr);
+    line.push_back('\n');
+}
+
+void HttpAccessLog::Drain(void)
+{
+    if(this->slots == nullptr)
+        return;
+
+    while(true)
+    {
+        HTTP_ACCESS_LOG_SLOT& slot = this->slots[this->dequeue_pos & (HTTP_ACCESS_LOG_QUEUE_SLOTS - 1)];
+
+        // Not written yet (claimed slots are written right away, so this is the end of the queue).
+        if(slot.sequence.load(std::memory_order_acquire) != this->dequeue_pos + 1)
+            break;
+
+        this->Format(slot.record);
+
+        // Free for the next lap.
+        slot.sequence.store(this->dequeue_pos + HTTP_ACCESS_LOG_QUEUE_SLOTS, std::memory_order_release);
+        this->dequeue_pos++;
+    }
+
+    uint64_t dropped_records = this->dropped.exchange(0, std::memory_order_relaxed);
+    if(dropped_records > 0)
+        HTTP_LOG_WNG(HTTP_ACCESS_LOG_MSG_DROPPED, (unsigned long)dropped_records);
+}
+
+void HttpAccessLog::Flush(void)
+{
+    if(this->batch.empty())
+        return;
+
+    if(this->max_file_size > 0 && this->file_size > 0 && this->file_size + this->batch.size() > this->max_file_size)
+        this->Rotate();
+
+    size_t written = 0;
+
+    while(this->fd >= 0 && written < this->batch.size())
+    {
+        ssize_t result = write(this->fd, this->batch.data() + written, this->batch.size() - written);
+
+        if(result < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            HTTP_LOG_ERR(HTTP_ACCESS_LOG_MSG_WRITE_ERROR, this->path.c_str(), errno);
+            break;
+        }
+
+        written += result;
+    }
+
+    this->file_size += written;
+    this->batch.clear();
+}
+
+void HttpAccessLog::WriterLoop(void)
+{
+    std::chrono::steady_clock::time_point last_flush = std::chrono::steady_clock::now();
+
+    while(this->running.load(std::memory_order_relaxed))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(HTTP_ACCESS_LOG_DRAIN_INTERVAL_MS));
+        this->Drain();
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        if(this->batch.size() >= HTTP_ACCESS_LOG_LEN_BATCH || now - last_flush >= std::chrono::milliseconds(this->flush_interval_ms))
+        {
+            this->Flush();
+            last_flush = now;
+        }
+    }
+}
+
+/******************************************/
@@ -0,0 +1,149 @@
+#ifndef CPP_HTTP_ACCESS_LOG_HPP
+#define CPP_HTTP_ACCESS_LOG_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <stdint.h>
+#include <time.h>
+#include <netinet/in.h>     // INET_ADDRSTRLEN
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "HttpServer_api.hpp"
+#include "HttpResponseHeader.hpp"
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_ACCESS_LOG_LEN_METHOD          16
+#define HTTP_ACCESS_LOG_LEN_TARGET          256         // Longer fields are truncated.
+#define HTTP_ACCESS_LOG_LEN_PROTOCOL        16
+#define HTTP_ACCESS_LOG_LEN_REFERER         128
+#define HTTP_ACCESS_LOG_LEN_USER_AGENT      192
+
+#define HTTP_ACCESS_LOG_QUEUE_SLOTS         16384       // Records that may be pending (power of two). Any further one is dropped.
+#define HTTP_ACCESS_LOG_DRAIN_INTERVAL_MS   5           // How often the queue is emptied into the write buffer.
+#define HTTP_ACCESS_LOG_LEN_BATCH           (64 * 1024) // Buffered bytes that trigger a write before the flush interval is over.
+
+#define HTTP_ACCESS_LOG_MSG_OPEN_ERROR      "Could not open access log \"%s\", errno: %d"
+#define HTTP_ACCESS_LOG_MSG_WRITE_ERROR     "Could not write to access log \"%s\", errno: %d"
+#define HTTP_ACCESS_LOG_MSG_DROPPED         "%lu access log records were dropped (access log queue full)."
+
+/************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+// Fixed-size, so that queueing it is a plain copy.
+typedef struct
+{
+    time_t      time                                        ;   // When the response was sent.
+    uint64_t    duration_us                                 ;   // From processing the request to having sent its response.
+    uint64_t    bytes                                       ;   // Response length, header included.
+    HTTP_STATUS status                                      ;
+    char        client_ip[INET_ADDRSTRLEN]                  ;
+    char        method[HTTP_ACCESS_LOG_LEN_METHOD]          ;
+    char        target[HTTP_ACCESS_LOG_LEN_TARGET]          ;
+    char        protocol[HTTP_ACCESS_LOG_LEN_PROTOCOL]      ;
+    char        referer[HTTP_ACCESS_LOG_LEN_REFERER]        ;
+    char        user_agent[HTTP_ACCESS_LOG_LEN_USER_AGENT]  ;
+} HTTP_ACCESS_LOG_RECORD;
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Access log in the combined log format, plus the time taken by every request (microseconds):
+//
+//   127.0.0.1 - - [18/Oct/2026:10:00:00 +0000] "GET /index.html HTTP/1.1" 200 6310 "-" "curl/8.5.0" 412
+//
+// Serving threads copy their records into a bounded lock-free queue (multiple producers, a single
+// consumer) and never wait for the file. A writer thread formats them and writes them in large
+// batches, once per flush interval (or as soon as a batch is full), rotating the file when it grows
+// past its size limit. Unlike HttpLog, threads share the queue: records are large, and blocking
+// mode runs a thread per connection.
+class HttpAccessLog
+{
+private:
+    // A slot may be written once its sequence equals the enqueue position, and read once it is one
+    // past it (bounded MPMC queue by D. Vyukov, with a single consumer).
+    typedef struct
+    {
+        std::atomic<uint64_t>   sequence    ;
+        HTTP_ACCESS_LOG_RECORD  record      ;
+    } HTTP_ACCESS_LOG_SLOT;
+
+    // Allocated the first time a file is set, and kept from then on.
+    std::unique_ptr<HTTP_ACCESS_LOG_SLOT[]> slots;
+
+    alignas(64) std::atomic<uint64_t>   enqueue_pos ;
+    alignas(64) std::atomic<uint64_t>   dropped     ;
+    uint64_t                            dequeue_pos ;   // Writer thread only.
+
+    // Settings and writer thread (SetFile). The file, its size and the batch belong to the writer thread.
+    std::mutex          config_mutex        ;
+    std::atomic<bool>   enabled             ;
+    std::atomic<bool>   running             ;
+    std::thread         writer_thread       ;
+    std::string         path                ;
+    unsigned int        flush_interval_ms   ;
+    unsigned long       max_file_size       ;
+    unsigned int        max_files           ;
+    int                 fd                  ;
+    unsigned long       file_size           ;
+    std::string         batch               ;
+
+    // Last timestamp formatted, as most records share it with the previous one.
+    time_t              formatted_time      ;
+    char                time_text[32]       ;
+
+    HttpAccessLog(void);
+    ~HttpAccessLog(void);
+
+    static void AppendField(std::string& line, const char* field, bool quoted);
+
+    int     OpenFile(void);
+    void    CloseFile(void);
+    void    Rotate(void);
+    void    Format(const HTTP_ACCESS_LOG_RECORD& record);
+    void    Drain(void);
+    void    Flush(void);
+    void    WriterLoop(void);
+    void    Stop(void);
+
+public:
+    HttpAccessLog(const HttpAccessLog& obj) = delete;
+
+    static HttpAccessLog& GetInstance(void);
+
+    // Whether requests are to be logged at all (checked before filling records in).
+    static inline bool IsEnabled(void)
+    {
+        return GetInstance().enabled.load(std::memory_order_acquire);
+    }
+
+    // Copy a field into a record, truncating it if needed ("-" if empty).
+    static void SetField(char* dest, size_t size, std::string_view value);
+
+    // Queue a record (any thread, lock-free). Only once IsEnabled.
+    static void Submit(const HTTP_ACCESS_LOG_RECORD& record);
+
+    // Log to path (nullptr or empty: stop logging). The file is rotated once it grows past
+    // max_file_size bytes (0: never), keeping max_files older ones (path.1 being the newest).
+    int SetFile(const char* path, unsigned int flush_interval_ms, unsigned long max_file_size, unsigned int max_files);
+};
+
+/*************************************/
+
+#endif
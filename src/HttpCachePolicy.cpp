@@ -0,0 +1,171 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpCachePolicy.hpp"
+#include <algorithm>
+#include <mutex>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_CACHE_POLICY_EXPIRED_DATE      "Thu, 01 Jan 1970 00:00:00 GMT"
+
+/*************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+HttpCachePolicyTable::HttpCachePolicyTable(void)
+{
+    this->AddDefaultPolicies();
+}
+
+HttpCachePolicyTable& HttpCachePolicyTable::GetInstance(void)
+{
+    static HttpCachePolicyTable instance;
+
+    return instance;
+}
+
+// Pages are usually not fingerprinted, so they are always revalidated (which is cheap, as they
+// carry validators); media files rarely change, so they are reused for a while.
+void HttpCachePolicyTable::AddDefaultPolicies(void)
+{
+    this->Add(HTTP_CACHE_POLICY_MATCH_EXTENSION , "html"    , 0                                         , HTTP_CACHE_POLICY_FLAG_NO_CACHE);
+    this->Add(HTTP_CACHE_POLICY_MATCH_EXTENSION , "htm"     , 0                                         , HTTP_CACHE_POLICY_FLAG_NO_CACHE);
+    this->Add(HTTP_CACHE_POLICY_MATCH_MIME_GROUP, "image"   , HTTP_CACHE_POLICY_DEFAULT_MEDIA_MAX_AGE   , 0);
+    this->Add(HTTP_CACHE_POLICY_MATCH_MIME_GROUP, "font"    , HTTP_CACHE_POLICY_DEFAULT_MEDIA_MAX_AGE   , 0);
+    this->Add(HTTP_CACHE_POLICY_MATCH_MIME_GROUP, "audio"   , HTTP_CACHE_POLICY_DEFAULT_MEDIA_MAX_AGE   , 0);
+    this->Add(HTTP_CACHE_POLICY_MATCH_MIME_GROUP, "video"   , HTTP_CACHE_POLICY_DEFAULT_MEDIA_MAX_AGE   , 0);
+}
+
+std::string HttpCachePolicyTable::ToLower(std::string_view text)
+{
+    std::string lower(text);
+
+    for(char& c : lower)
+        if(c >= 'A' && c <= 'Z')
+            c = (char)(c - 'A' + 'a');
+
+    return lower;
+}
+
+HttpCachePolicyTable::policy_ptr HttpCachePolicyTable::Render(long int max_age, unsigned int flags)
+{
+    std::shared_ptr<HTTP_CACHE_POLICY> policy = std::make_shared<HTTP_CACHE_POLICY>();
+
+    policy->cache_control = "Cache-Control: ";
+
+    if(flags & (HTTP_CACHE_POLICY_FLAG_NO_STORE | HTTP_CACHE_POLICY_FLAG_NO_CACHE))
+    {
+        policy->max_age = -1;
+        policy->cache_control.append((flags & HTTP_CACHE_POLICY_FLAG_NO_STORE) ? "no-store" : "no-cache");
+
+        if(flags & HTTP_CACHE_POLICY_FLAG_PRIVATE)
+            policy->cache_control.append(", private");
+
+        // HTTP/1.0 caches do not know about Cache-Control.
+        policy->expires = "Expires: " HTTP_CACHE_POLICY_EXPIRED_DATE "\r\n";
+    }
+    else
+    {
+        policy->max_age = std::clamp(max_age, 0L, (long int)HTTP_CACHE_POLICY_MAX_MAX_AGE);
+        policy->cache_control.append((flags & HTTP_CACHE_POLICY_FLAG_PRIVATE) ? "private" : "public");
+        policy->cache_control.append(", max-age=").append(std::to_string(policy->max_age));
+
+        if(flags & HTTP_CACHE_POLICY_FLAG_IMMUTABLE)
+            policy->cache_control.append(", immutable");
+    }
+
+    policy->cache_control.append("\r\n");
+
+    return policy;
+}
+
+int HttpCachePolicyTable::Add(HTTP_CACHE_POLICY_MATCH match, const char* key, long int max_age, unsigned int flags)
+{
+    if(key == nullptr && match != HTTP_CACHE_POLICY_MATCH_DEFAULT)
+        return HTTP_CACHE_POLICY_ERR_INVALID;
+
+    policy_ptr policy = Render(max_age, flags);
+
+    std::unique_lock<std::shared_mutex> lock(this->table_mutex);
+
+    switch(match)
+    {
+        case HTTP_CACHE_POLICY_MATCH_PATH_PREFIX:
+        {
+            std::string prefix(key);
+
+            this->prefix_rules.erase(std::remove_if(this->prefix_rules.begin(), this->prefix_rules.end(),
+                                     [&prefix](const HTTP_CACHE_POLICY_PREFIX_RULE& rule){ return rule.prefix == prefix; }),
+                                     this->prefix_rules.end());
+
+            this->prefix_rules.push_back({prefix, policy});
+
+            // First match is then the most specific one.
+            std::stable_sort(this->prefix_rules.begin(), this->prefix_rules.end(), [](const HTTP_CACHE_POLICY_PREFIX_RULE& a, const HTTP_CACHE_POLICY_PREFIX_RULE& b)
+            {
+                return a.prefix.size() > b.prefix.size();
+            });
+        }
+        break;
+
+        case HTTP_CACHE_POLICY_MATCH_EXTENSION:
+            this->extension_rules[ToLower(key)] = policy;
+        break;
+
+        case HTTP_CACHE_POLICY_MATCH_MIME_GROUP:
+            this->mime_group_rules[ToLower(key)] = policy;
+        break;
+
+        case HTTP_CACHE_POLICY_MATCH_DEFAULT:
+            this->default_policy = policy;
+        break;
+
+        default:
+        return HTTP_CACHE_POLICY_ERR_INVALID;
+    }
+
+    return 0;
+}
+
+void HttpCachePolicyTable::Clear(void)
+{
+    std::unique_lock<std::shared_mutex> lock(this->table_mutex);
+
+    this->prefix_rules.clear();
+    this->extension_rules.clear();
+    this->mime_group_rules.clear();
+    this->default_policy.reset();
+}
+
+std::shared_ptr<const HTTP_CACHE_POLICY> HttpCachePolicyTable::Find(std::string_view target, std::string_view extension, std::string_view mime_group)
+{
+    // Extensions and groups are short, so their lowercase copies do not allocate.
+    std::string extension_key   = ToLower(extension);
+    std::string mime_group_key  = ToLower(mime_group);
+
+    std::shared_lock<std::shared_mutex> lock(this->table_mutex);
+
+    for(const HTTP_CACHE_POLICY_PREFIX_RULE& rule : this->prefix_rules)
+        if(target.substr(0, rule.prefix.size()) == rule.prefix)
+            return rule.policy;
+
+    std::unordered_map<std::string, policy_ptr>::const_iterator it = this->extension_rules.find(extension_key);
+    if(it != this->extension_rules.end())
+        return it->second;
+
+    it = this->mime_group_rules.find(mime_group_key);
+    if(it != this->mime_group_rules.end())
+        return it->second;
+
+    return this->default_policy;
+}
+
+/******************************************/
@@ -0,0 +1,90 @@
+#ifndef CPP_HTTP_CACHE_POLICY_HPP
+#define CPP_HTTP_CACHE_POLICY_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpServer_api.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_CACHE_POLICY_DEFAULT_MEDIA_MAX_AGE     86400       // Images, fonts, audio and video: one day, unless configured otherwise.
+#define HTTP_CACHE_POLICY_MAX_MAX_AGE               31536000    // One year: larger values are clamped (RFC 9111 section 1.2.2).
+
+/************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+// Caching directives of a group of resources, rendered once when the policy is added so that
+// responses only have to copy them.
+typedef struct
+{
+    long int        max_age         ;   // Seconds (negative: not to be reused without revalidation).
+    std::string     cache_control   ;   // "Cache-Control: ...\r\n"
+    std::string     expires         ;   // Fixed "Expires: ...\r\n" for policies that are never fresh, empty
+                                        // otherwise (the date is then max_age from the time of the response).
+} HTTP_CACHE_POLICY;
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Process-wide table of cache policies. Policies are expected to be set up before serving, but may
+// be changed at any time: lookups take a shared lock and hand out shared pointers, so a policy in use
+// outlives its removal.
+class HttpCachePolicyTable
+{
+private:
+    using policy_ptr = std::shared_ptr<const HTTP_CACHE_POLICY>;
+
+    typedef struct
+    {
+        std::string prefix  ;
+        policy_ptr  policy  ;
+    } HTTP_CACHE_POLICY_PREFIX_RULE;
+
+    std::shared_mutex                               table_mutex     ;
+    std::vector<HTTP_CACHE_POLICY_PREFIX_RULE>      prefix_rules    ;   // Longest prefix first.
+    std::unordered_map<std::string, policy_ptr>     extension_rules ;   // Lowercase keys.
+    std::unordered_map<std::string, policy_ptr>     mime_group_rules;   // Lowercase keys.
+    policy_ptr                                      default_policy  ;
+
+    static policy_ptr Render(long int max_age, unsigned int flags);
+    static std::string ToLower(std::string_view text);
+
+    void AddDefaultPolicies(void);
+
+public:
+    HttpCachePolicyTable(void);
+    HttpCachePolicyTable(const HttpCachePolicyTable& obj) = delete;
+
+    static HttpCachePolicyTable& GetInstance(void);
+
+    // Returns HTTP_CACHE_POLICY_ERR_INVALID if match is unknown or key is missing.
+    int  Add(HTTP_CACHE_POLICY_MATCH match, const char* key, long int max_age, unsigned int flags);
+    // Remove every policy, the built-in ones included.
+    void Clear(void);
+
+    // Policy for a request target, given the extension and MIME group of the file it maps to.
+    // nullptr if none applies.
+    std::shared_ptr<const HTTP_CACHE_POLICY> Find(std::string_view target, std::string_view extension, std::string_view mime_group);
+};
+
+/*************************************/
+
+#endif
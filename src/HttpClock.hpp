@@ -0,0 +1,30 @@
+#ifndef CPP_HTTP_CLOCK_HPP
+#define CPP_HTTP_CLOCK_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <stdint.h>
+#include <time.h>
+
+/*************************************/
+
+/**************************************/
+/******** Function definitions ********/
+/**************************************/
+
+// Milliseconds on the coarse monotonic clock. It is read through the vDSO, so it costs no system
+// call, and it is only as precise as the kernel tick (a few milliseconds), which is plenty for
+// timeouts, revalidation intervals and negative cache entries.
+inline uint64_t HttpNowMs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+
+    return (uint64_t)now.tv_sec * 1000UL + (uint64_t)now.tv_nsec / 1000000UL;
+}
+
+/**************************************/
+
+#endif
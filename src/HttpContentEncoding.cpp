@@ -0,0 +1,286 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpContentEncoding.hpp"
+#include "HttpLog.hpp"
+#include <zlib.h>
+#include <dlfcn.h>
+#include <cstdint>
+#include <mutex>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_CONTENT_ENCODING_QVALUE_MAX        1000        // Weights are kept in thousandths (q=1 -> 1000).
+#define HTTP_CONTENT_ENCODING_QVALUE_UNSET      -1
+#define HTTP_CONTENT_ENCODING_GZIP_WINDOW_BITS  (15 + 16)   // Largest window, gzip wrapper instead of zlib's.
+#define HTTP_CONTENT_ENCODING_GZIP_MEM_LEVEL    8
+#define HTTP_CONTENT_ENCODING_BROTLI_LGWIN      22          // BROTLI_DEFAULT_WINDOW
+#define HTTP_CONTENT_ENCODING_BROTLI_MODE_TEXT  1           // BROTLI_MODE_TEXT
+
+/*************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+// Brotli encoder entry points (encode.h), resolved at runtime so that it stays an optional dependency.
+typedef int     (*BROTLI_ENCODER_COMPRESS)(int quality, int lgwin, int mode, size_t input_size, const uint8_t* input, size_t* encoded_size, uint8_t* encoded);
+typedef size_t  (*BROTLI_ENCODER_MAX_COMPRESSED_SIZE)(size_t input_size);
+
+typedef struct
+{
+    bool                                available               ;
+    BROTLI_ENCODER_COMPRESS             compress                ;
+    BROTLI_ENCODER_MAX_COMPRESSED_SIZE  max_compressed_size     ;
+} HTTP_BROTLI_ENCODER;
+
+/************************************/
+
+/******************************************/
+/****** Private variable definitions ******/
+/******************************************/
+
+static const char* const encoding_names[HTTP_CONTENT_ENCODING_COUNT]      = {"identity", "gzip", "br"};
+static const char* const encoding_suffixes[HTTP_CONTENT_ENCODING_COUNT]   = {"", ".gz", ".br"};
+
+static HTTP_BROTLI_ENCODER  brotli_encoder      ;
+static std::once_flag       brotli_encoder_once ;
+
+/******************************************/
+
+/******************************************/
+/******** Private helper functions ********/
+/******************************************/
+
+static inline bool IsBlank(char c)
+{
+    return (c == ' ' || c == '\t');
+}
+
+static std::string_view Trim(std::string_view text)
+{
+    while(!text.empty() && IsBlank(text.front()))
+        text.remove_prefix(1);
+
+    while(!text.empty() && IsBlank(text.back()))
+        text.remove_suffix(1);
+
+    return text;
+}
+
+static bool EqualsIgnoreCase(std::string_view a, std::string_view b)
+{
+    if(a.size() != b.size())
+        return false;
+
+    for(std::size_t i = 0; i < a.size(); i++)
+        if((a[i] | 0x20) != (b[i] | 0x20))
+            return false;
+
+    return true;
+}
+
+// qvalue = ( "0" [ "." 0*3DIGIT ] ) / ( "1" [ "." 0*3("0") ] ). Anything else counts as q=1, as
+// if the parameter was not there.
+static int ParseQValue(std::string_view text)
+{
+    if(text.empty() || (text[0] != '0' && text[0] != '1'))
+        return HTTP_CONTENT_ENCODING_QVALUE_MAX;
+
+    int qvalue = (text[0] - '0') * HTTP_CONTENT_ENCODING_QVALUE_MAX;
+
+    if(text.size() > 1 && text[1] == '.')
+    {
+        int scale = HTTP_CONTENT_ENCODING_QVALUE_MAX / 10;
+
+        for(std::size_t i = 2; i < text.size() && i < 5 && text[i] >= '0' && text[i] <= '9'; i++, scale /= 10)
+            qvalue += (text[i] - '0') * scale;
+    }
+
+    return (qvalue > HTTP_CONTENT_ENCODING_QVALUE_MAX) ? HTTP_CONTENT_ENCODING_QVALUE_MAX : qvalue;
+}
+
+static void LoadBrotliEncoder(void)
+{
+    brotli_encoder = {};
+
+    void* library = dlopen(HTTP_CONTENT_ENCODING_BROTLI_LIB, RTLD_NOW | RTLD_LOCAL);
+    if(library == nullptr)
+    {
+        HTTP_LOG_WNG(HTTP_CONTENT_ENCODING_MSG_NO_BROTLI, HTTP_CONTENT_ENCODING_BROTLI_LIB);
+        return;
+    }
+
+    // Never closed: the encoder is used for as long as the process runs.
+    brotli_encoder.compress             = (BROTLI_ENCODER_COMPRESS)dlsym(library, "BrotliEncoderCompress");
+    brotli_encoder.max_compressed_size  = (BROTLI_ENCODER_MAX_COMPRESSED_SIZE)dlsym(library, "BrotliEncoderMaxCompressedSize");
+    brotli_encoder.available            = (brotli_encoder.compress != nullptr && brotli_encoder.max_compressed_size != nullptr);
+}
+
+static const HTTP_BROTLI_ENCODER& GetBrotliEncoder(void)
+{
+    std::call_once(brotli_encoder_once, LoadBrotliEncoder);
+
+    return brotli_encoder;
+}
+
+static bool CompressGzip(const std::string& source, std::string& dest)
+{
+    z_stream stream = {};
+
+    if(deflateInit2(&stream, HTTP_CONTENT_ENCODING_GZIP_LEVEL, Z_DEFLATED, HTTP_CONTENT_ENCODING_GZIP_WINDOW_BITS, HTTP_CONTENT_ENCODING_GZIP_MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    dest.resize(deflateBound(&stream, source.size()));
+
+    stream.next_in      = (Bytef*)source.data();
+    stream.avail_in     = (uInt)source.size();
+    stream.next_out     = (Bytef*)dest.data();
+    stream.avail_out    = (uInt)dest.size();
+
+    // The output buffer is bound to be large enough, so a single call does it all.
+    int deflate_result = deflate(&stream, Z_FINISH);
+    dest.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return (deflate_result == Z_STREAM_END);
+}
+
+static bool CompressBrotli(const std::string& source, std::string& dest)
+{
+    const HTTP_BROTLI_ENCODER& encoder = GetBrotliEncoder();
+
+    if(!encoder.available)
+        return false;
+
+    size_t encoded_size = encoder.max_compressed_size(source.size());
+    if(encoded_size == 0)
+        return false;
+
+    dest.resize(encoded_size);
+
+    if(!encoder.compress(HTTP_CONTENT_ENCODING_BROTLI_QUALITY, HTTP_CONTENT_ENCODING_BROTLI_LGWIN, HTTP_CONTENT_ENCODING_BROTLI_MODE_TEXT,
+                         source.size(), (const uint8_t*)source.data(), &encoded_size, (uint8_t*)dest.data()))
+        return false;
+
+    dest.resize(encoded_size);
+
+    return true;
+}
+
+/******************************************/
+
+/**************************************/
+/******** Function definitions ********/
+/**************************************/
+
+int HttpParseAcceptEncoding(std::string_view value, HTTP_CONTENT_ENCODING preferred[HTTP_CONTENT_ENCODING_COUNT])
+{
+    int qvalues[HTTP_CONTENT_ENCODING_COUNT];
+    int wildcard_qvalue = HTTP_CONTENT_ENCODING_QVALUE_UNSET;
+
+    for(int& qvalue : qvalues)
+        qvalue = HTTP_CONTENT_ENCODING_QVALUE_UNSET;
+
+    while(!value.empty())
+    {
+        std::size_t comma = value.find(',');
+        std::string_view element = value.substr(0, comma);
+        value = (comma == std::string_view::npos) ? std::string_view() : value.substr(comma + 1);
+
+        std::size_t semicolon = element.find(';');
+        std::string_view coding = Trim(element.substr(0, semicolon));
+        int qvalue = HTTP_CONTENT_ENCODING_QVALUE_MAX;
+
+        // Only the weight parameter is defined for content codings.
+        while(semicolon != std::string_view::npos)
+        {
+            element = element.substr(semicolon + 1);
+            semicolon = element.find(';');
+
+            std::string_view parameter = Trim(element.substr(0, semicolon));
+
+            if(parameter.size() > 2 && (parameter[0] | 0x20) == 'q' && parameter[1] == '=')
+                qvalue = ParseQValue(parameter.substr(2));
+        }
+
+        if(coding == "*")
+            wildcard_qvalue = qvalue;
+        else if(EqualsIgnoreCase(coding, "gzip") || EqualsIgnoreCase(coding, "x-gzip"))
+            qvalues[HTTP_CONTENT_ENCODING_GZIP] = qvalue;
+        else if(EqualsIgnoreCase(coding, "br"))
+            qvalues[HTTP_CONTENT_ENCODING_BROTLI] = qvalue;
+    }
+
+    // Codings not named explicitly take the weight of "*", if present.
+    for(int& qvalue : qvalues)
+        if(qvalue == HTTP_CONTENT_ENCODING_QVALUE_UNSET)
+            qvalue = (wildcard_qvalue == HTTP_CONTENT_ENCODING_QVALUE_UNSET) ? 0 : wildcard_qvalue;
+
+    int preferred_count = 0;
+
+    // Best weight first; brotli goes first on ties as it compresses better.
+    for(int qvalue = HTTP_CONTENT_ENCODING_QVALUE_MAX; qvalue > 0; )
+    {
+        int next_qvalue = 0;
+
+        for(int encoding = HTTP_CONTENT_ENCODING_COUNT - 1; encoding > HTTP_CONTENT_ENCODING_IDENTITY; encoding--)
+        {
+            if(qvalues[encoding] == qvalue)
+                preferred[preferred_count++] = (HTTP_CONTENT_ENCODING)encoding;
+            else if(qvalues[encoding] < qvalue && qvalues[encoding] > next_qvalue)
+                next_qvalue = qvalues[encoding];
+        }
+
+        qvalue = next_qvalue;
+    }
+
+    return preferred_count;
+}
+
+const char* HttpContentEncodingName(HTTP_CONTENT_ENCODING encoding)
+{
+    return encoding_names[encoding];
+}
+
+const char* HttpContentEncodingSuffix(HTTP_CONTENT_ENCODING encoding)
+{
+    return encoding_suffixes[encoding];
+}
+
+bool HttpIsContentEncodingAvailable(HTTP_CONTENT_ENCODING encoding)
+{
+    switch(encoding)
+    {
+        case HTTP_CONTENT_ENCODING_GZIP:
+            return true;
+
+        case HTTP_CONTENT_ENCODING_BROTLI:
+            return GetBrotliEncoder().available;
+
+        default:
+            return false;
+    }
+}
+
+bool HttpCompress(HTTP_CONTENT_ENCODING encoding, const std::string& source, std::string& dest)
+{
+    switch(encoding)
+    {
+        case HTTP_CONTENT_ENCODING_GZIP:
+            return CompressGzip(source, dest);
+
+        case HTTP_CONTENT_ENCODING_BROTLI:
+            return CompressBrotli(source, dest);
+
+        default:
+            return false;
+    }
+}
+
+/**************************************/
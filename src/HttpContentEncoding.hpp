@@ -0,0 +1,61 @@
+#ifndef CPP_HTTP_CONTENT_ENCODING_HPP
+#define CPP_HTTP_CONTENT_ENCODING_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <string>
+#include <string_view>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_CONTENT_ENCODING_GZIP_LEVEL        9           // Compression happens once per file version, so the best ratio is worth it.
+#define HTTP_CONTENT_ENCODING_BROTLI_QUALITY    9           // Most of the ratio of quality 11, at a fraction of the time.
+#define HTTP_CONTENT_ENCODING_BROTLI_LIB        "libbrotlienc.so.1"
+
+#define HTTP_CONTENT_ENCODING_MSG_NO_BROTLI     "Brotli encoder (%s) not found, only gzip will be offered."
+
+/************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+typedef enum
+{
+    HTTP_CONTENT_ENCODING_IDENTITY      = 0 ,
+    HTTP_CONTENT_ENCODING_GZIP              ,
+    HTTP_CONTENT_ENCODING_BROTLI            ,
+    HTTP_CONTENT_ENCODING_COUNT             ,
+} HTTP_CONTENT_ENCODING;
+
+/************************************/
+
+/**************************************/
+/******** Function declarations *******/
+/**************************************/
+
+// Parse an Accept-Encoding value (RFC 9110 section 12.5.3) and write the codings the server can
+// produce that the client accepts (q > 0), best first, into preferred. Equal weights are broken
+// in favour of brotli. Identity is never listed: it is what is left when nothing else applies.
+// Returns how many codings were written.
+int HttpParseAcceptEncoding(std::string_view value, HTTP_CONTENT_ENCODING preferred[HTTP_CONTENT_ENCODING_COUNT]);
+
+// Content-Encoding token ("gzip", "br"), and the suffix of precompressed sidecar files (".gz", ".br").
+const char* HttpContentEncodingName(HTTP_CONTENT_ENCODING encoding);
+const char* HttpContentEncodingSuffix(HTTP_CONTENT_ENCODING encoding);
+
+// gzip is always available (zlib is linked), brotli only if its encoder library could be loaded.
+bool HttpIsContentEncodingAvailable(HTTP_CONTENT_ENCODING encoding);
+
+// Compress source into dest. Returns false if the encoding is not available or compression failed.
+bool HttpCompress(HTTP_CONTENT_ENCODING encoding, const std::string& source, std::string& dest);
+
+/**************************************/
+
+#endif
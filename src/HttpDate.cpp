@@ -0,0 +1,105 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpDate.hpp"
+#include <cstring>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_DATE_MAX_PARSED_LEN        64
+
+/*************************************/
+
+/******************************************/
+/****** Private variable definitions ******/
+/******************************************/
+
+static const char* const day_names[]    = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+static const char* const month_names[]  = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+// IMF-fixdate, RFC 850 and asctime, in the order they are tried.
+static const char* const date_formats[] =
+{
+    "%a, %d %b %Y %H:%M:%S GMT" ,
+    "%A, %d-%b-%y %H:%M:%S GMT" ,
+    "%a %b %e %H:%M:%S %Y"      ,
+};
+
+/******************************************/
+
+/******************************************/
+/******** Private helper functions ********/
+/******************************************/
+
+static inline char* WriteTwoDigits(char* dest, int value)
+{
+    dest[0] = (char)('0' + value / 10);
+    dest[1] = (char)('0' + value % 10);
+
+    return dest + 2;
+}
+
+/******************************************/
+
+/**************************************/
+/******** Function definitions ********/
+/**************************************/
+
+std::size_t HttpFormatDate(time_t t, char* dest)
+{
+    struct tm tm;
+    gmtime_r(&t, &tm);
+
+    // Formatted by hand: strftime would follow the locale, and is slower anyway.
+    char* ptr = dest;
+
+    memcpy(ptr, day_names[tm.tm_wday], 3);      ptr += 3;
+    *ptr++ = ',';
+    *ptr++ = ' ';
+    ptr = WriteTwoDigits(ptr, tm.tm_mday);
+    *ptr++ = ' ';
+    memcpy(ptr, month_names[tm.tm_mon], 3);     ptr += 3;
+    *ptr++ = ' ';
+    ptr = WriteTwoDigits(ptr, (tm.tm_year + 1900) / 100);
+    ptr = WriteTwoDigits(ptr, (tm.tm_year + 1900) % 100);
+    *ptr++ = ' ';
+    ptr = WriteTwoDigits(ptr, tm.tm_hour);
+    *ptr++ = ':';
+    ptr = WriteTwoDigits(ptr, tm.tm_min);
+    *ptr++ = ':';
+    ptr = WriteTwoDigits(ptr, tm.tm_sec);
+    memcpy(ptr, " GMT", 4);                     ptr += 4;
+    *ptr = '\0';
+
+    return HTTP_DATE_LEN;
+}
+
+time_t HttpParseDate(std::string_view value)
+{
+    char date[HTTP_DATE_MAX_PARSED_LEN];
+
+    if(value.empty() || value.size() >= sizeof(date))
+        return HTTP_DATE_INVALID;
+
+    memcpy(date, value.data(), value.size());
+    date[value.size()] = '\0';
+
+    for(const char* format : date_formats)
+    {
+        struct tm tm = {};
+        const char* end = strptime(date, format, &tm);
+
+        // The whole value has to match.
+        if(end != nullptr && *end == '\0')
+            return timegm(&tm);
+    }
+
+    return HTTP_DATE_INVALID;
+}
+
+/**************************************/
@@ -0,0 +1,37 @@
+#ifndef CPP_HTTP_DATE_HPP
+#define CPP_HTTP_DATE_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <cstddef>
+#include <ctime>
+#include <string_view>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_DATE_LEN                   29          // "Sun, 06 Nov 1994 08:49:37 GMT" (IMF-fixdate, RFC 9110 section 5.6.7).
+#define HTTP_DATE_INVALID               ((time_t)-1)
+
+/************************************/
+
+/**************************************/
+/******** Function declarations *******/
+/**************************************/
+
+// Write t as an IMF-fixdate into dest, which must hold HTTP_DATE_LEN + 1 bytes (it is
+// NUL-terminated). Independent of the current locale. Returns HTTP_DATE_LEN.
+std::size_t HttpFormatDate(time_t t, char* dest);
+
+// Parse any of the three formats HTTP recipients have to accept (IMF-fixdate, RFC 850 and
+// asctime). Returns HTTP_DATE_INVALID if value is none of them.
+time_t HttpParseDate(std::string_view value);
+
+/**************************************/
+
+#endif
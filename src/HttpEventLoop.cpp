@@ -0,0 +1,319 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpEventLoop.hpp"
+#include "HttpStats.hpp"
+#include "HttpLog.hpp"
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+
+/*************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+HttpEventLoop::HttpEventLoop(const std::string path_to_resources, const HTTP_EVENT_LOOP_CONFIG& config):
+    path_to_resources(path_to_resources)    ,
+    config(config)                          ,
+    server_io_mode(HTTP_SERVER_IO_NON_BLOCKING) ,
+    listen_socket(-1)                       ,
+    epoll_fd(-1)                            ,
+    stop_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+    // Without a budget of its own (0, e.g. a budget too small to be split among reactors, or none
+    // at all), the loop uses the shared cache, which holds no more than its own budget allows.
+    if(this->config.file_cache_bytes > 0)
+        this->file_cache = std::make_unique<HttpFileCache>(this->config.file_cache_bytes, this->config.file_cache_entry_bytes);
+}
+
+HttpEventLoop::~HttpEventLoop(void)
+{
+    // Destroy every HttpServer (so their files are closed) before closing its socket.
+    for(std::pair<const int, std::unique_ptr<HttpServer>>& connection : this->connections)
+    {
+        connection.second.reset();
+        close(connection.first);
+        HttpStats::AddCounter(HTTP_STATS_COUNTER_CONNECTIONS_CLOSED);
+    }
+
+    this->connections.clear();
+    this->server_pool.clear();
+
+    if(this->listen_socket >= 0)
+        close(this->listen_socket);
+
+    if(this->epoll_fd >= 0)
+        close(this->epoll_fd);
+
+    if(this->stop_fd >= 0)
+        close(this->stop_fd);
+}
+
+int HttpEventLoop::PinToCpu(void)
+{
+    if(this->config.cpu == HTTP_EVENT_LOOP_NO_CPU)
+        return 0;
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(this->config.cpu, &cpu_set);
+
+    int set_affinity = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if(set_affinity != 0)
+        HTTP_LOG_WNG(HTTP_EVENT_LOOP_MSG_AFFINITY_ERROR, this->config.cpu, set_affinity);
+
+    return set_affinity;
+}
+
+int HttpEventLoop::OpenListenSocket(void)
+{
+    this->listen_socket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(this->listen_socket < 0)
+    {
+        HTTP_LOG_ERR(HTTP_EVENT_LOOP_MSG_SOCKET_ERROR, errno);
+        return HTTP_EVENT_LOOP_ERR_SOCKET;
+    }
+
+    int enable = 1;
+    setsockopt(this->listen_socket, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    if(this->config.reuse_port)
+        setsockopt(this->listen_socket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable));
+
+    struct sockaddr_in server_address = {};
+    server_address.sin_family       = AF_INET;
+    server_address.sin_addr.s_addr  = htonl(INADDR_ANY);
+    server_address.sin_port         = htons(this->config.server_port);
+
+    if(bind(this->listen_socket, (struct sockaddr*)&server_address, sizeof(server_address)) < 0)
+    {
+        HTTP_LOG_ERR(HTTP_EVENT_LOOP_MSG_BIND_ERROR, this->config.server_port, errno);
+        return HTTP_EVENT_LOOP_ERR_BIND;
+    }
+
+    if(listen(this->listen_socket, HTTP_EVENT_LOOP_LISTEN_BACKLOG) < 0)
+    {
+        HTTP_LOG_ERR(HTTP_EVENT_LOOP_MSG_LISTEN_ERROR, this->config.server_port, errno);
+        return HTTP_EVENT_LOOP_ERR_LISTEN;
+    }
+
+    return 0;
+}
+
+void HttpEventLoop::AcceptConnections(void)
+{
+    // Edge-triggered: accept until the kernel queue is empty.
+    while(true)
+    {
+        int client_socket = accept4(this->listen_socket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if(client_socket < 0)
+        {
+            if(errno == EINTR || errno == ECONNABORTED)
+                continue;
+
+            if(errno != EAGAIN && errno != EWOULDBLOCK)
+                HTTP_LOG_ERR(HTTP_EVENT_LOOP_MSG_ACCEPT_ERROR, errno);
+
+            return;
+        }
+
+        // Refuse the connection rather than leaving it in the queue, where it would wait for nothing.
+        if((int)this->connections.size() >= this->config.max_connections)
+        {
+            HTTP_LOG_WNG(HTTP_EVENT_LOOP_MSG_TOO_MANY_CONNECTIONS, (int)this->connections.size());
+            close(client_socket);
+            continue;
+        }
+
+        int enable = 1;
+        setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        // Both directions are watched from the beginning: being edge-triggered, the socket only
+        // reports changes, so there is no need to switch interests along with the FSM state.
+        struct epoll_event event = {};
+        event.events    = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.fd   = client_socket;
+
+        if(epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, client_socket, &event) < 0)
+        {
+            HTTP_LOG_ERR(HTTP_EVENT_LOOP_MSG_EPOLL_ERROR, errno);
+            close(client_socket);
+            continue;
+        }
+
+        this->connections[client_socket] = this->GetServer();
+        this->ScheduleIdleTimeout(client_socket);
+    }
+}
+
+std::unique_ptr<HttpServer> HttpEventLoop::GetServer(void)
+{
+    // Every connection takes a server, and gives it back once closed.
+    HttpStats::AddCounter(HTTP_STATS_COUNTER_CONNECTIONS_OPENED);
+
+    if(this->server_pool.empty())
+    {
+        std::unique_ptr<HttpServer> http_server = std::make_unique<HttpServer>(this->path_to_resources, false, this->config.max_request_len, this->server_io_mode, this->file_cache.get());
+        http_server->SetKeepAlive(this->config.keep_alive_timeout, this->config.keep_alive_requests);
+
+        return http_server;
+    }
+
+    std::unique_ptr<HttpServer> http_server = std::move(this->server_pool.back());
+    this->server_pool.pop_back();
+
+    http_server->SetKeepAlive(this->config.keep_alive_timeout, this->config.keep_alive_requests);
+
+    return http_server;
+}
+
+void HttpEventLoop::ReleaseServer(std::unique_ptr<HttpServer>& http_server)
+{
+    HttpStats::AddCounter(HTTP_STATS_COUNTER_CONNECTIONS_CLOSED);
+
+    // Keep the instance (and its buffers) for the next connection, releasing its files now.
+    http_server->Reset();
+
+    if(this->server_pool.size() < HTTP_EVENT_LOOP_MAX_POOLED_SERVERS)
+        this->server_pool.push_back(std::move(http_server));
+}
+
+void HttpEventLoop::ResumeConnection(int client_socket)
+{
+    std::unordered_map<int, std::unique_ptr<HttpServer>>::iterator connection = this->connections.find(client_socket);
+    if(connection == this->connections.end())
+        return;
+
+    if(connection->second->Resume(client_socket) < 0)
+        this->CloseConnection(client_socket);
+    else
+        this->ScheduleIdleTimeout(client_socket);
+}
+
+void HttpEventLoop::CloseConnection(int client_socket)
+{
+    std::unordered_map<int, std::unique_ptr<HttpServer>>::iterator connection = this->connections.find(client_socket);
+
+    if(connection != this->connections.end())
+    {
+        this->ReleaseServer(connection->second);
+        this->connections.erase(connection);
+    }
+
+    this->idle_timers.Cancel(client_socket);
+
+    // Closing the socket removes it from the epoll instance as well.
+    close(client_socket);
+}
+
+unsigned int HttpEventLoop::GetIdleTimeout(void) const
+{
+    if(this->config.keep_alive_timeout > 0)
+        return this->config.keep_alive_timeout;
+
+    return (this->config.request_timeout > 0) ? this->config.request_timeout : HTTP_EVENT_LOOP_DEFAULT_REQUEST_TIMEOUT;
+}
+
+void HttpEventLoop::ScheduleIdleTimeout(int client_socket)
+{
+    this->idle_timers.Schedule(client_socket, this->GetIdleTimeout() * 1000UL);
+}
+
+void HttpEventLoop::CloseIdleConnections(void)
+{
+    this->expired_sockets.clear();
+    this->idle_timers.Expire(this->expired_sockets);
+
+    for(int client_socket : this->expired_sockets)
+    {
+        HTTP_LOG_DBG(HTTP_EVENT_LOOP_MSG_IDLE_TIMEOUT, client_socket, this->GetIdleTimeout());
+        this->CloseConnection(client_socket);
+    }
+}
+
+int HttpEventLoop::Run(void)
+{
+    struct epoll_event events[HTTP_EVENT_LOOP_MAX_EVENTS];
+
+    // Peers closing their end while a file is being sent must not kill the process.
+    signal(SIGPIPE, SIG_IGN);
+
+    this->PinToCpu();
+
+    int open_listen_socket = this->OpenListenSocket();
+    if(open_listen_socket < 0)
+        return open_listen_socket;
+
+    this->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if(this->epoll_fd < 0 || this->stop_fd < 0)
+    {
+        HTTP_LOG_ERR(HTTP_EVENT_LOOP_MSG_EPOLL_ERROR, errno);
+        return HTTP_EVENT_LOOP_ERR_EPOLL;
+    }
+
+    struct epoll_event event = {};
+    event.events    = EPOLLIN;
+    event.data.fd   = this->listen_socket;
+    epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, this->listen_socket, &event);
+
+    event.data.fd   = this->stop_fd;
+    epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, this->stop_fd, &event);
+
+    HTTP_LOG_INF(HTTP_EVENT_LOOP_MSG_LISTENING, this->config.server_port, this->config.max_connections);
+
+    bool keep_running = true;
+
+    while(keep_running)
+    {
+        int events_count = epoll_wait(this->epoll_fd, events, HTTP_EVENT_LOOP_MAX_EVENTS, this->idle_timers.GetWaitMs());
+
+        if(events_count < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            HTTP_LOG_ERR(HTTP_EVENT_LOOP_MSG_EPOLL_ERROR, errno);
+            return HTTP_EVENT_LOOP_ERR_EPOLL;
+        }
+
+        for(int i = 0; i < events_count; i++)
+        {
+            int fd = events[i].data.fd;
+
+            if(fd == this->stop_fd)
+                keep_running = false;
+            else if(fd == this->listen_socket)
+                this->AcceptConnections();
+            // Errors and hang-ups are found out (and handled) by the read/write calls themselves.
+            else
+                this->ResumeConnection(fd);
+        }
+
+        this->CloseIdleConnections();
+    }
+
+    HTTP_LOG_INF(HTTP_EVENT_LOOP_MSG_STOPPED);
+
+    return 0;
+}
+
+void HttpEventLoop::Stop(void)
+{
+    uint64_t value = 1;
+    ssize_t written = write(this->stop_fd, &value, sizeof(value));
+    (void)written;
+}
+
+/******************************************/
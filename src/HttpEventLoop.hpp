@@ -0,0 +1,129 @@
+#ifndef CPP_HTTP_EVENT_LOOP_HPP
+#define CPP_HTTP_EVENT_LOOP_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpServer.hpp"
+#include "HttpFileCache.hpp"
+#include "HttpTimerWheel.hpp"
+#include <string>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_EVENT_LOOP_MAX_EVENTS                  256         // Events handled per epoll_wait call.
+#define HTTP_EVENT_LOOP_LISTEN_BACKLOG              4096        // Pending connections queued by the kernel.
+#define HTTP_EVENT_LOOP_MAX_POOLED_SERVERS          1024        // Idle HttpServer instances kept for reuse.
+#define HTTP_EVENT_LOOP_DEFAULT_REQUEST_TIMEOUT     15          // Seconds a connection may take to send a request when keep-alive is off.
+#define HTTP_EVENT_LOOP_NO_CPU                      -1
+
+#define HTTP_EVENT_LOOP_MSG_LISTENING               "Event loop listening on port %d (up to %d connections)."
+#define HTTP_EVENT_LOOP_MSG_STOPPED                 "Event loop stopped."
+#define HTTP_EVENT_LOOP_MSG_SOCKET_ERROR            "Could not create the listening socket, errno: %d"
+#define HTTP_EVENT_LOOP_MSG_BIND_ERROR              "Could not bind to port %d, errno: %d"
+#define HTTP_EVENT_LOOP_MSG_LISTEN_ERROR            "Could not listen on port %d, errno: %d"
+#define HTTP_EVENT_LOOP_MSG_EPOLL_ERROR             "epoll error, errno: %d"
+#define HTTP_EVENT_LOOP_MSG_ACCEPT_ERROR            "Could not accept connection, errno: %d"
+#define HTTP_EVENT_LOOP_MSG_TOO_MANY_CONNECTIONS    "Connection refused: %d connections already open."
+#define HTTP_EVENT_LOOP_MSG_AFFINITY_ERROR          "Could not pin the event loop to CPU %d, error: %d"
+#define HTTP_EVENT_LOOP_MSG_IDLE_TIMEOUT            "Closing connection %d: idle for %u seconds."
+
+#define HTTP_EVENT_LOOP_ERR_SOCKET                  -1
+#define HTTP_EVENT_LOOP_ERR_BIND                    -2
+#define HTTP_EVENT_LOOP_ERR_LISTEN                  -3
+#define HTTP_EVENT_LOOP_ERR_EPOLL                   -4
+
+/************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+typedef struct
+{
+    int             server_port         ;
+    int             max_connections     ;
+    unsigned long   max_request_len     ;
+    bool            reuse_port          ;   // Share the port with other loops (SO_REUSEPORT): the kernel spreads connections among them.
+    int             cpu                 ;   // CPU the loop thread is pinned to (HTTP_EVENT_LOOP_NO_CPU: none).
+    unsigned long   file_cache_bytes    ;   // Size of a private file cache shard (0: use the shared cache).
+    unsigned long   file_cache_entry_bytes;
+    bool            io_uring            ;   // Serve through io_uring (HttpUringLoop) if the kernel supports it.
+    unsigned int    keep_alive_timeout  ;   // Seconds without any activity before a connection is closed (see HttpServer::SetKeepAlive).
+    unsigned int    keep_alive_requests ;
+    unsigned int    request_timeout     ;   // Same, for connections that are not persistent (0: HTTP_EVENT_LOOP_DEFAULT_REQUEST_TIMEOUT).
+} HTTP_EVENT_LOOP_CONFIG;
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Single-threaded alternative to running one blocking HttpServer::Run per client through
+// ServerSocketRun. The loop owns the listening socket; every accepted connection is made
+// non-blocking, registered (edge-triggered) in an epoll instance and given an event-driven
+// HttpServer, whose FSMs are resumed each time the socket becomes readable or writable.
+// Connections are plaintext only, as TLS is provided by C_Server_Socket.
+// Several loops may serve the same port, each one from its own thread (see HttpReactorPool): in
+// that case, everything a loop touches (connections, pooled HttpServer instances and, if
+// configured, its file cache shard) belongs to it alone.
+class HttpEventLoop
+{
+protected:
+    const std::string               path_to_resources   ;
+    const HTTP_EVENT_LOOP_CONFIG    config              ;
+    // How the HttpServer instances handed out by GetServer do their I/O.
+    HTTP_SERVER_IO_MODE             server_io_mode      ;
+
+    int listen_socket   ;
+    int epoll_fd        ;
+    int stop_fd         ;
+
+    std::unique_ptr<HttpFileCache> file_cache;
+
+    std::unordered_map<int, std::unique_ptr<HttpServer>> connections;
+    // Instances left by closed connections, ready to be reused without allocating again.
+    std::vector<std::unique_ptr<HttpServer>> server_pool;
+
+    // Connections without any activity for keep_alive_timeout seconds are closed: every event
+    // pushes their timer forward. Without keep-alive, request_timeout applies instead, so that
+    // clients that never send a whole request cannot hold descriptors forever either.
+    HttpTimerWheel      idle_timers     ;
+    std::vector<int>    expired_sockets ;
+
+    // Used by Run
+    int  PinToCpu(void);
+    int  OpenListenSocket(void);
+    void AcceptConnections(void);
+    void ResumeConnection(int client_socket);
+    void CloseConnection(int client_socket);
+    unsigned int GetIdleTimeout(void) const;
+    void ScheduleIdleTimeout(int client_socket);
+    void CloseIdleConnections(void);
+    std::unique_ptr<HttpServer> GetServer(void);
+    void ReleaseServer(std::unique_ptr<HttpServer>& http_server);
+
+public:
+    HttpEventLoop(const std::string path_to_resources, const HTTP_EVENT_LOOP_CONFIG& config);
+    virtual ~HttpEventLoop(void);
+
+    HttpEventLoop(const HttpEventLoop& obj) = delete;
+
+    // Serve connections until Stop is called or an unrecoverable error happens.
+    virtual int Run(void);
+    // May be called from any thread (or a signal handler).
+    void Stop(void);
+};
+
+/*************************************/
+
+#endif
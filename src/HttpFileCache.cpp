@@ -0,0 +1,440 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "HttpFileCache.hpp"
+#include "HttpClock.hpp"
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <vector>
+#include <algorithm>
+
+/*************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+std::mutex                  HttpFileCache::registry_mutex   ;
+std::vector<HttpFileCache*> HttpFileCache::registry         ;
+
+HttpFileCache::HttpFileCache(unsigned long max_bytes, unsigned long max_entry_bytes):
+    dirty()                             ,
+    hand(ring.end())                    ,
+    used_bytes(0)                       ,
+    max_bytes(max_bytes)                ,
+    max_entry_bytes(max_entry_bytes)    ,
+    evictions(0)
+{
+    for(HTTP_FILE_CACHE_INDEX_SHARD& index_shard : this->index_shards)
+        index_shard.generation.store(0, std::memory_order_relaxed);
+
+    for(HTTP_FILE_CACHE_COUNTERS& stripe : this->counters)
+    {
+        stripe.hits.store(0, std::memory_order_relaxed);
+        stripe.misses.store(0, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(HttpFileCache::registry_mutex);
+    HttpFileCache::registry.push_back(this);
+}
+
+HttpFileCache::~HttpFileCache(void)
+{
+    std::lock_guard<std::mutex> lock(HttpFileCache::registry_mutex);
+    HttpFileCache::registry.erase(std::remove(HttpFileCache::registry.begin(), HttpFileCache::registry.end(), this), HttpFileCache::registry.end());
+}
+
+HttpFileCache& HttpFileCache::GetInstance(void)
+{
+    static HttpFileCache instance;
+
+    return instance;
+}
+
+size_t HttpFileCache::GetShard(const std::string& path)
+{
+    return std::hash<std::string>{}(path) & (HTTP_FILE_CACHE_INDEX_SHARDS - 1);
+}
+
+size_t HttpFileCache::GetStripe(void)
+{
+    static std::atomic<size_t> next_stripe(0);
+    thread_local size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) & (HTTP_FILE_CACHE_COUNTER_STRIPES - 1);
+
+    return stripe;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Read path
+
+bool HttpFileCache::Lookup(const std::string& path, std::shared_ptr<const std::string>& body, struct stat& file_stat, Reader& reader)
+{
+    // Fetch the part the path belongs to if it was not held yet, or was published again since (a
+    // single atomic load otherwise).
+    size_t shard = GetShard(path);
+    uint64_t shard_generation = this->index_shards[shard].generation.load(std::memory_order_acquire);
+
+    if(reader.index[shard] == nullptr || shard_generation != reader.shard_generation[shard])
+    {
+        // Bodies handed out from the former copy may still be in use.
+        if(reader.index[shard] != nullptr)
+            reader.retired.push_back(std::move(reader.index[shard]));
+
+        reader.index[shard]             = std::atomic_load(&this->index_shards[shard].index);
+        reader.shard_generation[shard]  = shard_generation;
+    }
+
+    HTTP_FILE_CACHE_COUNTERS& stripe = this->counters[GetStripe()];
+    const std::shared_ptr<const entry_index>& index = reader.index[shard];
+
+    // The entry is kept alive by the reader's copy, so it is not copied (that would make every
+    // thread serving the same file write to its reference count).
+    entry_index::const_iterator it;
+    if(index == nullptr || (it = index->find(path)) == index->end())
+    {
+        stripe.misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const entry_ptr& entry = it->second;
+
+    // If the file changed on disk, drop the stale copy and let the caller load it again.
+    if(!this->Revalidate(entry, HttpNowMs()))
+    {
+        this->Remove(entry);
+        stripe.misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Only written when it changes, so that hot entries stay shared in every core's cache.
+    if(!entry->referenced.load(std::memory_order_relaxed))
+        entry->referenced.store(true, std::memory_order_relaxed);
+
+    // Aliasing an empty pointer: no control block, so nothing is written by this copy or any later one.
+    body        = std::shared_ptr<const std::string>(std::shared_ptr<const std::string>(), entry->body.get());
+    file_stat   = entry->file_stat;
+
+    stripe.hits.fetch_add(1, std::memory_order_relaxed);
+
+    return true;
+}
+
+bool HttpFileCache::Revalidate(const entry_ptr& entry, long int now_ms)
+{
+    long int validated_at_ms = entry->validated_at_ms.load(std::memory_order_relaxed);
+
+    if(now_ms - validated_at_ms < HTTP_FILE_CACHE_REVALIDATE_MS)
+        return true;
+
+    // Only one thread pays for the stat call, the others keep on serving the current body meanwhile.
+    if(!entry->validated_at_ms.compare_exchange_strong(validated_at_ms, now_ms, std::memory_order_relaxed))
+        return true;
+
+    struct stat file_stat;
+    if(stat(entry->path.c_str(), &file_stat) < 0)
+        return false;
+
+    return  file_stat.st_dev            == entry->file_stat.st_dev          &&
+            file_stat.st_ino            == entry->file_stat.st_ino          &&
+            file_stat.st_size           == entry->file_stat.st_size         &&
+            file_stat.st_mtim.tv_sec    == entry->file_stat.st_mtim.tv_sec  &&
+            file_stat.st_mtim.tv_nsec   == entry->file_stat.st_mtim.tv_nsec ;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Load path
+
+int HttpFileCache::Load(const std::string& path, std::shared_ptr<const std::string>& body)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return HTTP_FILE_CACHE_ERR_OPEN;
+
+    // Take the stat from the descriptor itself so that size and version always match the bytes read.
+    struct stat file_stat;
+    int load_file = (fstat(fd, &file_stat) < 0) ? HTTP_FILE_CACHE_ERR_READ : this->Load(path, fd, file_stat, body);
+
+    close(fd);
+
+    return load_file;
+}
+
+int HttpFileCache::Load(const std::string& path, int fd, const struct stat& file_stat, std::shared_ptr<const std::string>& body)
+{
+    std::string content(file_stat.st_size, '\0');
+    size_t bytes_read = 0;
+
+    // From the beginning, whatever the file offset of the descriptor is.
+    while(bytes_read < content.size())
+    {
+        ssize_t read_now = pread(fd, content.data() + bytes_read, content.size() - bytes_read, bytes_read);
+
+        if(read_now < 0 && errno == EINTR)
+            continue;
+
+        if(read_now < 0)
+            return HTTP_FILE_CACHE_ERR_READ;
+
+        // File got truncated in the meantime.
+        if(read_now == 0)
+            break;
+
+        bytes_read += read_now;
+    }
+
+    // Do not keep partial reads around.
+    bool complete_read = (bytes_read == content.size());
+    content.resize(bytes_read);
+
+    body = std::make_shared<const std::string>(std::move(content));
+
+    if(complete_read && (unsigned long)file_stat.st_size <= this->max_entry_bytes.load(std::memory_order_relaxed))
+        this->Insert(path, file_stat, body);
+
+    return 0;
+}
+
+void HttpFileCache::Insert(const std::string& path, const struct stat& file_stat, const std::shared_ptr<const std::string>& body)
+{
+    entry_ptr entry = std::make_shared<HTTP_FILE_CACHE_ENTRY>();
+
+    entry->path         = path      ;
+    entry->body         = body      ;
+    entry->file_stat    = file_stat ;
+    entry->validated_at_ms.store(HttpNowMs(), std::memory_order_relaxed);
+    entry->referenced.store(false, std::memory_order_relaxed);
+
+    size_t shard = GetShard(path);
+
+    std::lock_guard<std::mutex> lock(this->cache_mutex);
+
+    if(body->size() > this->max_bytes.load(std::memory_order_relaxed))
+        return;
+
+    entry_table::iterator it = this->entries[shard].find(path);
+    if(it != this->entries[shard].end())
+        this->EraseLocked(it->second);
+
+    this->EvictLocked(body->size());
+
+    // New entries go right behind the clock hand, so they are the last ones to be checked.
+    this->entries[shard][path]  = this->ring.insert(this->hand, entry);
+    this->dirty[shard]          = true;
+    this->used_bytes           += body->size();
+
+    this->PublishLocked();
+}
+
+void HttpFileCache::Remove(const entry_ptr& entry)
+{
+    entry_table& shard_entries = this->entries[GetShard(entry->path)];
+
+    std::lock_guard<std::mutex> lock(this->cache_mutex);
+
+    // Another thread may have loaded a newer version under the same path already.
+    entry_table::iterator it = shard_entries.find(entry->path);
+    if(it != shard_entries.end() && *(it->second) == entry)
+    {
+        this->EraseLocked(it->second);
+        this->PublishLocked();
+    }
+}
+
+void HttpFileCache::EraseLocked(clock_ring::iterator it)
+{
+    if(this->hand == it)
+        ++this->hand;
+
+    size_t shard = GetShard((*it)->path);
+
+    this->used_bytes -= (*it)->body->size();
+    this->entries[shard].erase((*it)->path);
+    this->dirty[shard] = true;
+    this->ring.erase(it);
+}
+
+void HttpFileCache::EvictLocked(unsigned long incoming_bytes)
+{
+    unsigned long limit = this->max_bytes.load(std::memory_order_relaxed);
+
+    while(!this->ring.empty() && this->used_bytes + incoming_bytes > limit)
+    {
+        if(this->hand == this->ring.end())
+            this->hand = this->ring.begin();
+
+        // Recently used entries get a second chance.
+        if((*this->hand)->referenced.exchange(false, std::memory_order_relaxed))
+        {
+            ++this->hand;
+            continue;
+        }
+
+        clock_ring::iterator victim = this->hand++;
+        this->EraseLocked(victim);
+
+        this->evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void HttpFileCache::PublishLocked(void)
+{
+    for(size_t i = 0; i < HTTP_FILE_CACHE_INDEX_SHARDS; i++)
+    {
+        if(!this->dirty[i])
+            continue;
+
+        std::shared_ptr<entry_index> new_index = std::make_shared<entry_index>();
+        new_index->reserve(this->entries[i].size());
+
+        for(const entry_table::value_type& entry : this->entries[i])
+            new_index->emplace(entry.first, *(entry.second));
+
+        // The copy must be in place before readers are told about it.
+        std::atomic_store(&this->index_shards[i].index, std::shared_ptr<const entry_index>(std::move(new_index)));
+        this->index_shards[i].generation.fetch_add(1, std::memory_order_release);
+
+        this->dirty[i] = false;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Settings and statistics
+
+void HttpFileCache::SetLimits(unsigned long max_bytes, unsigned long max_entry_bytes)
+{
+    this->max_bytes.store(max_bytes, std::memory_order_relaxed);
+    this->max_entry_bytes.store(max_entry_bytes, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(this->cache_mutex);
+    this->EvictLocked(0);
+    this->PublishLocked();
+}
+
+unsigned long HttpFileCache::GetMaxBytes(void)
+{
+    return this->max_bytes.load(std::memory_order_relaxed);
+}
+
+unsigned long HttpFileCache::GetMaxEntryBytes(void)
+{
+    return this->max_entry_bytes.load(std::memory_order_relaxed);
+}
+
+void HttpFileCache::Clear(void)
+{
+    std::lock_guard<std::mutex> lock(this->cache_mutex);
+
+    for(size_t i = 0; i < HTTP_FILE_CACHE_INDEX_SHARDS; i++)
+    {
+        this->dirty[i] = this->dirty[i] || !this->entries[i].empty();
+        this->entries[i].clear();
+    }
+
+    this->ring.clear();
+    this->hand          = this->ring.end();
+    this->used_bytes    = 0;
+
+    this->PublishLocked();
+}
+
+void HttpFileCache::Invalidate(const std::unordered_set<std::string>& paths)
+{
+    std::lock_guard<std::mutex> lock(this->cache_mutex);
+
+    for(clock_ring::iterator it = this->ring.begin(); it != this->ring.end();)
+    {
+        clock_ring::iterator current = it++;
+
+        if(HttpPathIsAffected(paths, (*current)->path))
+            this->EraseLocked(current);
+    }
+
+    this->PublishLocked();
+}
+
+void HttpFileCache::GetStats(HTTP_FILE_CACHE_STATS& stats)
+{
+    stats.hits      = 0;
+    stats.misses    = 0;
+    stats.evictions = this->evictions.load(std::memory_order_relaxed);
+
+    for(HTTP_FILE_CACHE_COUNTERS& stripe : this->counters)
+    {
+        stats.hits      += stripe.hits.load(std::memory_order_relaxed)  ;
+        stats.misses    += stripe.misses.load(std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(this->cache_mutex);
+
+    stats.entries   = this->ring.size() ;
+    stats.bytes     = this->used_bytes  ;
+}
+
+void HttpFileCache::GetTotalStats(HTTP_FILE_CACHE_STATS& stats)
+{
+    stats = {};
+
+    std::lock_guard<std::mutex> lock(HttpFileCache::registry_mutex);
+
+    for(HttpFileCache* file_cache : HttpFileCache::registry)
+    {
+        HTTP_FILE_CACHE_STATS shard_stats;
+        file_cache->GetStats(shard_stats);
+
+        stats.hits      += shard_stats.hits     ;
+        stats.misses    += shard_stats.misses   ;
+        stats.evictions += shard_stats.evictions;
+        stats.entries   += shard_stats.entries  ;
+        stats.bytes     += shard_stats.bytes    ;
+    }
+}
+
+void HttpFileCache::ClearAll(void)
+{
+    std::lock_guard<std::mutex> lock(HttpFileCache::registry_mutex);
+
+    for(HttpFileCache* file_cache : HttpFileCache::registry)
+        file_cache->Clear();
+}
+
+void HttpFileCache::InvalidateAll(const std::unordered_set<std::string>& paths)
+{
+    std::lock_guard<std::mutex> lock(HttpFileCache::registry_mutex);
+
+    for(HttpFileCache* file_cache : HttpFileCache::registry)
+        file_cache->Invalidate(paths);
+}
+
+/******************************************/
+
+/**************************************/
+/******** Function definitions ********/
+/**************************************/
+
+bool HttpPathIsAffected(const std::unordered_set<std::string>& paths, const std::string& path)
+{
+    if(paths.empty())
+        return false;
+
+    if(paths.count(path) > 0)
+        return true;
+
+    // Every directory the path goes through, from the innermost one.
+    for(size_t separator = path.rfind('/'); separator != std::string::npos && separator > 0; separator = path.rfind('/', separator - 1))
+    {
+        if(paths.count(path.substr(0, separator)) > 0)
+            return true;
+    }
+
+    return false;
+}
+
+/**************************************/
@@ -0,0 +1,195 @@
+#ifndef CPP_HTTP_FILE_CACHE_HPP
+#define CPP_HTTP_FILE_CACHE_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "HttpServer_api.hpp"
+#include <time.h>
+#include <string>
+#include <list>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_FILE_CACHE_DEFAULT_MAX_BYTES           (64UL * 1024UL * 1024UL)    // Whole cache size (64 MiB).
+#define HTTP_FILE_CACHE_DEFAULT_MAX_ENTRY_BYTES     (1UL * 1024UL * 1024UL)     // Larger files are never cached (1 MiB).
+#define HTTP_FILE_CACHE_REVALIDATE_MS               1000                        // Time an entry is trusted without calling stat.
+#define HTTP_FILE_CACHE_INDEX_SHARDS                64                          // Parts of the index published on their own (power of two).
+#define HTTP_FILE_CACHE_COUNTER_STRIPES             16                          // Copies of the hit and miss counters (power of two).
+
+#define HTTP_FILE_CACHE_ERR_OPEN                    -1
+#define HTTP_FILE_CACHE_ERR_READ                    -2
+
+/************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Process-wide, size-bounded cache of file bodies keyed by path. Each entry remembers the
+// inode, size and modification time of the file it was loaded from, and is checked against
+// them again (through a single stat call) once every HTTP_FILE_CACHE_REVALIDATE_MS.
+// Replacement follows the CLOCK algorithm so that hits only set a flag instead of moving
+// entries around. Lookups take no lock at all: the table is split into
+// HTTP_FILE_CACHE_INDEX_SHARDS parts, each of them published as an immutable copy that is only
+// replaced (under the writers' mutex) when an entry of its own is added or dropped. Readers fetch
+// the copy of a part the first time they need it, and keep it until they are released or its
+// generation number changes.
+// Files bigger than the per-entry limit are read but never kept.
+// The process-wide instance is shared by every connection, but other instances (shards) may be
+// created as well, e.g. one per reactor thread. Statistics can be gathered across all of them.
+class HttpFileCache
+{
+private:
+    typedef struct
+    {
+        std::string                         path            ;
+        std::shared_ptr<const std::string>  body            ;
+        struct stat                         file_stat       ;   // Of the version held in body.
+        std::atomic<long int>               validated_at_ms ;
+        std::atomic<bool>                   referenced      ;
+    } HTTP_FILE_CACHE_ENTRY;
+
+    using entry_ptr     = std::shared_ptr<HTTP_FILE_CACHE_ENTRY>        ;
+    using clock_ring    = std::list<entry_ptr>                          ;
+    using entry_table   = std::unordered_map<std::string, clock_ring::iterator>;
+    using entry_index   = std::unordered_map<std::string, entry_ptr>    ;
+
+    // Published copy of a part of the table.
+    typedef struct alignas(64)
+    {
+        std::shared_ptr<const entry_index>  index       ;   // Accessed through std::atomic_load/store only.
+        std::atomic<uint64_t>               generation  ;
+    } HTTP_FILE_CACHE_INDEX_SHARD;
+
+    // Counters updated by lookups, one copy per group of threads so that they do not share cache lines.
+    typedef struct alignas(64)
+    {
+        std::atomic<unsigned long>  hits    ;
+        std::atomic<unsigned long>  misses  ;
+    } HTTP_FILE_CACHE_COUNTERS;
+
+    // Writers only (Insert, Remove, eviction...).
+    std::mutex              cache_mutex                                 ;
+    entry_table             entries[HTTP_FILE_CACHE_INDEX_SHARDS]       ;
+    bool                    dirty[HTTP_FILE_CACHE_INDEX_SHARDS]         ;   // Changed since last published.
+    clock_ring              ring                                        ;
+    clock_ring::iterator    hand                                        ;
+    unsigned long           used_bytes                                  ;
+
+    // Readers.
+    HTTP_FILE_CACHE_INDEX_SHARD index_shards[HTTP_FILE_CACHE_INDEX_SHARDS]  ;
+
+    std::atomic<unsigned long> max_bytes        ;
+    std::atomic<unsigned long> max_entry_bytes  ;
+
+    HTTP_FILE_CACHE_COUNTERS   counters[HTTP_FILE_CACHE_COUNTER_STRIPES]    ;
+    std::atomic<unsigned long> evictions                                    ;
+
+    static size_t GetShard(const std::string& path);
+    // Stripe of the counters used by the calling thread.
+    static size_t GetStripe(void);
+
+    // Every live instance, so that statistics can be summed up.
+    static std::mutex                   registry_mutex  ;
+    static std::vector<HttpFileCache*>  registry        ;
+
+    // Used by Lookup and Load
+    bool Revalidate(const entry_ptr& entry, long int now_ms);
+    void Insert(const std::string& path, const struct stat& file_stat, const std::shared_ptr<const std::string>& body);
+    void Remove(const entry_ptr& entry);
+    // Must be called with cache_mutex held.
+    void EraseLocked(clock_ring::iterator it);
+    void EvictLocked(unsigned long incoming_bytes);
+    void PublishLocked(void);
+
+public:
+    // Copies of the index held by a single reader (a connection or a reactor thread), never shared
+    // between threads. They keep alive the bodies handed out by Lookup until Release is called once
+    // none of those bodies is in use anymore (e.g. once the responses carrying them have been sent),
+    // so that a reader holds nothing in between: entries evicted meanwhile are freed right away,
+    // whatever the number of idle connections. Copies replaced while in use are retired until then.
+    class Reader
+    {
+        friend class HttpFileCache;
+
+        std::shared_ptr<const entry_index>                  index[HTTP_FILE_CACHE_INDEX_SHARDS]             ;
+        uint64_t                                            shard_generation[HTTP_FILE_CACHE_INDEX_SHARDS]  ;
+        std::vector<std::shared_ptr<const entry_index>>     retired                                         ;
+
+    public:
+        Reader(void): shard_generation() {}
+
+        inline void Release(void)
+        {
+            for(std::shared_ptr<const entry_index>& index : this->index)
+                index.reset();
+
+            this->retired.clear();
+        }
+    };
+
+public:
+    HttpFileCache(unsigned long max_bytes = HTTP_FILE_CACHE_DEFAULT_MAX_BYTES, unsigned long max_entry_bytes = HTTP_FILE_CACHE_DEFAULT_MAX_ENTRY_BYTES);
+    virtual ~HttpFileCache(void);
+
+    HttpFileCache(const HttpFileCache& obj) = delete;
+
+    static HttpFileCache& GetInstance(void);
+
+    // Get the contents of the file found at path from memory, along with the metadata of the version
+    // they belong to, through the copies of the index held by reader (lock-free). Returns false on a
+    // miss. body does not own the contents (copying it touches no reference count): they are kept
+    // alive by reader until its next Release.
+    bool Lookup(const std::string& path, std::shared_ptr<const std::string>& body, struct stat& file_stat, Reader& reader);
+    // Read the file found at path from disk, then keep it in memory if it fits.
+    int Load(const std::string& path, std::shared_ptr<const std::string>& body);
+    // Same, from a descriptor already open on it (left open) and its metadata.
+    int Load(const std::string& path, int fd, const struct stat& file_stat, std::shared_ptr<const std::string>& body);
+
+    void SetLimits(unsigned long max_bytes, unsigned long max_entry_bytes);
+    unsigned long GetMaxBytes(void);
+    unsigned long GetMaxEntryBytes(void);
+    void Clear(void);
+    // Drop the entries of the given paths, and of every file below those that are directories.
+    void Invalidate(const std::unordered_set<std::string>& paths);
+    void GetStats(HTTP_FILE_CACHE_STATS& stats);
+    // Sum of the statistics of every instance (the shared one and all the shards).
+    static void GetTotalStats(HTTP_FILE_CACHE_STATS& stats);
+    // Same as Clear and Invalidate, on every instance.
+    static void ClearAll(void);
+    static void InvalidateAll(const std::unordered_set<std::string>& paths);
+};
+
+/*************************************/
+
+/**************************************/
+/******** Function declarations *******/
+/**************************************/
+
+// Whether path is one of paths, or lies below one of them.
+bool HttpPathIsAffected(const std::unordered_set<std::string>& paths, const std::string& path);
+
+/**************************************/
+
+#endif
@@ -0,0 +1,150 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpHeaderScan.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HTTP_HEADER_SCAN_X86
+#endif
+
+/*************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+typedef std::size_t (*HTTP_HEADER_SCAN_FN)(const char* data, std::size_t length, std::size_t from);
+
+/************************************/
+
+/******************************************/
+/******** Private helper functions ********/
+/******************************************/
+
+// Portable kernel: jump from one '\r' to the next with memchr, then check the three bytes after it.
+static std::size_t FindHeaderEndScalar(const char* data, std::size_t length, std::size_t from)
+{
+    while(from + HTTP_HEADER_SCAN_TERMINATOR_LEN <= length)
+    {
+        const char* carriage_return = (const char*)memchr(data + from, '\r', length - from - (HTTP_HEADER_SCAN_TERMINATOR_LEN - 1));
+        if(carriage_return == nullptr)
+            break;
+
+        from = carriage_return - data;
+
+        if(memcmp(carriage_return, HTTP_HEADER_SCAN_TERMINATOR, HTTP_HEADER_SCAN_TERMINATOR_LEN) == 0)
+            return from + HTTP_HEADER_SCAN_TERMINATOR_LEN;
+
+        from++;
+    }
+
+    return HTTP_HEADER_SCAN_NOT_FOUND;
+}
+
+#ifdef HTTP_HEADER_SCAN_X86
+
+// Vector kernels: four unaligned loads shifted by one byte each are compared against '\r', '\n',
+// '\r', '\n'. ANDing the four masks leaves a bit set only where a whole terminator begins.
+// Whatever is left at the end of the buffer (less than a vector plus 3 bytes) is scanned by the
+// scalar kernel.
+
+static std::size_t FindHeaderEndSSE2(const char* data, std::size_t length, std::size_t from)
+{
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+
+    while(from + sizeof(__m128i) + (HTTP_HEADER_SCAN_TERMINATOR_LEN - 1) <= length)
+    {
+        const char* p = data + from;
+
+        __m128i b0 = _mm_loadu_si128((const __m128i*)(p + 0));
+        __m128i b1 = _mm_loadu_si128((const __m128i*)(p + 1));
+        __m128i b2 = _mm_loadu_si128((const __m128i*)(p + 2));
+        __m128i b3 = _mm_loadu_si128((const __m128i*)(p + 3));
+
+        unsigned int mask = _mm_movemask_epi8(_mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(b0, cr), _mm_cmpeq_epi8(b1, lf)),
+                                                            _mm_and_si128(_mm_cmpeq_epi8(b2, cr), _mm_cmpeq_epi8(b3, lf))));
+
+        if(mask != 0)
+            return from + __builtin_ctz(mask) + HTTP_HEADER_SCAN_TERMINATOR_LEN;
+
+        from += sizeof(__m128i);
+    }
+
+    return FindHeaderEndScalar(data, length, from);
+}
+
+__attribute__((target("avx2")))
+static std::size_t FindHeaderEndAVX2(const char* data, std::size_t length, std::size_t from)
+{
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+
+    while(from + sizeof(__m256i) + (HTTP_HEADER_SCAN_TERMINATOR_LEN - 1) <= length)
+    {
+        const char* p = data + from;
+
+        __m256i b0 = _mm256_loadu_si256((const __m256i*)(p + 0));
+        __m256i b1 = _mm256_loadu_si256((const __m256i*)(p + 1));
+        __m256i b2 = _mm256_loadu_si256((const __m256i*)(p + 2));
+        __m256i b3 = _mm256_loadu_si256((const __m256i*)(p + 3));
+
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(_mm256_cmpeq_epi8(b0, cr), _mm256_cmpeq_epi8(b1, lf)),
+                                                                                _mm256_and_si256(_mm256_cmpeq_epi8(b2, cr), _mm256_cmpeq_epi8(b3, lf))));
+
+        if(mask != 0)
+            return from + __builtin_ctz(mask) + HTTP_HEADER_SCAN_TERMINATOR_LEN;
+
+        from += sizeof(__m256i);
+    }
+
+    return FindHeaderEndSSE2(data, length, from);
+}
+
+#endif
+
+static HTTP_HEADER_SCAN_FN SelectHeaderScanKernel(void)
+{
+#ifdef HTTP_HEADER_SCAN_X86
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx2"))
+        return FindHeaderEndAVX2;
+
+    if(__builtin_cpu_supports("sse2"))
+        return FindHeaderEndSSE2;
+#endif
+
+    return FindHeaderEndScalar;
+}
+
+/******************************************/
+
+/**************************************/
+/******** Function definitions ********/
+/**************************************/
+
+std::size_t HttpFindHeaderEnd(const char* data, std::size_t length, std::size_t from)
+{
+    // Thread-safe one-time selection (function-local static initialization).
+    static const HTTP_HEADER_SCAN_FN scan_kernel = SelectHeaderScanKernel();
+
+    if(from >= length)
+        return HTTP_HEADER_SCAN_NOT_FOUND;
+
+    return scan_kernel(data, length, from);
+}
+
+std::size_t HttpHeaderScanResumeOffset(std::size_t length, std::size_t from)
+{
+    if(length < from + (HTTP_HEADER_SCAN_TERMINATOR_LEN - 1))
+        return from;
+
+    return length - (HTTP_HEADER_SCAN_TERMINATOR_LEN - 1);
+}
+
+/**************************************/
@@ -0,0 +1,38 @@
+#ifndef CPP_HTTP_HEADER_SCAN_HPP
+#define CPP_HTTP_HEADER_SCAN_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <cstddef>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_HEADER_SCAN_TERMINATOR         "\r\n\r\n"
+#define HTTP_HEADER_SCAN_TERMINATOR_LEN     4
+#define HTTP_HEADER_SCAN_NOT_FOUND          ((std::size_t)-1)
+
+/************************************/
+
+/**************************************/
+/******** Function declarations *******/
+/**************************************/
+
+// Look for the first "\r\n\r\n" within data[from, length). Returns the offset just past the
+// terminator (that is, the length of the header block when data begins with the request line),
+// or HTTP_HEADER_SCAN_NOT_FOUND. The fastest kernel supported by the CPU (AVX2, SSE2 or plain
+// C++) is picked the first time it is called.
+std::size_t HttpFindHeaderEnd(const char* data, std::size_t length, std::size_t from);
+
+// Where the next scan over a buffer of the given length should begin if the previous one found
+// nothing: the last (terminator length - 1) bytes may still be the beginning of a terminator.
+std::size_t HttpHeaderScanResumeOffset(std::size_t length, std::size_t from);
+
+/**************************************/
+
+#endif
@@ -4,6 +4,12 @@
 
 #include "HttpServer_api.hpp"
 #include "HttpInteractHandler.hpp"
+#include "HttpFileCache.hpp"
+#include "HttpCachePolicy.hpp"
+#include "HttpStats.hpp"
+#include "HttpAccessLog.hpp"
+#include "HttpResourceManifest.hpp"
+#include "HttpResourceWatcher.hpp"
 #include <string>
 
 /*************************************/
@@ -23,9 +29,108 @@ void HttpInteract::SetPathToResources(const char* path_to_resources)
     HttpInteractHandler::SetPathToResources(path_to_resources);
 }
 
+void HttpInteract::SetSecureConnection(bool secure_connection)
+{
+    HttpInteractHandler::SetSecureConnection(secure_connection);
+}
+
+void HttpInteract::SetMaxRequestSize(unsigned long max_request_len)
+{
+    HttpInteractHandler::SetMaxRequestSize(max_request_len);
+}
+
 int HttpInteract::InteractFn(int client_socket)
 {
     return HttpInteractHandler::InteractFn(client_socket);
 }
 
+void HttpInteract::SetIoUring(bool io_uring)
+{
+    HttpInteractHandler::SetIoUring(io_uring);
+}
+
+void HttpInteract::SetKeepAlive(unsigned int timeout_secs, unsigned int max_requests)
+{
+    HttpInteractHandler::SetKeepAlive(timeout_secs, max_requests);
+}
+
+int HttpInteract::RunEventLoop(int server_port, int max_connections)
+{
+    return HttpInteractHandler::RunEventLoop(server_port, max_connections);
+}
+
+int HttpInteract::RunReactors(int server_port, int max_connections, int workers, const char* core_list)
+{
+    return HttpInteractHandler::RunReactors(server_port, max_connections, workers, core_list);
+}
+
+void HttpInteract::SetFileCacheLimits(unsigned long max_bytes, unsigned long max_entry_bytes)
+{
+    HttpFileCache::GetInstance().SetLimits(max_bytes, max_entry_bytes);
+}
+
+void HttpInteract::GetFileCacheStats(HTTP_FILE_CACHE_STATS* stats)
+{
+    if(stats == nullptr)
+        return;
+
+    HttpFileCache::GetTotalStats(*stats);
+}
+
+int HttpInteract::AddCachePolicy(HTTP_CACHE_POLICY_MATCH match, const char* key, long int max_age, unsigned int flags)
+{
+    return HttpCachePolicyTable::GetInstance().Add(match, key, max_age, flags);
+}
+
+void HttpInteract::ClearCachePolicies(void)
+{
+    HttpCachePolicyTable::GetInstance().Clear();
+}
+
+void HttpInteract::SetStatsPath(const char* path)
+{
+    HttpStats::GetInstance().SetPath(path);
+}
+
+void HttpInteract::GetServerStats(HTTP_SERVER_STATS* stats)
+{
+    if(stats == nullptr)
+        return;
+
+    HttpStats::GetInstance().GetStats(*stats);
+}
+
+long HttpInteract::BuildResourceManifest(unsigned long preload_bytes)
+{
+    return HttpInteractHandler::BuildResourceManifest(preload_bytes);
+}
+
+void HttpInteract::ClearResourceManifest(void)
+{
+    HttpResourceManifest::GetInstance().Clear();
+}
+
+int HttpInteract::WatchResources(void)
+{
+    return HttpInteractHandler::WatchResources();
+}
+
+void HttpInteract::StopWatchingResources(void)
+{
+    HttpResourceWatcher::GetInstance().Stop();
+}
+
+void HttpInteract::GetResourceWatcherStats(HTTP_RESOURCE_WATCHER_STATS* stats)
+{
+    if(stats == nullptr)
+        return;
+
+    HttpStats::GetInstance().GetWatcherStats(*stats);
+}
+
+int HttpInteract::SetAccessLog(const char* path, unsigned int flush_interval_ms, unsigned long max_file_size, unsigned int max_files)
+{
+    return HttpAccessLog::GetInstance().SetFile(path, flush_interval_ms, max_file_size, max_files);
+}
+
 /******************************************/
@@ -4,7 +4,16 @@
 
 #include "HttpServer.hpp"
 #include "HttpInteractHandler.hpp"
+#include "HttpEventLoop.hpp"
+#include "HttpUringLoop.hpp"
+#include "HttpReactorPool.hpp"
+#include "HttpStats.hpp"
+#include "HttpResourceManifest.hpp"
+#include "HttpResourceWatcher.hpp"
+#include "HttpLog.hpp"
 #include <string>
+#include <vector>
+#include <memory>
 
 /*************************************/
 
@@ -19,17 +28,114 @@
 /******************************************/
 
 std::string HttpInteractHandler::path_to_resources = "";
+bool HttpInteractHandler::secure_connection = true;
+unsigned long HttpInteractHandler::max_request_len = HTTP_SERVER_DEFAULT_MAX_REQUEST_LEN;
+bool HttpInteractHandler::io_uring = false;
+unsigned int HttpInteractHandler::keep_alive_timeout = HTTP_SERVER_DEFAULT_KEEP_ALIVE_TIMEOUT;
+unsigned int HttpInteractHandler::keep_alive_requests = HTTP_SERVER_DEFAULT_KEEP_ALIVE_REQUESTS;
 
 void HttpInteractHandler::SetPathToResources(const char* path_to_resources)
 {
     HttpInteractHandler::path_to_resources = path_to_resources;
 }
 
+void HttpInteractHandler::SetSecureConnection(bool secure_connection)
+{
+    HttpInteractHandler::secure_connection = secure_connection;
+}
+
+void HttpInteractHandler::SetMaxRequestSize(unsigned long max_request_len)
+{
+    HttpInteractHandler::max_request_len = max_request_len;
+}
+
+void HttpInteractHandler::SetIoUring(bool io_uring)
+{
+    HttpInteractHandler::io_uring = io_uring;
+}
+
+void HttpInteractHandler::SetKeepAlive(unsigned int timeout_secs, unsigned int max_requests)
+{
+    HttpInteractHandler::keep_alive_timeout     = timeout_secs;
+    HttpInteractHandler::keep_alive_requests    = max_requests;
+}
+
 int HttpInteractHandler::InteractFn(int client_socket)
 {
-    HttpServer http_server(HttpInteractHandler::path_to_resources);
+    HttpServer http_server(HttpInteractHandler::path_to_resources, HttpInteractHandler::secure_connection, HttpInteractHandler::max_request_len);
+    http_server.SetKeepAlive(HttpInteractHandler::keep_alive_timeout, HttpInteractHandler::keep_alive_requests);
+
+    HttpStats::AddCounter(HTTP_STATS_COUNTER_CONNECTIONS_OPENED);
+    int run = http_server.Run(client_socket);
+    HttpStats::AddCounter(HTTP_STATS_COUNTER_CONNECTIONS_CLOSED);
+
+    return run;
+}
+
+int HttpInteractHandler::RunEventLoop(int server_port, int max_connections)
+{
+    if(HttpInteractHandler::secure_connection)
+    {
+        HTTP_LOG_ERR(HTTP_INTERACT_MSG_EVENT_LOOP_SECURE);
+        return HTTP_INTERACT_ERR_EVENT_LOOP_SECURE;
+    }
 
-    return http_server.Run(client_socket);
+    HTTP_EVENT_LOOP_CONFIG config = {};
+    config.server_port         = server_port;
+    config.max_connections     = max_connections;
+    config.max_request_len     = HttpInteractHandler::max_request_len;
+    config.reuse_port          = false;
+    config.cpu                 = HTTP_EVENT_LOOP_NO_CPU;
+    config.file_cache_bytes    = 0;
+    config.io_uring            = HttpInteractHandler::io_uring;
+    config.keep_alive_timeout  = HttpInteractHandler::keep_alive_timeout;
+    config.keep_alive_requests = HttpInteractHandler::keep_alive_requests;
+
+    std::unique_ptr<HttpEventLoop> event_loop;
+
+    if(config.io_uring)
+        event_loop = std::make_unique<HttpUringLoop>(HttpInteractHandler::path_to_resources, config);
+    else
+        event_loop = std::make_unique<HttpEventLoop>(HttpInteractHandler::path_to_resources, config);
+
+    return event_loop->Run();
+}
+
+int HttpInteractHandler::RunReactors(int server_port, int max_connections, int workers, const char* core_list)
+{
+    if(HttpInteractHandler::secure_connection)
+    {
+        HTTP_LOG_ERR(HTTP_INTERACT_MSG_EVENT_LOOP_SECURE);
+        return HTTP_INTERACT_ERR_EVENT_LOOP_SECURE;
+    }
+
+    std::vector<int> cores;
+    int parse_cores = HttpReactorPool::ParseCoreList((core_list != nullptr) ? core_list : "", cores);
+    if(parse_cores < 0)
+        return parse_cores;
+
+    HTTP_EVENT_LOOP_CONFIG config = {};
+    config.server_port         = server_port;
+    config.max_connections     = max_connections;
+    config.max_request_len     = HttpInteractHandler::max_request_len;
+    config.io_uring            = HttpInteractHandler::io_uring;
+    config.keep_alive_timeout  = HttpInteractHandler::keep_alive_timeout;
+    config.keep_alive_requests = HttpInteractHandler::keep_alive_requests;
+
+    HttpReactorPool reactor_pool(HttpInteractHandler::path_to_resources, config, workers, cores);
+
+    return reactor_pool.Run();
+}
+
+long HttpInteractHandler::BuildResourceManifest(unsigned long preload_bytes)
+{
+    // Preloaded bodies are limited to what the file cache would keep in memory anyway; larger files are streamed.
+    return HttpResourceManifest::GetInstance().Build(HttpInteractHandler::path_to_resources, preload_bytes, HttpFileCache::GetInstance().GetMaxEntryBytes());
+}
+
+int HttpInteractHandler::WatchResources(void)
+{
+    return HttpResourceWatcher::GetInstance().Start(HttpInteractHandler::path_to_resources);
 }
 
 /******************************************/
@@ -14,6 +14,10 @@
 /********* Define statements ********/
 /************************************/
 
+#define HTTP_INTERACT_MSG_EVENT_LOOP_SECURE     "The event loop only serves plaintext connections (TLS is provided by ServerSocketRun)."
+
+#define HTTP_INTERACT_ERR_EVENT_LOOP_SECURE     -10
+
 /************************************/
 
 /************************************/
@@ -30,10 +34,23 @@ class HttpInteractHandler
 {
 private:
     static std::string path_to_resources;
+    static bool secure_connection;
+    static unsigned long max_request_len;
+    static bool io_uring;
+    static unsigned int keep_alive_timeout;
+    static unsigned int keep_alive_requests;
 
 public:
     static void SetPathToResources(const char* path_to_resources);
+    static void SetSecureConnection(bool secure_connection);
+    static void SetMaxRequestSize(unsigned long max_request_len);
+    static void SetIoUring(bool io_uring);
+    static void SetKeepAlive(unsigned int timeout_secs, unsigned int max_requests);
     static int InteractFn(int client_socket);
+    static int RunEventLoop(int server_port, int max_connections);
+    static int RunReactors(int server_port, int max_connections, int workers, const char* core_list);
+    static long BuildResourceManifest(unsigned long preload_bytes);
+    static int WatchResources(void);
 };
 
 /*************************************/
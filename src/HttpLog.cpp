@@ -0,0 +1,188 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpLog.hpp"
+#include "SeverityLog_api.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <chrono>
+
+/*************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+thread_local bool HttpLog::ThreadRing::destroyed = false;
+
+HttpLog::ThreadRing::ThreadRing(void):
+    ring(HttpLog::GetInstance().AcquireRing())
+{}
+
+HttpLog::ThreadRing::~ThreadRing(void)
+{
+    HttpLog::GetInstance().ReleaseRing(this->ring);
+
+    this->ring      = nullptr;
+    destroyed       = true;
+}
+
+HttpLog::HttpLog(void):
+    running(true)
+{
+    this->drain_thread = std::thread(&HttpLog::DrainLoop, this);
+}
+
+HttpLog::~HttpLog(void)
+{
+    // Whatever is still pending is written before leaving.
+    this->running.store(false, std::memory_order_relaxed);
+
+    if(this->drain_thread.joinable())
+        this->drain_thread.join();
+
+    this->Drain();
+}
+
+HttpLog& HttpLog::GetInstance(void)
+{
+    static HttpLog instance;
+
+    return instance;
+}
+
+HttpLog::HTTP_LOG_RING* HttpLog::GetThreadRing(void)
+{
+    // A plain bool has no destructor, so it can still be read after thread_ring is gone.
+    if(ThreadRing::destroyed)
+        return nullptr;
+
+    thread_local ThreadRing thread_ring;
+
+    return thread_ring.ring;
+}
+
+HttpLog::HTTP_LOG_RING* HttpLog::AcquireRing(void)
+{
+    std::lock_guard<std::mutex> lock(this->rings_mutex);
+
+    HTTP_LOG_RING* ring;
+
+    if(this->free_rings.empty())
+        ring = new HTTP_LOG_RING;
+    else
+    {
+        ring = this->free_rings.back();
+        this->free_rings.pop_back();
+    }
+
+    ring->head.store(0, std::memory_order_relaxed);
+    ring->tail.store(0, std::memory_order_relaxed);
+    ring->dropped.store(0, std::memory_order_relaxed);
+    ring->retired.store(false, std::memory_order_relaxed);
+
+    this->active_rings.push_back(ring);
+
+    return ring;
+}
+
+void HttpLog::ReleaseRing(HTTP_LOG_RING* ring)
+{
+    // The drain thread recycles it once its last messages are out.
+    ring->retired.store(true, std::memory_order_release);
+}
+
+void HttpLog::Write(int level, const char* format, ...)
+{
+    HTTP_LOG_RING* thread_ring = GetThreadRing();
+
+    if(thread_ring == nullptr)
+        return;
+
+    HTTP_LOG_RING& ring = *thread_ring;
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+
+    if(head - ring.tail.load(std::memory_order_acquire) >= HTTP_LOG_RING_SLOTS)
+    {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    HTTP_LOG_MESSAGE& message = ring.messages[head & (HTTP_LOG_RING_SLOTS - 1)];
+    message.level = level;
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message.text, sizeof(message.text), format, args);
+    va_end(args);
+
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void HttpLog::Drain(void)
+{
+    std::vector<HTTP_LOG_RING*> rings;
+    {
+        std::lock_guard<std::mutex> lock(this->rings_mutex);
+        rings = this->active_rings;
+    }
+
+    // Rings are never released while they are in active_rings, so no lock is needed from here on.
+    for(HTTP_LOG_RING* ring : rings)
+    {
+        // Read before the messages: anything written after this check is left for the next pass.
+        bool retired = ring->retired.load(std::memory_order_acquire);
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+
+        for(; tail != head; tail++)
+        {
+            const HTTP_LOG_MESSAGE& message = ring->messages[tail & (HTTP_LOG_RING_SLOTS - 1)];
+
+            switch(message.level)
+            {
+                case HTTP_LOG_LEVEL_ERR:
+                    SVRTY_LOG_ERR("%s", message.text);
+                break;
+
+                case HTTP_LOG_LEVEL_WNG:
+                    SVRTY_LOG_WNG("%s", message.text);
+                break;
+
+                case HTTP_LOG_LEVEL_INF:
+                    SVRTY_LOG_INF("%s", message.text);
+                break;
+
+                default:
+                    SVRTY_LOG_DBG("%s", message.text);
+                break;
+            }
+        }
+
+        ring->tail.store(tail, std::memory_order_release);
+
+        uint64_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+        if(dropped > 0)
+            SVRTY_LOG_WNG(HTTP_LOG_MSG_DROPPED, (unsigned long)dropped);
+
+        if(retired)
+        {
+            std::lock_guard<std::mutex> lock(this->rings_mutex);
+
+            this->active_rings.erase(std::find(this->active_rings.begin(), this->active_rings.end(), ring));
+            this->free_rings.push_back(ring);
+        }
+    }
+}
+
+void HttpLog::DrainLoop(void)
+{
+    while(this->running.load(std::memory_order_relaxed))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(HTTP_LOG_DRAIN_INTERVAL_MS));
+        this->Drain();
+    }
+}
+
+/******************************************/
@@ -0,0 +1,130 @@
+#ifndef CPP_HTTP_LOG_HPP
+#define CPP_HTTP_LOG_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_LOG_LEVEL_NONE             0
+#define HTTP_LOG_LEVEL_ERR              1
+#define HTTP_LOG_LEVEL_WNG              2
+#define HTTP_LOG_LEVEL_INF              3
+#define HTTP_LOG_LEVEL_DBG              4
+
+// Statements above this level are compiled out, arguments included (the Makefile sets it from LOG_LEVEL).
+#ifndef HTTP_LOG_LEVEL
+#define HTTP_LOG_LEVEL                  HTTP_LOG_LEVEL_INF
+#endif
+
+#define HTTP_LOG_RING_SLOTS             32          // Messages a thread may have pending (power of two, 16 KiB per thread). Any further one is dropped.
+#define HTTP_LOG_LEN_MESSAGE            512         // Longer messages are truncated.
+#define HTTP_LOG_MAX_PAYLOAD_DUMP       256         // Request/response bytes shown by payload dumps.
+#define HTTP_LOG_PAYLOAD_SAMPLE_RATE    16          // One payload dump out of every HTTP_LOG_PAYLOAD_SAMPLE_RATE is kept.
+#define HTTP_LOG_DRAIN_INTERVAL_MS      10          // How often pending messages are handed to SeverityLog.
+
+#define HTTP_LOG_MSG_DROPPED            "%lu log messages were dropped (log ring full)."
+
+#define HTTP_LOG(level, ...)    do { if((level) <= HTTP_LOG_LEVEL) HttpLog::Write(level, __VA_ARGS__); } while(0)
+
+#define HTTP_LOG_ERR(...)       HTTP_LOG(HTTP_LOG_LEVEL_ERR, __VA_ARGS__)
+#define HTTP_LOG_WNG(...)       HTTP_LOG(HTTP_LOG_LEVEL_WNG, __VA_ARGS__)
+#define HTTP_LOG_INF(...)       HTTP_LOG(HTTP_LOG_LEVEL_INF, __VA_ARGS__)
+#define HTTP_LOG_DBG(...)       HTTP_LOG(HTTP_LOG_LEVEL_DBG, __VA_ARGS__)
+
+// Debug dump of request or response bytes, through "%.*s". Only a sample of them is kept: every
+// call site counts its own dumps (per thread), so that sites called alternately are all sampled.
+#define HTTP_LOG_DBG_PAYLOAD(format, length, data)                                                                      \
+    do                                                                                                                  \
+    {                                                                                                                   \
+        static thread_local unsigned long payload_dumps = 0;                                                            \
+                                                                                                                        \
+        if(HTTP_LOG_LEVEL_DBG <= HTTP_LOG_LEVEL && payload_dumps++ % HTTP_LOG_PAYLOAD_SAMPLE_RATE == 0)                 \
+            HttpLog::Write(HTTP_LOG_LEVEL_DBG, format, (int)std::min((size_t)(length), (size_t)HTTP_LOG_MAX_PAYLOAD_DUMP), data);   \
+    } while(0)
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Asynchronous front end of SeverityLog. Every thread formats its messages into a ring of its own
+// (single producer, single consumer: no locking), and a background thread hands them to
+// SeverityLog in batches, so that serving threads never wait for the log to be written. Messages
+// are dropped (and counted) instead when a ring is full. As with HttpStats, the rings of threads
+// that exit are recycled once they have been drained.
+class HttpLog
+{
+private:
+    typedef struct
+    {
+        int  level                      ;
+        char text[HTTP_LOG_LEN_MESSAGE] ;
+    } HTTP_LOG_MESSAGE;
+
+    typedef struct
+    {
+        HTTP_LOG_MESSAGE        messages[HTTP_LOG_RING_SLOTS]   ;
+        std::atomic<uint64_t>   head                            ;   // Next message to be written (owner thread).
+        std::atomic<uint64_t>   tail                            ;   // Next message to be drained (drain thread).
+        std::atomic<uint64_t>   dropped                         ;
+        std::atomic<bool>       retired                         ;   // Its thread is gone.
+    } HTTP_LOG_RING;
+
+    // Hands a ring to every thread that logs something, and gives it back once it exits. Once the
+    // ring has been given back (e.g. a destructor logging later on during thread exit), the ring
+    // may belong to another thread already, so destroyed tells Write to drop the message instead.
+    class ThreadRing
+    {
+    public:
+        HTTP_LOG_RING* ring;
+
+        static thread_local bool destroyed;
+
+        ThreadRing(void);
+        ~ThreadRing(void);
+    };
+
+    std::mutex                  rings_mutex     ;
+    std::vector<HTTP_LOG_RING*> active_rings    ;
+    std::vector<HTTP_LOG_RING*> free_rings      ;
+
+    std::atomic<bool>   running         ;
+    std::thread         drain_thread    ;
+
+    HttpLog(void);
+    ~HttpLog(void);
+
+    static HTTP_LOG_RING* GetThreadRing(void);
+
+    HTTP_LOG_RING*  AcquireRing(void);
+    void            ReleaseRing(HTTP_LOG_RING* ring);
+    void            Drain(void);
+    void            DrainLoop(void);
+
+public:
+    HttpLog(const HttpLog& obj) = delete;
+
+    static HttpLog& GetInstance(void);
+
+    // Queue a message (any thread, lock-free). Use the HTTP_LOG_* macros instead.
+    static void Write(int level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+/*************************************/
+
+#endif
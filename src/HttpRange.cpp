@@ -0,0 +1,173 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpRange.hpp"
+#include <algorithm>
+#include <limits>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_RANGE_UNIT                 "bytes="
+
+/*************************************/
+
+/******************************************/
+/******** Private helper functions ********/
+/******************************************/
+
+static inline bool IsBlank(char c)
+{
+    return (c == ' ' || c == '\t');
+}
+
+static std::string_view Trim(std::string_view text)
+{
+    while(!text.empty() && IsBlank(text.front()))
+        text.remove_prefix(1);
+
+    while(!text.empty() && IsBlank(text.back()))
+        text.remove_suffix(1);
+
+    return text;
+}
+
+// Parse a non-empty string of digits. Returns false on anything else or on overflow.
+static bool ParsePosition(std::string_view text, off_t& position)
+{
+    if(text.empty())
+        return false;
+
+    position = 0;
+
+    for(char c : text)
+    {
+        if(c < '0' || c > '9')
+            return false;
+
+        if(position > (std::numeric_limits<off_t>::max() - (c - '0')) / 10)
+            return false;
+
+        position = position * 10 + (c - '0');
+    }
+
+    return true;
+}
+
+static bool StartsWithIgnoreCase(std::string_view text, std::string_view prefix)
+{
+    if(text.size() < prefix.size())
+        return false;
+
+    for(std::size_t i = 0; i < prefix.size(); i++)
+        if((text[i] | 0x20) != (prefix[i] | 0x20))
+            return false;
+
+    return true;
+}
+
+/******************************************/
+
+/**************************************/
+/******** Function definitions ********/
+/**************************************/
+
+int HttpParseRange(std::string_view value, off_t resource_size, std::vector<HTTP_BYTE_RANGE>& ranges)
+{
+    ranges.clear();
+
+    value = Trim(value);
+
+    if(!StartsWithIgnoreCase(value, HTTP_RANGE_UNIT))
+        return HTTP_RANGE_IGNORE;
+
+    value.remove_prefix(sizeof(HTTP_RANGE_UNIT) - 1);
+
+    int range_specs = 0;
+
+    while(!value.empty())
+    {
+        std::size_t comma = value.find(',');
+        std::string_view range_spec = Trim(value.substr(0, comma));
+        value = (comma == std::string_view::npos) ? std::string_view() : value.substr(comma + 1);
+
+        // Empty list elements are allowed (RFC 9110 section 5.6.1).
+        if(range_spec.empty())
+            continue;
+
+        if(++range_specs > HTTP_RANGE_MAX_RANGES)
+            return HTTP_RANGE_IGNORE;
+
+        std::size_t dash = range_spec.find('-');
+        if(dash == std::string_view::npos)
+            return HTTP_RANGE_IGNORE;
+
+        std::string_view first_text = Trim(range_spec.substr(0, dash));
+        std::string_view last_text  = Trim(range_spec.substr(dash + 1));
+        HTTP_BYTE_RANGE range;
+
+        // suffix-range: the last N bytes.
+        if(first_text.empty())
+        {
+            off_t suffix_length;
+            if(!ParsePosition(last_text, suffix_length))
+                return HTTP_RANGE_IGNORE;
+
+            if(suffix_length == 0 || resource_size == 0)
+                continue;
+
+            range.first = (suffix_length < resource_size) ? resource_size - suffix_length : 0;
+            range.last  = resource_size - 1;
+        }
+        else
+        {
+            if(!ParsePosition(first_text, range.first))
+                return HTTP_RANGE_IGNORE;
+
+            if(last_text.empty())
+                range.last = resource_size - 1;
+            else if(!ParsePosition(last_text, range.last) || range.last < range.first)
+                return HTTP_RANGE_IGNORE;
+
+            // Ranges starting past the end are not satisfiable, the rest is clamped.
+            if(range.first >= resource_size)
+                continue;
+
+            range.last = std::min(range.last, resource_size - 1);
+        }
+
+        ranges.push_back(range);
+    }
+
+    if(range_specs == 0)
+        return HTTP_RANGE_IGNORE;
+
+    if(ranges.empty())
+        return HTTP_RANGE_NOT_SATISFIABLE;
+
+    std::sort(ranges.begin(), ranges.end(), [](const HTTP_BYTE_RANGE& a, const HTTP_BYTE_RANGE& b)
+    {
+        return a.first < b.first;
+    });
+
+    // Coalesce overlapping and adjacent ranges (RFC 9110 section 14.2 allows it), so that no byte is sent twice.
+    std::size_t merged = 0;
+
+    for(std::size_t i = 1; i < ranges.size(); i++)
+    {
+        if(ranges[i].first <= ranges[merged].last + 1)
+            ranges[merged].last = std::max(ranges[merged].last, ranges[i].last);
+        else
+            ranges[++merged] = ranges[i];
+    }
+
+    ranges.resize(merged + 1);
+
+    return HTTP_RANGE_SATISFIABLE;
+}
+
+/**************************************/
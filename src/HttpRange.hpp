@@ -0,0 +1,49 @@
+#ifndef CPP_HTTP_RANGE_HPP
+#define CPP_HTTP_RANGE_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <string_view>
+#include <vector>
+#include <sys/types.h>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_RANGE_MAX_RANGES           16          // Range sets with more elements are ignored (whole resource is sent).
+
+#define HTTP_RANGE_IGNORE               0           // Malformed, unknown unit or too many ranges: answer 200 as if there was no Range.
+#define HTTP_RANGE_SATISFIABLE          1           // At least one range overlaps the resource: answer 206.
+#define HTTP_RANGE_NOT_SATISFIABLE      2           // Valid, but no range overlaps the resource: answer 416.
+
+/************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+typedef struct
+{
+    off_t first ;   // First byte of the range.
+    off_t last  ;   // Last byte of the range (included).
+} HTTP_BYTE_RANGE;
+
+/************************************/
+
+/**************************************/
+/******** Function declarations *******/
+/**************************************/
+
+// Parse a Range header value (RFC 9110 section 14.2) against a resource of resource_size bytes.
+// On HTTP_RANGE_SATISFIABLE, ranges holds the satisfiable ranges clamped to the resource, sorted
+// and with overlapping or adjacent ones merged (so a resource is never sent more than once).
+int HttpParseRange(std::string_view value, off_t resource_size, std::vector<HTTP_BYTE_RANGE>& ranges);
+
+/**************************************/
+
+#endif
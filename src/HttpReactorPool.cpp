@@ -0,0 +1,129 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpReactorPool.hpp"
+#include "HttpFileCache.hpp"
+#include "HttpUringLoop.hpp"
+#include "HttpLog.hpp"
+#include <sched.h>
+#include <thread>
+#include <sstream>
+#include <cstdlib>
+
+/*************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+HttpReactorPool::HttpReactorPool(const std::string path_to_resources, const HTTP_EVENT_LOOP_CONFIG& config, int workers, const std::vector<int>& cores):
+    path_to_resources(path_to_resources),
+    config(config)                      ,
+    cores(cores)                        ,
+    workers(workers)
+{
+    if(this->workers <= 0)
+        this->workers = !this->cores.empty() ? (int)this->cores.size() : (int)std::thread::hardware_concurrency();
+
+    if(this->workers <= 0)
+        this->workers = 1;
+}
+
+int HttpReactorPool::Run(void)
+{
+    if(this->workers > HTTP_REACTOR_POOL_MAX_WORKERS)
+    {
+        HTTP_LOG_ERR(HTTP_REACTOR_POOL_MSG_INVALID_WORKERS, this->workers);
+        return HTTP_REACTOR_POOL_ERR_INVALID_WORKERS;
+    }
+
+    HTTP_LOG_INF(HTTP_REACTOR_POOL_MSG_STARTING, this->workers, this->config.server_port);
+
+    // Split both the connection limit and the shared cache budget among the reactors.
+    HttpFileCache& shared_file_cache = HttpFileCache::GetInstance();
+
+    HTTP_EVENT_LOOP_CONFIG reactor_config   = this->config;
+    reactor_config.reuse_port               = true;
+    reactor_config.max_connections          = (this->config.max_connections + this->workers - 1) / this->workers;
+    reactor_config.file_cache_bytes         = shared_file_cache.GetMaxBytes() / this->workers;
+    reactor_config.file_cache_entry_bytes   = shared_file_cache.GetMaxEntryBytes();
+
+    for(int i = 0; i < this->workers; i++)
+    {
+        reactor_config.cpu = this->cores.empty() ? HTTP_EVENT_LOOP_NO_CPU : this->cores[i % this->cores.size()];
+
+        if(reactor_config.cpu != HTTP_EVENT_LOOP_NO_CPU)
+            HTTP_LOG_INF(HTTP_REACTOR_POOL_MSG_REACTOR_CPU, i, reactor_config.cpu);
+
+        if(reactor_config.io_uring)
+            this->event_loops.push_back(std::make_unique<HttpUringLoop>(this->path_to_resources, reactor_config));
+        else
+            this->event_loops.push_back(std::make_unique<HttpEventLoop>(this->path_to_resources, reactor_config));
+    }
+
+    std::vector<std::thread> threads;
+    std::vector<int> results(this->workers, 0);
+
+    for(int i = 0; i < this->workers; i++)
+        threads.emplace_back([this, i, &results]()
+        {
+            results[i] = this->event_loops[i]->Run();
+
+            // A reactor that could not start (or died) takes the rest down with it.
+            if(results[i] < 0)
+                this->Stop();
+        });
+
+    for(std::thread& thread : threads)
+        thread.join();
+
+    this->event_loops.clear();
+
+    for(int result : results)
+        if(result < 0)
+            return result;
+
+    return 0;
+}
+
+void HttpReactorPool::Stop(void)
+{
+    for(std::unique_ptr<HttpEventLoop>& event_loop : this->event_loops)
+        event_loop->Stop();
+}
+
+int HttpReactorPool::ParseCoreList(const std::string& core_list, std::vector<int>& cores)
+{
+    std::istringstream iss(core_list);
+    std::string range;
+
+    cores.clear();
+
+    while(std::getline(iss, range, ','))
+    {
+        if(range.empty())
+            continue;
+
+        char* end;
+        long first = strtol(range.c_str(), &end, 10);
+        long last  = first;
+
+        if(*end == '-')
+            last = strtol(end + 1, &end, 10);
+
+        if(end == range.c_str() || *end != '\0' || first < 0 || last < first || last >= CPU_SETSIZE)
+        {
+            HTTP_LOG_ERR(HTTP_REACTOR_POOL_MSG_INVALID_CORES, core_list.c_str());
+            cores.clear();
+            return HTTP_REACTOR_POOL_ERR_INVALID_CORES;
+        }
+
+        for(long core = first; core <= last; core++)
+            cores.push_back((int)core);
+    }
+
+    return 0;
+}
+
+/******************************************/
@@ -0,0 +1,68 @@
+#ifndef CPP_HTTP_REACTOR_POOL_HPP
+#define CPP_HTTP_REACTOR_POOL_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpEventLoop.hpp"
+#include <string>
+#include <memory>
+#include <vector>
+#include <atomic>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_REACTOR_POOL_MAX_WORKERS           1024
+
+#define HTTP_REACTOR_POOL_MSG_STARTING          "Starting %d reactors on port %d."
+#define HTTP_REACTOR_POOL_MSG_REACTOR_CPU       "Reactor %d pinned to CPU %d."
+#define HTTP_REACTOR_POOL_MSG_INVALID_CORES     "Invalid core list: \"%s\"."
+#define HTTP_REACTOR_POOL_MSG_INVALID_WORKERS   "Invalid number of reactors: %d."
+
+#define HTTP_REACTOR_POOL_ERR_INVALID_CORES     -20
+#define HTTP_REACTOR_POOL_ERR_INVALID_WORKERS   -21
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Multi-reactor mode: N event loops, each one running in its own thread with its own
+// SO_REUSEPORT listening socket (so that the kernel spreads incoming connections among them
+// instead of every thread contending for a single accept queue), optionally pinned to a core,
+// and with its own pool of HttpServer instances and file cache shard. The shared file cache
+// limits are split evenly among the shards.
+class HttpReactorPool
+{
+private:
+    const std::string       path_to_resources   ;
+    HTTP_EVENT_LOOP_CONFIG  config              ;
+    std::vector<int>        cores               ;
+    int                     workers             ;
+
+    std::vector<std::unique_ptr<HttpEventLoop>> event_loops;
+
+public:
+    // workers <= 0: one reactor per core found in cores (or per online CPU if cores is empty).
+    // cores: reactor i is pinned to cores[i % cores.size()]. An empty list means no pinning.
+    HttpReactorPool(const std::string path_to_resources, const HTTP_EVENT_LOOP_CONFIG& config, int workers, const std::vector<int>& cores);
+
+    HttpReactorPool(const HttpReactorPool& obj) = delete;
+
+    // Serve connections until Stop is called or any reactor fails (then every other one is stopped too).
+    int Run(void);
+    void Stop(void);
+
+    // Parse a core list such as "0,2,4-7". An empty string yields an empty list.
+    static int ParseCoreList(const std::string& core_list, std::vector<int>& cores);
+};
+
+/*************************************/
+
+#endif
@@ -0,0 +1,307 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpRequestParser.hpp"
+#include "HttpStaticTables.hpp"
+
+#include <cstring>
+#include <string_view>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_PARSER_PROTOCOL_PREFIX     "HTTP/"
+
+/*************************************/
+
+/******************************************/
+/******** Private helper functions ********/
+/******************************************/
+
+static inline bool IsBlank(char c)
+{
+    return (c == ' ' || c == '\t');
+}
+
+static inline char ToLowerAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+static bool EqualsIgnoreCase(std::string_view a, std::string_view b)
+{
+    if(a.size() != b.size())
+        return false;
+
+    for(std::size_t i = 0; i < a.size(); i++)
+        if(ToLowerAscii(a[i]) != ToLowerAscii(b[i]))
+            return false;
+
+    return true;
+}
+
+/******************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+HttpRequestParser::HttpRequestParser(void)
+{
+    this->Reset();
+}
+
+void HttpRequestParser::Reset(void)
+{
+    this->parse_fsm         = HTTP_PARSE_FSM_REQUEST_LINE;
+    this->buffer            = nullptr;
+    this->offset            = 0;
+    this->header_block_len  = 0;
+    this->method            = {0, 0};
+    this->target            = {0, 0};
+    this->protocol          = {0, 0};
+    this->header_count      = 0;
+
+    memset(this->known_headers, 0, sizeof(this->known_headers));
+}
+
+std::string_view HttpRequestParser::View(const HTTP_PARSER_SPAN& span) const
+{
+    if(this->buffer == nullptr)
+        return std::string_view();
+
+    return std::string_view(this->buffer + span.offset, span.length);
+}
+
+int HttpRequestParser::Parse(std::string_view buffer)
+{
+    this->buffer = buffer.data();
+
+    while(this->parse_fsm != HTTP_PARSE_FSM_END)
+    {
+        std::size_t line_feed = buffer.find('\n', this->offset);
+
+        // No complete line left: check limits against what has been received so far, then wait for more.
+        if(line_feed == std::string_view::npos)
+        {
+            if(this->parse_fsm == HTTP_PARSE_FSM_REQUEST_LINE && buffer.size() - this->offset > HTTP_PARSER_MAX_REQUEST_LINE_LEN)
+                return HTTP_PARSE_ERR_REQUEST_LINE_TOO_LONG;
+
+            if(buffer.size() > HTTP_PARSER_MAX_HEADER_BLOCK_LEN)
+                return HTTP_PARSE_ERR_HEADERS_TOO_LARGE;
+
+            return HTTP_PARSE_INCOMPLETE;
+        }
+
+        std::size_t line_offset = this->offset;
+
+        // Only CRLF terminates a line: the server finds the end of the header block by looking
+        // for CRLFCRLF, so a bare LF would let both disagree on where the request ends.
+        if(line_feed == line_offset || buffer[line_feed - 1] != '\r')
+            return HTTP_PARSE_ERR_MALFORMED;
+
+        std::string_view line = buffer.substr(line_offset, line_feed - 1 - line_offset);
+        this->offset = line_feed + 1;
+
+        if(this->offset > HTTP_PARSER_MAX_HEADER_BLOCK_LEN)
+            return HTTP_PARSE_ERR_HEADERS_TOO_LARGE;
+
+        switch(this->parse_fsm)
+        {
+            case HTTP_PARSE_FSM_REQUEST_LINE:
+            {
+                // Empty lines received before the request line are ignored (RFC 9112, section 2.2).
+                if(line.empty())
+                    break;
+
+                if(line.size() > HTTP_PARSER_MAX_REQUEST_LINE_LEN)
+                    return HTTP_PARSE_ERR_REQUEST_LINE_TOO_LONG;
+
+                int parse_request_line = this->ParseRequestLine(line, line_offset);
+                if(parse_request_line < 0)
+                    return parse_request_line;
+
+                this->parse_fsm = HTTP_PARSE_FSM_HEADER_LINE;
+            }
+            break;
+
+            case HTTP_PARSE_FSM_HEADER_LINE:
+            {
+                // An empty line ends the header block.
+                if(line.empty())
+                {
+                    this->header_block_len  = this->offset;
+                    this->parse_fsm         = HTTP_PARSE_FSM_END;
+                    break;
+                }
+
+                int parse_header_line = this->ParseHeaderLine(line, line_offset);
+                if(parse_header_line < 0)
+                    return parse_header_line;
+            }
+            break;
+
+            default:
+            break;
+        }
+    }
+
+    return HTTP_PARSE_DONE;
+}
+
+int HttpRequestParser::ParseRequestLine(std::string_view line, std::size_t line_offset)
+{
+    // request-line = method SP request-target SP HTTP-version
+    std::size_t method_end = line.find(' ');
+    if(method_end == std::string_view::npos || method_end == 0)
+        return HTTP_PARSE_ERR_MALFORMED;
+
+    std::size_t target_begin = line.find_first_not_of(' ', method_end);
+    if(target_begin == std::string_view::npos)
+        return HTTP_PARSE_ERR_MALFORMED;
+
+    std::size_t target_end = line.find(' ', target_begin);
+    if(target_end == std::string_view::npos)
+        return HTTP_PARSE_ERR_MALFORMED;
+
+    std::size_t protocol_begin = line.find_first_not_of(' ', target_end);
+    std::size_t protocol_end   = line.find_last_not_of(' ') + 1;
+    if(protocol_begin == std::string_view::npos || protocol_end <= protocol_begin)
+        return HTTP_PARSE_ERR_MALFORMED;
+
+    std::string_view protocol = line.substr(protocol_begin, protocol_end - protocol_begin);
+    if(protocol.substr(0, sizeof(HTTP_PARSER_PROTOCOL_PREFIX) - 1) != HTTP_PARSER_PROTOCOL_PREFIX)
+        return HTTP_PARSE_ERR_MALFORMED;
+
+    this->method    = {(std::uint32_t)line_offset                     , (std::uint32_t)method_end                     };
+    this->target    = {(std::uint32_t)(line_offset + target_begin)    , (std::uint32_t)(target_end - target_begin)    };
+    this->protocol  = {(std::uint32_t)(line_offset + protocol_begin)  , (std::uint32_t)protocol.size()                };
+
+    return 0;
+}
+
+int HttpRequestParser::ParseHeaderLine(std::string_view line, std::size_t line_offset)
+{
+    // Obsolete line folding is rejected (RFC 9112, section 5.2).
+    if(IsBlank(line[0]))
+        return HTTP_PARSE_ERR_MALFORMED;
+
+    // No whitespace is allowed between field name and colon (RFC 9112, section 5.1).
+    std::size_t colon = line.find(':');
+    if(colon == std::string_view::npos || colon == 0 || IsBlank(line[colon - 1]))
+        return HTTP_PARSE_ERR_MALFORMED;
+
+    if(this->header_count >= HTTP_PARSER_MAX_HEADERS)
+        return HTTP_PARSE_ERR_HEADERS_TOO_LARGE;
+
+    std::size_t value_begin = colon + 1;
+    std::size_t value_end   = line.size();
+
+    while(value_begin < value_end && IsBlank(line[value_begin]))
+        value_begin++;
+
+    while(value_end > value_begin && IsBlank(line[value_end - 1]))
+        value_end--;
+
+    HTTP_PARSER_HEADER& header = this->headers[this->header_count];
+
+    header.name     = {(std::uint32_t)line_offset                 , (std::uint32_t)colon                      };
+    header.value    = {(std::uint32_t)(line_offset + value_begin) , (std::uint32_t)(value_end - value_begin)  };
+    header.id       = LookupHeaderName(line.substr(0, colon));
+
+    this->header_count++;
+
+    // Only the first occurrence of every known header is indexed.
+    if(header.id != HTTP_HDR_UNKNOWN && this->known_headers[header.id] == 0)
+        this->known_headers[header.id] = (std::uint8_t)this->header_count;
+
+    return 0;
+}
+
+std::size_t HttpRequestParser::GetHeaderBlockLength(void) const
+{
+    return this->header_block_len;
+}
+
+std::string_view HttpRequestParser::GetMethod(void) const
+{
+    return this->View(this->method);
+}
+
+std::string_view HttpRequestParser::GetTarget(void) const
+{
+    return this->View(this->target);
+}
+
+std::string_view HttpRequestParser::GetProtocol(void) const
+{
+    return this->View(this->protocol);
+}
+
+std::string_view HttpRequestParser::GetHeader(HTTP_HDR id) const
+{
+    if(id <= HTTP_HDR_UNKNOWN || id >= HTTP_HDR_COUNT || this->known_headers[id] == 0)
+        return std::string_view();
+
+    return this->View(this->headers[this->known_headers[id] - 1].value);
+}
+
+std::string_view HttpRequestParser::GetHeader(std::string_view name) const
+{
+    for(std::size_t i = 0; i < this->header_count; i++)
+        if(EqualsIgnoreCase(this->View(this->headers[i].name), name))
+            return this->View(this->headers[i].value);
+
+    return std::string_view();
+}
+
+bool HttpRequestParser::HasHeader(HTTP_HDR id) const
+{
+    return (id > HTTP_HDR_UNKNOWN && id < HTTP_HDR_COUNT && this->known_headers[id] != 0);
+}
+
+bool HttpRequestParser::HasDifferingHeaders(HTTP_HDR id) const
+{
+    if(!this->HasHeader(id))
+        return false;
+
+    std::string_view first_value = this->GetHeader(id);
+
+    for(std::size_t i = this->known_headers[id]; i < this->header_count; i++)
+        if(this->headers[i].id == id && this->View(this->headers[i].value) != first_value)
+            return true;
+
+    return false;
+}
+
+std::size_t HttpRequestParser::GetHeaderCount(void) const
+{
+    return this->header_count;
+}
+
+std::string_view HttpRequestParser::GetHeaderName(std::size_t index) const
+{
+    if(index >= this->header_count)
+        return std::string_view();
+
+    return this->View(this->headers[index].name);
+}
+
+std::string_view HttpRequestParser::GetHeaderValue(std::size_t index) const
+{
+    if(index >= this->header_count)
+        return std::string_view();
+
+    return this->View(this->headers[index].value);
+}
+
+HTTP_HDR HttpRequestParser::LookupHeaderName(std::string_view name)
+{
+    return header_name_to_id.Find(name, HTTP_HDR_UNKNOWN);
+}
+
+/******************************************/
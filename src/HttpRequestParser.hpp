@@ -0,0 +1,153 @@
+#ifndef CPP_HTTP_REQUEST_PARSER_HPP
+#define CPP_HTTP_REQUEST_PARSER_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_PARSER_MAX_REQUEST_LINE_LEN    8192        // Longest accepted request line (method + target + protocol).
+#define HTTP_PARSER_MAX_HEADER_BLOCK_LEN    65536       // Longest accepted header block, request line included.
+#define HTTP_PARSER_MAX_HEADERS             100         // Maximum number of header fields per request.
+
+#define HTTP_PARSE_INCOMPLETE               0           // More bytes are needed.
+#define HTTP_PARSE_DONE                     1           // Whole header block has been parsed.
+#define HTTP_PARSE_ERR_MALFORMED            -1          // Request is not valid HTTP/1.x.
+#define HTTP_PARSE_ERR_REQUEST_LINE_TOO_LONG -2         // Request line exceeds HTTP_PARSER_MAX_REQUEST_LINE_LEN.
+#define HTTP_PARSE_ERR_HEADERS_TOO_LARGE    -3          // Header block or header count exceeds its limit.
+
+/************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+// Header fields the server knows about. Any other field is still stored, as HTTP_HDR_UNKNOWN.
+typedef enum
+{
+    HTTP_HDR_UNKNOWN                    = 0 ,
+    HTTP_HDR_HOST                           ,
+    HTTP_HDR_CONNECTION                     ,
+    HTTP_HDR_KEEP_ALIVE                     ,
+    HTTP_HDR_CACHE_CONTROL                  ,
+    HTTP_HDR_PRAGMA                         ,
+    HTTP_HDR_UPGRADE_INSECURE_REQUESTS      ,
+    HTTP_HDR_USER_AGENT                     ,
+    HTTP_HDR_ACCEPT                         ,
+    HTTP_HDR_ACCEPT_ENCODING                ,
+    HTTP_HDR_ACCEPT_LANGUAGE                ,
+    HTTP_HDR_CONTENT_LENGTH                 ,
+    HTTP_HDR_CONTENT_TYPE                   ,
+    HTTP_HDR_TRANSFER_ENCODING              ,
+    HTTP_HDR_EXPECT                         ,
+    HTTP_HDR_REFERER                        ,
+    HTTP_HDR_ORIGIN                         ,
+    HTTP_HDR_COOKIE                         ,
+    HTTP_HDR_AUTHORIZATION                  ,
+    HTTP_HDR_RANGE                          ,
+    HTTP_HDR_IF_RANGE                       ,
+    HTTP_HDR_IF_NONE_MATCH                  ,
+    HTTP_HDR_IF_MODIFIED_SINCE              ,
+    HTTP_HDR_PURPOSE                        ,
+    HTTP_HDR_SEC_PURPOSE                    ,
+    HTTP_HDR_SEC_CH_UA                      ,
+    HTTP_HDR_SEC_CH_UA_MOBILE               ,
+    HTTP_HDR_SEC_CH_UA_PLATFORM             ,
+    HTTP_HDR_SEC_FETCH_SITE                 ,
+    HTTP_HDR_SEC_FETCH_MODE                 ,
+    HTTP_HDR_SEC_FETCH_USER                 ,
+    HTTP_HDR_SEC_FETCH_DEST                 ,
+    HTTP_HDR_COUNT                          ,
+} HTTP_HDR;
+
+typedef enum
+{
+    HTTP_PARSE_FSM_REQUEST_LINE     = 0 ,
+    HTTP_PARSE_FSM_HEADER_LINE          ,
+    HTTP_PARSE_FSM_END                  ,
+} HTTP_PARSE_FSM;
+
+// Position of a token within the parsed buffer. Offsets are kept instead of pointers, so the
+// buffer may be reallocated between two Parse calls while the request is still incomplete.
+typedef struct
+{
+    std::uint32_t offset;
+    std::uint32_t length;
+} HTTP_PARSER_SPAN;
+
+typedef struct
+{
+    HTTP_PARSER_SPAN    name    ;
+    HTTP_PARSER_SPAN    value   ;
+    HTTP_HDR            id      ;
+} HTTP_PARSER_HEADER;
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Incremental HTTP/1.x request head parser. It never copies nor allocates: every field it yields
+// is a std::string_view into the buffer most recently passed to Parse, so that buffer must not
+// be modified while the views are in use. Parse may be called again each time more bytes are
+// appended to the buffer; lines that were already parsed are not scanned again.
+class HttpRequestParser
+{
+private:
+    HTTP_PARSE_FSM      parse_fsm           ;
+    const char*         buffer              ;
+    std::size_t         offset              ;
+    std::size_t         header_block_len    ;
+
+    HTTP_PARSER_SPAN    method              ;
+    HTTP_PARSER_SPAN    target              ;
+    HTTP_PARSER_SPAN    protocol            ;
+
+    HTTP_PARSER_HEADER  headers[HTTP_PARSER_MAX_HEADERS];
+    std::size_t         header_count        ;
+
+    // Index + 1 of the first occurrence of every known header within headers (0: not found).
+    std::uint8_t        known_headers[HTTP_HDR_COUNT];
+
+    std::string_view View(const HTTP_PARSER_SPAN& span) const;
+
+    // Used by Parse
+    int ParseRequestLine(std::string_view line, std::size_t line_offset);
+    int ParseHeaderLine(std::string_view line, std::size_t line_offset);
+
+public:
+    HttpRequestParser(void);
+
+    void Reset(void);
+    int Parse(std::string_view buffer);
+
+    // Only meaningful once Parse has returned HTTP_PARSE_DONE.
+    std::size_t         GetHeaderBlockLength(void)  const;
+    std::string_view    GetMethod(void)             const;
+    std::string_view    GetTarget(void)             const;
+    std::string_view    GetProtocol(void)           const;
+    std::string_view    GetHeader(HTTP_HDR id)      const;
+    std::string_view    GetHeader(std::string_view name) const;
+    bool                HasHeader(HTTP_HDR id)      const;
+    // Whether a known header is found more than once, with values other than those of the first one.
+    bool                HasDifferingHeaders(HTTP_HDR id) const;
+    std::size_t         GetHeaderCount(void)        const;
+    std::string_view    GetHeaderName(std::size_t index)  const;
+    std::string_view    GetHeaderValue(std::size_t index) const;
+
+    static HTTP_HDR     LookupHeaderName(std::string_view name);
+};
+
+/*************************************/
+
+#endif
@@ -0,0 +1,249 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "HttpResourceManifest.hpp"
+#include "HttpStaticTables.hpp"
+#include "HttpFileCache.hpp"
+#include "HttpResourceResolver.hpp"
+#include "HttpLog.hpp"
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <filesystem>
+#include <system_error>
+
+/*************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+HttpResourceManifest::HttpResourceManifest(void):
+    generation(0)       ,
+    preload_bytes(0)    ,
+    max_entry_bytes(0)
+{}
+
+HttpResourceManifest& HttpResourceManifest::GetInstance(void)
+{
+    static HttpResourceManifest instance;
+
+    return instance;
+}
+
+int HttpResourceManifest::ReadFile(int fd, const struct stat& file_stat, std::shared_ptr<const std::string>& body)
+{
+    std::string content(file_stat.st_size, '\0');
+    size_t bytes_read = 0;
+
+    while(bytes_read < content.size())
+    {
+        ssize_t read_now = read(fd, content.data() + bytes_read, content.size() - bytes_read);
+
+        if(read_now < 0 && errno == EINTR)
+            continue;
+
+        // Failed, or truncated in the meantime: better not preloaded than partially preloaded.
+        if(read_now <= 0)
+            return -1;
+
+        bytes_read += read_now;
+    }
+
+    body = std::make_shared<const std::string>(std::move(content));
+
+    return 0;
+}
+
+void HttpResourceManifest::AddFile(entry_table& new_table, const root_ptr& root, const std::string& key, unsigned long& preloaded_bytes)
+{
+    HTTP_RESOURCE_MANIFEST_ENTRY entry = {};
+
+    if(key.compare(0, this->path_to_resources.size(), this->path_to_resources) != 0)
+        return;
+
+    size_t relative_begin = key.find_first_not_of('/', this->path_to_resources.size());
+    if(relative_begin == std::string::npos)
+        return;
+
+    // Opened the way servers open files not listed here: only regular files that resolve below
+    // the resources directory (symbolic links included) are listed.
+    int fd = HttpResourceResolver::GetInstance().Open(root, "/" + key.substr(relative_begin), key, entry.file_stat);
+    if(fd < 0)
+        return;
+
+    if((unsigned long)entry.file_stat.st_size <= this->max_entry_bytes && preloaded_bytes + entry.file_stat.st_size <= this->preload_bytes)
+    {
+        if(ReadFile(fd, entry.file_stat, entry.body) == 0)
+            preloaded_bytes += entry.body->size();
+    }
+
+    close(fd);
+
+    size_t dot_position = key.find_last_of('.');
+    if(dot_position != std::string::npos && dot_position > key.find_last_of('/'))
+        entry.content_type = extension_to_content_type.Find(std::string_view(key).substr(dot_position + 1), "");
+
+    entry.validators = HttpValidatorCache::GetInstance().Get(key, entry.file_stat);
+
+    new_table[key] = std::move(entry);
+}
+
+void HttpResourceManifest::ScanDirectory(entry_table& new_table, const root_ptr& root, const std::string& directory, unsigned long& preloaded_bytes, std::error_code& error)
+{
+    // Paths yielded by the iterator are directory followed by a separator (unless it already ends
+    // with one) and the relative path, whereas servers append the request target ("/relative/path")
+    // to the resources directory as it is. Keys are built the way servers do.
+    size_t relative_begin = directory.size() + ((!directory.empty() && directory.back() == '/') ? 0 : 1);
+
+    std::filesystem::recursive_directory_iterator it(directory, error);
+
+    for(; !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+    {
+        const std::string path = it->path().string();
+
+        if(path.size() > relative_begin)
+            this->AddFile(new_table, root, directory + "/" + path.substr(relative_begin), preloaded_bytes);
+    }
+}
+
+void HttpResourceManifest::Publish(std::shared_ptr<entry_table> new_table)
+{
+    std::atomic_store(&this->table, snapshot(std::move(new_table)));
+    this->generation.fetch_add(1, std::memory_order_release);
+}
+
+long int HttpResourceManifest::Build(const std::string& path_to_resources, unsigned long preload_bytes, unsigned long max_entry_bytes)
+{
+    std::lock_guard<std::mutex> lock(this->build_mutex);
+
+    this->path_to_resources = path_to_resources;
+    this->preload_bytes     = preload_bytes;
+    this->max_entry_bytes   = max_entry_bytes;
+
+    std::shared_ptr<entry_table> new_table = std::make_shared<entry_table>();
+    unsigned long preloaded_bytes = 0;
+    std::error_code error;
+    root_ptr root;
+    uint64_t root_generation = 0;
+
+    HttpResourceResolver::GetInstance().Refresh(path_to_resources, root, root_generation);
+
+    this->ScanDirectory(*new_table, root, path_to_resources, preloaded_bytes, error);
+
+    if(error)
+    {
+        HTTP_LOG_ERR(HTTP_RESOURCE_MANIFEST_MSG_SCAN_ERROR, path_to_resources.c_str(), error.message().c_str());
+        return HTTP_RESOURCE_MANIFEST_ERR_SCAN;
+    }
+
+    long int files = (long int)new_table->size();
+
+    this->Publish(std::move(new_table));
+
+    HTTP_LOG_INF(HTTP_RESOURCE_MANIFEST_MSG_BUILT, path_to_resources.c_str(), (unsigned long)files, preloaded_bytes);
+
+    return files;
+}
+
+long int HttpResourceManifest::Rebuild(void)
+{
+    std::string     last_path_to_resources  ;
+    unsigned long   last_preload_bytes      ;
+    unsigned long   last_max_entry_bytes    ;
+
+    {
+        std::lock_guard<std::mutex> lock(this->build_mutex);
+
+        if(std::atomic_load(&this->table) == nullptr)
+            return 0;
+
+        last_path_to_resources  = this->path_to_resources;
+        last_preload_bytes      = this->preload_bytes;
+        last_max_entry_bytes    = this->max_entry_bytes;
+    }
+
+    return this->Build(last_path_to_resources, last_preload_bytes, last_max_entry_bytes);
+}
+
+void HttpResourceManifest::Update(const std::unordered_set<std::string>& paths)
+{
+    std::lock_guard<std::mutex> lock(this->build_mutex);
+
+    snapshot current_table = std::atomic_load(&this->table);
+
+    if(current_table == nullptr || paths.empty())
+        return;
+
+    // Unaffected entries are shared with the current table: nothing but the affected paths is
+    // looked up on disk.
+    std::shared_ptr<entry_table> new_table = std::make_shared<entry_table>();
+    unsigned long preloaded_bytes = 0;
+    root_ptr root;
+    uint64_t root_generation = 0;
+
+    HttpResourceResolver::GetInstance().Refresh(this->path_to_resources, root, root_generation);
+
+    new_table->reserve(current_table->size());
+
+    for(const entry_table::value_type& entry : *current_table)
+    {
+        if(HttpPathIsAffected(paths, entry.first))
+            continue;
+
+        new_table->insert(entry);
+
+        if(entry.second.body != nullptr)
+            preloaded_bytes += entry.second.body->size();
+    }
+
+    for(const std::string& path : paths)
+    {
+        struct stat link_stat;
+        size_t separator = path.rfind('/');
+
+        // Scanned along with a directory above it.
+        if(separator != std::string::npos && HttpPathIsAffected(paths, path.substr(0, separator)))
+            continue;
+
+        // Gone: already dropped above.
+        if(lstat(path.c_str(), &link_stat) < 0)
+            continue;
+
+        // Directories are scanned whole, unless they are symbolic links (as in Build).
+        if(S_ISDIR(link_stat.st_mode))
+        {
+            std::error_code error;
+            this->ScanDirectory(*new_table, root, path, preloaded_bytes, error);
+        }
+        else
+            this->AddFile(*new_table, root, path, preloaded_bytes);
+    }
+
+    this->Publish(std::move(new_table));
+}
+
+void HttpResourceManifest::Clear(void)
+{
+    std::lock_guard<std::mutex> lock(this->build_mutex);
+
+    this->Publish(nullptr);
+}
+
+const HTTP_RESOURCE_MANIFEST_ENTRY* HttpResourceManifest::Find(const snapshot& table_snapshot, const std::string& path)
+{
+    if(table_snapshot == nullptr)
+        return nullptr;
+
+    entry_table::const_iterator it = table_snapshot->find(path);
+
+    return (it != table_snapshot->end()) ? &it->second : nullptr;
+}
+
+/******************************************/
@@ -0,0 +1,124 @@
+#ifndef CPP_HTTP_RESOURCE_MANIFEST_HPP
+#define CPP_HTTP_RESOURCE_MANIFEST_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <system_error>
+#include "HttpServer_api.hpp"
+#include "HttpValidatorCache.hpp"
+#include "HttpResourceResolver.hpp"
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_RESOURCE_MANIFEST_MSG_SCAN_ERROR   "Could not scan resources directory \"%s\": %s"
+#define HTTP_RESOURCE_MANIFEST_MSG_BUILT        "Resource manifest of \"%s\" built: %lu files, %lu bytes preloaded."
+
+/************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+// Everything a response needs to know about a file, gathered once when the manifest is built.
+typedef struct
+{
+    struct stat                             file_stat       ;
+    std::string_view                        content_type    ;   // Empty if the extension is unknown.
+    std::shared_ptr<const HTTP_VALIDATORS>  validators      ;
+    std::shared_ptr<const std::string>      body            ;   // nullptr: not preloaded (read through the file cache).
+} HTTP_RESOURCE_MANIFEST_ENTRY;
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Immutable table of every regular file found below the resources directory, keyed by the path a
+// server builds for it (directory + request target), so that requests for known files need no
+// stat calls at all. The table is built off the request path and swapped in as a whole: servers
+// keep the snapshot they got and only fetch the new one once the generation number changes.
+// Files missing from it (e.g. created after the last build) are looked up on disk as usual.
+// Preloaded files changed since then are served as they were when it was built, until it is built
+// again; any other file is read from disk, and described after what is read.
+class HttpResourceManifest
+{
+private:
+    using entry_table = std::unordered_map<std::string, HTTP_RESOURCE_MANIFEST_ENTRY>;
+    using root_ptr    = HttpResourceResolver::root_ptr;
+
+    // Serializes builds and updates; lookups never take it.
+    std::mutex                          build_mutex ;
+    std::shared_ptr<const entry_table>  table       ;   // Accessed through std::atomic_load/store only.
+    std::atomic<uint64_t>               generation  ;
+
+    // Settings of the last build, for updates to follow them (under build_mutex).
+    std::string                         path_to_resources   ;
+    unsigned long                       preload_bytes       ;
+    unsigned long                       max_entry_bytes     ;
+
+    HttpResourceManifest(void);
+
+    // Read the whole file behind fd, file_stat being taken from it.
+    static int ReadFile(int fd, const struct stat& file_stat, std::shared_ptr<const std::string>& body);
+
+    // Used by Build and Update (under build_mutex). Keys are built from directory the way servers
+    // build paths, and files are opened below root as servers open them.
+    void AddFile(entry_table& new_table, const root_ptr& root, const std::string& key, unsigned long& preloaded_bytes);
+    void ScanDirectory(entry_table& new_table, const root_ptr& root, const std::string& directory, unsigned long& preloaded_bytes, std::error_code& error);
+    void Publish(std::shared_ptr<entry_table> new_table);
+
+public:
+    using snapshot = std::shared_ptr<const entry_table>;
+
+    HttpResourceManifest(const HttpResourceManifest& obj) = delete;
+
+    static HttpResourceManifest& GetInstance(void);
+
+    // Scan path_to_resources and swap the new table in. Files up to max_entry_bytes each are
+    // preloaded into memory as long as the total stays within preload_bytes. Returns the number of
+    // files found, or HTTP_RESOURCE_MANIFEST_ERR_SCAN (the previous table is kept then).
+    long int Build(const std::string& path_to_resources, unsigned long preload_bytes, unsigned long max_entry_bytes);
+    // Build the table again with the settings of the last build (nothing to do if there is none).
+    long int Rebuild(void);
+    // Refresh the entries of the given paths (files or directories, gone or not) and of every file
+    // below them, keeping the rest of the table as it is (nothing to do if there is none).
+    void Update(const std::unordered_set<std::string>& paths);
+    // Drop the table: every file is looked up on disk again.
+    void Clear(void);
+
+    // Refresh table_snapshot if a new table has been swapped in since it was taken (otherwise, it
+    // costs a single atomic load).
+    inline void Refresh(snapshot& table_snapshot, uint64_t& snapshot_generation)
+    {
+        uint64_t current_generation = this->generation.load(std::memory_order_acquire);
+
+        if(current_generation != snapshot_generation)
+        {
+            table_snapshot      = std::atomic_load(&this->table);
+            snapshot_generation = current_generation;
+        }
+    }
+
+    static const HTTP_RESOURCE_MANIFEST_ENTRY* Find(const snapshot& table_snapshot, const std::string& path);
+};
+
+/*************************************/
+
+#endif
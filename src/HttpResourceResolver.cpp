@@ -0,0 +1,344 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include "HttpResourceResolver.hpp"
+#include "HttpClock.hpp"
+#include "HttpLog.hpp"
+
+#if __has_include(<linux/openat2.h>)
+#include <linux/openat2.h>
+#endif
+
+#include <functional>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+// Built against headers that know about openat2 (it is still checked for at run time).
+#if defined(SYS_openat2) && defined(RESOLVE_BENEATH)
+#define HTTP_RESOURCE_RESOLVER_OPENAT2
+#endif
+
+/************************************/
+
+/**************************************/
+/******** Function definitions ********/
+/**************************************/
+
+static int HexDigitValue(char c)
+{
+    if(c >= '0' && c <= '9')
+        return c - '0';
+
+    if(c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+
+    if(c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+
+    return -1;
+}
+
+// Upper bits of the hash of a missing path, as many as fit next to its expiry time; never 0, so
+// that empty slots match no path.
+static inline uint64_t MissingTag(uint64_t hash)
+{
+    return (hash >> HTTP_RESOURCE_RESOLVER_MISSING_TIME_BITS) | 1;
+}
+
+/**************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+HttpResourceResolver::HttpResourceResolver(void):
+    generation(0)           ,
+    openat2_supported(true)
+{
+    this->ClearMissing();
+}
+
+HttpResourceResolver& HttpResourceResolver::GetInstance(void)
+{
+    static HttpResourceResolver instance;
+
+    return instance;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Targets
+
+bool HttpResourceResolver::NormalizeTarget(std::string_view target, std::string& normalized)
+{
+    // Absolute form (as sent to proxies): only its path is taken.
+    if(!target.empty() && target[0] != '/')
+    {
+        size_t authority = target.find("://");
+        if(authority == std::string_view::npos)
+            return false;
+
+        size_t path_begin = target.find('/', authority + 3);
+        target = (path_begin == std::string_view::npos) ? std::string_view("/") : target.substr(path_begin);
+    }
+
+    // Neither the query nor the fragment name a file.
+    target = target.substr(0, target.find_first_of("?#"));
+
+    if(target.empty())
+        return false;
+
+    normalized.assign(1, '/');
+    bool trailing_slash = false;
+
+    // Every segment is decoded into normalized, then dealt with as soon as it ends (one past the
+    // end of the target ends the last one).
+    for(size_t i = 1; i <= target.size(); i++)
+    {
+        char c = '/';
+
+        if(i < target.size() && target[i] == '%')
+        {
+            if(i + 2 >= target.size())
+                return false;
+
+            int high    = HexDigitValue(target[i + 1]);
+            int low     = HexDigitValue(target[i + 2]);
+
+            // A NUL byte would cut the path short.
+            if(high < 0 || low < 0 || (high | low) == 0)
+                return false;
+
+            c   = (char)((high << 4) | low);
+            i  += 2;
+        }
+        else if(i < target.size())
+            c = target[i];
+
+        if(c != '/')
+        {
+            normalized.push_back(c);
+            continue;
+        }
+
+        size_t segment = normalized.rfind('/') + 1;
+        std::string_view name(normalized.data() + segment, normalized.size() - segment);
+
+        trailing_slash = (name.empty() || name == "." || name == "..");
+
+        if(name == ".")
+            normalized.resize(segment);
+        else if(name == "..")
+        {
+            // Nothing to go back to: the target leads outside.
+            if(segment == 1)
+                return false;
+
+            normalized.resize(normalized.rfind('/', segment - 2) + 1);
+        }
+        else if(!name.empty())
+            normalized.push_back('/');
+    }
+
+    if(!trailing_slash && normalized.size() > 1)
+        normalized.pop_back();
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Resources directory
+
+std::shared_ptr<const HTTP_RESOURCE_ROOT> HttpResourceResolver::OpenRoot(const std::string& path)
+{
+    HTTP_RESOURCE_ROOT* root = new HTTP_RESOURCE_ROOT();
+    struct stat root_stat;
+
+    root->path  = path;
+    root->fd    = open(path.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+
+    if(root->fd >= 0 && fstat(root->fd, &root_stat) == 0)
+    {
+        root->dev = root_stat.st_dev;
+        root->ino = root_stat.st_ino;
+    }
+    else
+    {
+        HTTP_LOG_ERR(HTTP_RESOURCE_RESOLVER_MSG_ROOT_ERROR, path.c_str(), errno);
+
+        if(root->fd >= 0)
+            close(root->fd);
+
+        root->fd = -1;
+    }
+
+    root->validated_at_ms.store(HttpNowMs(), std::memory_order_relaxed);
+
+    return std::shared_ptr<const HTTP_RESOURCE_ROOT>(root, [](const HTTP_RESOURCE_ROOT* root)
+    {
+        if(root->fd >= 0)
+            close(root->fd);
+
+        delete root;
+    });
+}
+
+std::shared_ptr<const HTTP_RESOURCE_ROOT> HttpResourceResolver::GetRoot(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(this->roots_mutex);
+
+    std::shared_ptr<const HTTP_RESOURCE_ROOT>& root = this->roots[path];
+
+    if(root == nullptr)
+        root = OpenRoot(path);
+
+    return root;
+}
+
+void HttpResourceResolver::Refresh(const std::string& path_to_resources, root_ptr& root, uint64_t& root_generation)
+{
+    uint64_t current_generation = this->generation.load(std::memory_order_acquire);
+
+    if(root == nullptr || current_generation != root_generation)
+    {
+        root_generation = current_generation;
+        root            = this->GetRoot(path_to_resources);
+        return;
+    }
+
+    // Once in a while, a single thread checks whether the directory has been replaced (e.g. a
+    // symbolic link swapped by a deploy), which would leave servers reading from the former one.
+    long int now_ms             = HttpNowMs();
+    long int validated_at_ms    = root->validated_at_ms.load(std::memory_order_relaxed);
+
+    if(now_ms - validated_at_ms < HTTP_RESOURCE_RESOLVER_REVALIDATE_MS)
+        return;
+
+    if(!root->validated_at_ms.compare_exchange_strong(validated_at_ms, now_ms, std::memory_order_relaxed))
+        return;
+
+    struct stat root_stat;
+    bool found = (stat(root->path.c_str(), &root_stat) == 0 && S_ISDIR(root_stat.st_mode));
+
+    if(root->fd >= 0 ? (found && root_stat.st_dev == root->dev && root_stat.st_ino == root->ino) : !found)
+        return;
+
+    HTTP_LOG_INF(HTTP_RESOURCE_RESOLVER_MSG_ROOT_REPLACED, root->path.c_str());
+
+    this->Reset();
+
+    root_generation = this->generation.load(std::memory_order_acquire);
+    root            = this->GetRoot(path_to_resources);
+}
+
+void HttpResourceResolver::Reset(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->roots_mutex);
+
+        this->roots.clear();
+        this->generation.fetch_add(1, std::memory_order_release);
+    }
+
+    this->ClearMissing();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Files
+
+int HttpResourceResolver::OpenBeneath(int root_fd, const char* relative_path)
+{
+#ifdef HTTP_RESOURCE_RESOLVER_OPENAT2
+    if(this->openat2_supported.load(std::memory_order_relaxed))
+    {
+        struct open_how how = {};
+
+        how.flags   = HTTP_RESOURCE_RESOLVER_OPEN_FLAGS;
+        how.resolve = RESOLVE_BENEATH | RESOLVE_NO_MAGICLINKS;
+
+        int fd = (int)syscall(SYS_openat2, root_fd, relative_path, &how, sizeof(how));
+
+        if(fd >= 0 || errno != ENOSYS)
+            return fd;
+
+        this->openat2_supported.store(false, std::memory_order_relaxed);
+    }
+#endif
+
+    // Kernels older than 5.6: the target has been normalized already, so only symbolic links may
+    // lead outside the directory (as they always could before).
+    return openat(root_fd, relative_path, HTTP_RESOURCE_RESOLVER_OPEN_FLAGS);
+}
+
+int HttpResourceResolver::Open(const root_ptr& root, const std::string& normalized_target, const std::string& path, struct stat& file_stat)
+{
+    if(root == nullptr || root->fd < 0)
+        return HTTP_RESOURCE_RESOLVER_ERR_NOT_FOUND;
+
+    uint64_t    hash    = std::hash<std::string>{}(path);
+    long int    now_ms  = HttpNowMs();
+
+    if(this->IsMissing(hash, now_ms))
+        return HTTP_RESOURCE_RESOLVER_ERR_NOT_FOUND;
+
+    // Relative to the directory: the leading '/' is skipped.
+    int fd = this->OpenBeneath(root->fd, normalized_target.c_str() + 1);
+
+    if(fd < 0)
+    {
+        // Only answers that stay the same until files change are remembered (not e.g. EMFILE).
+        if(errno == ENOENT || errno == ENOTDIR || errno == EXDEV || errno == ELOOP || errno == EACCES || errno == ENAMETOOLONG)
+            this->SetMissing(hash, now_ms);
+
+        return HTTP_RESOURCE_RESOLVER_ERR_NOT_FOUND;
+    }
+
+    if(fstat(fd, &file_stat) < 0)
+    {
+        close(fd);
+        return HTTP_RESOURCE_RESOLVER_ERR_NOT_FOUND;
+    }
+
+    // Directories and special files are never served.
+    if(!S_ISREG(file_stat.st_mode))
+    {
+        close(fd);
+        this->SetMissing(hash, now_ms);
+        return HTTP_RESOURCE_RESOLVER_ERR_NOT_FOUND;
+    }
+
+    return fd;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Missing paths
+
+bool HttpResourceResolver::IsMissing(uint64_t hash, long int now_ms)
+{
+    uint64_t slot = this->missing[hash & (HTTP_RESOURCE_RESOLVER_MISSING_SLOTS - 1)].load(std::memory_order_relaxed);
+
+    return ((slot >> HTTP_RESOURCE_RESOLVER_MISSING_TIME_BITS) == MissingTag(hash) && (uint64_t)now_ms < (slot & HTTP_RESOURCE_RESOLVER_MISSING_TIME_MASK));
+}
+
+void HttpResourceResolver::SetMissing(uint64_t hash, long int now_ms)
+{
+    uint64_t expires_ms = (uint64_t)(now_ms + HTTP_RESOURCE_RESOLVER_MISSING_TTL_MS) & HTTP_RESOURCE_RESOLVER_MISSING_TIME_MASK;
+
+    this->missing[hash & (HTTP_RESOURCE_RESOLVER_MISSING_SLOTS - 1)].store((MissingTag(hash) << HTTP_RESOURCE_RESOLVER_MISSING_TIME_BITS) | expires_ms, std::memory_order_relaxed);
+}
+
+void HttpResourceResolver::ClearMissing(void)
+{
+    for(std::atomic<uint64_t>& slot : this->missing)
+        slot.store(0, std::memory_order_relaxed);
+}
+
+/******************************************/
@@ -0,0 +1,120 @@
+#ifndef CPP_HTTP_RESOURCE_RESOLVER_HPP
+#define CPP_HTTP_RESOURCE_RESOLVER_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_RESOURCE_RESOLVER_MISSING_SLOTS        4096        // Missing paths remembered at once (power of two). Newer ones take the place of older ones.
+#define HTTP_RESOURCE_RESOLVER_MISSING_TTL_MS       1000        // Time a missing path is answered as such without looking it up again.
+#define HTTP_RESOURCE_RESOLVER_MISSING_TIME_BITS    40          // Bits of a slot holding the expiry time (ms of monotonic clock: 34 years).
+#define HTTP_RESOURCE_RESOLVER_MISSING_TIME_MASK    ((UINT64_C(1) << HTTP_RESOURCE_RESOLVER_MISSING_TIME_BITS) - 1)
+#define HTTP_RESOURCE_RESOLVER_REVALIDATE_MS        1000        // Time the resources directory is trusted not to have been replaced.
+// Opening a FIFO must not block: the descriptor is only kept if it turns out to be a regular file.
+#define HTTP_RESOURCE_RESOLVER_OPEN_FLAGS           (O_RDONLY | O_CLOEXEC | O_NONBLOCK | O_NOCTTY)
+
+#define HTTP_RESOURCE_RESOLVER_ERR_NOT_FOUND        -1
+
+#define HTTP_RESOURCE_RESOLVER_MSG_ROOT_ERROR       "Could not open resources directory \"%s\", errno: %d"
+#define HTTP_RESOURCE_RESOLVER_MSG_ROOT_REPLACED    "Resources directory \"%s\" has been replaced, opening it again."
+
+/************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+// Resources directory, kept open for as long as any server resolves paths below it.
+typedef struct
+{
+    std::string                     path            ;
+    int                             fd              ;   // O_PATH descriptor (-1: it could not be opened).
+    dev_t                           dev             ;
+    ino_t                           ino             ;
+    mutable std::atomic<long int>   validated_at_ms ;
+} HTTP_RESOURCE_ROOT;
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Turns request targets into files below the resources directory. Targets are normalized first
+// (query and fragment dropped, percent-encoding decoded, "." and ".." segments applied), so that
+// they never lead outside of it, and files are then opened relative to a descriptor of the
+// directory through openat2 with RESOLVE_BENEATH (symbolic links may not lead outside either).
+// The directory is opened once, and again only if it gets replaced (checked once every
+// HTTP_RESOURCE_RESOLVER_REVALIDATE_MS) or Reset is called.
+// Paths found missing are remembered for HTTP_RESOURCE_RESOLVER_MISSING_TTL_MS in a small lossy
+// table, so that repeated requests for files that do not exist (e.g. scanners) cost no system call.
+class HttpResourceResolver
+{
+private:
+    // Open resources directories by path. Servers keep the one they got until the generation changes.
+    std::mutex                                                              roots_mutex ;
+    std::unordered_map<std::string, std::shared_ptr<const HTTP_RESOURCE_ROOT>> roots    ;
+    std::atomic<uint64_t>                                                   generation  ;
+
+    // Every slot packs the upper bits of the hash of a missing path (its tag, never 0) with the
+    // time it expires at, so that both are always read and written together.
+    std::atomic<uint64_t> missing[HTTP_RESOURCE_RESOLVER_MISSING_SLOTS];
+
+    // Cleared the first time the kernel turns out not to know about openat2.
+    std::atomic<bool>   openat2_supported;
+
+    HttpResourceResolver(void);
+
+    static std::shared_ptr<const HTTP_RESOURCE_ROOT> OpenRoot(const std::string& path);
+
+    std::shared_ptr<const HTTP_RESOURCE_ROOT> GetRoot(const std::string& path);
+    int  OpenBeneath(int root_fd, const char* relative_path);
+    bool IsMissing(uint64_t hash, long int now_ms);
+    void SetMissing(uint64_t hash, long int now_ms);
+
+public:
+    using root_ptr = std::shared_ptr<const HTTP_RESOURCE_ROOT>;
+
+    HttpResourceResolver(const HttpResourceResolver& obj) = delete;
+
+    static HttpResourceResolver& GetInstance(void);
+
+    // Turn a request target (origin or absolute form) into a path below the resources directory,
+    // starting with '/' ("/" for the directory itself). A trailing '/' is kept, so that it only
+    // matches directories. Returns false if the target is malformed or leads outside of it.
+    static bool NormalizeTarget(std::string_view target, std::string& normalized);
+
+    // Get the resources directory found at path_to_resources into root, unless root is current.
+    void Refresh(const std::string& path_to_resources, root_ptr& root, uint64_t& root_generation);
+
+    // Open normalized_target (as given by NormalizeTarget) below root and take its metadata. path
+    // is the full path of the file, only used as the key of missing paths. Returns the descriptor
+    // of the file, or HTTP_RESOURCE_RESOLVER_ERR_NOT_FOUND if it is not a regular file below root.
+    int Open(const root_ptr& root, const std::string& normalized_target, const std::string& path, struct stat& file_stat);
+
+    // Forget every path found missing (files may have been created since).
+    void ClearMissing(void);
+    // Open every resources directory again on next use (e.g. after it was replaced).
+    void Reset(void);
+};
+
+/*************************************/
+
+#endif
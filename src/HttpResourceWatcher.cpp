@@ -0,0 +1,370 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include "HttpResourceWatcher.hpp"
+#include "HttpClock.hpp"
+#include "HttpResourceManifest.hpp"
+#include "HttpResourceResolver.hpp"
+#include "HttpFileCache.hpp"
+#include "HttpStats.hpp"
+#include "HttpLog.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+/*************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+HttpResourceWatcher::HttpResourceWatcher(void):
+    inotify_fd(-1)          ,
+    wake_fd(-1)             ,
+    root_wd(-1)             ,
+    parent_wd(-1)           ,
+    resync_pending(false)   ,
+    resync_reason("")       ,
+    max_delay_ms(0)
+{}
+
+HttpResourceWatcher::~HttpResourceWatcher(void)
+{
+    this->Stop();
+}
+
+HttpResourceWatcher& HttpResourceWatcher::GetInstance(void)
+{
+    static HttpResourceWatcher instance;
+
+    return instance;
+}
+
+int HttpResourceWatcher::Start(const std::string& path_to_resources)
+{
+    std::lock_guard<std::mutex> lock(this->control_mutex);
+
+    this->StopLocked();
+
+    this->inotify_fd    = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    this->wake_fd       = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if(this->inotify_fd < 0 || this->wake_fd < 0)
+    {
+        HTTP_LOG_ERR(HTTP_RESOURCE_WATCHER_MSG_INIT_ERROR, errno);
+        this->StopLocked();
+        return HTTP_RESOURCE_WATCHER_ERR_INIT;
+    }
+
+    this->path_to_resources = path_to_resources;
+
+    if(this->AddWatches(path_to_resources) < 0)
+    {
+        this->StopLocked();
+        return HTTP_RESOURCE_WATCHER_ERR_WATCH;
+    }
+
+    // The parent tells whether the resources directory gets replaced as a whole.
+    std::filesystem::path resources_path = std::filesystem::path(path_to_resources).lexically_normal();
+    if(!resources_path.has_filename())
+        resources_path = resources_path.parent_path();
+
+    this->resources_name = resources_path.filename().string();
+
+    if(this->resources_name.empty() || this->resources_name == "." || this->resources_name == "..")
+        this->resources_name.clear();
+    else
+    {
+        std::string parent_path = resources_path.has_parent_path() ? resources_path.parent_path().string() : ".";
+        this->parent_wd = inotify_add_watch(this->inotify_fd, parent_path.c_str(), HTTP_RESOURCE_WATCHER_PARENT_MASK | IN_ONLYDIR);
+    }
+
+    this->watcher_thread = std::thread(&HttpResourceWatcher::WatcherLoop, this);
+
+    return 0;
+}
+
+void HttpResourceWatcher::Stop(void)
+{
+    std::lock_guard<std::mutex> lock(this->control_mutex);
+
+    this->StopLocked();
+}
+
+void HttpResourceWatcher::StopLocked(void)
+{
+    if(this->watcher_thread.joinable())
+    {
+        uint64_t wake = 1;
+        ssize_t written = write(this->wake_fd, &wake, sizeof(wake));
+        (void)written;
+
+        this->watcher_thread.join();
+    }
+
+    // Closing the inotify descriptor removes every watch.
+    if(this->inotify_fd >= 0)
+        close(this->inotify_fd);
+
+    if(this->wake_fd >= 0)
+        close(this->wake_fd);
+
+    this->inotify_fd        = -1;
+    this->wake_fd           = -1;
+    this->root_wd           = -1;
+    this->parent_wd         = -1;
+    this->resync_pending    = false;
+    this->watched_dirs.clear();
+    this->pending_paths.clear();
+}
+
+int HttpResourceWatcher::AddWatches(const std::string& directory)
+{
+    bool root = (directory == this->path_to_resources);
+
+    // Symbolic links to directories are not followed, except for the resources directory itself.
+    int wd = inotify_add_watch(this->inotify_fd, directory.c_str(), HTTP_RESOURCE_WATCHER_MASK | IN_ONLYDIR | (root ? 0 : IN_DONT_FOLLOW));
+
+    if(wd < 0)
+    {
+        HTTP_LOG_WNG(HTTP_RESOURCE_WATCHER_MSG_WATCH_ERROR, directory.c_str(), errno);
+        return -1;
+    }
+
+    if(root)
+        this->root_wd = wd;
+
+    this->watched_dirs[wd] = directory;
+
+    std::error_code error;
+    for(const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, error))
+    {
+        std::error_code status_error;
+
+        // Built the way servers build paths, as invalidations are looked up by path.
+        if(std::filesystem::is_directory(entry.symlink_status(status_error)))
+            this->AddWatches(directory + "/" + entry.path().filename().string());
+    }
+
+    HttpStats::SetWatcherValue(HTTP_STATS_WATCHER_WATCHES, this->watched_dirs.size());
+
+    return 0;
+}
+
+void HttpResourceWatcher::RemoveWatches(const std::string& directory)
+{
+    for(std::unordered_map<int, std::string>::iterator it = this->watched_dirs.begin(); it != this->watched_dirs.end();)
+    {
+        if(it->second == directory || (it->second.size() > directory.size() && it->second.compare(0, directory.size(), directory) == 0 && it->second[directory.size()] == '/'))
+        {
+            inotify_rm_watch(this->inotify_fd, it->first);
+            it = this->watched_dirs.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    HttpStats::SetWatcherValue(HTTP_STATS_WATCHER_WATCHES, this->watched_dirs.size());
+}
+
+void HttpResourceWatcher::RemoveAllWatches(void)
+{
+    for(const std::pair<const int, std::string>& watched_dir : this->watched_dirs)
+        inotify_rm_watch(this->inotify_fd, watched_dir.first);
+
+    this->watched_dirs.clear();
+    this->root_wd = -1;
+
+    HttpStats::SetWatcherValue(HTTP_STATS_WATCHER_WATCHES, 0);
+}
+
+void HttpResourceWatcher::RequestResync(const char* reason)
+{
+    this->resync_pending    = true;
+    this->resync_reason     = reason;
+}
+
+void HttpResourceWatcher::ReadEvents(void)
+{
+    alignas(struct inotify_event) char buffer[HTTP_RESOURCE_WATCHER_LEN_EVENTS];
+
+    while(true)
+    {
+        ssize_t length = read(this->inotify_fd, buffer, sizeof(buffer));
+
+        if(length < 0 && errno == EINTR)
+            continue;
+
+        if(length <= 0)
+            break;
+
+        const struct inotify_event* event;
+
+        for(char* next = buffer; next < buffer + length; next += sizeof(struct inotify_event) + event->len)
+        {
+            event = (const struct inotify_event*)next;
+
+            HttpStats::AddWatcherValue(HTTP_STATS_WATCHER_EVENTS);
+
+            // Events were lost: no telling what changed.
+            if(event->mask & IN_Q_OVERFLOW)
+            {
+                this->RequestResync("event queue overflow");
+                continue;
+            }
+
+            if(event->wd == this->parent_wd)
+            {
+                if(event->len > 0 && this->resources_name == event->name)
+                    this->RequestResync("resources directory replaced");
+                continue;
+            }
+
+            if(event->mask & IN_IGNORED)
+            {
+                if(event->wd == this->root_wd)
+                    this->RequestResync("resources directory removed");
+
+                this->watched_dirs.erase(event->wd);
+                HttpStats::SetWatcherValue(HTTP_STATS_WATCHER_WATCHES, this->watched_dirs.size());
+                continue;
+            }
+
+            if(event->mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+            {
+                if(event->wd == this->root_wd)
+                    this->RequestResync("resources directory moved or removed");
+                continue;
+            }
+
+            std::unordered_map<int, std::string>::const_iterator watched_dir = this->watched_dirs.find(event->wd);
+
+            // Directory attributes: nothing is cached about them.
+            if(watched_dir == this->watched_dirs.end() || event->len == 0)
+                continue;
+
+            std::string path = watched_dir->second + "/" + event->name;
+
+            // Subdirectories: a directory moved within the tree is watched again under its new path.
+            if(event->mask & IN_ISDIR)
+            {
+                if(event->mask & (IN_DELETE | IN_MOVED_FROM))
+                    this->RemoveWatches(path);
+
+                if(event->mask & (IN_CREATE | IN_MOVED_TO))
+                    this->AddWatches(path);
+            }
+
+            this->pending_paths.insert(std::move(path));
+        }
+    }
+
+    HttpStats::SetWatcherValue(HTTP_STATS_WATCHER_PENDING, this->pending_paths.size());
+}
+
+void HttpResourceWatcher::Apply(uint64_t first_event_ms)
+{
+    unsigned long applied_paths = this->pending_paths.size();
+
+    if(this->resync_pending)
+    {
+        HTTP_LOG_WNG(HTTP_RESOURCE_WATCHER_MSG_RESYNC, this->path_to_resources.c_str(), this->resync_reason);
+
+        // The resources directory may be another one by now: watch whatever is found there.
+        this->RemoveAllWatches();
+        this->AddWatches(this->path_to_resources);
+
+        HttpResourceResolver::GetInstance().Reset();
+        HttpFileCache::ClearAll();
+        HttpResourceManifest::GetInstance().Rebuild();
+
+        this->resync_pending = false;
+        HttpStats::AddWatcherValue(HTTP_STATS_WATCHER_RESYNCS);
+    }
+    else
+    {
+        // Missing paths are only remembered for a moment: forgetting all of them is cheaper
+        // than telling which ones the batch created.
+        HttpResourceResolver::GetInstance().ClearMissing();
+        HttpFileCache::InvalidateAll(this->pending_paths);
+        HttpResourceManifest::GetInstance().Update(this->pending_paths);
+    }
+
+    this->pending_paths.clear();
+
+    uint64_t delay_ms = HttpNowMs() - first_event_ms;
+
+    this->max_delay_ms = std::max(this->max_delay_ms, delay_ms);
+
+    HttpStats::SetWatcherValue(HTTP_STATS_WATCHER_PENDING, 0);
+    HttpStats::AddWatcherValue(HTTP_STATS_WATCHER_APPLIED, applied_paths);
+    HttpStats::AddWatcherValue(HTTP_STATS_WATCHER_BATCHES);
+    HttpStats::SetWatcherValue(HTTP_STATS_WATCHER_MAX_DELAY_MS, this->max_delay_ms);
+
+    HTTP_LOG_DBG(HTTP_RESOURCE_WATCHER_MSG_APPLIED, applied_paths, (unsigned long)delay_ms);
+}
+
+void HttpResourceWatcher::WatcherLoop(void)
+{
+    struct pollfd poll_fds[2] =
+    {
+        {this->inotify_fd   , POLLIN, 0},
+        {this->wake_fd      , POLLIN, 0},
+    };
+
+    uint64_t first_event_ms = 0;
+    uint64_t last_event_ms  = 0;
+
+    while(true)
+    {
+        bool waiting = (this->resync_pending || !this->pending_paths.empty());
+        int timeout_ms = -1;
+
+        // Until the burst is over, or has been going on for too long.
+        if(waiting)
+        {
+            int64_t now_ms          = (int64_t)HttpNowMs();
+            int64_t quiet_left_ms   = (int64_t)last_event_ms  + HTTP_RESOURCE_WATCHER_COALESCE_MS  - now_ms;
+            int64_t delay_left_ms   = (int64_t)first_event_ms + HTTP_RESOURCE_WATCHER_MAX_DELAY_MS - now_ms;
+
+            timeout_ms = (int)std::max((int64_t)0, std::min(quiet_left_ms, delay_left_ms));
+        }
+
+        if(poll(poll_fds, 2, timeout_ms) < 0 && errno != EINTR)
+            break;
+
+        if(poll_fds[1].revents & POLLIN)
+            break;
+
+        if(poll_fds[0].revents & POLLIN)
+        {
+            this->ReadEvents();
+
+            last_event_ms = HttpNowMs();
+            if(!waiting)
+                first_event_ms = last_event_ms;
+        }
+
+        if(!this->resync_pending && this->pending_paths.empty())
+            continue;
+
+        uint64_t now_ms = HttpNowMs();
+
+        if(now_ms - last_event_ms >= HTTP_RESOURCE_WATCHER_COALESCE_MS || now_ms - first_event_ms >= HTTP_RESOURCE_WATCHER_MAX_DELAY_MS)
+            this->Apply(first_event_ms);
+    }
+
+    // Nothing is left behind when stopping.
+    if(this->resync_pending || !this->pending_paths.empty())
+        this->Apply(first_event_ms);
+}
+
+/******************************************/
@@ -0,0 +1,97 @@
+#ifndef CPP_HTTP_RESOURCE_WATCHER_HPP
+#define CPP_HTTP_RESOURCE_WATCHER_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <sys/inotify.h>
+#include <stdint.h>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include "HttpServer_api.hpp"
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_RESOURCE_WATCHER_COALESCE_MS       20          // Quiet time that ends a burst of events.
+#define HTTP_RESOURCE_WATCHER_MAX_DELAY_MS      200         // Longest a burst may hold its invalidations back.
+#define HTTP_RESOURCE_WATCHER_LEN_EVENTS        65536       // Bytes of events read at once.
+
+// Changes to the entries of a watched directory, and to the directory itself (only relevant for
+// the resources directory: its parent reports any other one).
+#define HTTP_RESOURCE_WATCHER_MASK              (IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)
+// Resources directory being replaced (e.g. a symbolic link swapped by a deploy), as seen from its parent.
+#define HTTP_RESOURCE_WATCHER_PARENT_MASK       (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)
+
+#define HTTP_RESOURCE_WATCHER_MSG_INIT_ERROR    "Could not initialize inotify, errno: %d"
+#define HTTP_RESOURCE_WATCHER_MSG_WATCH_ERROR   "Could not watch \"%s\", errno: %d"
+#define HTTP_RESOURCE_WATCHER_MSG_RESYNC        "Resources below \"%s\" invalidated as a whole (%s)."
+#define HTTP_RESOURCE_WATCHER_MSG_APPLIED       "%lu resource paths invalidated after %lu ms."
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Keeps the file cache and the resource manifest in step with the resources directory. A thread
+// watches every directory below it (symbolic links to directories are not followed, as in the
+// manifest) through inotify, and gathers the paths that changed until events stop coming for
+// HTTP_RESOURCE_WATCHER_COALESCE_MS (or HTTP_RESOURCE_WATCHER_MAX_DELAY_MS at most), so that a
+// deploy touching many files costs a single pass. Only the affected entries are then dropped from
+// the file cache and refreshed in the manifest; changed directories are handled as a whole, so
+// that renaming a new version of a file or directory into place (atomic deploys) is caught as
+// well. If the event queue overflows, or the resources directory itself is replaced, everything
+// is invalidated at once.
+class HttpResourceWatcher
+{
+private:
+    std::mutex              control_mutex   ;   // Serializes Start and Stop.
+    std::thread             watcher_thread  ;
+    int                     inotify_fd      ;
+    int                     wake_fd         ;   // eventfd telling the thread to stop.
+
+    // Owned by the watcher thread from here on.
+    std::string                             path_to_resources   ;
+    std::string                             resources_name      ;   // Entry of the resources directory in its parent (empty: not watched).
+    int                                     root_wd             ;
+    int                                     parent_wd           ;
+    std::unordered_map<int, std::string>    watched_dirs        ;   // Watch descriptor to directory path.
+    std::unordered_set<std::string>         pending_paths       ;
+    bool                                    resync_pending      ;
+    const char*                             resync_reason       ;
+
+    uint64_t                                max_delay_ms        ;   // Longest one so far (every figure is published into HttpStats).
+
+    HttpResourceWatcher(void);
+    ~HttpResourceWatcher(void);
+
+    int     AddWatches(const std::string& directory);
+    void    RemoveWatches(const std::string& directory);
+    void    RemoveAllWatches(void);
+    void    RequestResync(const char* reason);
+    void    ReadEvents(void);
+    void    Apply(uint64_t first_event_ms);
+    void    WatcherLoop(void);
+    void    StopLocked(void);
+
+public:
+    HttpResourceWatcher(const HttpResourceWatcher& obj) = delete;
+
+    static HttpResourceWatcher& GetInstance(void);
+
+    // Watch path_to_resources (any former watch is stopped first).
+    int  Start(const std::string& path_to_resources);
+    void Stop(void);
+};
+
+/*************************************/
+
+#endif
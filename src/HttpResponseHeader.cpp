@@ -0,0 +1,138 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpResponseHeader.hpp"
+#include "HttpDate.hpp"
+#include <ctime>
+#include <cstring>
+#include <charconv>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_RESPONSE_HEADER_STATUS(status_code, static_fields) std::string_view("HTTP/1.1 " status_code "\r\n" static_fields)
+
+#define HTTP_RESPONSE_HEADER_ERROR_FIELDS       "Content-Length: 0\r\nConnection: close\r\n"   // The connection is closed right after errors.
+
+#define HTTP_RESPONSE_HEADER_CODE_OFFSET        (sizeof("HTTP/1.1 ") - 1)
+#define HTTP_RESPONSE_HEADER_CODE_LEN           3
+
+#define HTTP_RESPONSE_HEADER_DATE_PREFIX        "Date: "
+#define HTTP_RESPONSE_HEADER_DATE_PREFIX_LEN    (sizeof(HTTP_RESPONSE_HEADER_DATE_PREFIX) - 1)
+
+#define HTTP_RESPONSE_HEADER_EXPIRES_PREFIX     "Expires: "
+#define HTTP_RESPONSE_HEADER_EXPIRES_PREFIX_LEN (sizeof(HTTP_RESPONSE_HEADER_EXPIRES_PREFIX) - 1)
+#define HTTP_RESPONSE_HEADER_EXPIRES_SLOTS      4   // Distinct max-age values cached per thread.
+
+/*************************************/
+
+/******************************************/
+/****** Private variable definitions ******/
+/******************************************/
+
+// The response version is always the highest one the server supports (RFC 9110 section 6.2),
+// whatever the request version is.
+static const std::string_view status_headers[HTTP_STATUS_COUNT] =
+{
+    HTTP_RESPONSE_HEADER_STATUS("100 Continue"                          , ""                                    ),
+    HTTP_RESPONSE_HEADER_STATUS("200 OK"                                , ""                                    ),
+    HTTP_RESPONSE_HEADER_STATUS("206 Partial Content"                   , HTTP_RESPONSE_HEADER_RANGES_FIELDS    ),
+    HTTP_RESPONSE_HEADER_STATUS("304 Not Modified"                      , ""                                    ),
+    HTTP_RESPONSE_HEADER_STATUS("400 Bad Request"                       , HTTP_RESPONSE_HEADER_ERROR_FIELDS     ),
+    HTTP_RESPONSE_HEADER_STATUS("404 Not Found"                         , ""                                    ),
+    HTTP_RESPONSE_HEADER_STATUS("405 Method Not Allowed"                , "Allow: GET, HEAD, TRACE\r\n"         ),
+    HTTP_RESPONSE_HEADER_STATUS("413 Content Too Large"                 , HTTP_RESPONSE_HEADER_ERROR_FIELDS     ),
+    HTTP_RESPONSE_HEADER_STATUS("414 URI Too Long"                      , HTTP_RESPONSE_HEADER_ERROR_FIELDS     ),
+    HTTP_RESPONSE_HEADER_STATUS("416 Range Not Satisfiable"             , HTTP_RESPONSE_HEADER_RANGES_FIELDS    ),
+    HTTP_RESPONSE_HEADER_STATUS("431 Request Header Fields Too Large"   , HTTP_RESPONSE_HEADER_ERROR_FIELDS     ),
+    HTTP_RESPONSE_HEADER_STATUS("501 Not Implemented"                   , HTTP_RESPONSE_HEADER_ERROR_FIELDS     ),
+};
+
+/******************************************/
+
+/**************************************/
+/******** Function definitions ********/
+/**************************************/
+
+std::string_view HttpGetDateHeader(void)
+{
+    // Every thread serves its own connections, so no locking is needed; time() is answered
+    // by the vDSO, so checking for a new second costs no system call.
+    thread_local time_t cached_second = HTTP_DATE_INVALID;
+    thread_local char   date_header[HTTP_RESPONSE_HEADER_DATE_PREFIX_LEN + HTTP_DATE_LEN + 3] = HTTP_RESPONSE_HEADER_DATE_PREFIX;
+
+    time_t now = time(nullptr);
+
+    if(now != cached_second)
+    {
+        HttpFormatDate(now, date_header + HTTP_RESPONSE_HEADER_DATE_PREFIX_LEN);
+        date_header[HTTP_RESPONSE_HEADER_DATE_PREFIX_LEN + HTTP_DATE_LEN    ] = '\r';
+        date_header[HTTP_RESPONSE_HEADER_DATE_PREFIX_LEN + HTTP_DATE_LEN + 1] = '\n';
+        cached_second = now;
+    }
+
+    return std::string_view(date_header, HTTP_RESPONSE_HEADER_DATE_PREFIX_LEN + HTTP_DATE_LEN + 2);
+}
+
+std::string_view HttpGetExpiresHeader(long int max_age)
+{
+    // Same as the Date field, but one slot per max-age value, as every cache policy has its own.
+    typedef struct
+    {
+        time_t      cached_second                                                           ;
+        long int    max_age                                                                 ;
+        char        expires_header[HTTP_RESPONSE_HEADER_EXPIRES_PREFIX_LEN + HTTP_DATE_LEN + 3] ;
+    } HTTP_EXPIRES_SLOT;
+
+    thread_local HTTP_EXPIRES_SLOT slots[HTTP_RESPONSE_HEADER_EXPIRES_SLOTS];
+
+    HTTP_EXPIRES_SLOT& slot = slots[(unsigned long)max_age % HTTP_RESPONSE_HEADER_EXPIRES_SLOTS];
+    time_t now = time(nullptr);
+
+    if(now != slot.cached_second || max_age != slot.max_age)
+    {
+        memcpy(slot.expires_header, HTTP_RESPONSE_HEADER_EXPIRES_PREFIX, HTTP_RESPONSE_HEADER_EXPIRES_PREFIX_LEN);
+        HttpFormatDate(now + max_age, slot.expires_header + HTTP_RESPONSE_HEADER_EXPIRES_PREFIX_LEN);
+        slot.expires_header[HTTP_RESPONSE_HEADER_EXPIRES_PREFIX_LEN + HTTP_DATE_LEN    ] = '\r';
+        slot.expires_header[HTTP_RESPONSE_HEADER_EXPIRES_PREFIX_LEN + HTTP_DATE_LEN + 1] = '\n';
+        slot.cached_second  = now;
+        slot.max_age        = max_age;
+    }
+
+    return std::string_view(slot.expires_header, HTTP_RESPONSE_HEADER_EXPIRES_PREFIX_LEN + HTTP_DATE_LEN + 2);
+}
+
+void HttpBeginResponseHeader(std::string& header, HTTP_STATUS status)
+{
+    header.append(status_headers[status]);
+
+    // Interim responses do not need a Date (RFC 9110 section 6.6.1).
+    if(status != HTTP_STATUS_100)
+        header.append(HttpGetDateHeader());
+}
+
+std::string_view HttpGetStatusCode(HTTP_STATUS status)
+{
+    return status_headers[status].substr(HTTP_RESPONSE_HEADER_CODE_OFFSET, HTTP_RESPONSE_HEADER_CODE_LEN);
+}
+
+void HttpAppendNumber(std::string& header, off_t value)
+{
+    char digits[HTTP_RESPONSE_HEADER_MAX_NUMBER_LEN + 1];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+
+    header.append(digits, result.ptr - digits);
+}
+
+void HttpAppendContentLength(std::string& header, off_t length)
+{
+    header.append("Content-Length: ");
+    HttpAppendNumber(header, length);
+    header.append("\r\n");
+}
+
+/**************************************/
@@ -0,0 +1,76 @@
+#ifndef CPP_HTTP_RESPONSE_HEADER_HPP
+#define CPP_HTTP_RESPONSE_HEADER_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_RESPONSE_HEADER_MAX_NUMBER_LEN     20          // Digits of the largest off_t.
+#define HTTP_RESPONSE_HEADER_RANGES_FIELDS      "Accept-Ranges: bytes\r\n"  // Only resources served from files take ranges.
+
+/************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+// Every status the server answers with. Indexes the table of pre-rendered status lines.
+typedef enum
+{
+    HTTP_STATUS_100 = 0 ,
+    HTTP_STATUS_200     ,
+    HTTP_STATUS_206     ,
+    HTTP_STATUS_304     ,
+    HTTP_STATUS_400     ,
+    HTTP_STATUS_404     ,
+    HTTP_STATUS_405     ,
+    HTTP_STATUS_413     ,
+    HTTP_STATUS_414     ,
+    HTTP_STATUS_416     ,
+    HTTP_STATUS_431     ,
+    HTTP_STATUS_501     ,
+
+    HTTP_STATUS_COUNT   ,
+} HTTP_STATUS;
+
+/************************************/
+
+/**************************************/
+/******** Function declarations *******/
+/**************************************/
+
+// Status line plus the header fields every response with that status carries, then the Date
+// field (final responses only). Nothing is formatted: the status part is rendered at compile
+// time and the Date field once per second and thread, so header strings that keep their
+// capacity across responses are filled without allocating.
+void HttpBeginResponseHeader(std::string& header, HTTP_STATUS status);
+
+// "Content-Length: <length>\r\n", formatted on the stack.
+void HttpAppendContentLength(std::string& header, off_t length);
+
+// Decimal representation of value, formatted on the stack.
+void HttpAppendNumber(std::string& header, off_t value);
+
+// Three-digit status code, e.g. "404".
+std::string_view HttpGetStatusCode(HTTP_STATUS status);
+
+// "Date: <now>\r\n" as an IMF-fixdate, cached per thread for the current second.
+std::string_view HttpGetDateHeader(void);
+
+// "Expires: <now + max_age>\r\n" as an IMF-fixdate, cached per thread and max_age for the current
+// second.
+std::string_view HttpGetExpiresHeader(long int max_age);
+
+/**************************************/
+
+#endif
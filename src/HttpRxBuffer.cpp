@@ -0,0 +1,115 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpRxBuffer.hpp"
+
+#include <cstring>
+
+/*************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+HttpRxBuffer::HttpRxBuffer(std::size_t max_capacity):
+    data(nullptr)               ,
+    size(0)                     ,
+    capacity(0)                 ,
+    max_capacity(max_capacity)
+{}
+
+long int HttpRxBuffer::Reserve(std::size_t min_free)
+{
+    if(this->capacity - this->size >= min_free)
+        return this->capacity - this->size;
+
+    std::size_t new_capacity = this->capacity * 2;
+
+    if(new_capacity < this->size + min_free)
+        new_capacity = this->size + min_free;
+
+    if(new_capacity > this->max_capacity)
+        new_capacity = this->max_capacity;
+
+    if(new_capacity <= this->size)
+        return HTTP_RX_BUFFER_ERR_LIMIT_REACHED;
+
+    if(new_capacity > this->capacity)
+    {
+        // Plain new[] leaves the memory uninitialized, which is fine as it is about to be written.
+        std::unique_ptr<char[]> new_data(new char[new_capacity]);
+
+        if(this->size > 0)
+            memcpy(new_data.get(), this->data.get(), this->size);
+
+        this->data      = std::move(new_data);
+        this->capacity  = new_capacity;
+    }
+
+    return this->capacity - this->size;
+}
+
+char* HttpRxBuffer::GetWritePointer(void)
+{
+    return this->data.get() + this->size;
+}
+
+std::size_t HttpRxBuffer::GetFreeSpace(void) const
+{
+    return this->capacity - this->size;
+}
+
+void HttpRxBuffer::Commit(std::size_t length)
+{
+    this->size += length;
+}
+
+void HttpRxBuffer::Consume(std::size_t length)
+{
+    if(length >= this->size)
+    {
+        this->size = 0;
+        return;
+    }
+
+    if(length == 0)
+        return;
+
+    memmove(this->data.get(), this->data.get() + length, this->size - length);
+    this->size -= length;
+}
+
+void HttpRxBuffer::Clear(void)
+{
+    this->size = 0;
+
+    // Do not let a single large request pin its memory for as long as the buffer lives.
+    if(this->capacity > HTTP_RX_BUFFER_KEPT_CAPACITY)
+    {
+        this->data.reset();
+        this->capacity = 0;
+    }
+}
+
+const char* HttpRxBuffer::GetData(void) const
+{
+    return this->data.get();
+}
+
+std::size_t HttpRxBuffer::GetSize(void) const
+{
+    return this->size;
+}
+
+std::size_t HttpRxBuffer::GetMaxCapacity(void) const
+{
+    return this->max_capacity;
+}
+
+std::string_view HttpRxBuffer::GetView(void) const
+{
+    return std::string_view(this->data.get(), this->size);
+}
+
+/******************************************/
@@ -0,0 +1,66 @@
+#ifndef CPP_HTTP_RX_BUFFER_HPP
+#define CPP_HTTP_RX_BUFFER_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_RX_BUFFER_KEPT_CAPACITY        65536       // Larger buffers are freed by Clear.
+
+#define HTTP_RX_BUFFER_ERR_LIMIT_REACHED    -1
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Per-connection receive buffer. Data is read straight into its spare capacity (no intermediate
+// buffer, no memset, no NUL terminator), so it is binary-safe. It grows geometrically, but never
+// beyond the limit it has been built with. Consumed bytes are dropped from the front by moving
+// the remaining ones back to the beginning, which only happens once per read.
+class HttpRxBuffer
+{
+private:
+    std::unique_ptr<char[]> data        ;
+    std::size_t             size        ;
+    std::size_t             capacity    ;
+    const std::size_t       max_capacity;
+
+public:
+    HttpRxBuffer(std::size_t max_capacity);
+
+    // Copying the buffer around is never needed.
+    HttpRxBuffer(const HttpRxBuffer& obj) = delete;
+
+    // Make room for (at least) min_free more bytes, or as many as the limit allows. Returns the
+    // spare capacity left, or HTTP_RX_BUFFER_ERR_LIMIT_REACHED if the buffer is already full.
+    long int    Reserve(std::size_t min_free);
+    char*       GetWritePointer(void);
+    std::size_t GetFreeSpace(void)  const;
+    // Account for length bytes written at GetWritePointer.
+    void        Commit(std::size_t length);
+    // Drop the first length bytes.
+    void        Consume(std::size_t length);
+    // Drop everything. Capacity is kept unless it grew beyond HTTP_RX_BUFFER_KEPT_CAPACITY.
+    void        Clear(void);
+
+    const char*         GetData(void)       const;
+    std::size_t         GetSize(void)       const;
+    std::size_t         GetMaxCapacity(void) const;
+    std::string_view    GetView(void)       const;
+};
+
+/*************************************/
+
+#endif
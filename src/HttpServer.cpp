@@ -5,17 +5,31 @@
 #include <netinet/in.h>     // INET_ADDRSTRLEN.
 #include <arpa/inet.h>      // sockaddr_in, inet_addr
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>   // Zero-copy file to socket transfers.
+#include <sys/uio.h>        // Vectored writes.
+#include <sys/stat.h>
 #include "HttpServer.hpp"
-#include "SeverityLog_api.h"
+#include "HttpStats.hpp"
+#include "HttpFileCache.hpp"
+#include "HttpStaticTables.hpp"
+#include "HttpHeaderScan.hpp"
+#include "HttpRange.hpp"
+#include "HttpDate.hpp"
+#include "HttpResponseHeader.hpp"
+#include "HttpLog.hpp"
 #include "ServerSocket_api.h"
-#include "MutexGuard_api.h"
 
 #include <string>
+#include <cstring>
 #include <fstream>          // Read from file to string
 #include <vector>
 #include <sstream>
-#include <filesystem>
 #include <map>
+#include <algorithm>
+#include <random>
+#include <cstdio>
 
 /*************************************/
 
@@ -29,110 +43,43 @@
 /*************************************/
 
 /******************************************/
-/****** Private variable definitions ******/
+/******** Private helper functions ********/
 /******************************************/
 
-bool is_rsc_read_mtx_init = false;
-
-MTX_GRD resources_read_mutex =
-{
-    .additional_data = (void*)&is_rsc_read_mtx_init
-};
-
-const std::map<const std::string, const std::string> extension_to_content_type =
-{
-    {"aac"      ,	"audio/aac"                                                                 },
-    {"abw"      ,	"application/x-abiword"                                                     },
-    {"apng"     ,   "image/apng"                                                                },
-    {"arc"      ,	"application/x-freearc"                                                     },
-    {"avif"     ,	"image/avif"                                                                },
-    {"avi"      ,	"video/x-msvideo"                                                           },
-    {"azw"      ,	"application/vnd.amazon.ebook"                                              },
-    {"bin"      ,	"application/octet-stream"                                                  },
-    {"bmp"      ,	"image/bmp"                                                                 },
-    {"bz"       ,	"application/x-bzip"                                                        },
-    {"bz2"      ,	"application/x-bzip2"                                                       },
-    {"cda"      ,	"application/x-cdf"                                                         },
-    {"csh"      ,	"application/x-csh"                                                         },
-    {"css"      ,	"text/css"                                                                  },
-    {"csv"      ,	"text/csv"                                                                  },
-    {"doc"      ,	"application/msword"                                                        },
-    {"docx"     ,	"application/vnd.openxmlformats-officedocument.wordprocessingml.document"   },
-    {"eot"      ,	"application/vnd.ms-fontobject"                                             },
-    {"epub"     ,	"application/epub+zip"                                                      },
-    {"gz"       ,	"application/gzip"                                                          },
-    {"gif"      ,	"image/gif"                                                                 },
-    {"htm"      ,	"text/html"                                                                 },
-    {"html"     ,	"text/html"                                                                 },
-    {"http"     ,   "message/http"                                                              },
-    {"ico"      ,	"image/vnd.microsoft.icon"                                                  },
-    {"ics"      ,	"text/calendar"                                                             },
-    {"jar"      ,	"application/java-archive"                                                  },
-    {"jpg"      ,	"image/jpeg"                                                                },
-    {"jpeg"     ,	"image/jpeg"                                                                },
-    {"js"       ,	"javascript"                                                                },
-    {"json"     ,	"application/json"                                                          },
-    {"jsonld"   ,	"application/ld+json"                                                       },
-    {"mid"      ,	"audio/x-midi"                                                              },
-    {"midi"     ,	"audio/x-midi"                                                              },
-    {"mjs"      ,	"text/javascript"                                                           },
-    {"mp3"      ,	"audio/mpeg"                                                                },
-    {"mp4"      ,	"video/mp4"                                                                 },
-    {"mpeg"     ,	"video/mpeg"                                                                },
-    {"mpkg"     ,	"application/vnd.apple.installer+xml"                                       },
-    {"odp"      ,	"application/vnd.oasis.opendocument.presentation"                           },
-    {"ods"      ,	"application/vnd.oasis.opendocument.spreadsheet"                            },
-    {"odt"      ,	"application/vnd.oasis.opendocument.text"                                   },
-    {"oga"      ,	"audio/ogg"                                                                 },
-    {"ogv"      ,	"video/ogg"                                                                 },
-    {"ogx"      ,	"application/ogg"                                                           },
-    {"opus"     ,	"audio/opus"                                                                },
-    {"otf"      ,	"font/otf"                                                                  },
-    {"png"      ,	"image/png"                                                                 },
-    {"pdf"      ,	"application/pdf"                                                           },
-    {"php"      ,	"application/x-httpd-php"                                                   },
-    {"ppt"      ,	"application/vnd.ms-powerpoint"                                             },
-    {"pptx"     ,	"application/vnd.openxmlformats-officedocument.presentationml.presentation" },
-    {"rar"      ,	"application/vnd.rar"                                                       },
-    {"rtf"      ,	"application/rtf"                                                           },
-    {"sh"       ,	"application/x-sh"                                                          },
-    {"svg"      ,	"image/svg+xml"                                                             },
-    {"tar"      ,	"application/x-tar"                                                         },
-    {"tif"      ,	"image/tiff"                                                                },
-    {"tiff"     ,	"image/tiff"                                                                },
-    {"ts"       ,	"video/mp2t"                                                                },
-    {"ttf"      ,	"font/ttf"                                                                  },
-    {"txt"      ,	"text/plain"                                                                },
-    {"vsd"      ,	"application/vnd.visio"                                                     },
-    {"wav"      ,	"audio/wav"                                                                 },
-    {"weba"     ,	"audio/webm"                                                                },
-    {"webm"     ,	"video/webm"                                                                },
-    {"webp"     ,	"image/webp"                                                                },
-    {"woff"     ,	"font/woff"                                                                 },
-    {"woff2"    ,	"font/woff2"                                                                },
-    {"xhtml"    ,	"application/xhtml+xml"                                                     },
-    {"xls"      ,	"application/vnd.ms-excel"                                                  },
-    {"xlsx"     ,	"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet"         },
-    {"xml"      ,	"application/xml"                                                           },
-    {"xul"      ,	"application/vnd.mozilla.xul+xml"                                           },
-    {"zip"      ,	"application/zip"                                                           },
-    {"3gp"      ,	"video/3gpp"                                                                },
-    {"3g2"      ,	"video/3gpp2"                                                               },
-    {"7z"       ,	"application/x-7z-compressed"                                               },
-    {"default"  ,   "application/octet-stream"                                                  },
-};
-
-const std::map<const std::string, const unsigned int> method_to_uint =
-{
-    {"GET"      , HTTP_SERVER_METHOD_CODE_GET    },
-    {"HEAD"     , HTTP_SERVER_METHOD_CODE_HEAD   },
-    {"POST"     , HTTP_SERVER_METHOD_CODE_POST   },
-    {"PUT"      , HTTP_SERVER_METHOD_CODE_PUT    },
-    {"DELETE"   , HTTP_SERVER_METHOD_CODE_DELETE },
-    {"CONNECT"  , HTTP_SERVER_METHOD_CODE_CONNECT},
-    {"OPTIONS"  , HTTP_SERVER_METHOD_CODE_OPTIONS},
-    {"TRACE"    , HTTP_SERVER_METHOD_CODE_TRACE  },
-};
+// Whether the comma-separated list of connection options value holds option (case-insensitive).
+static bool HasConnectionOption(std::string_view value, std::string_view option)
+{
+    while(!value.empty())
+    {
+        size_t comma = value.find(',');
+        std::string_view token = value.substr(0, comma);
+
+        while(!token.empty() && (token.front() == ' ' || token.front() == '\t'))
+            token.remove_prefix(1);
+        while(!token.empty() && (token.back() == ' ' || token.back() == '\t'))
+            token.remove_suffix(1);
+
+        if(token.size() == option.size() && std::equal(token.begin(), token.end(), option.begin(), [](char a, char b){ return (a | 0x20) == (b | 0x20); }))
+            return true;
+
+        if(comma == std::string_view::npos)
+            break;
+
+        value.remove_prefix(comma + 1);
+    }
+
+    return false;
+}
+
+// Same file, same version: what was described by one is what the other gives access to.
+static bool IsSameFileVersion(const struct stat& a, const struct stat& b)
+{
+    return  a.st_dev            == b.st_dev             &&
+            a.st_ino            == b.st_ino             &&
+            a.st_size           == b.st_size            &&
+            a.st_mtim.tv_sec    == b.st_mtim.tv_sec     &&
+            a.st_mtim.tv_nsec   == b.st_mtim.tv_nsec    ;
+}
 
 /******************************************/
 
@@ -140,33 +87,87 @@ const std::map<const std::string, const unsigned int> method_to_uint =
 /******** Class method definitions ********/
 /******************************************/
 
-HttpServer::HttpServer(const std::string path_to_resources):
+HttpServer::HttpServer(const std::string path_to_resources, bool secure_connection, unsigned long max_request_len, HTTP_SERVER_IO_MODE io_mode, HttpFileCache* file_cache):
     path_to_resources(path_to_resources)                                                    ,
-    ptr_extension_to_content(std::make_shared<ext_to_type_table>(extension_to_content_type)),
-    ptr_method_to_uint(std::make_shared<method_to_uint_table>(method_to_uint))              ,
-    ptr_to_resources_read_mutex(std::make_shared<MTX_GRD>(resources_read_mutex))
+    secure_connection(secure_connection)                                                    ,
+    io_mode(io_mode)                                                                        ,
+    file_cache((file_cache != nullptr) ? *file_cache : HttpFileCache::GetInstance())        ,
+    manifest_generation(0)                                                                  ,
+    resources_root_generation(0)                                                            ,
+    resource({nullptr, nullptr, -1, {}})                                                    ,
+    content_encoding(HTTP_CONTENT_ENCODING_IDENTITY)                                        ,
+    vary_encoding(false)                                                                    ,
+    rx_buffer(std::max(max_request_len, (unsigned long)HTTP_SERVER_MIN_MAX_REQUEST_LEN))    ,
+    request_begin(0)                                                                        ,
+    scan_offset(0)                                                                          ,
+    header_end(HTTP_HEADER_SCAN_NOT_FOUND)                                                  ,
+    head_parsed(false)                                                                      ,
+    body_length(0)                                                                          ,
+    responses_count(0)                                                                      ,
+    tx_response_index(0)                                                                    ,
+    tx_part(HTTP_RESPONSE_PART_HEADER)                                                      ,
+    tx_part_offset(0)                                                                       ,
+    http_run_fsm(HTTP_RUN_FSM_READ)                                                         ,
+    end_after_write(false)                                                                  ,
+    keep_alive_timeout(HTTP_SERVER_DEFAULT_KEEP_ALIVE_TIMEOUT)                              ,
+    keep_alive_requests(HTTP_SERVER_DEFAULT_KEEP_ALIVE_REQUESTS)                            ,
+    requests_served(0)                                                                      ,
+    keep_alive(false)                                                                       ,
+    request_rx_timeout({})                                                                  ,
+    rx_timeout_saved(false)                                                                 ,
+    idle_rx_timeout(false)                                                                  ,
+    batch_begin_ns(0)                                                                       ,
+    batch_requests(0)                                                                       ,
+    rx_first_byte_ns(0)                                                                     ,
+    client_ip()                                                                             ,
+    client_ip_known(false)                                                                  ,
+    access_records_count(0)
 {
-    SVRTY_LOG_INF(HTTP_SERVER_MSG_INTANCE_CREATED, this->GetPathToResources().c_str());
+    char boundary[17];
+    snprintf(boundary, sizeof(boundary), "%08x%08x", std::random_device()(), std::random_device()());
+    this->multipart_boundary = std::string(HTTP_SERVER_MULTIPART_BOUNDARY_PREFIX) + boundary;
+
+    HTTP_LOG_DBG(HTTP_SERVER_MSG_INTANCE_CREATED, this->GetPathToResources().c_str());
 }
 
 HttpServer::~HttpServer()
 {
-    SVRTY_LOG_INF(HTTP_SERVER_MSG_INTANCE_DESTROYED, this->GetPathToResources().c_str());
-}
+    this->ReleaseResource(this->resource);
+    this->ClearResponses();
 
-/////////////////////////////////////////////////////////////////////////////////////////
-// Check shared resources mutex status
+    HTTP_LOG_DBG(HTTP_SERVER_MSG_INTANCE_DESTROYED, this->GetPathToResources().c_str());
+}
 
-void HttpServer::InitResourcesMutex(void)
+void HttpServer::Reset(void)
 {
-    bool is_mutex_init = *((bool*)(this->ptr_to_resources_read_mutex->additional_data));
-    
-    if(is_mutex_init)
-        return;
+    this->ClearResponses();
+    this->rx_buffer.Clear();
+    this->request_parser.Reset();
+
+    this->request_begin     = 0;
+    this->scan_offset       = 0;
+    this->header_end        = HTTP_HEADER_SCAN_NOT_FOUND;
+    this->head_parsed       = false;
+    this->body_length       = 0;
+    this->http_run_fsm      = HTTP_RUN_FSM_READ;
+    this->end_after_write   = false;
+    this->requests_served   = 0;
+    this->keep_alive        = false;
+    this->rx_timeout_saved  = false;
+    this->idle_rx_timeout   = false;
+    this->batch_begin_ns    = 0;
+    this->batch_requests    = 0;
+    this->rx_first_byte_ns  = 0;
+
+    this->client_ip[0]          = '\0';
+    this->client_ip_known       = false;
+    this->access_records_count  = 0;
+}
 
-    *((bool*)(this->ptr_to_resources_read_mutex->additional_data)) = true;
-    
-    MTX_GRD_INIT(this->ptr_to_resources_read_mutex.get());
+void HttpServer::SetKeepAlive(unsigned int timeout_secs, unsigned int max_requests)
+{
+    this->keep_alive_timeout    = timeout_secs;
+    this->keep_alive_requests   = max_requests;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -174,16 +175,25 @@ void HttpServer::InitResourcesMutex(void)
 
 int HttpServer::ReadFromClient(int& client_socket)
 {
-    char rx_buffer[HTTP_SERVER_LEN_RX_BUFFER];
     HTTP_READ_FSM http_read_fsm = HTTP_READ_FSM_READ_TRY;
-    ssize_t read_from_socket = -1;
+    long int read_from_socket = -1;
     bool keep_trying = true;
     int keep_connected = 0;
-    char client_IP_addr[INET_ADDRSTRLEN] = {};
 
-    memset(rx_buffer, 0, sizeof(rx_buffer));
-    this->read_from_client.clear();
-    ServerSocketGetClientIPv4(client_socket, client_IP_addr);
+    // Leftover bytes from pipelined requests may already hold a whole request.
+    if(this->CheckRequestEnd())
+        return 0;
+
+    // Otherwise, drop the requests that have already been answered and keep any partial one.
+    this->CompactRxBuffer();
+
+    // Data is pushed by the engine (FeedData) instead.
+    if(this->io_mode == HTTP_SERVER_IO_COMPLETION)
+        return HTTP_SERVER_IO_WAIT_READ;
+
+    // Event loops expire idle connections on their own; a blocking socket has to time out by itself.
+    if(this->io_mode == HTTP_SERVER_IO_BLOCKING)
+        this->SetIdleRxTimeout(client_socket, this->GetBufferedLength() == 0);
 
     while(keep_trying)
     {
@@ -191,43 +201,74 @@ int HttpServer::ReadFromClient(int& client_socket)
         {
             case HTTP_READ_FSM_READ_TRY:
             {
-                read_from_socket = SERVER_SOCKET_READ(client_socket, rx_buffer);
+                // Read straight into the spare capacity of the buffer, making it grow if needed.
+                if(this->rx_buffer.Reserve(HTTP_SERVER_LEN_RX_BUFFER) <= 0)
+                {
+                    HTTP_LOG_ERR(HTTP_SERVER_MSG_RX_BUFFER_FULL, this->rx_buffer.GetSize());
+                    keep_connected = HTTP_SERVER_ERR_RX_BUFFER_FULL;
+                    http_read_fsm = HTTP_READ_FSM_READ_END;
+                    break;
+                }
+
+                // Event-driven sockets belong to this library (plaintext only), so they are read directly.
+                if(this->io_mode == HTTP_SERVER_IO_NON_BLOCKING)
+                    read_from_socket = recv(client_socket, this->rx_buffer.GetWritePointer(), this->rx_buffer.GetFreeSpace(), 0);
+                else
+                    read_from_socket = ServerSocketRead(client_socket, this->rx_buffer.GetWritePointer(), this->rx_buffer.GetFreeSpace());
 
                 if(read_from_socket == 0)
                 {
-                    SVRTY_LOG_WNG(HTTP_SERVER_MSG_CLIENT_DISCONNECTED, client_IP_addr);
+                    // Peers closing their side is the normal end of every connection, hence only
+                    // logged by debug builds. The address is only looked up when it is logged.
+                    if(HTTP_LOG_LEVEL_DBG <= HTTP_LOG_LEVEL)
+                    {
+                        char client_IP_addr[INET_ADDRSTRLEN] = {};
+                        ServerSocketGetClientIPv4(client_socket, client_IP_addr);
+                        HTTP_LOG_DBG(HTTP_SERVER_MSG_CLIENT_DISCONNECTED, client_IP_addr);
+                    }
+
                     keep_connected = -1;
                     http_read_fsm = HTTP_READ_FSM_READ_END;
                 }
                 else if(read_from_socket > 0)
                 {
+                    if(this->GetBufferedLength() == 0)
+                        this->rx_first_byte_ns = HttpStats::GetNowNs();
+
+                    HttpStats::AddCounter(HTTP_STATS_COUNTER_BYTES_IN, read_from_socket);
                     keep_connected = 0;
                     http_read_fsm = HTTP_READ_FSM_ADD_TO_READ_DATA;
                 }
+                // Nothing left to be read from a non-blocking socket: come back once there is.
+                else if(this->io_mode == HTTP_SERVER_IO_NON_BLOCKING && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+                {
+                    keep_connected = HTTP_SERVER_IO_WAIT_READ;
+                    http_read_fsm = HTTP_READ_FSM_READ_END;
+                }
                 else // read_from_socket < 0
                 {
                     switch(errno)
                     {
                         // Firrst, let's fiñter well known errors, such as reset, abort or refusal messages sent by the peer.
                         case ECONNABORTED:
-                            SVRTY_LOG_WNG(HTTP_SERVER_MSG_ECONNABORTED, errno);
+                            HTTP_LOG_WNG(HTTP_SERVER_MSG_ECONNABORTED, errno);
                         break;
 
                         case ECONNRESET:
-                            SVRTY_LOG_WNG(HTTP_SERVER_MSG_ECONNRESET, errno);
+                            HTTP_LOG_WNG(HTTP_SERVER_MSG_ECONNRESET, errno);
                         break;
 
                         case ECONNREFUSED:
-                            SVRTY_LOG_WNG(HTTP_SERVER_MSG_ECONNREFUSED, errno);
+                            HTTP_LOG_WNG(HTTP_SERVER_MSG_ECONNREFUSED, errno);
                         break;
 
                         default:
                         {
                             // Other errors:
                             if(errno != EAGAIN && errno != EWOULDBLOCK && errno != 0)
-                                SVRTY_LOG_WNG(HTTP_SERVER_MSG_ERROR_WHILE_READING, errno);
+                                HTTP_LOG_WNG(HTTP_SERVER_MSG_ERROR_WHILE_READING, errno);
                             else // Timeout expiral
-                                SVRTY_LOG_WNG(HTTP_SERVER_MSG_READ_TMT_EXPIRED);
+                                HTTP_LOG_WNG(HTTP_SERVER_MSG_READ_TMT_EXPIRED);
                         }
                         break;
                     }
@@ -240,16 +281,21 @@ int HttpServer::ReadFromClient(int& client_socket)
 
             case HTTP_READ_FSM_ADD_TO_READ_DATA:
             {
-                this->read_from_client += rx_buffer;
-                memset(rx_buffer, 0, read_from_socket);
+                this->rx_buffer.Commit(read_from_socket);
 
                 if(this->CheckRequestEnd())
                 {
-                    SVRTY_LOG_DBG(HTTP_SERVER_MSG_DATA_READ_FROM_CLIENT, this->read_from_client.data());
+                    HTTP_LOG_DBG_PAYLOAD(HTTP_SERVER_MSG_DATA_READ_FROM_CLIENT, this->rx_buffer.GetSize(), this->rx_buffer.GetData());
                     http_read_fsm = HTTP_READ_FSM_READ_END;
                 }
                 else
+                {
+                    // A request has started: the rest of it is given the regular receive timeout.
+                    if(this->io_mode == HTTP_SERVER_IO_BLOCKING)
+                        this->SetIdleRxTimeout(client_socket, false);
+
                     http_read_fsm = HTTP_READ_FSM_READ_TRY;
+                }
             }
             break;
 
@@ -267,94 +313,267 @@ int HttpServer::ReadFromClient(int& client_socket)
     return keep_connected;
 }
 
-bool HttpServer::CheckRequestEnd(void)
+void HttpServer::SetIdleRxTimeout(int client_socket, bool idle)
 {
-    // Check first whether or not is the request message long enough.
-    if (this->read_from_client.length() < 4)
-        return false;
-    
-    std::string end = this->read_from_client.substr(this->read_from_client.length() - 4); // Extract last 4 characters
-    
-    return (end == HTTP_SERVER_HTTP_MSG_END);
+    if(this->keep_alive_timeout == 0 || idle == this->idle_rx_timeout)
+        return;
+
+    if(!this->rx_timeout_saved)
+    {
+        socklen_t timeout_len = sizeof(this->request_rx_timeout);
+
+        if(getsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &this->request_rx_timeout, &timeout_len) < 0)
+        {
+            HTTP_LOG_WNG(HTTP_SERVER_MSG_IDLE_TIMEOUT_ERROR, errno);
+            return;
+        }
+
+        this->rx_timeout_saved = true;
+    }
+
+    struct timeval timeout = this->request_rx_timeout;
+
+    if(idle)
+    {
+        timeout.tv_sec  = this->keep_alive_timeout;
+        timeout.tv_usec = 0;
+    }
+
+    if(setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0)
+    {
+        HTTP_LOG_WNG(HTTP_SERVER_MSG_IDLE_TIMEOUT_ERROR, errno);
+        return;
+    }
+
+    this->idle_rx_timeout = idle;
 }
 
-/////////////////////////////////////////////////////////////////////////////////////////
+void HttpServer::CompactRxBuffer(void)
+{
+    this->rx_buffer.Consume(this->request_begin);
+    this->scan_offset  -= this->request_begin;
+    if(this->header_end != HTTP_HEADER_SCAN_NOT_FOUND)
+        this->header_end -= this->request_begin;
+    this->request_begin = 0;
+}
+
+int HttpServer::FeedData(const char* data, size_t length)
+{
+    // Bytes of requests that have already been answered are not needed anymore.
+    if(this->request_begin > 0 && this->rx_buffer.GetFreeSpace() < length)
+        this->CompactRxBuffer();
+
+    if(this->rx_buffer.Reserve(length) < (long int)length)
+    {
+        HTTP_LOG_ERR(HTTP_SERVER_MSG_RX_BUFFER_FULL, this->rx_buffer.GetSize());
+        return HTTP_SERVER_ERR_RX_BUFFER_FULL;
+    }
+
+    memcpy(this->rx_buffer.GetWritePointer(), data, length);
+    this->rx_buffer.Commit(length);
+
+    HttpStats::AddCounter(HTTP_STATS_COUNTER_BYTES_IN, length);
+
+    return 0;
+}
+
+size_t HttpServer::GetBufferedLength(void) const
+{
+    return this->rx_buffer.GetSize() - this->request_begin;
+}
+
+bool HttpServer::CheckRequestEnd(void)
+{
+    // Header block already parsed: wait for the whole body to be there.
+    if(this->head_parsed)
+        return (this->rx_buffer.GetSize() - this->header_end >= this->body_length);
+
+    if(this->header_end != HTTP_HEADER_SCAN_NOT_FOUND)
+        return true;
+
+    std::string_view buffer = this->rx_buffer.GetView();
+
+    // Empty lines received before the request line are ignored (RFC 9112, section 2.2).
+    while(this->scan_offset == this->request_begin && buffer.substr(this->request_begin, 2) == "\r\n")
+    {
+        this->request_begin += 2;
+        this->scan_offset   += 2;
+    }
+
+    // Look for the end of the header block of the request currently at the front of the buffer,
+    // starting where the previous search gave up so that no byte is scanned twice.
+    this->header_end = HttpFindHeaderEnd(buffer.data(), buffer.size(), this->scan_offset);
+
+    if(this->header_end == HTTP_HEADER_SCAN_NOT_FOUND)
+    {
+        this->scan_offset = HttpHeaderScanResumeOffset(buffer.size(), this->scan_offset);
+
+        // A header block which is already longer than the limit will never be accepted, so let
+        // ProcessRequest reject it right away instead of waiting for (and storing) the rest.
+        return (buffer.size() - this->request_begin > HTTP_PARSER_MAX_HEADER_BLOCK_LEN);
+    }
+
+    return true;
+}
 
 /////////////////////////////////////////////////////////////////////////////////////////
 // Process request
 
 int HttpServer::ProcessRequest(void)
 {
-    // Process every line within the request except for the first one (it has already been analysed).
-    std::string line;
-    std::istringstream iss(this->read_from_client);
-    
-    std::getline(iss, line);
-    if(!line.empty() && line[line.size() - 1] == '\n')
-        line.erase(line.size() - 1);
-    if(!line.empty() && line[line.size() - 1] == '\r')
-        line.erase(line.size() - 1);
+    // Only the header block found by CheckRequestEnd is handed to the parser (or everything
+    // received so far if it is too long to have been found). Every field found within the
+    // request is a view into rx_buffer, so nothing is copied.
+    size_t head_end = (this->header_end != HTTP_HEADER_SCAN_NOT_FOUND) ? this->header_end : this->rx_buffer.GetSize();
+    std::string_view request_head = this->rx_buffer.GetView().substr(this->request_begin, head_end - this->request_begin);
+
+    // Back here once the body has arrived: the header block has already been parsed, but the
+    // buffer may have been moved or reallocated since then, so just point the parser to it again.
+    if(this->head_parsed)
+    {
+        this->request_parser.Parse(request_head);
+        return 0;
+    }
 
-    // Clean all values found within request_fields map.
-    for(std::pair<const std::string, std::string>& p : this->request_fields)
-        p.second = "";
+    this->request_parser.Reset();
 
-    std::vector<std::string> words_from_req_line = this->ExtractWordsFromReqLine(line);
+    int parse_request = this->request_parser.Parse(request_head);
 
-    SVRTY_LOG_DBG(HTTP_SERVER_MSG_RQST_METHOD     , words_from_req_line[0].c_str());
-    SVRTY_LOG_DBG(HTTP_SERVER_MSG_RQST_RESOURCE   , words_from_req_line[1].c_str());
-    SVRTY_LOG_DBG(HTTP_SERVER_MSG_RQST_PROTOCOL   , words_from_req_line[2].c_str());
+    if(parse_request != HTTP_PARSE_DONE)
+    {
+        HTTP_LOG_WNG(HTTP_SERVER_MSG_RQST_PARSE_FAILED, parse_request);
 
-    this->request_fields.at("Method")             = words_from_req_line[0];
-    this->request_fields.at("Requested resource") = words_from_req_line[1];
-    this->request_fields.at("Protocol")           = words_from_req_line[2];
+        switch(parse_request)
+        {
+            case HTTP_PARSE_ERR_REQUEST_LINE_TOO_LONG:
+                this->AddErrorResponse(HTTP_STATUS_414);
+            break;
+
+            case HTTP_PARSE_ERR_HEADERS_TOO_LARGE:
+                this->AddErrorResponse(HTTP_STATUS_431);
+            break;
+
+            default:
+                this->AddErrorResponse(HTTP_STATUS_400);
+            break;
+        }
 
-    if(this->request_fields.at("Method").empty() || this->request_fields.at("Requested resource").empty() || this->request_fields.at("Protocol").empty())
-    {
-        SVRTY_LOG_ERR(HTTP_SERVER_MSG_BASIC_RQST_FIELD_MISSING);
         return HTTP_SERVER_ERR_BASIC_RQST_FIELDS_FAILED;
     }
 
-    while(std::getline(iss, line))
+    // Where CheckRequestEnd found it as well, as both only accept CRLF line endings (unless it gave
+    // up on the header block limit before finding it).
+    this->header_end = this->request_begin + this->request_parser.GetHeaderBlockLength();
+
+    std::string_view method     = this->request_parser.GetMethod()      ;
+    std::string_view resource   = this->request_parser.GetTarget()      ;
+    std::string_view protocol   = this->request_parser.GetProtocol()    ;
+
+    HTTP_LOG_DBG(HTTP_SERVER_MSG_RQST_METHOD     , (int)method.size()  , method.data()     );
+    HTTP_LOG_DBG(HTTP_SERVER_MSG_RQST_RESOURCE   , (int)resource.size(), resource.data()   );
+    HTTP_LOG_DBG(HTTP_SERVER_MSG_RQST_PROTOCOL   , (int)protocol.size(), protocol.data()   );
+
+    int get_body_length = this->GetRequestBodyLength();
+    if(get_body_length < 0)
+        return get_body_length;
+
+    this->head_parsed = true;
+
+    if(this->CheckRequestEnd())
+        return 0;
+
+    // The client may be waiting for an interim response before sending the body (RFC 9110, section 10.1.1).
+    if(this->request_parser.GetHeader(HTTP_HDR_EXPECT) == "100-continue")
+    {
+        HTTP_RESPONSE& response = this->AddResponse();
+        HttpBeginResponseHeader(response.header, HTTP_STATUS_100);
+        response.header.append("\r\n");
+    }
+
+    return HTTP_SERVER_RQST_BODY_PENDING;
+}
+
+int HttpServer::GetRequestBodyLength(void)
+{
+    this->body_length = 0;
+
+    // Only Content-Length delimited bodies are supported (RFC 9112, section 6.1: 501 otherwise).
+    if(this->request_parser.HasHeader(HTTP_HDR_TRANSFER_ENCODING))
+    {
+        std::string_view transfer_encoding = this->request_parser.GetHeader(HTTP_HDR_TRANSFER_ENCODING);
+        HTTP_LOG_WNG(HTTP_SERVER_MSG_UNSUPPORTED_TRANSFER_CODING, (int)transfer_encoding.size(), transfer_encoding.data());
+        this->AddErrorResponse(HTTP_STATUS_501);
+        return HTTP_SERVER_ERR_UNSUPPORTED_TRANSFER_CODING;
+    }
+
+    if(!this->request_parser.HasHeader(HTTP_HDR_CONTENT_LENGTH))
+        return 0;
+
+    std::string_view content_length = this->request_parser.GetHeader(HTTP_HDR_CONTENT_LENGTH);
+
+    // Several differing lengths: whichever one is picked, another hop may pick a different one and
+    // see a different request there (RFC 9112, section 6.3).
+    if(this->request_parser.HasDifferingHeaders(HTTP_HDR_CONTENT_LENGTH))
     {
-        size_t pos = line.find(": ");
-        std::string key;
-        std::string value;
-        
-        if(!line.empty() && line[line.size() - 1] == '\n')
-            line.erase(line.size() - 1);
-        if(!line.empty() && line[line.size() - 1] == '\r')
-            line.erase(line.size() - 1);
+        HTTP_LOG_WNG(HTTP_SERVER_MSG_INVALID_CONTENT_LENGTH, (int)content_length.size(), content_length.data());
+        this->AddErrorResponse(HTTP_STATUS_400);
+        return HTTP_SERVER_ERR_INVALID_CONTENT_LENGTH;
+    }
 
-        if(line.empty())
-            continue;
+    unsigned long head_length = this->header_end - this->request_begin;
+    unsigned long max_length  = this->rx_buffer.GetMaxCapacity();
+
+    // Content-Length = 1*DIGIT. Anything else makes the message framing unreliable, so the connection is closed.
+    size_t digits = 0;
+    for(; digits < content_length.size() && content_length[digits] >= '0' && content_length[digits] <= '9'; digits++)
+    {
+        this->body_length = this->body_length * 10 + (content_length[digits] - '0');
 
-        // If ": " found, split the line into two parts
-        if (pos != std::string::npos)
+        // Stop before overflowing: the request is already too large anyway.
+        if(this->body_length > max_length)
         {
-            key     = line.substr(0, pos);  // Before ": "
-            value   = line.substr(pos + 2); // After ": "
+            HTTP_LOG_WNG(HTTP_SERVER_MSG_REQUEST_TOO_LARGE, head_length + this->body_length, max_length);
+            this->AddErrorResponse(HTTP_STATUS_413);
+            return HTTP_SERVER_ERR_REQUEST_TOO_LARGE;
         }
+    }
 
-        if(this->request_fields.count(key) != 0)
-            this->request_fields.at(key) = value;
-        else
-            SVRTY_LOG_WNG(HTTP_SERVER_MSG_UNKNOWN_RQST_FIELD, key.c_str());
+    if(digits == 0 || digits != content_length.size())
+    {
+        HTTP_LOG_WNG(HTTP_SERVER_MSG_INVALID_CONTENT_LENGTH, (int)content_length.size(), content_length.data());
+        this->AddErrorResponse(HTTP_STATUS_400);
+        return HTTP_SERVER_ERR_INVALID_CONTENT_LENGTH;
+    }
+
+    if(head_length + this->body_length > max_length)
+    {
+        HTTP_LOG_WNG(HTTP_SERVER_MSG_REQUEST_TOO_LARGE, head_length + this->body_length, max_length);
+        this->AddErrorResponse(HTTP_STATUS_413);
+        return HTTP_SERVER_ERR_REQUEST_TOO_LARGE;
     }
 
     return 0;
 }
 
-std::vector<std::string> HttpServer::ExtractWordsFromReqLine(const std::string& input)
+void HttpServer::AddErrorResponse(HTTP_STATUS status)
 {
-    std::vector<std::string> words;
-    std::istringstream iss(input);
-    std::string word;
+    // The connection is closed right after sending it: the pre-rendered header says so.
+    HTTP_RESPONSE& response = this->AddResponse();
 
-    while (iss >> word)
-        words.push_back(word);
+    HttpBeginResponseHeader(response.header, status);
+    response.header.append("\r\n");
+
+    HttpStats::RecordStatus(status);
+    this->AddAccessRecord(status, response.header.size());
+}
 
-    return words;
+void HttpServer::ConsumeRequest(void)
+{
+    this->request_begin  = this->header_end + this->body_length;
+    this->scan_offset    = this->request_begin;
+    this->header_end     = HTTP_HEADER_SCAN_NOT_FOUND;
+    this->head_parsed    = false;
+    this->body_length    = 0;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -362,17 +581,25 @@ std::vector<std::string> HttpServer::ExtractWordsFromReqLine(const std::string&
 
 long int HttpServer::GenerateResponse(void)
 {
-    std::string content_type ;
+    std::string_view content_type;
     std::string resource_to_send;
     long int requested_resource_size;
-    std::string resource_file;
+    std::shared_ptr<const std::string> resource_file;
     bool generating_response = true;
     HTTP_GEN_RESP_FSM http_gen_resp_fsm = HTTP_GEN_RESP_FSM_CHECK_REQUEST_METHOD;
     int gen_resp_error = 0;
+    bool stats_prometheus = false;
+
+    // Take a new (empty) response slot from the queue, and clear the status code. Multipart
+    // responses take more slots after this one: it is only referenced by index from then on.
+    const size_t response_index = this->responses_count;
+    HTTP_RESPONSE& response = this->AddResponse();
+    this->http_response_status = HTTP_STATUS_200;
 
-    // Clear the response string before starting, as well as request and response fields.
-    this->http_response.clear()             ;
-    this->http_response_status_code.clear() ;
+    // Requests pipelined after the last one the connection carries are left unanswered.
+    this->keep_alive = this->CheckKeepAlive();
+    if(!this->keep_alive)
+        this->end_after_write = true;
 
     while(generating_response)
     {
@@ -382,12 +609,15 @@ long int HttpServer::GenerateResponse(void)
             {
                 // NOTE: according to RFC 9110 (HTTP semantics), 
                 // "All general-purpose servers MUST support the methods GET and HEAD. All other methods are OPTIONAL."
-                switch( this->ptr_method_to_uint->at(this->request_fields.at("Method")) )
+                switch( method_to_uint.Find(this->request_parser.GetMethod(), HTTP_SERVER_METHOD_CODE_UNKNOWN) )
                 {
                     case HTTP_SERVER_METHOD_CODE_GET :
                     case HTTP_SERVER_METHOD_CODE_HEAD:
                     {
-                        http_gen_resp_fsm = HTTP_GEN_RESP_FSM_GET_PATH_TO_RESOURCE;
+                        if(HttpStats::GetInstance().IsStatsTarget(this->request_parser.GetTarget(), stats_prometheus))
+                            http_gen_resp_fsm = HTTP_GEN_RESP_FSM_BUILD_STATS_RESPONSE;
+                        else
+                            http_gen_resp_fsm = HTTP_GEN_RESP_FSM_GET_PATH_TO_RESOURCE;
                     }
                     break;
 
@@ -399,7 +629,8 @@ long int HttpServer::GenerateResponse(void)
 
                     default:
                     {
-                        SVRTY_LOG_WNG(HTTP_SERVER_MSG_UNSUPPORTED_METHOD, this->request_fields.at("Method").c_str());
+                        std::string_view method = this->request_parser.GetMethod();
+                        HTTP_LOG_WNG(HTTP_SERVER_MSG_UNSUPPORTED_METHOD, (int)method.size(), method.data());
                         http_gen_resp_fsm = HTTP_GEN_RESP_FSM_BUILD_SERVER_UNSUPPORTED_METHOD_RESPONSE;
                     }
                     break;
@@ -419,18 +650,27 @@ long int HttpServer::GenerateResponse(void)
             // Check whether or not does the requested resource matches a supported type.
             case HTTP_GEN_RESP_FSM_CHECK_RESOURCE_EXTENSION:
             {
-                try
-                {
-                    // Get file extension of the resource to be sent, then get its proper content type.
-                    content_type = std::string( this->ptr_extension_to_content->at( this->ParseFileExtension(resource_to_send) ) );
-                }
-                catch(const std::out_of_range& e)
+                // Get file extension of the resource to be sent, then get its proper content type.
+                std::string file_extension = this->ParseFileExtension(resource_to_send);
+
+                if(this->resource.manifest_entry != nullptr)
+                    content_type = this->resource.manifest_entry->content_type;
+                else
+                    content_type = extension_to_content_type.Find(file_extension, "");
+
+                if(content_type.empty())
                 {
-                    SVRTY_LOG_WNG(HTTP_SERVER_MSG_UNKNOWN_CONTENT_TYPE, this->ParseFileExtension(resource_to_send).c_str());
+                    HTTP_LOG_WNG(HTTP_SERVER_MSG_UNKNOWN_CONTENT_TYPE, file_extension.c_str());
 
-                    content_type = std::string( this->ptr_extension_to_content->at("default"));
+                    content_type = HTTP_SERVER_DEFAULT_CONTENT_TYPE;
                 }
 
+                // The 404 page is not the requested resource, so no policy applies to it.
+                if(this->resource_not_found)
+                    this->cache_policy.reset();
+                else
+                    this->cache_policy = HttpCachePolicyTable::GetInstance().Find(this->resource_target, file_extension, this->GetMIMEDataType(content_type));
+
                 http_gen_resp_fsm = HTTP_GEN_RESP_FSM_GET_REQUESTED_RESOURCE_SIZE;
             }
             break;
@@ -440,7 +680,60 @@ long int HttpServer::GenerateResponse(void)
             {
                 requested_resource_size = this->GetRequestedResourceSize(resource_to_send);
 
+                // Validators are only given for the resource itself, not for the 404 page.
+                if(this->resource_not_found || requested_resource_size < 0)
+                    this->validators.reset();
+                else if(this->resource.manifest_entry != nullptr)
+                    this->validators = this->resource.manifest_entry->validators;
+                else
+                    this->validators = HttpValidatorCache::GetInstance().Get(resource_to_send, this->resource_stat);
+
+                http_gen_resp_fsm = HTTP_GEN_RESP_FSM_SELECT_CONTENT_ENCODING;
+            }
+            break;
+
+            // Compressed representation, if the client accepts one and it is ready. From here on,
+            // resource_to_send and requested_resource_size refer to the representation being sent.
+            case HTTP_GEN_RESP_FSM_SELECT_CONTENT_ENCODING:
+            {
+                this->SelectContentEncoding(content_type, resource_to_send, requested_resource_size);
+
+                http_gen_resp_fsm = HTTP_GEN_RESP_FSM_CHECK_CONDITIONAL;
+            }
+            break;
+
+            // Conditional requests (RFC 9110 section 13.2.2): evaluated before Range, and before the
+            // body is ever opened, so that a cached copy costs just a header.
+            case HTTP_GEN_RESP_FSM_CHECK_CONDITIONAL:
+            {
+                if(this->CheckNotModified())
+                    http_gen_resp_fsm = HTTP_GEN_RESP_FSM_BUILD_NOT_MODIFIED_RESPONSE;
+                else
+                    http_gen_resp_fsm = HTTP_GEN_RESP_FSM_CHECK_RANGE;
+            }
+            break;
+
+            // Range requests (GET only, RFC 9110 section 14.2): answer just the requested bytes.
+            case HTTP_GEN_RESP_FSM_CHECK_RANGE:
+            {
                 http_gen_resp_fsm = HTTP_GEN_RESP_FSM_BUILD_RESPONSE_HEADER;
+
+                if(this->resource_not_found || requested_resource_size < 0 || this->request_parser.GetMethod() != "GET")
+                    break;
+
+                switch(this->CheckRange(requested_resource_size))
+                {
+                    case HTTP_RANGE_SATISFIABLE:
+                        http_gen_resp_fsm = (this->ranges.size() == 1) ? HTTP_GEN_RESP_FSM_BUILD_PARTIAL_RESPONSE : HTTP_GEN_RESP_FSM_BUILD_MULTIPART_RESPONSE;
+                    break;
+
+                    case HTTP_RANGE_NOT_SATISFIABLE:
+                        http_gen_resp_fsm = HTTP_GEN_RESP_FSM_BUILD_RANGE_NOT_SATISFIABLE_RESPONSE;
+                    break;
+
+                    default:
+                    break;
+                }
             }
             break;
 
@@ -448,50 +741,190 @@ long int HttpServer::GenerateResponse(void)
             case HTTP_GEN_RESP_FSM_BUILD_RESPONSE_HEADER:
             {
                 if(this->resource_not_found)
-                    this->http_response_status_code = HTTP_SERVER_STATUS_CODE_404;
+                    this->http_response_status = HTTP_STATUS_404;
                 else
-                    this->http_response_status_code = HTTP_SERVER_STATUS_CODE_200;
-
-                this->http_response =   this->request_fields.at("Protocol") + " " + this->http_response_status_code + "\r\n"
-                                        "Content-Type: "        +   content_type                                    + "\r\n" +
-                                        "Content-Length: "      +   std::to_string(requested_resource_size)         + "\r\n" +
-                                        "Connection: "          +   this->request_fields.at("Connection")           + "\r\n" +
-                                        "\r\n";
+                    this->http_response_status = HTTP_STATUS_200;
+
+                HttpBeginResponseHeader(response.header, this->http_response_status);
+                // Unlike TRACE or statistics responses, files may be asked for in ranges.
+                if(this->http_response_status == HTTP_STATUS_200)
+                    response.header.append(HTTP_RESPONSE_HEADER_RANGES_FIELDS);
+                response.header.append("Content-Type: "     ).append(content_type                                       ).append("\r\n");
+                HttpAppendContentLength(response.header, requested_resource_size);
+                if(this->content_encoding != HTTP_CONTENT_ENCODING_IDENTITY)
+                    response.header.append("Content-Encoding: " ).append(HttpContentEncodingName(this->content_encoding)).append("\r\n");
+                this->AddValidators(response.header);
+                this->AddCacheDirectives(response.header);
+                this->AddConnectionHeader(response.header);
+                response.header.append("\r\n");
 
                 // If request method is GET, then add the resource file as string as well.            
-                if(this->request_fields.at("Method") == "GET")
+                if(this->request_parser.GetMethod() == "GET")
                     http_gen_resp_fsm = HTTP_GEN_RESP_FSM_BUILD_ADD_RESOURCE;
                 else
                     http_gen_resp_fsm = HTTP_GEN_RESP_FSM_END_GEN_RESP;
             }
             break;
 
-            // Add response body for GET method requests.
+            // Add response body for GET method requests. The body is not copied into the response string:
+            // files small enough to be cached are shared from memory, larger ones are streamed from disk.
             case HTTP_GEN_RESP_FSM_BUILD_ADD_RESOURCE:
             {
-                int get_resource = this->CopyFileToString(resource_to_send, resource_file);
-                if(get_resource < 0)
+                int get_resource;
+
+                if(this->encoded_body != nullptr)
                 {
+                    response.body       = this->encoded_body;
+                    response.body_src   = HTTP_BODY_SRC_MEMORY;
+                    http_gen_resp_fsm   = HTTP_GEN_RESP_FSM_END_GEN_RESP;
+                    break;
+                }
+
+                if((unsigned long)requested_resource_size > this->file_cache.GetMaxEntryBytes())
+                    get_resource = this->OpenResourceFile(resource_to_send, 0, requested_resource_size, response);
+                else
+                    get_resource = this->CopyFileToString(resource_to_send, resource_file);
+
+                if(get_resource < 0)
                     gen_resp_error = get_resource;
+                // Should the file have changed in between anyway, the header is not sent with a body
+                // it does not describe.
+                else if(resource_file != nullptr && (long int)resource_file->size() != requested_resource_size)
+                {
+                    HTTP_LOG_ERR(HTTP_SERVER_MSG_RESOURCE_CHANGED, resource_to_send.c_str(), requested_resource_size, resource_file->size());
+                    gen_resp_error = HTTP_SERVER_ERR_RESOURCE_CHANGED;
+                }
+                else if(resource_file != nullptr)
+                {
+                    response.body       = resource_file;
+                    response.body_src   = HTTP_BODY_SRC_MEMORY;
+                }
 
-                    http_gen_resp_fsm = HTTP_GEN_RESP_FSM_END_GEN_RESP;
+                http_gen_resp_fsm = HTTP_GEN_RESP_FSM_END_GEN_RESP;
+            }
+            break;
+
+            // Single range: always streamed from the file, whatever its size, so that memory stays
+            // bounded by the transfer chunk instead of the range.
+            case HTTP_GEN_RESP_FSM_BUILD_PARTIAL_RESPONSE:
+            {
+                const HTTP_BYTE_RANGE& range = this->ranges[0];
+                off_t range_len = range.last - range.first + 1;
+
+                this->http_response_status = HTTP_STATUS_206;
+
+                HttpBeginResponseHeader(response.header, this->http_response_status);
+                response.header.append("Content-Type: "     ).append(content_type                                       ).append("\r\n");
+                this->AddContentRange(response.header, range, requested_resource_size);
+                HttpAppendContentLength(response.header, range_len);
+                this->AddValidators(response.header);
+                this->AddCacheDirectives(response.header);
+                this->AddConnectionHeader(response.header);
+                response.header.append("\r\n");
+
+                gen_resp_error = this->OpenResourceFile(resource_to_send, range.first, range.last + 1, response);
+
+                http_gen_resp_fsm = HTTP_GEN_RESP_FSM_END_GEN_RESP;
+            }
+            break;
+
+            // Several ranges: multipart/byteranges body (RFC 9110 section 14.6). Every part takes a
+            // response slot of its own (boundary and part header, then the range streamed from the
+            // file) plus a last one for the closing boundary, so parts go out exactly like pipelined
+            // responses do and no range is ever held in memory.
+            case HTTP_GEN_RESP_FSM_BUILD_MULTIPART_RESPONSE:
+            {
+                std::string first_part_header;
+                off_t content_length = 0;
+
+                this->http_response_status = HTTP_STATUS_206;
+
+                for(size_t i = 0; i < this->ranges.size(); i++)
+                {
+                    std::string& part_header = (i == 0) ? first_part_header : this->AddResponse().header;
+
+                    if(i > 0)
+                        part_header.append("\r\n");
+
+                    part_header.append("--").append(this->multipart_boundary).append("\r\n");
+                    part_header.append("Content-Type: ").append(content_type).append("\r\n");
+                    this->AddContentRange(part_header, this->ranges[i], requested_resource_size);
+                    part_header.append("\r\n");
+
+                    content_length += part_header.size() + (this->ranges[i].last - this->ranges[i].first + 1);
                 }
-                
-                this->http_response += resource_file;
+
+                std::string& closing_boundary = this->AddResponse().header;
+                closing_boundary.append("\r\n--").append(this->multipart_boundary).append("--\r\n");
+                content_length += closing_boundary.size();
+
+                std::string& header = this->responses[response_index].header;
+
+                HttpBeginResponseHeader(header, this->http_response_status);
+                header.append("Content-Type: multipart/byteranges; boundary=").append(this->multipart_boundary).append("\r\n");
+                HttpAppendContentLength(header, content_length);
+                this->AddValidators(header);
+                this->AddCacheDirectives(header);
+                this->AddConnectionHeader(header);
+                header.append("\r\n");
+                header.append(first_part_header);
+
+                for(size_t i = 0; i < this->ranges.size() && gen_resp_error == 0; i++)
+                    gen_resp_error = this->OpenResourceFile(resource_to_send, this->ranges[i].first, this->ranges[i].last + 1, this->responses[response_index + i]);
 
                 http_gen_resp_fsm = HTTP_GEN_RESP_FSM_END_GEN_RESP;
             }
             break;
 
-            case HTTP_GEN_RESP_FSM_BUILD_TRACE_RESPONSE:
+            case HTTP_GEN_RESP_FSM_BUILD_RANGE_NOT_SATISFIABLE_RESPONSE:
+            {
+                std::string_view range = this->request_parser.GetHeader(HTTP_HDR_RANGE);
+                HTTP_LOG_WNG(HTTP_SERVER_MSG_RANGE_NOT_SATISFIABLE, (int)range.size(), range.data(), requested_resource_size);
+
+                this->http_response_status = HTTP_STATUS_416;
+
+                HttpBeginResponseHeader(response.header, this->http_response_status);
+                response.header.append("Content-Range: bytes */");
+                HttpAppendNumber(response.header, requested_resource_size);
+                response.header.append("\r\n");
+                response.header.append("Content-Length: 0\r\n");
+                this->AddConnectionHeader(response.header);
+                response.header.append("\r\n");
+
+                http_gen_resp_fsm = HTTP_GEN_RESP_FSM_END_GEN_RESP;
+            }
+            break;
+
+            // Header only: no Content-Length (it would describe the body that is not sent) and the
+            // file is neither opened nor read.
+            case HTTP_GEN_RESP_FSM_BUILD_NOT_MODIFIED_RESPONSE:
             {
-                this->http_response_status_code = HTTP_SERVER_STATUS_CODE_200;
-                content_type = this->ptr_extension_to_content->at("http");
+                this->http_response_status = HTTP_STATUS_304;
+
+                HttpBeginResponseHeader(response.header, this->http_response_status);
+                this->AddValidators(response.header);
+                this->AddCacheDirectives(response.header);
+                this->AddConnectionHeader(response.header);
+                response.header.append("\r\n");
+
+                http_gen_resp_fsm = HTTP_GEN_RESP_FSM_END_GEN_RESP;
+            }
+            break;
 
-                this->http_response =   this->request_fields.at("Protocol") + " " + this->http_response_status_code + "\r\n"
-                                        "Content-Type: " + content_type + "\r\n"
-                                        "\r\n" +
-                                        this->read_from_client;
+            case HTTP_GEN_RESP_FSM_BUILD_TRACE_RESPONSE:
+            {
+                this->http_response_status = HTTP_STATUS_200;
+                content_type = extension_to_content_type.Find("http", HTTP_SERVER_DEFAULT_CONTENT_TYPE);
+
+                HttpBeginResponseHeader(response.header, this->http_response_status);
+                // Echo the request being answered (not the whole buffer, as it may hold pipelined requests too).
+                std::string_view request = this->rx_buffer.GetView().substr(this->request_begin, this->request_parser.GetHeaderBlockLength());
+
+                response.header.append("Content-Type: ").append(content_type).append("\r\n");
+                HttpAppendContentLength(response.header, request.size());
+                this->AddConnectionHeader(response.header);
+                response.header.append("\r\n");
+                response.header.append(request);
                 
                 http_gen_resp_fsm = HTTP_GEN_RESP_FSM_END_GEN_RESP;
             }
@@ -499,14 +932,41 @@ long int HttpServer::GenerateResponse(void)
 
             case HTTP_GEN_RESP_FSM_BUILD_SERVER_UNSUPPORTED_METHOD_RESPONSE:
             {
-                this->http_response_status_code = HTTP_SERVER_STATUS_CODE_405;
-                content_type = this->ptr_extension_to_content->at("txt");
+                this->http_response_status = HTTP_STATUS_405;
+                content_type = extension_to_content_type.Find("txt", HTTP_SERVER_DEFAULT_CONTENT_TYPE);
+
+                HttpBeginResponseHeader(response.header, this->http_response_status);
+                response.header.append("Content-Type: ").append(content_type).append("\r\n");
+                response.header.append("Content-Length: 30\r\n");
+                this->AddConnectionHeader(response.header);
+                response.header.append("\r\n");
+                response.header.append("METHOD NOT SUPPORTED BY SERVER");
+
+                http_gen_resp_fsm = HTTP_GEN_RESP_FSM_END_GEN_RESP;
+            }
+            break;
+
+            // Server statistics, taken right now: never to be stored by caches.
+            case HTTP_GEN_RESP_FSM_BUILD_STATS_RESPONSE:
+            {
+                std::shared_ptr<std::string> stats = std::make_shared<std::string>();
+                HttpStats::GetInstance().Render(stats_prometheus, *stats);
+
+                this->http_response_status = HTTP_STATUS_200;
+                content_type = stats_prometheus ? HTTP_STATS_CONTENT_TYPE_PROMETHEUS : HTTP_STATS_CONTENT_TYPE_JSON;
 
-                this->http_response =   this->request_fields.at("Protocol") + " " + this->http_response_status_code + "\r\n"
-                                        "Content-Type: " + content_type + "\r\n"
-                                        "Content-Length: 30\r\n"
-                                        "\r\n"
-                                        "METHOD NOT SUPPORTED BY SERVER";
+                HttpBeginResponseHeader(response.header, this->http_response_status);
+                response.header.append("Content-Type: ").append(content_type).append("\r\n");
+                HttpAppendContentLength(response.header, stats->size());
+                response.header.append("Cache-Control: no-store\r\n");
+                this->AddConnectionHeader(response.header);
+                response.header.append("\r\n");
+
+                if(this->request_parser.GetMethod() == "GET")
+                {
+                    response.body       = std::move(stats);
+                    response.body_src   = HTTP_BODY_SRC_MEMORY;
+                }
 
                 http_gen_resp_fsm = HTTP_GEN_RESP_FSM_END_GEN_RESP;
             }
@@ -524,33 +984,68 @@ long int HttpServer::GenerateResponse(void)
         }
     }
 
+    // Streamed bodies hold descriptors of their own by now.
+    this->ReleaseResource(this->resource);
+
+    // Nothing of a failed response is sent: its slots are handed back, so that only the responses
+    // queued before it are written.
     if(gen_resp_error < 0)
+    {
+        while(this->responses_count > response_index)
+        {
+            HTTP_RESPONSE& failed_response = this->responses[--this->responses_count];
+
+            failed_response.body.reset();
+            this->CloseResourceFile(failed_response);
+        }
+
         return gen_resp_error;
-    
-    return this->http_response.size();
+    }
+
+    HttpStats::RecordStatus(this->http_response_status);
+
+    long int response_length = 0;
+
+    for(size_t i = response_index; i < this->responses_count; i++)
+        response_length += this->GetResponseLength(this->responses[i]);
+
+    this->AddAccessRecord(this->http_response_status, response_length);
+
+    return response_length;
 }
 
 const std::string HttpServer::GetPathToRequestedResource(void)
 {
-    std::string requested_resource_aux = std::string(this->request_fields.at("Requested resource"));
+    // Clear resource_not_found first, along with whatever the former request resolved.
+    this->resource_not_found = false;
+    this->ReleaseResource(this->resource);
+
+    HttpResourceManifest::GetInstance().Refresh(this->manifest, this->manifest_generation);
+    HttpResourceResolver::GetInstance().Refresh(this->path_to_resources, this->resources_root, this->resources_root_generation);
 
+    // Query, percent-encoding and dot segments are dealt with before anything is looked up, so
+    // that targets leading outside the resources directory are simply not found.
+    if(!HttpResourceResolver::NormalizeTarget(this->request_parser.GetTarget(), this->resource_target))
+        this->resource_not_found = true;
     // If no resource has been specified, then return the index page by default.
-    if(this->request_fields.at("Requested resource") == "" || this->request_fields.at("Requested resource") == "/")
-        requested_resource_aux = HTTP_SERVER_DEFAULT_PAGE;
-    
-    // Clear resource_not_found first.
-    this->resource_not_found = false;
+    else if(this->resource_target == "/")
+        this->resource_target = HTTP_SERVER_DEFAULT_PAGE;
+
+    std::string requested_resource = this->GetPathToResources() + this->resource_target;
 
     // Then check if the target resource exist.
-    if(this->FileExists(this->GetPathToResources() + requested_resource_aux))
-        requested_resource_aux = this->GetPathToResources() + requested_resource_aux;
-    else
+    if(this->resource_not_found || !this->ResolveResource(this->resource_target, requested_resource, this->resource))
     {
         this->resource_not_found    = true;
-        requested_resource_aux      = this->GetPathToResources() + HTTP_SERVER_DEFAULT_ERROR_404_PAGE_PATH;
+        this->resource_target       = HTTP_SERVER_DEFAULT_ERROR_404_PAGE_PATH;
+        requested_resource          = this->GetPathToResources() + this->resource_target;
+
+        this->ResolveResource(this->resource_target, requested_resource, this->resource);
     }
 
-    return (const std::string)requested_resource_aux;
+    this->resource_stat = this->resource.file_stat;
+
+    return (const std::string)requested_resource;
 }
 
 const std::string HttpServer::GetPathToResources(void)
@@ -558,9 +1053,85 @@ const std::string HttpServer::GetPathToResources(void)
     return this->path_to_resources;
 }
 
-bool HttpServer::FileExists(const std::string& filePath)
+bool HttpServer::ResolveResource(const std::string& target, const std::string& path, HTTP_RESOLVED_RESOURCE& resolved)
 {
-    return std::filesystem::exists(filePath) && std::filesystem::is_regular_file(filePath);
+    // Files known to the manifest need no lookup on disk.
+    resolved.manifest_entry = HttpResourceManifest::Find(this->manifest, path);
+    if(resolved.manifest_entry != nullptr)
+    {
+        resolved.file_stat = resolved.manifest_entry->file_stat;
+
+        // Bodies that were not preloaded are read from the file as it is now.
+        if(resolved.manifest_entry->body == nullptr && this->request_parser.GetMethod() == "GET")
+            return this->ConfirmManifestEntry(target, path, resolved);
+
+        return true;
+    }
+
+    // Neither do hot ones: the cache keeps the metadata of the version it holds (checked against
+    // the file at most once per HTTP_FILE_CACHE_REVALIDATE_MS).
+    if(this->file_cache.Lookup(path, resolved.body, resolved.file_stat, this->file_cache_reader))
+        return true;
+
+    // Anything else is opened (once) below the resources directory, unless it was found missing lately.
+    resolved.fd = HttpResourceResolver::GetInstance().Open(this->resources_root, target, path, resolved.file_stat);
+
+    return (resolved.fd >= 0);
+}
+
+bool HttpServer::ConfirmManifestEntry(const std::string& target, const std::string& path, HTTP_RESOLVED_RESOURCE& resolved)
+{
+    // The body to be sent is taken right away, so that the response is described after it rather
+    // than after the manifest: the file may have changed since it was built (no watcher running, or
+    // changes not applied yet), and a Content-Length not matching the body would break the framing
+    // of every response sent after this one on the connection.
+    struct stat file_stat;
+
+    if(this->file_cache.Lookup(path, resolved.body, file_stat, this->file_cache_reader))
+    {
+        if(!IsSameFileVersion(file_stat, resolved.file_stat))
+        {
+            resolved.manifest_entry = nullptr;
+            resolved.file_stat      = file_stat;
+        }
+
+        return true;
+    }
+
+    resolved.fd = HttpResourceResolver::GetInstance().Open(this->resources_root, target, path, file_stat);
+
+    if(resolved.fd < 0)
+    {
+        resolved.manifest_entry = nullptr;
+        return false;
+    }
+
+    // Changed since: answered as any file the manifest does not know about.
+    if(!IsSameFileVersion(file_stat, resolved.file_stat))
+    {
+        resolved.manifest_entry = nullptr;
+        resolved.file_stat      = file_stat;
+    }
+
+    return true;
+}
+
+int HttpServer::OpenResource(const std::string& path)
+{
+    if(this->resource.fd < 0)
+        this->resource.fd = HttpResourceResolver::GetInstance().Open(this->resources_root, this->resource_target, path, this->resource.file_stat);
+
+    return this->resource.fd;
+}
+
+void HttpServer::ReleaseResource(HTTP_RESOLVED_RESOURCE& resolved)
+{
+    if(resolved.fd >= 0)
+        close(resolved.fd);
+
+    resolved.manifest_entry = nullptr;
+    resolved.fd             = -1;
+    resolved.body.reset();
 }
 
 std::string HttpServer::ParseFileExtension(const std::string& text)
@@ -575,51 +1146,371 @@ std::string HttpServer::ParseFileExtension(const std::string& text)
 
 long int HttpServer::GetRequestedResourceSize(const std::string& resource_to_send)
 {
-    std::ifstream file(resource_to_send, std::ios::binary | std::ios::ate); // Open file in binary mode and move the file pointer to the end
-    
-    if (!file.is_open())
+    // Its metadata was taken when resolving it (nothing was found if not even the 404 page exists).
+    if(this->resource.manifest_entry == nullptr && this->resource.body == nullptr && this->resource.fd < 0)
     {
-        SVRTY_LOG_ERR(HTTP_SERVER_MSG_OPENING_FILE, resource_to_send.c_str());
+        HTTP_LOG_ERR(HTTP_SERVER_MSG_OPENING_FILE, resource_to_send.c_str());
         return HTTP_SERVER_ERR_REQUESTED_FILE_NOT_FOUND;
     }
-    
-    std::streampos fileSize = file.tellg(); // Get the position of the file pointer, which is at the end
-    file.close();
-    return fileSize;
+
+    return this->resource_stat.st_size;
 }
 
-int HttpServer::CopyFileToString(const std::string& path_to_requested_resource, std::string& dest)
+void HttpServer::SelectContentEncoding(std::string_view content_type, std::string& resource_to_send, long int& resource_size)
 {
-    MTX_GRD_LOCK_SC(this->ptr_to_resources_read_mutex.get(), read_2_file_mtx_ptr);
+    this->content_encoding  = HTTP_CONTENT_ENCODING_IDENTITY;
+    this->vary_encoding     = false;
+    this->encoded_body.reset();
+    this->sidecar_validators.reset();
 
-    std::ifstream file(path_to_requested_resource); // Open the file
+    if(this->resource_not_found || resource_size < 0 || !compressible_content_type.Find(content_type, false))
+        return;
 
-    // If not even the 404 error page could be found, then an error sould be returned.
-    if (!file.is_open())
+    // Whatever is chosen below, the answer depends on Accept-Encoding from now on.
+    this->vary_encoding = true;
+
+    // Ranges always refer to the identity representation.
+    if(!this->request_parser.GetHeader(HTTP_HDR_RANGE).empty())
+        return;
+
+    HTTP_CONTENT_ENCODING preferred[HTTP_CONTENT_ENCODING_COUNT];
+    int preferred_count = HttpParseAcceptEncoding(this->request_parser.GetHeader(HTTP_HDR_ACCEPT_ENCODING), preferred);
+
+    HttpVariantCache& variant_cache = HttpVariantCache::GetInstance();
+
+    for(int i = 0; i < preferred_count; i++)
     {
-        SVRTY_LOG_ERR(HTTP_SERVER_MSG_OPENING_FILE, path_to_requested_resource.c_str());
-        return HTTP_SERVER_ERR_REQUESTED_FILE_NOT_FOUND;
+        // Copies compressed by the server come first, as they cost no system call at all.
+        switch(variant_cache.Lookup(resource_to_send, preferred[i], this->resource_stat, this->encoded_body))
+        {
+            case HTTP_VARIANT_CACHE_HIT:
+            {
+                this->content_encoding  = preferred[i];
+                resource_size           = this->encoded_body->size();
+            }
+            return;
+
+            case HTTP_VARIANT_CACHE_NOT_SMALLER:
+            continue;
+
+            default:
+            break;
+        }
+
+        // Precompressed sidecar next to the file ("style.css.gz"), unless it is older than the file.
+        // The manifest knows about it if it knows about the file; otherwise, it is resolved like
+        // the file was (missing sidecars are remembered as such too).
+        std::string sidecar_target  = this->resource_target + HttpContentEncodingSuffix(preferred[i]);
+        std::string sidecar_path    = resource_to_send + HttpContentEncodingSuffix(preferred[i]);
+        HTTP_RESOLVED_RESOURCE sidecar = {nullptr, nullptr, -1, {}};
+        bool sidecar_found;
+
+        if(this->resource.manifest_entry != nullptr && HttpResourceManifest::Find(this->manifest, sidecar_path) == nullptr)
+            sidecar_found = false;
+        else
+            sidecar_found = this->ResolveResource(sidecar_target, sidecar_path, sidecar);
+
+        if( sidecar_found                                                                                   &&
+            S_ISREG(sidecar.file_stat.st_mode)                                                              &&
+            (sidecar.file_stat.st_mtim.tv_sec  >  this->resource_stat.st_mtim.tv_sec                         ||
+            (sidecar.file_stat.st_mtim.tv_sec  == this->resource_stat.st_mtim.tv_sec                         &&
+             sidecar.file_stat.st_mtim.tv_nsec >= this->resource_stat.st_mtim.tv_nsec))                     )
+        {
+            this->ReleaseResource(this->resource);
+
+            if(sidecar.manifest_entry != nullptr)
+                this->sidecar_validators = sidecar.manifest_entry->validators;
+            else
+                this->sidecar_validators = HttpValidatorCache::GetInstance().Get(sidecar_path, sidecar.file_stat);
+
+            this->content_encoding  = preferred[i];
+            resource_to_send        = sidecar_path;
+            resource_size           = sidecar.file_stat.st_size;
+            this->resource_target   = sidecar_target;
+            this->resource          = std::move(sidecar);
+            return;
+        }
+
+        this->ReleaseResource(sidecar);
+
+        // Sent uncompressed this time; the variant will be ready for the next requests.
+        variant_cache.Request(this->resources_root, this->resource_target, resource_to_send, preferred[i], this->resource_stat);
+    }
+}
+
+// Entity tag of the representation being sent; validators must be known. A sidecar file's tag is
+// derived from the sidecar itself, so it never matches the one of the copy compressed by the server.
+std::string_view HttpServer::GetEntityTag(void)
+{
+    if(this->sidecar_validators != nullptr)
+        return this->sidecar_validators->etag[this->content_encoding];
+
+    return this->validators->etag[this->content_encoding];
+}
+
+bool HttpServer::CheckNotModified(void)
+{
+    if(this->validators == nullptr)
+        return false;
+
+    // If-None-Match takes precedence: If-Modified-Since is ignored whenever it is present.
+    std::string_view if_none_match = this->request_parser.GetHeader(HTTP_HDR_IF_NONE_MATCH);
+
+    if(!if_none_match.empty())
+        return HttpEntityTagListMatches(if_none_match, this->GetEntityTag());
+
+    std::string_view if_modified_since = this->request_parser.GetHeader(HTTP_HDR_IF_MODIFIED_SINCE);
+
+    if(if_modified_since.empty())
+        return false;
+
+    time_t date = HttpParseDate(if_modified_since);
+
+    return (date != HTTP_DATE_INVALID && this->resource_stat.st_mtime <= date);
+}
+
+void HttpServer::AddValidators(std::string& header)
+{
+    if(this->vary_encoding)
+        header.append("Vary: Accept-Encoding\r\n");
+
+    if(this->validators == nullptr)
+        return;
+
+    header.append("ETag: "              ).append(this->GetEntityTag()           ).append("\r\n");
+    header.append("Last-Modified: "     ).append(this->validators->last_modified).append("\r\n");
+}
+
+void HttpServer::AddCacheDirectives(std::string& header)
+{
+    if(this->cache_policy == nullptr)
+        return;
+
+    header.append(this->cache_policy->cache_control);
+
+    if(!this->cache_policy->expires.empty())
+    {
+        header.append(this->cache_policy->expires);
+        return;
+    }
+
+    header.append(HttpGetExpiresHeader(this->cache_policy->max_age));
+}
+
+// RFC 9112 section 9.3: HTTP/1.1 connections persist unless either side says "close"; HTTP/1.0
+// ones only if the client asks for it (keep-alive).
+bool HttpServer::CheckKeepAlive(void)
+{
+    this->requests_served++;
+
+    if(this->keep_alive_timeout == 0)
+        return false;
+
+    if(this->keep_alive_requests > 0 && this->requests_served >= this->keep_alive_requests)
+        return false;
+
+    std::string_view connection = this->request_parser.GetHeader(HTTP_HDR_CONNECTION);
+
+    if(HasConnectionOption(connection, "close"))
+        return false;
+
+    if(this->request_parser.GetProtocol() == HTTP_SERVER_PROTOCOL_1_0)
+        return HasConnectionOption(connection, "keep-alive");
+
+    return true;
+}
+
+void HttpServer::AddConnectionHeader(std::string& header)
+{
+    if(!this->keep_alive)
+    {
+        header.append("Connection: close\r\n");
+        return;
+    }
+
+    // Persistence has to be confirmed to HTTP/1.0 clients, HTTP/1.1 ones take it for granted.
+    if(this->request_parser.GetProtocol() == HTTP_SERVER_PROTOCOL_1_0)
+        header.append("Connection: keep-alive\r\n");
+
+    header.append("Keep-Alive: timeout=");
+    HttpAppendNumber(header, this->keep_alive_timeout);
+
+    if(this->keep_alive_requests > 0)
+    {
+        header.append(", max=");
+        HttpAppendNumber(header, this->keep_alive_requests - this->requests_served);
     }
 
-    // Read the file content into an std::string
-    dest.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    header.append("\r\n");
+}
+
+int HttpServer::CheckRange(long int resource_size)
+{
+    std::string_view range = this->request_parser.GetHeader(HTTP_HDR_RANGE);
+
+    if(range.empty() || !this->CheckIfRange())
+        return HTTP_RANGE_IGNORE;
 
-    // Close the file
-    file.close();
+    return HttpParseRange(range, resource_size, this->ranges);
+}
+
+bool HttpServer::CheckIfRange(void)
+{
+    std::string_view if_range = this->request_parser.GetHeader(HTTP_HDR_IF_RANGE);
+
+    // No condition: the range applies.
+    if(if_range.empty())
+        return true;
+
+    // Entity tags use the strong comparison: weak ones never match. A date has to match the
+    // modification time exactly (RFC 9110 section 13.1.5). Otherwise the whole resource is sent.
+    if(if_range[0] == '"' || if_range.substr(0, 2) == "W/")
+        return (this->validators != nullptr && if_range == this->GetEntityTag());
+
+    time_t date = HttpParseDate(if_range);
+
+    return (date != HTTP_DATE_INVALID && date == this->resource_stat.st_mtime);
+}
+
+void HttpServer::AddContentRange(std::string& header, const HTTP_BYTE_RANGE& range, long int resource_size)
+{
+    header.append("Content-Range: bytes ");
+    HttpAppendNumber(header, range.first);
+    header.append("-");
+    HttpAppendNumber(header, range.last);
+    header.append("/");
+    HttpAppendNumber(header, resource_size);
+    header.append("\r\n");
+}
+
+int HttpServer::CopyFileToString(const std::string& path_to_requested_resource, std::shared_ptr<const std::string>& dest)
+{
+    // Preloaded by the manifest: not even a stat call is needed to check the copy is current.
+    if(this->resource.manifest_entry != nullptr && this->resource.manifest_entry->body != nullptr)
+    {
+        dest = this->resource.manifest_entry->body;
+        return 0;
+    }
+
+    // Hot resources are served straight from memory, without touching the disk nor taking any lock
+    // (those found in the cache when resolving them are already at hand).
+    if(this->resource.body != nullptr)
+    {
+        dest = this->resource.body;
+        return 0;
+    }
+
+    // Misses read the file through the descriptor it was resolved to: the cache only locks while
+    // the new entry is published.
+    int load_file = HTTP_FILE_CACHE_ERR_OPEN;
+
+    if(this->OpenResource(path_to_requested_resource) >= 0)
+        load_file = this->file_cache.Load(path_to_requested_resource, this->resource.fd, this->resource.file_stat, dest);
+
+    // If not even the 404 error page could be found, then an error sould be returned.
+    if(load_file < 0)
+    {
+        HTTP_LOG_ERR(HTTP_SERVER_MSG_OPENING_FILE, path_to_requested_resource.c_str());
+        return HTTP_SERVER_ERR_REQUESTED_FILE_NOT_FOUND;
+    }
 
     return 0;
 }
 
-const std::string HttpServer::GetMIMEDataType(const std::string& content_type)
+std::string_view HttpServer::GetMIMEDataType(std::string_view content_type)
 {
     size_t pos = content_type.find('/');
 
-    if (pos != std::string::npos)
+    if (pos != std::string_view::npos)
         return content_type.substr(0, pos);
     else
         return content_type;
 }
 
+int HttpServer::OpenResourceFile(const std::string& path_to_requested_resource, off_t offset, off_t end, HTTP_RESPONSE& response)
+{
+    this->CloseResourceFile(response);
+
+    // Every response streaming the resource gets a descriptor of its own, as it outlives the one it
+    // was resolved to (pread and sendfile take offsets of their own, so the file offset is not shared).
+    if(this->OpenResource(path_to_requested_resource) >= 0)
+        response.body_fd = fcntl(this->resource.fd, F_DUPFD_CLOEXEC, 0);
+
+    if(response.body_fd < 0)
+    {
+        HTTP_LOG_ERR(HTTP_SERVER_MSG_OPENING_FILE, path_to_requested_resource.c_str());
+        return HTTP_SERVER_ERR_REQUESTED_FILE_NOT_FOUND;
+    }
+
+    response.body_src       = HTTP_BODY_SRC_FILE;
+    response.body_offset    = offset;
+    response.body_end       = end;
+
+    // The body is read once, front to back: ask for aggressive readahead over it, and for its
+    // beginning to be fetched right away, before the first chunk is even requested.
+    posix_fadvise(response.body_fd, offset, end - offset, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(response.body_fd, offset, std::min(end - offset, (off_t)HTTP_SERVER_LEN_FILE_READAHEAD), POSIX_FADV_WILLNEED);
+
+    return 0;
+}
+
+void HttpServer::CloseResourceFile(HTTP_RESPONSE& response)
+{
+    if(response.body_fd >= 0)
+        close(response.body_fd);
+
+    response.body_fd = -1;
+}
+
+HTTP_RESPONSE& HttpServer::AddResponse(void)
+{
+    if(this->responses_count == this->responses.size())
+        this->responses.push_back({"", HTTP_BODY_SRC_NONE, nullptr, -1, 0, 0});
+
+    HTTP_RESPONSE& response = this->responses[this->responses_count++];
+
+    response.header.clear();
+    response.body_src       = HTTP_BODY_SRC_NONE;
+    response.body_offset    = 0;
+    response.body_end       = 0;
+
+    return response;
+}
+
+long int HttpServer::GetResponseLength(const HTTP_RESPONSE& response)
+{
+    switch(response.body_src)
+    {
+        case HTTP_BODY_SRC_MEMORY:
+            return response.header.size() + response.body->size();
+
+        case HTTP_BODY_SRC_FILE:
+            return response.header.size() + (response.body_end - response.body_offset);
+
+        default:
+            return response.header.size();
+    }
+}
+
+void HttpServer::ClearResponses(void)
+{
+    for(size_t i = 0; i < this->responses_count; i++)
+    {
+        this->responses[i].body.reset();
+        this->CloseResourceFile(this->responses[i]);
+    }
+
+    this->responses_count = 0;
+
+    // No body taken from the file cache is referenced anymore.
+    this->file_cache_reader.Release();
+
+    // The next batch will be written from the header of its first response.
+    this->tx_response_index = 0;
+    this->tx_part           = HTTP_RESPONSE_PART_HEADER;
+    this->tx_part_offset    = 0;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////
 
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -627,53 +1518,94 @@ const std::string HttpServer::GetMIMEDataType(const std::string& content_type)
 
 int HttpServer::WriteToClient(int& client_socket)
 {
-    unsigned long remaining_data_len    = this->http_response.size();
-    unsigned long bytes_already_written = 0;
-    
     HTTP_WRITE_FSM http_write_fsm = HTTP_WRITE_FSM_WRITE_TRY;
     int end_connection = 0;
     bool keep_trying = true;
 
+    // The engine takes the responses (GetTxSegments) and calls CompleteWrite once they are sent.
+    if(this->io_mode == HTTP_SERVER_IO_COMPLETION)
+        return HTTP_SERVER_IO_WAIT_WRITE;
+
+    // The write cursor is only reset once the whole batch has been sent, so that an event-driven
+    // connection resumes exactly where the socket stopped accepting data.
+
     while(keep_trying)
     {
         switch(http_write_fsm)
         {
+            // Write every in-memory part (headers and cached bodies) of the queued responses
+            // at once, up to the first body that has to be streamed from a file.
             case HTTP_WRITE_FSM_WRITE_TRY:
             {
-                long int socket_write = ServerSocketWrite(client_socket, this->http_response.data() + bytes_already_written, remaining_data_len);
+                const char* data;
+                size_t length;
 
-                if((socket_write < 0))
+                if(this->tx_response_index >= this->responses_count)
                 {
-                    if((errno != EAGAIN && errno != EWOULDBLOCK))
-                    {
-                        end_connection = -1;
-                        http_write_fsm = HTTP_WRITE_FSM_WRITE_END;
-                    }
+                    for(size_t i = 0; i < this->responses_count; i++)
+                        HTTP_LOG_DBG_PAYLOAD(HTTP_SERVER_MSG_DATA_WRITTEN_TO_CLIENT, this->responses[i].header.size(), this->responses[i].header.data());
+
+                    http_write_fsm = HTTP_WRITE_FSM_WRITE_END;
+                    break;
                 }
-                else if(socket_write == 0)
+
+                if(!this->GetTxPart(this->tx_response_index, this->tx_part, data, length))
                 {
-                    char client_IP_addr[INET_ADDRSTRLEN] = {};
-                    ServerSocketGetClientIPv4(client_socket, client_IP_addr);
-                    SVRTY_LOG_WNG(HTTP_SERVER_MSG_CLIENT_DISCONNECTED, client_IP_addr);
-                    
-                    end_connection = -1;
-                    http_write_fsm = HTTP_WRITE_FSM_WRITE_END;
+                    http_write_fsm = HTTP_WRITE_FSM_WRITE_BODY_FILE;
+                    break;
                 }
-                else // socket_write > 0
+
+                // Nothing (left) to be sent within the current part.
+                if(this->tx_part_offset >= length)
                 {
-                    bytes_already_written   += socket_write;
-                    remaining_data_len      -= socket_write;
+                    this->NextTxPart(this->tx_response_index, this->tx_part);
+                    this->tx_part_offset = 0;
+                    break;
+                }
 
-                    // If no partial write has been detected, then jump to HTTP_WRITE_FSM_WRITE_END state.
-                    // Otherwise, keep writing.
-                    if(remaining_data_len == 0)
+                size_t requested_len = 0;
+                long int socket_write = this->SendMemoryParts(client_socket, requested_len);
+                int check_write = this->CheckWriteResult(client_socket, socket_write);
+
+                if(check_write != 0)
+                {
+                    end_connection = check_write;
+                    http_write_fsm = HTTP_WRITE_FSM_WRITE_END;
+                }
+                else if(socket_write > 0)
+                {
+                    // If a partial write has been detected, the cursor just resumes where it stopped.
+                    if((size_t)socket_write < requested_len)
                     {
-                        SVRTY_LOG_DBG(HTTP_SERVER_MSG_DATA_WRITTEN_TO_CLIENT, this->http_response.data());
-                        http_write_fsm = HTTP_WRITE_FSM_WRITE_END;
-                        end_connection = 0;
+                        HTTP_LOG_WNG(HTTP_SERVER_MSG_PARTIAL_WRITE, socket_write, requested_len - socket_write);
+                        HttpStats::AddCounter(HTTP_STATS_COUNTER_PARTIAL_WRITES);
                     }
-                    else
-                        SVRTY_LOG_WNG(HTTP_SERVER_MSG_PARTIAL_WRITE, bytes_already_written, remaining_data_len);
+
+                    this->AdvanceTxCursor(socket_write);
+                }
+            }
+            break;
+
+            // Stream the body from the resource file. Every chunk resumes at the current file offset.
+            case HTTP_WRITE_FSM_WRITE_BODY_FILE:
+            {
+                HTTP_RESPONSE& response = this->responses[this->tx_response_index];
+
+                if(response.body_offset >= response.body_end)
+                {
+                    this->NextTxPart(this->tx_response_index, this->tx_part);
+                    this->tx_part_offset = 0;
+                    http_write_fsm = HTTP_WRITE_FSM_WRITE_TRY;
+                    break;
+                }
+
+                long int socket_write = this->SendFileChunk(client_socket, response);
+                int check_write = this->CheckWriteResult(client_socket, socket_write);
+
+                if(check_write != 0)
+                {
+                    end_connection = check_write;
+                    http_write_fsm = HTTP_WRITE_FSM_WRITE_END;
                 }
             }
             break;
@@ -689,19 +1621,347 @@ int HttpServer::WriteToClient(int& client_socket)
         }
     }
 
+    // Keep the queued responses until they have been completely sent.
+    if(end_connection != HTTP_SERVER_IO_WAIT_WRITE)
+        this->ClearResponses();
+
     return end_connection;
 }
 
+void HttpServer::GetTxSegments(std::vector<HTTP_TX_SEGMENT>& segments)
+{
+    size_t              response_index  = 0;
+    HTTP_RESPONSE_PART  part            = HTTP_RESPONSE_PART_HEADER;
+
+    segments.clear();
+
+    while(response_index < this->responses_count)
+    {
+        HTTP_TX_SEGMENT segment = {nullptr, 0, -1, 0, 0};
+
+        if(!this->GetTxPart(response_index, part, segment.data, segment.length))
+        {
+            segment.fd      = this->responses[response_index].body_fd;
+            segment.offset  = this->responses[response_index].body_offset;
+            segment.end     = this->responses[response_index].body_end;
+        }
+
+        if(segment.length > 0 || segment.offset < segment.end)
+            segments.push_back(segment);
+
+        this->NextTxPart(response_index, part);
+    }
+}
+
+void HttpServer::CompleteWrite(void)
+{
+    long int bytes_sent = 0;
+
+    for(size_t i = 0; i < this->responses_count; i++)
+    {
+        HTTP_LOG_DBG_PAYLOAD(HTTP_SERVER_MSG_DATA_WRITTEN_TO_CLIENT, this->responses[i].header.size(), this->responses[i].header.data());
+        bytes_sent += this->GetResponseLength(this->responses[i]);
+    }
+
+    HttpStats::AddCounter(HTTP_STATS_COUNTER_BYTES_OUT, bytes_sent);
+
+    this->ClearResponses();
+    this->RecordBatchLatency();
+    this->LogAccess();
+
+    this->http_run_fsm = this->end_after_write ? HTTP_RUN_FSM_END_CONNECTION : HTTP_RUN_FSM_READ;
+}
+
+bool HttpServer::GetTxPart(size_t response_index, HTTP_RESPONSE_PART part, const char*& data, size_t& length)
+{
+    HTTP_RESPONSE& response = this->responses[response_index];
+
+    data    = nullptr;
+    length  = 0;
+
+    if(part == HTTP_RESPONSE_PART_HEADER)
+    {
+        data    = response.header.data();
+        length  = response.header.size();
+        return true;
+    }
+
+    switch(response.body_src)
+    {
+        case HTTP_BODY_SRC_MEMORY:
+        {
+            data    = response.body->data();
+            length  = response.body->size();
+        }
+        break;
+
+        // File bodies are not in memory, they are sent by SendFileChunk instead.
+        case HTTP_BODY_SRC_FILE:
+            return false;
+
+        default:
+        break;
+    }
+
+    return true;
+}
+
+void HttpServer::NextTxPart(size_t& response_index, HTTP_RESPONSE_PART& part)
+{
+    if(part == HTTP_RESPONSE_PART_HEADER && this->responses[response_index].body_src != HTTP_BODY_SRC_NONE)
+    {
+        part = HTTP_RESPONSE_PART_BODY;
+        return;
+    }
+
+    part = HTTP_RESPONSE_PART_HEADER;
+    response_index++;
+}
+
+void HttpServer::AdvanceTxCursor(size_t bytes_written)
+{
+    while(bytes_written > 0 && this->tx_response_index < this->responses_count)
+    {
+        const char* data;
+        size_t length;
+
+        if(!this->GetTxPart(this->tx_response_index, this->tx_part, data, length))
+            return;
+
+        size_t part_remaining = length - this->tx_part_offset;
+
+        if(bytes_written < part_remaining)
+        {
+            this->tx_part_offset += bytes_written;
+            return;
+        }
+
+        bytes_written -= part_remaining;
+        this->NextTxPart(this->tx_response_index, this->tx_part);
+        this->tx_part_offset = 0;
+    }
+}
+
+long int HttpServer::SendMemoryParts(int& client_socket, size_t& requested_len)
+{
+    size_t              response_index  = this->tx_response_index   ;
+    HTTP_RESPONSE_PART  part            = this->tx_part             ;
+    size_t              offset          = this->tx_part_offset      ;
+    const char*         data                                        ;
+    size_t              length                                      ;
+
+    requested_len = 0;
+
+    // Plaintext: hand every part to the kernel with a single vectored write. If a file body comes
+    // next, tell the kernel so that headers are not sent on their own in a small segment.
+    if(!this->secure_connection)
+    {
+        struct iovec iov[HTTP_SERVER_MAX_IOV];
+        int iov_count = 0;
+        bool more_data_follows = false;
+
+        while(response_index < this->responses_count)
+        {
+            if(iov_count == HTTP_SERVER_MAX_IOV || !this->GetTxPart(response_index, part, data, length))
+            {
+                more_data_follows = true;
+                break;
+            }
+
+            if(length > offset)
+            {
+                iov[iov_count].iov_base = (void*)(data + offset);
+                iov[iov_count].iov_len  = length - offset;
+                requested_len          += length - offset;
+                iov_count++;
+            }
+
+            offset = 0;
+            this->NextTxPart(response_index, part);
+        }
+
+        struct msghdr message = {};
+        message.msg_iov     = iov;
+        message.msg_iovlen  = iov_count;
+
+        return sendmsg(client_socket, &message, MSG_NOSIGNAL | (more_data_follows ? MSG_MORE : 0));
+    }
+
+    // TLS: every write becomes (at least) one record, so copy small parts together first.
+    // Parts that are large enough on their own are written straight from where they are.
+    this->GetTxPart(response_index, part, data, length);
+    if(length - offset >= HTTP_SERVER_LEN_TX_COALESCE)
+    {
+        requested_len = length - offset;
+        return ServerSocketWrite(client_socket, data + offset, requested_len);
+    }
+
+    this->tx_coalesce.clear();
+
+    while(response_index < this->responses_count && this->GetTxPart(response_index, part, data, length))
+    {
+        if(this->tx_coalesce.size() + (length - offset) > HTTP_SERVER_LEN_TX_COALESCE)
+            break;
+
+        this->tx_coalesce.append(data + offset, length - offset);
+
+        offset = 0;
+        this->NextTxPart(response_index, part);
+    }
+
+    requested_len = this->tx_coalesce.size();
+
+    return ServerSocketWrite(client_socket, this->tx_coalesce.data(), this->tx_coalesce.size());
+}
+
+long int HttpServer::SendFileChunk(int& client_socket, HTTP_RESPONSE& response)
+{
+    off_t remaining = response.body_end - response.body_offset;
+
+    // Plaintext: let the kernel move the data from the page cache to the socket. sendfile
+    // updates the offset by itself, so partial writes resume from the right position.
+    if(!this->secure_connection)
+    {
+        long int socket_write = sendfile(client_socket, response.body_fd, &response.body_offset, remaining);
+
+        if(socket_write == 0)
+            HTTP_LOG_ERR(HTTP_SERVER_MSG_RESOURCE_TRUNCATED, (long int)remaining);
+
+        return socket_write;
+    }
+
+    // TLS: data has to go through userspace to be encrypted, so use a fixed-size buffer.
+    char tx_buffer[HTTP_SERVER_LEN_TX_BUFFER];
+    size_t chunk_len = (remaining < (off_t)sizeof(tx_buffer)) ? remaining : sizeof(tx_buffer);
+
+    ssize_t read_from_file = pread(response.body_fd, tx_buffer, chunk_len, response.body_offset);
+    if(read_from_file <= 0)
+    {
+        HTTP_LOG_ERR(HTTP_SERVER_MSG_RESOURCE_TRUNCATED, (long int)remaining);
+        return 0;
+    }
+
+    ssize_t chunk_written = 0;
+    while(chunk_written < read_from_file)
+    {
+        long int socket_write = ServerSocketWrite(client_socket, tx_buffer + chunk_written, read_from_file - chunk_written);
+
+        if(socket_write <= 0 && !(socket_write < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)))
+            return socket_write;
+
+        if(socket_write > 0)
+            chunk_written += socket_write;
+    }
+
+    response.body_offset += chunk_written;
+
+    return chunk_written;
+}
+
+int HttpServer::CheckWriteResult(int& client_socket, long int socket_write)
+{
+    if(socket_write < 0)
+    {
+        if(errno != EAGAIN && errno != EWOULDBLOCK)
+            return -1;
+
+        // Socket buffer is full: blocking connections retry, event-driven ones wait until it is writable.
+        if(this->io_mode == HTTP_SERVER_IO_NON_BLOCKING)
+            return HTTP_SERVER_IO_WAIT_WRITE;
+    }
+    else if(socket_write == 0)
+    {
+        if(HTTP_LOG_LEVEL_DBG <= HTTP_LOG_LEVEL)
+        {
+            char client_IP_addr[INET_ADDRSTRLEN] = {};
+            ServerSocketGetClientIPv4(client_socket, client_IP_addr);
+            HTTP_LOG_DBG(HTTP_SERVER_MSG_CLIENT_DISCONNECTED, client_IP_addr);
+        }
+
+        return -1;
+    }
+    else
+        HttpStats::AddCounter(HTTP_STATS_COUNTER_BYTES_OUT, socket_write);
+
+    return 0;
+}
+
+void HttpServer::RecordBatchLatency(void)
+{
+    if(this->batch_requests > 0)
+        HttpStats::RecordLatency(HTTP_STATS_STAGE_REQUEST, HttpStats::GetNowNs() - this->batch_begin_ns, this->batch_requests);
+
+    this->batch_requests = 0;
+}
+
+void HttpServer::AddAccessRecord(HTTP_STATUS status, long int bytes)
+{
+    if(!HttpAccessLog::IsEnabled())
+        return;
+
+    if(this->access_records_count == this->access_records.size())
+        this->access_records.emplace_back();
+
+    HTTP_ACCESS_LOG_RECORD& record = this->access_records[this->access_records_count++];
+
+    // Whatever the parser found, if anything (requests rejected by it are logged as well).
+    record.status   = status;
+    record.bytes    = bytes;
+    HttpAccessLog::SetField(record.client_ip    , sizeof(record.client_ip)  , this->client_ip                                      );
+    HttpAccessLog::SetField(record.method       , sizeof(record.method)     , this->request_parser.GetMethod()                      );
+    HttpAccessLog::SetField(record.target       , sizeof(record.target)     , this->request_parser.GetTarget()                      );
+    HttpAccessLog::SetField(record.protocol     , sizeof(record.protocol)   , this->request_parser.GetProtocol()                    );
+    HttpAccessLog::SetField(record.referer      , sizeof(record.referer)    , this->request_parser.GetHeader(HTTP_HDR_REFERER)      );
+    HttpAccessLog::SetField(record.user_agent   , sizeof(record.user_agent) , this->request_parser.GetHeader(HTTP_HDR_USER_AGENT)   );
+}
+
+void HttpServer::LogAccess(void)
+{
+    if(this->access_records_count == 0)
+        return;
+
+    // Every response of the batch left together: they all took as long as the first one.
+    uint64_t duration_us = (HttpStats::GetNowNs() - this->batch_begin_ns) / 1000;
+    time_t now = time(nullptr);
+
+    for(size_t i = 0; i < this->access_records_count; i++)
+    {
+        this->access_records[i].time        = now;
+        this->access_records[i].duration_us = duration_us;
+
+        HttpAccessLog::Submit(this->access_records[i]);
+    }
+
+    this->access_records_count = 0;
+}
+
 int HttpServer::Run(int& client_socket)
 {
-    bool keep_interacting       = true              ;
-    HTTP_RUN_FSM http_run_fsm   = HTTP_RUN_FSM_READ ;
+    // Blocking sockets never ask to wait: Resume only returns once the connection has to be closed.
+    this->Resume(client_socket);
+
+    return 0;
+}
+
+int HttpServer::Resume(int& client_socket)
+{
+    bool keep_interacting   = true  ;
+    int resume_result       = -1    ;
+    uint64_t stage_begin_ns = HttpStats::GetNowNs();
 
-    InitResourcesMutex();
+    if(!this->client_ip_known && HttpAccessLog::IsEnabled())
+    {
+        ServerSocketGetClientIPv4(client_socket, this->client_ip);
+        this->client_ip_known = true;
+    }
 
     while(keep_interacting)
     {
-        switch(http_run_fsm)
+        // Every step but the last one is timed; each one starts when the previous one ends.
+        HTTP_RUN_FSM stage = this->http_run_fsm;
+        bool record_stage = (stage != HTTP_RUN_FSM_END_CONNECTION);
+
+        switch(this->http_run_fsm)
         {
             // First, try to read something from client.
             // If client got disconnected while trying to read or any error happened, end_connection > 0.
@@ -709,51 +1969,99 @@ int HttpServer::Run(int& client_socket)
             case HTTP_RUN_FSM_READ:
             {
                 int end_connection = this->ReadFromClient(client_socket);
-                
+
+                // A blocking read waits for the next request of an idle connection: reading starts
+                // with its first bytes (and never did if the connection ended before any came).
+                if(this->rx_first_byte_ns > stage_begin_ns)
+                    stage_begin_ns = this->rx_first_byte_ns;
+
                 if(end_connection < 0)
-                    http_run_fsm = HTTP_RUN_FSM_END_CONNECTION;
+                {
+                    record_stage = (this->GetBufferedLength() > 0);
+                    this->http_run_fsm = HTTP_RUN_FSM_END_CONNECTION;
+                }
+                else if(end_connection == HTTP_SERVER_IO_WAIT_READ)
+                {
+                    resume_result       = HTTP_SERVER_IO_WAIT_READ;
+                    keep_interacting    = false;
+                }
                 else
-                    http_run_fsm = HTTP_RUN_FSM_PROCESS_REQUEST;
+                    this->http_run_fsm = HTTP_RUN_FSM_PROCESS_REQUEST;
             }
             break;
 
-            // Once something has been read, process the request. Erase the current request string afterwards,
-            // leaving enough space for potential incoming requests.
+            // Once something has been read, process the request found at the front of the buffer.
             case HTTP_RUN_FSM_PROCESS_REQUEST:
             {
+                // Pipelined requests are answered together: they all wait for the first one of the batch.
+                if(this->batch_requests == 0)
+                    this->batch_begin_ns = stage_begin_ns;
+
                 int process_request = this->ProcessRequest();
                 
-                // If request could not be processed properly, then stop interacting with the client.
+                // If request could not be processed properly, then stop interacting with the client
+                // (once the responses to the requests that came before it have been sent).
                 if(process_request < 0)
-                    http_run_fsm = HTTP_RUN_FSM_END_CONNECTION;
+                {
+                    this->end_after_write = true;
+                    this->http_run_fsm = (this->responses_count > 0) ? HTTP_RUN_FSM_WRITE : HTTP_RUN_FSM_END_CONNECTION;
+                }
+                // The body is still on its way: send whatever has been queued so far (an interim
+                // 100 Continue response, among others) and keep reading.
+                else if(process_request == HTTP_SERVER_RQST_BODY_PENDING)
+                    this->http_run_fsm = (this->responses_count > 0) ? HTTP_RUN_FSM_WRITE : HTTP_RUN_FSM_READ;
                 else
-                    http_run_fsm = HTTP_RUN_FSM_GENERATE_RESPONSE;
+                    this->http_run_fsm = HTTP_RUN_FSM_GENERATE_RESPONSE;
             }
             break;
 
-            // After processing the request, generate a proper response.
+            // After processing the request, generate a proper response and queue it. If pipelined
+            // requests are already waiting in the buffer, answer them as well before writing, so
+            // that all of the responses leave together.
             case HTTP_RUN_FSM_GENERATE_RESPONSE:
             {
                 long int response_size = this->GenerateResponse();
 
-                // If response could not be generated, exit and wait for an incoming connection to happen again.
+                // If response could not be generated, then stop interacting with the client (once the
+                // responses to the requests that came before it have been sent).
                 if(response_size < 0)
-                    http_run_fsm = HTTP_RUN_FSM_END_CONNECTION;
+                {
+                    this->end_after_write = true;
+                    this->http_run_fsm = (this->responses_count > 0) ? HTTP_RUN_FSM_WRITE : HTTP_RUN_FSM_END_CONNECTION;
+                    break;
+                }
+
+                this->ConsumeRequest();
+                this->batch_requests++;
+
+                if(!this->end_after_write && this->responses_count < HTTP_SERVER_MAX_PIPELINED_RESPONSES && this->CheckRequestEnd())
+                    this->http_run_fsm = HTTP_RUN_FSM_PROCESS_REQUEST;
                 else
-                    http_run_fsm = HTTP_RUN_FSM_WRITE;
+                    this->http_run_fsm = HTTP_RUN_FSM_WRITE;
             }
             break;
 
-            // Finally, send the generated response back to the client.
+            // Finally, send the generated responses back to the client.
             // If client got disconnected or any other kind of error happened while trying to wtite, then exit the process.
             case HTTP_RUN_FSM_WRITE:
             {
                 int write_to_client = this->WriteToClient(client_socket);
 
-                if(write_to_client < 0)
-                    http_run_fsm = HTTP_RUN_FSM_END_CONNECTION;
+                if(write_to_client == HTTP_SERVER_IO_WAIT_WRITE)
+                {
+                    resume_result       = HTTP_SERVER_IO_WAIT_WRITE;
+                    keep_interacting    = false;
+                }
                 else
-                    http_run_fsm = HTTP_RUN_FSM_READ;
+                {
+                    if(write_to_client == 0)
+                    {
+                        this->RecordBatchLatency();
+                        this->LogAccess();
+                    }
+
+                    this->http_run_fsm = (write_to_client < 0 || this->end_after_write) ? HTTP_RUN_FSM_END_CONNECTION : HTTP_RUN_FSM_READ;
+                }
             }
             break;
 
@@ -766,9 +2074,17 @@ int HttpServer::Run(int& client_socket)
             default:
             break;
         }
+
+        // The first stages of HTTP_STATS_STAGE follow the order of HTTP_RUN_FSM.
+        if(record_stage)
+        {
+            uint64_t stage_end_ns = HttpStats::GetNowNs();
+            HttpStats::RecordLatency((HTTP_STATS_STAGE)stage, stage_end_ns - stage_begin_ns);
+            stage_begin_ns = stage_end_ns;
+        }
     }
 
-    return 0;
+    return resume_result;
 }
 
 /******************************************/
\ No newline at end of file
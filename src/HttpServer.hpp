@@ -9,7 +9,22 @@
 #include <vector>
 #include <map>
 #include <memory>
-#include <MutexGuard_api.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <stdint.h>
+#include "HttpRequestParser.hpp"
+#include "HttpRxBuffer.hpp"
+#include "HttpFileCache.hpp"
+#include "HttpRange.hpp"
+#include "HttpValidatorCache.hpp"
+#include "HttpContentEncoding.hpp"
+#include "HttpVariantCache.hpp"
+#include "HttpCachePolicy.hpp"
+#include "HttpResponseHeader.hpp"
+#include "HttpAccessLog.hpp"
+#include "HttpResourceManifest.hpp"
+#include "HttpResourceResolver.hpp"
 
 /*************************************/
 
@@ -17,10 +32,20 @@
 /********* Define statements ********/
 /************************************/
 
-#define HTTP_SERVER_LEN_RX_BUFFER                   8192        // RX buffer size.
+#define HTTP_SERVER_LEN_RX_BUFFER                   8192        // Least spare room requested from the RX buffer before every read.
+#define HTTP_SERVER_DEFAULT_MAX_REQUEST_LEN         (1UL * 1024UL * 1024UL)                                 // Largest request (header block + body) accepted by default.
+#define HTTP_SERVER_MIN_MAX_REQUEST_LEN             (HTTP_PARSER_MAX_HEADER_BLOCK_LEN + HTTP_SERVER_LEN_RX_BUFFER) // Any header block the parser accepts has to fit.
 #define HTTP_SERVER_LEN_TX_BUFFER                   8192        // TX buffer size.
-#define HTTP_SERVER_HTTP_MSG_END                    "\r\n\r\n"
+#define HTTP_SERVER_LEN_TX_COALESCE                 65536       // Most bytes copied together into a single TLS write.
+#define HTTP_SERVER_MAX_PIPELINED_RESPONSES         32          // Responses queued before they are flushed to the client.
+#define HTTP_SERVER_MAX_IOV                         64          // Buffers handed to a single writev call.
+#define HTTP_SERVER_LEN_FILE_READAHEAD              (512L * 1024L)  // File bytes the kernel is asked to prefetch when a body starts streaming.
+#define HTTP_SERVER_DEFAULT_KEEP_ALIVE_TIMEOUT      15          // Seconds an idle persistent connection is kept open (0: connections are not persistent).
+#define HTTP_SERVER_DEFAULT_KEEP_ALIVE_REQUESTS     1000        // Requests served per connection before closing it (0: no limit).
+#define HTTP_SERVER_MULTIPART_BOUNDARY_PREFIX       "CPP_HTTP_SERVER_"
+#define HTTP_SERVER_PROTOCOL_1_0                    "HTTP/1.0"
 #define HTTP_SERVER_DEFAULT_PAGE                    "/index.html"
+#define HTTP_SERVER_DEFAULT_CONTENT_TYPE            "application/octet-stream"
 #define HTTP_SERVER_DEFAULT_ERROR_404_PAGE_PATH     "/page_not_found.html"
 #define HTTP_SERVER_DEFAULT_ERROR_404_PAGE          "<!DOCTYPE html>\n" \
                                                     "<html lang=\"en\">\n" \
@@ -35,27 +60,45 @@
                                                     "</body>\n" \
                                                     "</html>"        
 
-#define HTTP_SERVER_MSG_DATA_READ_FROM_CLIENT       "Data read from client: <\r\n%s\r\n>"
-#define HTTP_SERVER_MSG_DATA_WRITTEN_TO_CLIENT      "Data written to client: <\r\n%s\r\n>"
+#define HTTP_SERVER_MSG_DATA_READ_FROM_CLIENT       "Data read from client: <\r\n%.*s\r\n>"
+#define HTTP_SERVER_MSG_DATA_WRITTEN_TO_CLIENT      "Data written to client: <\r\n%.*s\r\n>"
 #define HTTP_SERVER_MSG_CLIENT_DISCONNECTED         "Client with IP <%s> disconnected."
 #define HTTP_SERVER_MSG_ECONNABORTED                "Connection aborted by peer, errno: %d"
 #define HTTP_SERVER_MSG_ECONNRESET                  "Connection reset by peer, errno: %d"
 #define HTTP_SERVER_MSG_ECONNREFUSED                "Connection refused by peer, errno: %d"
 #define HTTP_SERVER_MSG_ERROR_WHILE_READING         "ERROR WHILE READING, errno: %d"
 #define HTTP_SERVER_MSG_READ_TMT_EXPIRED            "READ TIMEOUT EXPIRED!"
-#define HTTP_SERVER_MSG_UNKNOWN_RQST_FIELD          "Unknown field: %s"
 #define HTTP_SERVER_MSG_OPENING_FILE                "Error opening file \"%s\"."
 #define HTTP_SERVER_MSG_UNKNOWN_CONTENT_TYPE        "UNKNOWN CONTENT TYPE (File extension: %s)"
-#define HTTP_SERVER_MSG_RQST_METHOD                 "METHOD:    %s"
-#define HTTP_SERVER_MSG_RQST_RESOURCE               "RESOURCE:  %s"
-#define HTTP_SERVER_MSG_RQST_PROTOCOL               "PROTOCOL:  %s"
-#define HTTP_SERVER_MSG_BASIC_RQST_FIELD_MISSING    "One of the basic request fields (either method, requested resource or protocol) is missing."
-#define HTTP_SERVER_MSG_PARTIAL_WRITE               "Partial write detected. Already written: %d. Remaining bytes amount: %d."
-#define HTTP_SERVER_MSG_UNSUPPORTED_METHOD          "%s method is unsupported by the server."
+#define HTTP_SERVER_MSG_RQST_METHOD                 "METHOD:    %.*s"
+#define HTTP_SERVER_MSG_RQST_RESOURCE               "RESOURCE:  %.*s"
+#define HTTP_SERVER_MSG_RQST_PROTOCOL               "PROTOCOL:  %.*s"
+#define HTTP_SERVER_MSG_RQST_PARSE_FAILED           "Request could not be parsed, error: %d"
+#define HTTP_SERVER_MSG_PARTIAL_WRITE               "Partial write detected. Already written: %ld. Remaining bytes amount: %lu."
+#define HTTP_SERVER_MSG_UNSUPPORTED_METHOD          "%.*s method is unsupported by the server."
+#define HTTP_SERVER_MSG_RX_BUFFER_FULL              "Receive buffer is full (%lu bytes) but the request is not complete yet."
+#define HTTP_SERVER_MSG_INVALID_CONTENT_LENGTH      "Invalid Content-Length: %.*s"
+#define HTTP_SERVER_MSG_REQUEST_TOO_LARGE           "Request (%lu bytes) exceeds the maximum request size (%lu bytes)."
+#define HTTP_SERVER_MSG_UNSUPPORTED_TRANSFER_CODING "Transfer-Encoding is not supported: %.*s"
+#define HTTP_SERVER_MSG_RANGE_NOT_SATISFIABLE       "Range not satisfiable: %.*s (resource size: %ld bytes)."
+#define HTTP_SERVER_MSG_RESOURCE_TRUNCATED          "Requested resource ended before the whole body could be sent. Remaining bytes amount: %ld."
+#define HTTP_SERVER_MSG_IDLE_TIMEOUT_ERROR          "Could not set the idle timeout of the connection, errno: %d"
+#define HTTP_SERVER_MSG_RESOURCE_CHANGED            "Requested resource \"%s\" changed while being answered (%ld bytes advertised, %lu read)."
 
 #define HTTP_SERVER_ERR_BASIC_RQST_FIELDS_FAILED    -1
 #define HTTP_SERVER_ERR_REQUESTED_FILE_NOT_FOUND    -2
+#define HTTP_SERVER_ERR_RX_BUFFER_FULL              -3
+#define HTTP_SERVER_ERR_INVALID_CONTENT_LENGTH      -4
+#define HTTP_SERVER_ERR_REQUEST_TOO_LARGE           -5
+#define HTTP_SERVER_ERR_UNSUPPORTED_TRANSFER_CODING -6
+#define HTTP_SERVER_ERR_RESOURCE_CHANGED            -7
 
+#define HTTP_SERVER_RQST_BODY_PENDING               1
+
+#define HTTP_SERVER_IO_WAIT_READ                    1           // Resume once the socket is readable.
+#define HTTP_SERVER_IO_WAIT_WRITE                   2           // Resume once the socket is writable.
+
+#define HTTP_SERVER_METHOD_CODE_UNKNOWN -1
 #define HTTP_SERVER_METHOD_CODE_GET     0
 #define HTTP_SERVER_METHOD_CODE_HEAD    1
 #define HTTP_SERVER_METHOD_CODE_POST    2
@@ -65,10 +108,6 @@
 #define HTTP_SERVER_METHOD_CODE_OPTIONS 6
 #define HTTP_SERVER_METHOD_CODE_TRACE   7
 
-#define HTTP_SERVER_STATUS_CODE_200     "200 OK"
-#define HTTP_SERVER_STATUS_CODE_404     "404 Not found"
-#define HTTP_SERVER_STATUS_CODE_405     "405 Method Not Allowed"
-
 /************************************/
 
 /************************************/
@@ -89,19 +128,79 @@ typedef enum
     HTTP_GEN_RESP_FSM_GET_PATH_TO_RESOURCE                      ,
     HTTP_GEN_RESP_FSM_CHECK_RESOURCE_EXTENSION                  ,
     HTTP_GEN_RESP_FSM_GET_REQUESTED_RESOURCE_SIZE               ,
+    HTTP_GEN_RESP_FSM_SELECT_CONTENT_ENCODING                   ,
+    HTTP_GEN_RESP_FSM_CHECK_CONDITIONAL                         ,
+    HTTP_GEN_RESP_FSM_CHECK_RANGE                               ,
     HTTP_GEN_RESP_FSM_BUILD_RESPONSE_HEADER                     ,
     HTTP_GEN_RESP_FSM_BUILD_ADD_RESOURCE                        ,
+    HTTP_GEN_RESP_FSM_BUILD_PARTIAL_RESPONSE                    ,
+    HTTP_GEN_RESP_FSM_BUILD_MULTIPART_RESPONSE                  ,
+    HTTP_GEN_RESP_FSM_BUILD_RANGE_NOT_SATISFIABLE_RESPONSE      ,
+    HTTP_GEN_RESP_FSM_BUILD_NOT_MODIFIED_RESPONSE               ,
     HTTP_GEN_RESP_FSM_BUILD_TRACE_RESPONSE                      ,
     HTTP_GEN_RESP_FSM_BUILD_SERVER_UNSUPPORTED_METHOD_RESPONSE  ,
+    HTTP_GEN_RESP_FSM_BUILD_STATS_RESPONSE                      ,
     HTTP_GEN_RESP_FSM_END_GEN_RESP                              ,
 } HTTP_GEN_RESP_FSM;
 
 typedef enum
 {
     HTTP_WRITE_FSM_WRITE_TRY        = 0 ,
+    HTTP_WRITE_FSM_WRITE_BODY_FILE      ,
     HTTP_WRITE_FSM_WRITE_END            ,
 } HTTP_WRITE_FSM;
 
+typedef enum
+{
+    HTTP_BODY_SRC_NONE              = 0 ,   // Whole response is found within its header string.
+    HTTP_BODY_SRC_MEMORY                ,   // Body is a (cached) string shared with other connections.
+    HTTP_BODY_SRC_FILE                  ,   // Body is streamed from an open file descriptor.
+} HTTP_BODY_SRC;
+
+typedef enum
+{
+    HTTP_RESPONSE_PART_HEADER       = 0 ,
+    HTTP_RESPONSE_PART_BODY             ,
+} HTTP_RESPONSE_PART;
+
+typedef struct
+{
+    std::string                         header      ;   // Status line and header fields (whole response if there is no separate body).
+    HTTP_BODY_SRC                       body_src    ;
+    std::shared_ptr<const std::string>  body        ;   // HTTP_BODY_SRC_MEMORY
+    int                                 body_fd     ;   // HTTP_BODY_SRC_FILE
+    off_t                               body_offset ;   // HTTP_BODY_SRC_FILE: next byte to be sent.
+    off_t                               body_end    ;   // HTTP_BODY_SRC_FILE: one past the last byte to be sent.
+} HTTP_RESPONSE;
+
+// How an HttpServer instance talks to its socket.
+typedef enum
+{
+    HTTP_SERVER_IO_BLOCKING         = 0 ,   // Blocking socket owned by C_Server_Socket (plaintext or TLS).
+    HTTP_SERVER_IO_NON_BLOCKING         ,   // Non-blocking plaintext socket, read and written when epoll says so.
+    HTTP_SERVER_IO_COMPLETION           ,   // No socket calls at all: received data is fed and responses are taken
+                                            // by an external engine (io_uring), which reports when they are sent.
+} HTTP_SERVER_IO_MODE;
+
+// Piece of the queued responses, as handed to an external engine (HTTP_SERVER_IO_COMPLETION).
+typedef struct
+{
+    const char* data    ;   // Memory segment (nullptr for file segments).
+    size_t      length  ;
+    int         fd      ;   // File segment: [offset, end) is to be sent from fd.
+    off_t       offset  ;
+    off_t       end     ;
+} HTTP_TX_SEGMENT;
+
+// Where the body of the representation being sent is to be taken from, as found when resolving it.
+typedef struct
+{
+    const HTTP_RESOURCE_MANIFEST_ENTRY* manifest_entry  ;   // Known to the manifest (nothing is opened then).
+    std::shared_ptr<const std::string>  body            ;   // Found in the file cache.
+    int                                 fd              ;   // Opened below the resources directory (-1: not open).
+    struct stat                         file_stat       ;
+} HTTP_RESOLVED_RESOURCE;
+
 typedef enum
 {
     HTTP_RUN_FSM_READ               = 0 ,
@@ -119,85 +218,209 @@ typedef enum
 
 class HttpServer
 {
+    // Microbenchmarks (bench/src/server_bench.cpp) drive the private stages one by one.
+    friend class HttpServerBench;
+
 private:
     const std::string path_to_resources;
+    const bool secure_connection;
+    const HTTP_SERVER_IO_MODE io_mode;
 
-    using ext_to_type_table     = const std::map<const std::string, const std::string>  ;
-    using method_to_uint_table  = const std::map<const std::string, const unsigned int> ;
-
-    const std::shared_ptr<ext_to_type_table> ptr_extension_to_content   ;
-    const std::shared_ptr<method_to_uint_table> ptr_method_to_uint      ;
-    const std::shared_ptr<MTX_GRD> ptr_to_resources_read_mutex          ;
-
-    std::map<const std::string, std::string> request_fields =
-    {
-        {"Method"                       , ""},
-        {"Requested resource"           , ""},
-        {"Protocol"                     , ""},
-        {"Host"                         , ""},
-        {"Connection"                   , ""},
-        {"Cache-Control"                , ""},
-        {"Upgrade-Insecure-Requests"    , ""},
-        {"User-Agent"                   , ""},
-        {"Accept"                       , ""},
-        {"Content-Length"               , ""},
-        {"Referer"                      , ""},
-        {"Accept-Encoding"              , ""},
-        {"Accept-Language"              , ""},
-        {"Purpose"                      , ""},
-        {"Sec-Purpose"                  , ""},
-        {"sec-ch-ua"                    , ""},
-        {"sec-ch-ua-mobile"             , ""},
-        {"sec-ch-ua-platform"           , ""},
-        {"Sec-Fetch-Site"               , ""},
-        {"Sec-Fetch-Mode"               , ""},
-        {"Sec-Fetch-User"               , ""},
-        {"Sec-Fetch-Dest"               , ""},
-    };
+    // Cache the requested files are looked up in (the process-wide one unless a shard is given),
+    // and the copies of its index this server reads from, so that lookups take no lock.
+    HttpFileCache&          file_cache          ;
+    HttpFileCache::Reader   file_cache_reader   ;
 
-    bool resource_not_found;
+    HttpRequestParser request_parser;
+
+    // Snapshot of the resource manifest (refreshed once a new one is built).
+    HttpResourceManifest::snapshot          manifest            ;
+    uint64_t                                manifest_generation ;
 
-    std::string read_from_client            ;
-    std::string http_response               ;
-    std::string http_response_status_code   ;
+    // Resources directory, kept open so that files are only ever opened below it.
+    HttpResourceResolver::root_ptr          resources_root              ;
+    uint64_t                                resources_root_generation   ;
 
-    // Check resource sharing mutex status
-    void InitResourcesMutex(void);
+    // Normalized target of the representation being sent, and where it was found. Released once
+    // the response has been generated (streamed bodies hold descriptors of their own).
+    std::string                             resource_target     ;
+    HTTP_RESOLVED_RESOURCE                  resource            ;
+
+    bool resource_not_found;
+    // Metadata of the resource being answered (found when resolving it, before any sidecar is chosen).
+    struct stat resource_stat;
+    // Its ETag and Last-Modified values (shared with every connection serving the same file version).
+    std::shared_ptr<const HTTP_VALIDATORS> validators;
+
+    // Representation chosen for it (SelectContentEncoding): its content coding, and the compressed
+    // body when it comes from the variant cache (precompressed sidecar files are sent as files,
+    // tagged after their own version, as their bytes differ from those the server compresses).
+    // vary_encoding tells whether the choice depended on Accept-Encoding at all.
+    HTTP_CONTENT_ENCODING                   content_encoding    ;
+    std::shared_ptr<const std::string>      encoded_body        ;
+    std::shared_ptr<const HTTP_VALIDATORS>  sidecar_validators  ;
+    bool                                    vary_encoding       ;
+
+    // Caching directives for it (nullptr: none).
+    std::shared_ptr<const HTTP_CACHE_POLICY> cache_policy;
+
+    // Byte ranges requested for the resource being answered, and the boundary separating them
+    // in multipart/byteranges responses (random, so that it is unlikely to be found in any body).
+    std::vector<HTTP_BYTE_RANGE>    ranges              ;
+    std::string                     multipart_boundary  ;
+
+    HttpRxBuffer rx_buffer                  ;
+    HTTP_STATUS http_response_status        ;
+
+    // Pipelined requests: rx_buffer may hold several of them. request_begin is the offset
+    // of the one being processed; bytes before it are dropped before reading from the socket again.
+    size_t request_begin    ;
+
+    // End-of-headers search state for the request at request_begin: scan_offset is where the next
+    // search resumes (bytes before it are known not to start a terminator), header_end is one past
+    // the terminator once found (HTTP_HEADER_SCAN_NOT_FOUND until then).
+    size_t scan_offset      ;
+    size_t header_end       ;
+
+    // Request body framing: once the header block has been parsed, the request is complete as
+    // soon as body_length more bytes (Content-Length) follow it.
+    bool   head_parsed      ;
+    size_t body_length      ;
+
+    // Responses generated for the requests found within a single read. They are kept (instead of
+    // being destroyed) after every flush so that their header strings can reuse the same capacity.
+    std::vector<HTTP_RESPONSE>  responses       ;
+    size_t                      responses_count ;
+
+    // Write cursor over the queued responses.
+    size_t              tx_response_index   ;
+    HTTP_RESPONSE_PART  tx_part             ;
+    size_t              tx_part_offset      ;
+    std::string         tx_coalesce         ;
+
+    // Where Resume will carry on from.
+    HTTP_RUN_FSM    http_run_fsm    ;
+    bool            end_after_write ;
+
+    // Persistent connections: how long an idle connection is kept open and how many requests it
+    // may carry (SetKeepAlive), requests answered so far and whether the connection outlives the
+    // response being generated.
+    unsigned int    keep_alive_timeout  ;
+    unsigned int    keep_alive_requests ;
+    unsigned int    requests_served     ;
+    bool            keep_alive          ;
+
+    // HTTP_SERVER_IO_BLOCKING: receive timeout of the socket as set up by C_Server_Socket, which
+    // applies while a request is being received (the idle timeout applies between requests).
+    struct timeval  request_rx_timeout  ;
+    bool            rx_timeout_saved    ;
+    bool            idle_rx_timeout     ;
+
+    // End-to-end latency of the responses being written: when processing the first of their
+    // requests began (monotonic clock), and how many requests they answer.
+    uint64_t        batch_begin_ns      ;
+    unsigned int    batch_requests      ;
+    // When the first bytes of a request arrived into an empty buffer (monotonic clock), so that
+    // waiting for them on an idle connection is not counted as reading.
+    uint64_t        rx_first_byte_ns    ;
+
+    // Access log: address of the client (looked up once per connection), and the records of the
+    // responses being written, which are queued once they have been sent.
+    char                                client_ip[INET_ADDRSTRLEN]  ;
+    bool                                client_ip_known             ;
+    std::vector<HTTP_ACCESS_LOG_RECORD> access_records              ;
+    size_t                              access_records_count        ;
 
     // Read data from client
     int ReadFromClient(int& client_socket);
     // Used by ReadFromClient
     bool CheckRequestEnd(void);
+    void CompactRxBuffer(void);
+    void SetIdleRxTimeout(int client_socket, bool idle);
     
     // Process request
     int ProcessRequest(void);
     // Used by ProcessRequest
-    std::vector<std::string> ExtractWordsFromReqLine(const std::string& input);
+    int  GetRequestBodyLength(void);
+    void AddErrorResponse(HTTP_STATUS status);
+    // Used by Run once a response has been generated
+    void ConsumeRequest(void);
 
     // Generate response for client
     long int GenerateResponse(void);
     // Used by GenerateResponse
     const std::string   GetPathToRequestedResource(void)                                                    ;
     const std::string   GetPathToResources(void)                                                            ;
-    bool                FileExists(const std::string& filePath)                                             ;
+    bool                ResolveResource(const std::string& target, const std::string& path, HTTP_RESOLVED_RESOURCE& resolved);
+    bool                ConfirmManifestEntry(const std::string& target, const std::string& path, HTTP_RESOLVED_RESOURCE& resolved);
+    int                 OpenResource(const std::string& path)                                               ;
+    void                ReleaseResource(HTTP_RESOLVED_RESOURCE& resolved)                                   ;
     std::string         ParseFileExtension(const std::string& text)                                         ;
     long int            GetRequestedResourceSize(const std::string& resource_to_send)                       ;
-    int                 CopyFileToString(const std::string& path_to_requested_resource, std::string& dest)  ;
-    const std::string   GetMIMEDataType(const std::string& content_type)                                    ;
+    void                SelectContentEncoding(std::string_view content_type, std::string& resource_to_send, long int& resource_size);
+    std::string_view    GetEntityTag(void)                                                                  ;
+    bool                CheckNotModified(void)                                                              ;
+    void                AddValidators(std::string& header)                                                  ;
+    void                AddCacheDirectives(std::string& header)                                             ;
+    bool                CheckKeepAlive(void)                                                                ;
+    void                AddConnectionHeader(std::string& header)                                            ;
+    int                 CheckRange(long int resource_size)                                                  ;
+    bool                CheckIfRange(void)                                                                  ;
+    void                AddContentRange(std::string& header, const HTTP_BYTE_RANGE& range, long int resource_size);
+    int                 CopyFileToString(const std::string& path_to_requested_resource, std::shared_ptr<const std::string>& dest);
+    std::string_view    GetMIMEDataType(std::string_view content_type)                                      ;
+    int                 OpenResourceFile(const std::string& path_to_requested_resource, off_t offset, off_t end, HTTP_RESPONSE& response);
+    void                CloseResourceFile(HTTP_RESPONSE& response)                                          ;
+    HTTP_RESPONSE&      AddResponse(void)                                                                   ;
+    void                ClearResponses(void)                                                                ;
+    long int            GetResponseLength(const HTTP_RESPONSE& response)                                    ;
 
     // Write to client
     int WriteToClient(int& client_socket);
+    // Used by WriteToClient
+    bool        GetTxPart(size_t response_index, HTTP_RESPONSE_PART part, const char*& data, size_t& length);
+    void        AdvanceTxCursor(size_t bytes_written);
+    void        NextTxPart(size_t& response_index, HTTP_RESPONSE_PART& part);
+    long int    SendMemoryParts(int& client_socket, size_t& requested_len);
+    long int    SendFileChunk(int& client_socket, HTTP_RESPONSE& response);
+    int         CheckWriteResult(int& client_socket, long int socket_write);
+    // Once the responses have been sent
+    void        RecordBatchLatency(void);
+    void        LogAccess(void);
+    // Used by ProcessRequest and GenerateResponse
+    void        AddAccessRecord(HTTP_STATUS status, long int bytes);
 
 public:
-    HttpServer(const std::string path_to_resources) ;
-    virtual ~HttpServer(void)                       ;
+    HttpServer(const std::string path_to_resources, bool secure_connection = true, unsigned long max_request_len = HTTP_SERVER_DEFAULT_MAX_REQUEST_LEN, HTTP_SERVER_IO_MODE io_mode = HTTP_SERVER_IO_BLOCKING, HttpFileCache* file_cache = nullptr);
+    virtual ~HttpServer(void);
 
     // Copy constructor will not be allowed as undefined/repeated parameters can lead to potential
     // conflicts during runtime.
     HttpServer(const HttpServer& obj) = delete;
 
+    // Get ready to serve a new connection, keeping the memory already allocated (pooling).
+    void Reset(void);
+
+    // Keep connections open for timeout_secs once idle (0: close them after every response), and
+    // for max_requests requests at most (0: no limit). Announced to clients through Keep-Alive.
+    void SetKeepAlive(unsigned int timeout_secs, unsigned int max_requests);
+
     // Run Http Server FSM
     int Run(int& client_socket);
+
+    // Run Http Server FSM over a non-blocking socket (or without any socket, for completion-based
+    // engines) until it has to wait for the socket. Returns HTTP_SERVER_IO_WAIT_READ/WRITE, or -1
+    // once the connection has to be closed.
+    int Resume(int& client_socket);
+
+    // HTTP_SERVER_IO_COMPLETION only.
+    // Append received bytes. Returns a negative value if they do not fit within the request limit.
+    int     FeedData(const char* data, size_t length);
+    size_t  GetBufferedLength(void) const;
+    // Once Resume returns HTTP_SERVER_IO_WAIT_WRITE: what has to be sent, in order.
+    void    GetTxSegments(std::vector<HTTP_TX_SEGMENT>& segments);
+    // Every segment has been sent: release the responses and let Resume carry on.
+    void    CompleteWrite(void);
 };
 
 /************************************/
@@ -11,12 +11,111 @@
 /********* Define statements ********/
 /************************************/
 
+// Cache-Control directives of a cache policy (AddCachePolicy), besides max-age.
+#define HTTP_CACHE_POLICY_FLAG_IMMUTABLE    0x01    // Never changes while fresh (fingerprinted assets): no revalidation on reload.
+#define HTTP_CACHE_POLICY_FLAG_NO_CACHE     0x02    // May be stored, but has to be revalidated every time (max-age is ignored).
+#define HTTP_CACHE_POLICY_FLAG_NO_STORE     0x04    // Must not be stored at all (max-age is ignored).
+#define HTTP_CACHE_POLICY_FLAG_PRIVATE      0x08    // Only the client may store it, not shared caches.
+
+#define HTTP_CACHE_POLICY_ERR_INVALID       -1
+
+#define HTTP_STATS_MAX_STATUS_CODES         16      // Different status codes reported at most.
+
+// Access log (SetAccessLog).
+#define HTTP_ACCESS_LOG_DEFAULT_FLUSH_MS        1000                        // Records are written once per second at most...
+#define HTTP_ACCESS_LOG_DEFAULT_MAX_FILE_SIZE   (64UL * 1024UL * 1024UL)    // ...to a file rotated past 64 MiB...
+#define HTTP_ACCESS_LOG_DEFAULT_MAX_FILES       5                           // ...keeping 5 rotated files.
+
+#define HTTP_ACCESS_LOG_ERR_OPEN            -1
+
+// Resource manifest (BuildResourceManifest).
+#define HTTP_RESOURCE_MANIFEST_DEFAULT_PRELOAD_BYTES    (32UL * 1024UL * 1024UL)    // File bodies preloaded at most (32 MiB).
+
+#define HTTP_RESOURCE_MANIFEST_ERR_SCAN     -1
+
+#define HTTP_RESOURCE_WATCHER_ERR_INIT      -1
+#define HTTP_RESOURCE_WATCHER_ERR_WATCH     -2
+
 /************************************/
 
 /************************************/
 /********* Type definitions *********/
 /************************************/
 
+typedef struct
+{
+    unsigned long hits      ;   // Requests served from memory.
+    unsigned long misses    ;   // Requests that had to read the file from disk.
+    unsigned long evictions ;   // Entries dropped to make room for new ones.
+    unsigned long entries   ;   // Files currently held in memory.
+    unsigned long bytes     ;   // Memory currently used by file bodies.
+} HTTP_FILE_CACHE_STATS;
+
+// What a cache policy applies to. When several match, the most specific one wins: the longest path
+// prefix, then the file extension, then the MIME group (type without subtype, e.g. "image"), then the
+// default one.
+typedef enum
+{
+    HTTP_CACHE_POLICY_MATCH_PATH_PREFIX     = 0 ,   // Request target starting with key, e.g. "/assets/".
+    HTTP_CACHE_POLICY_MATCH_EXTENSION           ,   // File extension, e.g. "css" (case-insensitive).
+    HTTP_CACHE_POLICY_MATCH_MIME_GROUP          ,   // e.g. "image", "font" (case-insensitive).
+    HTTP_CACHE_POLICY_MATCH_DEFAULT             ,   // Any other resource (key is ignored).
+} HTTP_CACHE_POLICY_MATCH;
+
+// Stages whose latency is measured. All but the last one are steps of the connection FSM, which
+// may run several times per request (e.g. once per read or write the socket needed).
+typedef enum
+{
+    HTTP_STATS_STAGE_READ               = 0 ,   // Reading from the socket (blocking mode: waiting for data as well).
+    HTTP_STATS_STAGE_PROCESS_REQUEST        ,   // Parsing a request.
+    HTTP_STATS_STAGE_GENERATE_RESPONSE      ,   // Building its response.
+    HTTP_STATS_STAGE_WRITE                  ,   // Writing responses to the socket.
+    HTTP_STATS_STAGE_REQUEST                ,   // End to end: from processing a request to having sent its response.
+
+    HTTP_STATS_STAGE_COUNT                  ,
+} HTTP_STATS_STAGE;
+
+typedef struct
+{
+    unsigned long count     ;
+    unsigned long min_ns    ;
+    unsigned long mean_ns   ;
+    unsigned long p50_ns    ;   // Percentiles are accurate to 1/16 of their value.
+    unsigned long p90_ns    ;
+    unsigned long p99_ns    ;
+    unsigned long p999_ns   ;
+    unsigned long max_ns    ;
+} HTTP_LATENCY_STATS;
+
+typedef struct
+{
+    int             status_code ;
+    unsigned long   count       ;
+} HTTP_STATUS_CODE_STATS;
+
+typedef struct
+{
+    HTTP_LATENCY_STATS      latency[HTTP_STATS_STAGE_COUNT]                 ;   // Indexed by HTTP_STATS_STAGE.
+    HTTP_STATUS_CODE_STATS  status_codes[HTTP_STATS_MAX_STATUS_CODES]       ;   // Responses sent, per status code.
+    unsigned int            status_codes_count                              ;
+    unsigned long           bytes_in                                        ;   // Received from clients.
+    unsigned long           bytes_out                                       ;   // Sent to clients.
+    unsigned long           connections_open                                ;
+    unsigned long           connections_total                               ;   // Accepted so far.
+    unsigned long           partial_writes                                  ;   // Writes the socket did not take whole.
+} HTTP_SERVER_STATS;
+
+typedef struct
+{
+    unsigned long events        ;   // inotify events read.
+    unsigned long pending       ;   // Changed paths waiting for their burst of events to end.
+    unsigned long applied       ;   // Changed paths whose cache and manifest entries were refreshed.
+    unsigned long batches       ;   // Times pending paths were applied.
+    unsigned long resyncs       ;   // Times everything was invalidated (event queue overflow, resources directory replaced).
+    unsigned long watches       ;   // Directories watched.
+    unsigned long max_delay_ms  ;   // Longest time from the first event of a batch to its paths being applied.
+} HTTP_RESOURCE_WATCHER_STATS;
+
 /************************************/
 
 /*************************************/
@@ -27,7 +126,25 @@ class HttpInteract
 {
 public:
     static void SetPathToResources(const char* path_to_resources);
+    static void SetSecureConnection(bool secure_connection);
+    static void SetMaxRequestSize(unsigned long max_request_len);
+    static void SetIoUring(bool io_uring);
+    static void SetKeepAlive(unsigned int timeout_secs, unsigned int max_requests);
     static int InteractFn(int client_socket);
+    static int RunEventLoop(int server_port, int max_connections);
+    static int RunReactors(int server_port, int max_connections, int workers, const char* core_list);
+    static void SetFileCacheLimits(unsigned long max_bytes, unsigned long max_entry_bytes);
+    static void GetFileCacheStats(HTTP_FILE_CACHE_STATS* stats);
+    static int  AddCachePolicy(HTTP_CACHE_POLICY_MATCH match, const char* key, long int max_age, unsigned int flags);
+    static void ClearCachePolicies(void);
+    static void SetStatsPath(const char* path);
+    static void GetServerStats(HTTP_SERVER_STATS* stats);
+    static long BuildResourceManifest(unsigned long preload_bytes = HTTP_RESOURCE_MANIFEST_DEFAULT_PRELOAD_BYTES);
+    static void ClearResourceManifest(void);
+    static int  WatchResources(void);
+    static void StopWatchingResources(void);
+    static void GetResourceWatcherStats(HTTP_RESOURCE_WATCHER_STATS* stats);
+    static int  SetAccessLog(const char* path, unsigned int flush_interval_ms = HTTP_ACCESS_LOG_DEFAULT_FLUSH_MS, unsigned long max_file_size = HTTP_ACCESS_LOG_DEFAULT_MAX_FILE_SIZE, unsigned int max_files = HTTP_ACCESS_LOG_DEFAULT_MAX_FILES);
 };
 
 /*************************************/
@@ -0,0 +1,325 @@
+#ifndef CPP_HTTP_STATIC_TABLES_HPP
+#define CPP_HTTP_STATIC_TABLES_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <string_view>
+#include "HttpServer.hpp"
+#include "HttpRequestParser.hpp"
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_STATIC_TABLE_EMPTY_SLOT        0xFF    // Slot value meaning "no entry here".
+#define HTTP_STATIC_TABLE_MAX_SEED_TRIALS   4096    // Seeds tried at compile time before giving up.
+
+/************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+template <typename V>
+struct HTTP_STATIC_TABLE_ENTRY
+{
+    std::string_view    key     ;
+    V                   value   ;
+};
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Read-only lookup table built entirely at compile time. The constructor looks for a hash seed
+// that sends every key to a different slot (i.e. a perfect hash), so a lookup costs one hash,
+// one slot read and one key comparison. SLOTS has to be a power of two; the larger it is compared
+// to N, the fewer seeds have to be tried.
+template <typename V, std::size_t N, std::size_t SLOTS, bool CASE_INSENSITIVE>
+class HttpStaticTable
+{
+private:
+    static_assert(N < HTTP_STATIC_TABLE_EMPTY_SLOT      , "Too many entries for 8-bit slot indexes.");
+    static_assert((SLOTS & (SLOTS - 1)) == 0            , "Slot count must be a power of two.");
+
+    std::array<HTTP_STATIC_TABLE_ENTRY<V>, N>   entries ;
+    std::array<std::uint8_t, SLOTS>             slots   ;
+    std::uint32_t                               seed    ;
+    bool                                        valid   ;
+
+    static constexpr char ToLower(char c)
+    {
+        return (CASE_INSENSITIVE && c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+    }
+
+    // FNV-1a, seeded.
+    static constexpr std::size_t Slot(std::string_view key, std::uint32_t seed)
+    {
+        std::uint32_t hash = 2166136261u ^ seed;
+
+        for(char c : key)
+        {
+            hash ^= (std::uint8_t)ToLower(c);
+            hash *= 16777619u;
+        }
+
+        return (hash ^ (hash >> 16)) & (SLOTS - 1);
+    }
+
+    static constexpr bool KeysMatch(std::string_view a, std::string_view b)
+    {
+        if(a.size() != b.size())
+            return false;
+
+        for(std::size_t i = 0; i < a.size(); i++)
+            if(ToLower(a[i]) != ToLower(b[i]))
+                return false;
+
+        return true;
+    }
+
+    constexpr bool TrySeed(std::uint32_t candidate)
+    {
+        for(std::size_t i = 0; i < SLOTS; i++)
+            this->slots[i] = HTTP_STATIC_TABLE_EMPTY_SLOT;
+
+        for(std::size_t i = 0; i < N; i++)
+        {
+            std::size_t slot = Slot(this->entries[i].key, candidate);
+
+            if(this->slots[slot] != HTTP_STATIC_TABLE_EMPTY_SLOT)
+                return false;
+
+            this->slots[slot] = (std::uint8_t)i;
+        }
+
+        return true;
+    }
+
+public:
+    constexpr HttpStaticTable(const HTTP_STATIC_TABLE_ENTRY<V> (&input)[N]): entries{}, slots{}, seed(0), valid(false)
+    {
+        for(std::size_t i = 0; i < N; i++)
+            this->entries[i] = input[i];
+
+        for(std::uint32_t candidate = 1; candidate <= HTTP_STATIC_TABLE_MAX_SEED_TRIALS && !this->valid; candidate++)
+        {
+            if(this->TrySeed(candidate))
+            {
+                this->seed  = candidate;
+                this->valid = true;
+            }
+        }
+    }
+
+    constexpr bool IsValid(void) const
+    {
+        return this->valid;
+    }
+
+    // Returns not_found if key is not within the table.
+    constexpr V Find(std::string_view key, V not_found) const
+    {
+        std::uint8_t index = this->slots[Slot(key, this->seed)];
+
+        if(index == HTTP_STATIC_TABLE_EMPTY_SLOT || !KeysMatch(this->entries[index].key, key))
+            return not_found;
+
+        return this->entries[index].value;
+    }
+
+    constexpr const std::array<HTTP_STATIC_TABLE_ENTRY<V>, N>& GetEntries(void) const
+    {
+        return this->entries;
+    }
+};
+
+/*************************************/
+
+/************************************/
+/********** Static tables ***********/
+/************************************/
+
+inline constexpr HTTP_STATIC_TABLE_ENTRY<std::string_view> extension_to_content_type_entries[] =
+{
+    {"aac"      ,	"audio/aac"                                                                 },
+    {"abw"      ,	"application/x-abiword"                                                     },
+    {"apng"     ,   "image/apng"                                                                },
+    {"arc"      ,	"application/x-freearc"                                                     },
+    {"avif"     ,	"image/avif"                                                                },
+    {"avi"      ,	"video/x-msvideo"                                                           },
+    {"azw"      ,	"application/vnd.amazon.ebook"                                              },
+    {"bin"      ,	"application/octet-stream"                                                  },
+    {"bmp"      ,	"image/bmp"                                                                 },
+    {"bz"       ,	"application/x-bzip"                                                        },
+    {"bz2"      ,	"application/x-bzip2"                                                       },
+    {"cda"      ,	"application/x-cdf"                                                         },
+    {"csh"      ,	"application/x-csh"                                                         },
+    {"css"      ,	"text/css"                                                                  },
+    {"csv"      ,	"text/csv"                                                                  },
+    {"doc"      ,	"application/msword"                                                        },
+    {"docx"     ,	"application/vnd.openxmlformats-officedocument.wordprocessingml.document"   },
+    {"eot"      ,	"application/vnd.ms-fontobject"                                             },
+    {"epub"     ,	"application/epub+zip"                                                      },
+    {"gz"       ,	"application/gzip"                                                          },
+    {"gif"      ,	"image/gif"                                                                 },
+    {"htm"      ,	"text/html"                                                                 },
+    {"html"     ,	"text/html"                                                                 },
+    {"http"     ,   "message/http"                                                              },
+    {"ico"      ,	"image/vnd.microsoft.icon"                                                  },
+    {"ics"      ,	"text/calendar"                                                             },
+    {"jar"      ,	"application/java-archive"                                                  },
+    {"jpg"      ,	"image/jpeg"                                                                },
+    {"jpeg"     ,	"image/jpeg"                                                                },
+    {"js"       ,	"text/javascript"                                                           },
+    {"json"     ,	"application/json"                                                          },
+    {"jsonld"   ,	"application/ld+json"                                                       },
+    {"mid"      ,	"audio/x-midi"                                                              },
+    {"midi"     ,	"audio/x-midi"                                                              },
+    {"mjs"      ,	"text/javascript"                                                           },
+    {"mp3"      ,	"audio/mpeg"                                                                },
+    {"mp4"      ,	"video/mp4"                                                                 },
+    {"mpeg"     ,	"video/mpeg"                                                                },
+    {"mpkg"     ,	"application/vnd.apple.installer+xml"                                       },
+    {"odp"      ,	"application/vnd.oasis.opendocument.presentation"                           },
+    {"ods"      ,	"application/vnd.oasis.opendocument.spreadsheet"                            },
+    {"odt"      ,	"application/vnd.oasis.opendocument.text"                                   },
+    {"oga"      ,	"audio/ogg"                                                                 },
+    {"ogv"      ,	"video/ogg"                                                                 },
+    {"ogx"      ,	"application/ogg"                                                           },
+    {"opus"     ,	"audio/opus"                                                                },
+    {"otf"      ,	"font/otf"                                                                  },
+    {"png"      ,	"image/png"                                                                 },
+    {"pdf"      ,	"application/pdf"                                                           },
+    {"php"      ,	"application/x-httpd-php"                                                   },
+    {"ppt"      ,	"application/vnd.ms-powerpoint"                                             },
+    {"pptx"     ,	"application/vnd.openxmlformats-officedocument.presentationml.presentation" },
+    {"rar"      ,	"application/vnd.rar"                                                       },
+    {"rtf"      ,	"application/rtf"                                                           },
+    {"sh"       ,	"application/x-sh"                                                          },
+    {"svg"      ,	"image/svg+xml"                                                             },
+    {"tar"      ,	"application/x-tar"                                                         },
+    {"tif"      ,	"image/tiff"                                                                },
+    {"tiff"     ,	"image/tiff"                                                                },
+    {"ts"       ,	"video/mp2t"                                                                },
+    {"ttf"      ,	"font/ttf"                                                                  },
+    {"txt"      ,	"text/plain"                                                                },
+    {"vsd"      ,	"application/vnd.visio"                                                     },
+    {"wav"      ,	"audio/wav"                                                                 },
+    {"weba"     ,	"audio/webm"                                                                },
+    {"webm"     ,	"video/webm"                                                                },
+    {"webp"     ,	"image/webp"                                                                },
+    {"woff"     ,	"font/woff"                                                                 },
+    {"woff2"    ,	"font/woff2"                                                                },
+    {"xhtml"    ,	"application/xhtml+xml"                                                     },
+    {"xls"      ,	"application/vnd.ms-excel"                                                  },
+    {"xlsx"     ,	"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet"         },
+    {"xml"      ,	"application/xml"                                                           },
+    {"xul"      ,	"application/vnd.mozilla.xul+xml"                                           },
+    {"zip"      ,	"application/zip"                                                           },
+    {"3gp"      ,	"video/3gpp"                                                                },
+    {"3g2"      ,	"video/3gpp2"                                                               },
+    {"7z"       ,	"application/x-7z-compressed"                                               },
+};
+
+// Content types worth compressing (text-based ones). Already compressed formats gain nothing.
+inline constexpr HTTP_STATIC_TABLE_ENTRY<bool> compressible_content_type_entries[] =
+{
+    {"application/json"             , true  },
+    {"application/ld+json"          , true  },
+    {"application/xhtml+xml"        , true  },
+    {"application/xml"              , true  },
+    {"application/x-csh"            , true  },
+    {"application/x-httpd-php"      , true  },
+    {"application/x-sh"             , true  },
+    {"image/svg+xml"                , true  },
+    {"image/vnd.microsoft.icon"     , true  },
+    {"message/http"                 , true  },
+    {"text/calendar"                , true  },
+    {"text/css"                     , true  },
+    {"text/csv"                     , true  },
+    {"text/html"                    , true  },
+    {"text/javascript"              , true  },
+    {"text/plain"                   , true  },
+};
+
+inline constexpr HTTP_STATIC_TABLE_ENTRY<int> method_to_uint_entries[] =
+{
+    {"GET"      , HTTP_SERVER_METHOD_CODE_GET    },
+    {"HEAD"     , HTTP_SERVER_METHOD_CODE_HEAD   },
+    {"POST"     , HTTP_SERVER_METHOD_CODE_POST   },
+    {"PUT"      , HTTP_SERVER_METHOD_CODE_PUT    },
+    {"DELETE"   , HTTP_SERVER_METHOD_CODE_DELETE },
+    {"CONNECT"  , HTTP_SERVER_METHOD_CODE_CONNECT},
+    {"OPTIONS"  , HTTP_SERVER_METHOD_CODE_OPTIONS},
+    {"TRACE"    , HTTP_SERVER_METHOD_CODE_TRACE  },
+};
+
+inline constexpr HTTP_STATIC_TABLE_ENTRY<HTTP_HDR> header_name_to_id_entries[] =
+{
+    {"Host"                         , HTTP_HDR_HOST                     },
+    {"Connection"                   , HTTP_HDR_CONNECTION               },
+    {"Keep-Alive"                   , HTTP_HDR_KEEP_ALIVE               },
+    {"Cache-Control"                , HTTP_HDR_CACHE_CONTROL            },
+    {"Pragma"                       , HTTP_HDR_PRAGMA                   },
+    {"Upgrade-Insecure-Requests"    , HTTP_HDR_UPGRADE_INSECURE_REQUESTS},
+    {"User-Agent"                   , HTTP_HDR_USER_AGENT               },
+    {"Accept"                       , HTTP_HDR_ACCEPT                   },
+    {"Accept-Encoding"              , HTTP_HDR_ACCEPT_ENCODING          },
+    {"Accept-Language"              , HTTP_HDR_ACCEPT_LANGUAGE          },
+    {"Content-Length"               , HTTP_HDR_CONTENT_LENGTH           },
+    {"Content-Type"                 , HTTP_HDR_CONTENT_TYPE             },
+    {"Transfer-Encoding"            , HTTP_HDR_TRANSFER_ENCODING        },
+    {"Expect"                       , HTTP_HDR_EXPECT                   },
+    {"Referer"                      , HTTP_HDR_REFERER                  },
+    {"Origin"                       , HTTP_HDR_ORIGIN                   },
+    {"Cookie"                       , HTTP_HDR_COOKIE                   },
+    {"Authorization"                , HTTP_HDR_AUTHORIZATION            },
+    {"Range"                        , HTTP_HDR_RANGE                    },
+    {"If-Range"                     , HTTP_HDR_IF_RANGE                 },
+    {"If-None-Match"                , HTTP_HDR_IF_NONE_MATCH            },
+    {"If-Modified-Since"            , HTTP_HDR_IF_MODIFIED_SINCE        },
+    {"Purpose"                      , HTTP_HDR_PURPOSE                  },
+    {"Sec-Purpose"                  , HTTP_HDR_SEC_PURPOSE              },
+    {"sec-ch-ua"                    , HTTP_HDR_SEC_CH_UA                },
+    {"sec-ch-ua-mobile"             , HTTP_HDR_SEC_CH_UA_MOBILE         },
+    {"sec-ch-ua-platform"           , HTTP_HDR_SEC_CH_UA_PLATFORM       },
+    {"Sec-Fetch-Site"               , HTTP_HDR_SEC_FETCH_SITE           },
+    {"Sec-Fetch-Mode"               , HTTP_HDR_SEC_FETCH_MODE           },
+    {"Sec-Fetch-User"               , HTTP_HDR_SEC_FETCH_USER           },
+    {"Sec-Fetch-Dest"               , HTTP_HDR_SEC_FETCH_DEST           },
+};
+
+// File extensions are matched case-insensitively ("INDEX.HTML" is still text/html).
+inline constexpr HttpStaticTable<std::string_view, std::size(extension_to_content_type_entries), 2048, true>
+    extension_to_content_type(extension_to_content_type_entries);
+
+// Media types are case-insensitive (RFC 9110, section 8.3.1).
+inline constexpr HttpStaticTable<bool, std::size(compressible_content_type_entries), 256, true>
+    compressible_content_type(compressible_content_type_entries);
+
+// Method names are case-sensitive (RFC 9110, section 9.1).
+inline constexpr HttpStaticTable<int, std::size(method_to_uint_entries), 64, false>
+    method_to_uint(method_to_uint_entries);
+
+// Header field names are case-insensitive (RFC 9110, section 5.1).
+inline constexpr HttpStaticTable<HTTP_HDR, std::size(header_name_to_id_entries), 256, true>
+    header_name_to_id(header_name_to_id_entries);
+
+static_assert(extension_to_content_type.IsValid()   , "No perfect hash seed found for extension_to_content_type.");
+static_assert(compressible_content_type.IsValid()   , "No perfect hash seed found for compressible_content_type.");
+static_assert(method_to_uint.IsValid()              , "No perfect hash seed found for method_to_uint.");
+static_assert(header_name_to_id.IsValid()           , "No perfect hash seed found for header_name_to_id.");
+
+/************************************/
+
+#endif
@@ -0,0 +1,563 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpStats.hpp"
+#include <time.h>
+#include <stdio.h>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <memory>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_STATS_NO_MIN   UINT64_MAX
+
+/*************************************/
+
+/******************************************/
+/****** Private variable definitions ******/
+/******************************************/
+
+static const char* const stage_names[HTTP_STATS_STAGE_COUNT] =
+{
+    "read"              ,
+    "process_request"   ,
+    "generate_response" ,
+    "write"             ,
+    "request"           ,
+};
+
+// Upper bounds of the Prometheus histogram buckets. Each one counts the values whose log-linear
+// bucket lies below the bound as a whole, so they are accurate to 1/16 as well.
+static const struct
+{
+    uint64_t    ns      ;
+    const char* seconds ;
+} prometheus_bounds[] =
+{
+    {1000ULL        , "1e-06"   },
+    {5000ULL        , "5e-06"   },
+    {10000ULL       , "1e-05"   },
+    {50000ULL       , "5e-05"   },
+    {100000ULL      , "0.0001"  },
+    {500000ULL      , "0.0005"  },
+    {1000000ULL     , "0.001"   },
+    {5000000ULL     , "0.005"   },
+    {10000000ULL    , "0.01"    },
+    {50000000ULL    , "0.05"    },
+    {100000000ULL   , "0.1"     },
+    {500000000ULL   , "0.5"     },
+    {1000000000ULL  , "1"       },
+    {5000000000ULL  , "5"       },
+    {10000000000ULL , "10"      },
+};
+
+/******************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+HttpStats::ThreadBlock::ThreadBlock(void):
+    block(HttpStats::GetInstance().AcquireBlock())
+{}
+
+HttpStats::ThreadBlock::~ThreadBlock(void)
+{
+    HttpStats::GetInstance().ReleaseBlock(this->block);
+}
+
+HttpStats::HttpStats(void):
+    retired_block(new HTTP_STATS_BLOCK) ,
+    path(HTTP_STATS_DEFAULT_PATH)
+{
+    ClearBlock(*this->retired_block);
+
+    for(int value = 0; value < HTTP_STATS_WATCHER_COUNT; value++)
+        this->watcher_values[value].store(0, std::memory_order_relaxed);
+}
+
+HttpStats& HttpStats::GetInstance(void)
+{
+    static HttpStats instance;
+
+    return instance;
+}
+
+uint64_t HttpStats::GetNowNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+HttpStats::HTTP_STATS_BLOCK& HttpStats::GetThreadBlock(void)
+{
+    thread_local ThreadBlock thread_block;
+
+    return *thread_block.block;
+}
+
+void HttpStats::ClearBlock(HTTP_STATS_BLOCK& block)
+{
+    for(int stage = 0; stage < HTTP_STATS_STAGE_COUNT; stage++)
+    {
+        for(size_t i = 0; i < HTTP_STATS_BUCKETS; i++)
+            block.buckets[stage][i].store(0, std::memory_order_relaxed);
+
+        block.count[stage].store(0, std::memory_order_relaxed);
+        block.sum_ns[stage].store(0, std::memory_order_relaxed);
+        block.min_ns[stage].store(HTTP_STATS_NO_MIN, std::memory_order_relaxed);
+        block.max_ns[stage].store(0, std::memory_order_relaxed);
+    }
+
+    for(int status = 0; status < HTTP_STATUS_COUNT; status++)
+        block.status_codes[status].store(0, std::memory_order_relaxed);
+
+    for(int counter = 0; counter < HTTP_STATS_COUNTER_COUNT; counter++)
+        block.counters[counter].store(0, std::memory_order_relaxed);
+}
+
+HttpStats::HTTP_STATS_BLOCK* HttpStats::AcquireBlock(void)
+{
+    std::lock_guard<std::mutex> lock(this->blocks_mutex);
+
+    HTTP_STATS_BLOCK* block;
+
+    if(this->free_blocks.empty())
+    {
+        block = new HTTP_STATS_BLOCK;
+        ClearBlock(*block);
+    }
+    else
+    {
+        block = this->free_blocks.back();
+        this->free_blocks.pop_back();
+    }
+
+    this->active_blocks.push_back(block);
+
+    return block;
+}
+
+void HttpStats::ReleaseBlock(HTTP_STATS_BLOCK* block)
+{
+    std::lock_guard<std::mutex> lock(this->blocks_mutex);
+
+    // Its owner is gone, so nobody else writes to the retired block.
+    HTTP_STATS_BLOCK& retired = *this->retired_block;
+
+    for(int stage = 0; stage < HTTP_STATS_STAGE_COUNT; stage++)
+    {
+        for(size_t i = 0; i < HTTP_STATS_BUCKETS; i++)
+            Add(retired.buckets[stage][i], block->buckets[stage][i].load(std::memory_order_relaxed));
+
+        Add(retired.count[stage] , block->count[stage].load(std::memory_order_relaxed) );
+        Add(retired.sum_ns[stage], block->sum_ns[stage].load(std::memory_order_relaxed));
+        retired.min_ns[stage].store(std::min(retired.min_ns[stage].load(std::memory_order_relaxed), block->min_ns[stage].load(std::memory_order_relaxed)), std::memory_order_relaxed);
+        retired.max_ns[stage].store(std::max(retired.max_ns[stage].load(std::memory_order_relaxed), block->max_ns[stage].load(std::memory_order_relaxed)), std::memory_order_relaxed);
+    }
+
+    for(int status = 0; status < HTTP_STATUS_COUNT; status++)
+        Add(retired.status_codes[status], block->status_codes[status].load(std::memory_order_relaxed));
+
+    for(int counter = 0; counter < HTTP_STATS_COUNTER_COUNT; counter++)
+        Add(retired.counters[counter], block->counters[counter].load(std::memory_order_relaxed));
+
+    ClearBlock(*block);
+
+    this->active_blocks.erase(std::remove(this->active_blocks.begin(), this->active_blocks.end(), block), this->active_blocks.end());
+    this->free_blocks.push_back(block);
+}
+
+size_t HttpStats::GetBucketIndex(uint64_t value_ns)
+{
+    if(value_ns < HTTP_STATS_SUB_BUCKETS)
+        return (size_t)value_ns;
+
+    value_ns = std::min(value_ns, ((uint64_t)1 << HTTP_STATS_MAX_VALUE_BITS) - 1);
+
+    // Values in [2^msb, 2^(msb + 1)) share the magnitude; the bits right below the most
+    // significant one pick the sub-bucket.
+    int msb     = 63 - __builtin_clzll(value_ns);
+    int shift   = msb - HTTP_STATS_SUB_BUCKET_BITS;
+
+    return (size_t)(shift + 1) * HTTP_STATS_SUB_BUCKETS + (size_t)((value_ns >> shift) - HTTP_STATS_SUB_BUCKETS);
+}
+
+uint64_t HttpStats::GetBucketHighestValue(size_t index)
+{
+    if(index < HTTP_STATS_SUB_BUCKETS)
+        return (uint64_t)index;
+
+    int         shift       = (int)(index / HTTP_STATS_SUB_BUCKETS) - 1;
+    uint64_t    sub_bucket  = (uint64_t)(index % HTTP_STATS_SUB_BUCKETS) + HTTP_STATS_SUB_BUCKETS;
+
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+uint64_t HttpStats::GetPercentile(const HTTP_STATS_TOTALS& totals, int stage, double percentile)
+{
+    uint64_t count = totals.count[stage];
+
+    if(count == 0)
+        return 0;
+
+    uint64_t rank       = std::max((uint64_t)1, (uint64_t)std::ceil(percentile * (double)count));
+    uint64_t cumulative = 0;
+
+    for(size_t i = 0; i < HTTP_STATS_BUCKETS; i++)
+    {
+        cumulative += totals.buckets[stage][i];
+
+        if(cumulative >= rank)
+            return std::min(std::max(GetBucketHighestValue(i), totals.min_ns[stage]), totals.max_ns[stage]);
+    }
+
+    return totals.max_ns[stage];
+}
+
+void HttpStats::RecordLatency(HTTP_STATS_STAGE stage, uint64_t elapsed_ns, uint64_t times)
+{
+    HTTP_STATS_BLOCK& block = GetThreadBlock();
+
+    Add(block.buckets[stage][GetBucketIndex(elapsed_ns)], times);
+    Add(block.count[stage], times);
+    Add(block.sum_ns[stage], elapsed_ns * times);
+
+    if(elapsed_ns < block.min_ns[stage].load(std::memory_order_relaxed))
+        block.min_ns[stage].store(elapsed_ns, std::memory_order_relaxed);
+
+    if(elapsed_ns > block.max_ns[stage].load(std::memory_order_relaxed))
+        block.max_ns[stage].store(elapsed_ns, std::memory_order_relaxed);
+}
+
+void HttpStats::RecordStatus(HTTP_STATUS status)
+{
+    Add(GetThreadBlock().status_codes[status], 1);
+}
+
+void HttpStats::AddCounter(HTTP_STATS_COUNTER counter, uint64_t amount)
+{
+    Add(GetThreadBlock().counters[counter], amount);
+}
+
+void HttpStats::SetWatcherValue(HTTP_STATS_WATCHER_VALUE value, uint64_t amount)
+{
+    HttpStats::GetInstance().watcher_values[value].store(amount, std::memory_order_relaxed);
+}
+
+void HttpStats::AddWatcherValue(HTTP_STATS_WATCHER_VALUE value, uint64_t amount)
+{
+    Add(HttpStats::GetInstance().watcher_values[value], amount);
+}
+
+void HttpStats::SetPath(const char* path)
+{
+    this->path = (path != nullptr) ? path : "";
+}
+
+bool HttpStats::IsStatsTarget(std::string_view target, bool& prometheus)
+{
+    if(this->path.empty())
+        return false;
+
+    size_t query_begin = target.find('?');
+
+    if(target.substr(0, query_begin) != this->path)
+        return false;
+
+    prometheus = false;
+
+    while(query_begin != std::string_view::npos)
+    {
+        size_t query_end = target.find('&', query_begin + 1);
+
+        if(target.substr(query_begin + 1, query_end - (query_begin + 1)) == HTTP_STATS_PROMETHEUS_QUERY)
+            prometheus = true;
+
+        query_begin = query_end;
+    }
+
+    return true;
+}
+
+void HttpStats::Collect(HTTP_STATS_TOTALS& totals)
+{
+    for(int stage = 0; stage < HTTP_STATS_STAGE_COUNT; stage++)
+    {
+        std::fill(std::begin(totals.buckets[stage]), std::end(totals.buckets[stage]), 0);
+        totals.count[stage]     = 0;
+        totals.sum_ns[stage]    = 0;
+        totals.min_ns[stage]    = HTTP_STATS_NO_MIN;
+        totals.max_ns[stage]    = 0;
+    }
+
+    std::fill(std::begin(totals.status_codes), std::end(totals.status_codes), 0);
+    std::fill(std::begin(totals.counters), std::end(totals.counters), 0);
+
+    std::lock_guard<std::mutex> lock(this->blocks_mutex);
+
+    std::vector<HTTP_STATS_BLOCK*> blocks = this->active_blocks;
+    blocks.push_back(this->retired_block);
+
+    // Owners keep writing meanwhile: the figures of a block may be a few events apart from each
+    // other, but every one of them is a value it actually had.
+    for(HTTP_STATS_BLOCK* block : blocks)
+    {
+        for(int stage = 0; stage < HTTP_STATS_STAGE_COUNT; stage++)
+        {
+            for(size_t i = 0; i < HTTP_STATS_BUCKETS; i++)
+                totals.buckets[stage][i] += block->buckets[stage][i].load(std::memory_order_relaxed);
+
+            totals.count[stage]     += block->count[stage].load(std::memory_order_relaxed);
+            totals.sum_ns[stage]    += block->sum_ns[stage].load(std::memory_order_relaxed);
+            totals.min_ns[stage]     = std::min(totals.min_ns[stage], block->min_ns[stage].load(std::memory_order_relaxed));
+            totals.max_ns[stage]     = std::max(totals.max_ns[stage], block->max_ns[stage].load(std::memory_order_relaxed));
+        }
+
+        for(int status = 0; status < HTTP_STATUS_COUNT; status++)
+            totals.status_codes[status] += block->status_codes[status].load(std::memory_order_relaxed);
+
+        for(int counter = 0; counter < HTTP_STATS_COUNTER_COUNT; counter++)
+            totals.counters[counter] += block->counters[counter].load(std::memory_order_relaxed);
+    }
+}
+
+void HttpStats::Summarize(const HTTP_STATS_TOTALS& totals, HTTP_SERVER_STATS& stats)
+{
+    stats = {};
+
+    for(int stage = 0; stage < HTTP_STATS_STAGE_COUNT; stage++)
+    {
+        HTTP_LATENCY_STATS& latency = stats.latency[stage];
+        uint64_t            count   = totals.count[stage];
+
+        if(count == 0)
+            continue;
+
+        latency.count   = count;
+        latency.min_ns  = totals.min_ns[stage];
+        latency.mean_ns = totals.sum_ns[stage] / count;
+        latency.p50_ns  = GetPercentile(totals, stage, 0.5  );
+        latency.p90_ns  = GetPercentile(totals, stage, 0.9  );
+        latency.p99_ns  = GetPercentile(totals, stage, 0.99 );
+        latency.p999_ns = GetPercentile(totals, stage, 0.999);
+        latency.max_ns  = totals.max_ns[stage];
+    }
+
+    for(int status = 0; status < HTTP_STATUS_COUNT && stats.status_codes_count < HTTP_STATS_MAX_STATUS_CODES; status++)
+    {
+        if(totals.status_codes[status] == 0)
+            continue;
+
+        std::string_view        code        = HttpGetStatusCode((HTTP_STATUS)status);
+        HTTP_STATUS_CODE_STATS& code_stats  = stats.status_codes[stats.status_codes_count++];
+
+        std::from_chars(code.data(), code.data() + code.size(), code_stats.status_code);
+        code_stats.count = totals.status_codes[status];
+    }
+
+    uint64_t opened = totals.counters[HTTP_STATS_COUNTER_CONNECTIONS_OPENED];
+    uint64_t closed = totals.counters[HTTP_STATS_COUNTER_CONNECTIONS_CLOSED];
+
+    stats.bytes_in          = totals.counters[HTTP_STATS_COUNTER_BYTES_IN];
+    stats.bytes_out         = totals.counters[HTTP_STATS_COUNTER_BYTES_OUT];
+    stats.connections_open  = (opened > closed) ? (opened - closed) : 0;
+    stats.connections_total = opened;
+    stats.partial_writes    = totals.counters[HTTP_STATS_COUNTER_PARTIAL_WRITES];
+}
+
+void HttpStats::GetStats(HTTP_SERVER_STATS& stats)
+{
+    std::unique_ptr<HTTP_STATS_TOTALS> totals = std::make_unique<HTTP_STATS_TOTALS>();
+
+    this->Collect(*totals);
+    this->Summarize(*totals, stats);
+}
+
+void HttpStats::GetWatcherStats(HTTP_RESOURCE_WATCHER_STATS& stats)
+{
+    stats.events        = this->watcher_values[HTTP_STATS_WATCHER_EVENTS].load(std::memory_order_relaxed)        ;
+    stats.pending       = this->watcher_values[HTTP_STATS_WATCHER_PENDING].load(std::memory_order_relaxed)       ;
+    stats.applied       = this->watcher_values[HTTP_STATS_WATCHER_APPLIED].load(std::memory_order_relaxed)       ;
+    stats.batches       = this->watcher_values[HTTP_STATS_WATCHER_BATCHES].load(std::memory_order_relaxed)       ;
+    stats.resyncs       = this->watcher_values[HTTP_STATS_WATCHER_RESYNCS].load(std::memory_order_relaxed)       ;
+    stats.watches       = this->watcher_values[HTTP_STATS_WATCHER_WATCHES].load(std::memory_order_relaxed)       ;
+    stats.max_delay_ms  = this->watcher_values[HTTP_STATS_WATCHER_MAX_DELAY_MS].load(std::memory_order_relaxed)  ;
+}
+
+void HttpStats::RenderJson(const HTTP_STATS_TOTALS& totals, std::string& body)
+{
+    HTTP_SERVER_STATS stats;
+    this->Summarize(totals, stats);
+
+    body.append("{\n  \"connections\": {\"open\": ");
+    HttpAppendNumber(body, stats.connections_open);
+    body.append(", \"total\": ");
+    HttpAppendNumber(body, stats.connections_total);
+    body.append("},\n  \"bytes\": {\"in\": ");
+    HttpAppendNumber(body, stats.bytes_in);
+    body.append(", \"out\": ");
+    HttpAppendNumber(body, stats.bytes_out);
+    body.append("},\n  \"partial_writes\": ");
+    HttpAppendNumber(body, stats.partial_writes);
+
+    HTTP_RESOURCE_WATCHER_STATS watcher_stats;
+    this->GetWatcherStats(watcher_stats);
+
+    body.append(",\n  \"resource_watcher\": {\"events\": ");
+    HttpAppendNumber(body, watcher_stats.events);
+    body.append(", \"pending\": ");
+    HttpAppendNumber(body, watcher_stats.pending);
+    body.append(", \"applied\": ");
+    HttpAppendNumber(body, watcher_stats.applied);
+    body.append(", \"batches\": ");
+    HttpAppendNumber(body, watcher_stats.batches);
+    body.append(", \"resyncs\": ");
+    HttpAppendNumber(body, watcher_stats.resyncs);
+    body.append(", \"watches\": ");
+    HttpAppendNumber(body, watcher_stats.watches);
+    body.append(", \"max_delay_ms\": ");
+    HttpAppendNumber(body, watcher_stats.max_delay_ms);
+    body.append("}");
+
+    body.append(",\n  \"status_codes\": {");
+    for(unsigned int i = 0; i < stats.status_codes_count; i++)
+    {
+        body.append((i > 0) ? ", \"" : "\"");
+        HttpAppendNumber(body, stats.status_codes[i].status_code);
+        body.append("\": ");
+        HttpAppendNumber(body, stats.status_codes[i].count);
+    }
+
+    body.append("},\n  \"latency_ns\": {");
+    for(int stage = 0; stage < HTTP_STATS_STAGE_COUNT; stage++)
+    {
+        const HTTP_LATENCY_STATS& latency = stats.latency[stage];
+
+        body.append((stage > 0) ? ",\n    \"" : "\n    \"");
+        body.append(stage_names[stage]);
+        body.append("\": {\"count\": ");
+        HttpAppendNumber(body, latency.count);
+        body.append(", \"min\": ");
+        HttpAppendNumber(body, latency.min_ns);
+        body.append(", \"mean\": ");
+        HttpAppendNumber(body, latency.mean_ns);
+        body.append(", \"p50\": ");
+        HttpAppendNumber(body, latency.p50_ns);
+        body.append(", \"p90\": ");
+        HttpAppendNumber(body, latency.p90_ns);
+        body.append(", \"p99\": ");
+        HttpAppendNumber(body, latency.p99_ns);
+        body.append(", \"p999\": ");
+        HttpAppendNumber(body, latency.p999_ns);
+        body.append(", \"max\": ");
+        HttpAppendNumber(body, latency.max_ns);
+        body.append("}");
+    }
+
+    body.append("\n  }\n}\n");
+}
+
+void HttpStats::RenderPrometheus(const HTTP_STATS_TOTALS& totals, std::string& body)
+{
+    HTTP_SERVER_STATS stats;
+    this->Summarize(totals, stats);
+
+    HTTP_RESOURCE_WATCHER_STATS watcher_stats;
+    this->GetWatcherStats(watcher_stats);
+
+    const struct
+    {
+        const char*     name    ;
+        const char*     type    ;
+        const char*     help    ;
+        unsigned long   value   ;
+    } scalars[] =
+    {
+        {"http_server_connections_open"                     , "gauge"   , "Connections currently open."                             , stats.connections_open     },
+        {"http_server_connections_total"                    , "counter" , "Connections accepted."                                   , stats.connections_total    },
+        {"http_server_received_bytes_total"                 , "counter" , "Bytes received from clients."                            , stats.bytes_in             },
+        {"http_server_sent_bytes_total"                     , "counter" , "Bytes sent to clients."                                  , stats.bytes_out            },
+        {"http_server_partial_writes_total"                 , "counter" , "Writes the socket did not take whole."                   , stats.partial_writes       },
+        {"http_server_resource_events_total"                , "counter" , "inotify events read from the resources directory."       , watcher_stats.events       },
+        {"http_server_resource_invalidations_pending"       , "gauge"   , "Changed paths waiting for their burst of events to end." , watcher_stats.pending      },
+        {"http_server_resource_invalidations_applied_total" , "counter" , "Changed paths whose cached entries were refreshed."      , watcher_stats.applied      },
+        {"http_server_resource_invalidation_batches_total"  , "counter" , "Times pending paths were applied."                       , watcher_stats.batches      },
+        {"http_server_resource_resyncs_total"               , "counter" , "Times every cached entry was invalidated."               , watcher_stats.resyncs      },
+        {"http_server_resource_watches"                     , "gauge"   , "Directories watched."                                    , watcher_stats.watches      },
+        {"http_server_resource_invalidation_max_delay_ms"   , "gauge"   , "Longest time from a change to its invalidation."         , watcher_stats.max_delay_ms },
+    };
+
+    for(const auto& scalar : scalars)
+    {
+        body.append("# HELP ").append(scalar.name).append(" ").append(scalar.help).append("\n");
+        body.append("# TYPE ").append(scalar.name).append(" ").append(scalar.type).append("\n");
+        body.append(scalar.name).append(" ");
+        HttpAppendNumber(body, scalar.value);
+        body.append("\n");
+    }
+
+    body.append("# HELP http_server_responses_total Responses sent, per status code.\n");
+    body.append("# TYPE http_server_responses_total counter\n");
+    for(unsigned int i = 0; i < stats.status_codes_count; i++)
+    {
+        body.append("http_server_responses_total{code=\"");
+        HttpAppendNumber(body, stats.status_codes[i].status_code);
+        body.append("\"} ");
+        HttpAppendNumber(body, stats.status_codes[i].count);
+        body.append("\n");
+    }
+
+    body.append("# HELP http_server_stage_duration_seconds Time spent in every stage of request handling.\n");
+    body.append("# TYPE http_server_stage_duration_seconds histogram\n");
+    for(int stage = 0; stage < HTTP_STATS_STAGE_COUNT; stage++)
+    {
+        std::string labels = std::string("{stage=\"") + stage_names[stage] + "\"";
+        uint64_t    cumulative  = 0;
+        size_t      bucket      = 0;
+
+        for(const auto& bound : prometheus_bounds)
+        {
+            for(; bucket < HTTP_STATS_BUCKETS && GetBucketHighestValue(bucket) <= bound.ns; bucket++)
+                cumulative += totals.buckets[stage][bucket];
+
+            body.append("http_server_stage_duration_seconds_bucket").append(labels).append(",le=\"").append(bound.seconds).append("\"} ");
+            HttpAppendNumber(body, cumulative);
+            body.append("\n");
+        }
+
+        body.append("http_server_stage_duration_seconds_bucket").append(labels).append(",le=\"+Inf\"} ");
+        HttpAppendNumber(body, totals.count[stage]);
+
+        char sum_seconds[32];
+        snprintf(sum_seconds, sizeof(sum_seconds), "%.9f", (double)totals.sum_ns[stage] / 1e9);
+
+        body.append("\nhttp_server_stage_duration_seconds_sum").append(labels).append("} ").append(sum_seconds);
+        body.append("\nhttp_server_stage_duration_seconds_count").append(labels).append("} ");
+        HttpAppendNumber(body, totals.count[stage]);
+        body.append("\n");
+    }
+}
+
+void HttpStats::Render(bool prometheus, std::string& body)
+{
+    std::unique_ptr<HTTP_STATS_TOTALS> totals = std::make_unique<HTTP_STATS_TOTALS>();
+
+    this->Collect(*totals);
+
+    if(prometheus)
+        this->RenderPrometheus(*totals, body);
+    else
+        this->RenderJson(*totals, body);
+}
+
+/******************************************/
@@ -0,0 +1,174 @@
+#ifndef CPP_HTTP_STATS_HPP
+#define CPP_HTTP_STATS_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "HttpServer_api.hpp"
+#include "HttpResponseHeader.hpp"
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+// Log-linear histogram: values below HTTP_STATS_SUB_BUCKETS are counted exactly, every power of
+// two above that is split into HTTP_STATS_SUB_BUCKETS buckets (relative error below 1/16).
+#define HTTP_STATS_SUB_BUCKET_BITS          4
+#define HTTP_STATS_SUB_BUCKETS              (1 << HTTP_STATS_SUB_BUCKET_BITS)
+#define HTTP_STATS_MAX_VALUE_BITS           44          // Largest value tracked: 2^44 ns (almost 5 hours). Longer ones are clamped.
+#define HTTP_STATS_BUCKETS                  ((HTTP_STATS_MAX_VALUE_BITS - HTTP_STATS_SUB_BUCKET_BITS + 1) * HTTP_STATS_SUB_BUCKETS)
+
+#define HTTP_STATS_DEFAULT_PATH             ""          // Not served unless a path is set.
+#define HTTP_STATS_PROMETHEUS_QUERY         "format=prometheus"
+#define HTTP_STATS_CONTENT_TYPE_JSON        "application/json"
+#define HTTP_STATS_CONTENT_TYPE_PROMETHEUS  "text/plain; version=0.0.4"
+
+/************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+typedef enum
+{
+    HTTP_STATS_COUNTER_BYTES_IN             = 0 ,
+    HTTP_STATS_COUNTER_BYTES_OUT                ,
+    HTTP_STATS_COUNTER_CONNECTIONS_OPENED       ,
+    HTTP_STATS_COUNTER_CONNECTIONS_CLOSED       ,
+    HTTP_STATS_COUNTER_PARTIAL_WRITES           ,
+
+    HTTP_STATS_COUNTER_COUNT                    ,
+} HTTP_STATS_COUNTER;
+
+// Figures of the resource watcher, published by its thread (see HTTP_RESOURCE_WATCHER_STATS).
+typedef enum
+{
+    HTTP_STATS_WATCHER_EVENTS               = 0 ,
+    HTTP_STATS_WATCHER_PENDING                  ,
+    HTTP_STATS_WATCHER_APPLIED                  ,
+    HTTP_STATS_WATCHER_BATCHES                  ,
+    HTTP_STATS_WATCHER_RESYNCS                  ,
+    HTTP_STATS_WATCHER_WATCHES                  ,
+    HTTP_STATS_WATCHER_MAX_DELAY_MS             ,
+
+    HTTP_STATS_WATCHER_COUNT                    ,
+} HTTP_STATS_WATCHER_VALUE;
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Process-wide server metrics: a latency histogram per HTTP_STATS_STAGE plus a few counters.
+// Every thread records into a block of its own, which no other thread writes to, so recording
+// takes a couple of plain loads and stores (relaxed atomics, only so that readers never see torn
+// values) and no locking at all. Blocks are only summed up when somebody asks for the figures.
+// The blocks of threads that exit (blocking mode runs one thread per connection) are folded into
+// a retired block and reused by later threads.
+class HttpStats
+{
+private:
+    typedef struct
+    {
+        std::atomic<uint64_t> buckets[HTTP_STATS_STAGE_COUNT][HTTP_STATS_BUCKETS];
+        std::atomic<uint64_t> count[HTTP_STATS_STAGE_COUNT]         ;
+        std::atomic<uint64_t> sum_ns[HTTP_STATS_STAGE_COUNT]        ;
+        std::atomic<uint64_t> min_ns[HTTP_STATS_STAGE_COUNT]        ;
+        std::atomic<uint64_t> max_ns[HTTP_STATS_STAGE_COUNT]        ;
+        std::atomic<uint64_t> status_codes[HTTP_STATUS_COUNT]       ;
+        std::atomic<uint64_t> counters[HTTP_STATS_COUNTER_COUNT]    ;
+    } HTTP_STATS_BLOCK;
+
+    // Sum of every block, as taken by Collect.
+    typedef struct
+    {
+        uint64_t buckets[HTTP_STATS_STAGE_COUNT][HTTP_STATS_BUCKETS];
+        uint64_t count[HTTP_STATS_STAGE_COUNT]      ;
+        uint64_t sum_ns[HTTP_STATS_STAGE_COUNT]     ;
+        uint64_t min_ns[HTTP_STATS_STAGE_COUNT]     ;
+        uint64_t max_ns[HTTP_STATS_STAGE_COUNT]     ;
+        uint64_t status_codes[HTTP_STATUS_COUNT]    ;
+        uint64_t counters[HTTP_STATS_COUNTER_COUNT] ;
+    } HTTP_STATS_TOTALS;
+
+    // Hands a block to every thread that records something, and gives it back once it exits.
+    class ThreadBlock
+    {
+    public:
+        HTTP_STATS_BLOCK* block;
+
+        ThreadBlock(void);
+        ~ThreadBlock(void);
+    };
+
+    std::mutex                      blocks_mutex    ;
+    std::vector<HTTP_STATS_BLOCK*>  active_blocks   ;
+    std::vector<HTTP_STATS_BLOCK*>  free_blocks     ;
+    HTTP_STATS_BLOCK*               retired_block   ;   // Figures of the threads that are gone.
+
+    // Written by the resource watcher thread only, so they need no block of their own.
+    std::atomic<uint64_t>           watcher_values[HTTP_STATS_WATCHER_COUNT];
+
+    // Reserved request target (empty: the endpoint is disabled). Set up before serving.
+    std::string path;
+
+    HttpStats(void);
+
+    static HTTP_STATS_BLOCK& GetThreadBlock(void);
+    static void ClearBlock(HTTP_STATS_BLOCK& block);
+    // Only the owner of a block writes to it: no read-modify-write instructions are needed.
+    static inline void Add(std::atomic<uint64_t>& value, uint64_t amount)
+    {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static size_t   GetBucketIndex(uint64_t value_ns);
+    static uint64_t GetBucketHighestValue(size_t index);
+    static uint64_t GetPercentile(const HTTP_STATS_TOTALS& totals, int stage, double percentile);
+
+    HTTP_STATS_BLOCK*   AcquireBlock(void);
+    void                ReleaseBlock(HTTP_STATS_BLOCK* block);
+    void                Collect(HTTP_STATS_TOTALS& totals);
+    void                Summarize(const HTTP_STATS_TOTALS& totals, HTTP_SERVER_STATS& stats);
+    void                RenderJson(const HTTP_STATS_TOTALS& totals, std::string& body);
+    void                RenderPrometheus(const HTTP_STATS_TOTALS& totals, std::string& body);
+
+public:
+    HttpStats(const HttpStats& obj) = delete;
+
+    static HttpStats& GetInstance(void);
+
+    // Monotonic clock reading, in nanoseconds.
+    static uint64_t GetNowNs(void);
+
+    // Recording (any thread, lock-free).
+    static void RecordLatency(HTTP_STATS_STAGE stage, uint64_t elapsed_ns, uint64_t times = 1);
+    static void RecordStatus(HTTP_STATUS status);
+    static void AddCounter(HTTP_STATS_COUNTER counter, uint64_t amount = 1);
+    static void SetWatcherValue(HTTP_STATS_WATCHER_VALUE value, uint64_t amount);
+    static void AddWatcherValue(HTTP_STATS_WATCHER_VALUE value, uint64_t amount = 1);
+
+    // Reserved request target, e.g. "/__stats" (empty: disabled).
+    void SetPath(const char* path);
+    // Whether target (query included) asks for the statistics, and in which format.
+    bool IsStatsTarget(std::string_view target, bool& prometheus);
+
+    void GetStats(HTTP_SERVER_STATS& stats);
+    void GetWatcherStats(HTTP_RESOURCE_WATCHER_STATS& stats);
+    // Response body: JSON, or Prometheus text exposition format.
+    void Render(bool prometheus, std::string& body);
+};
+
+/*************************************/
+
+#endif
@@ -0,0 +1,126 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpTimerWheel.hpp"
+#include "HttpClock.hpp"
+#include <time.h>
+#include <algorithm>
+
+/*************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+HttpTimerWheel::HttpTimerWheel(void):
+    slots(HTTP_TIMER_WHEEL_SLOTS, HTTP_TIMER_WHEEL_NONE)    ,
+    current_tick(HttpNowMs() / HTTP_TIMER_WHEEL_TICK_MS)    ,
+    scheduled_count(0)
+{}
+
+void HttpTimerWheel::Link(int fd)
+{
+    HTTP_TIMER_NODE& node = this->nodes[fd];
+    int& head = this->slots[node.expiry & (HTTP_TIMER_WHEEL_SLOTS - 1)];
+
+    node.prev       = HTTP_TIMER_WHEEL_NONE;
+    node.next       = head;
+    node.scheduled  = true;
+
+    if(head != HTTP_TIMER_WHEEL_NONE)
+        this->nodes[head].prev = fd;
+
+    head = fd;
+    this->scheduled_count++;
+}
+
+void HttpTimerWheel::Unlink(int fd)
+{
+    HTTP_TIMER_NODE& node = this->nodes[fd];
+
+    if(node.prev != HTTP_TIMER_WHEEL_NONE)
+        this->nodes[node.prev].next = node.next;
+    else
+        this->slots[node.expiry & (HTTP_TIMER_WHEEL_SLOTS - 1)] = node.next;
+
+    if(node.next != HTTP_TIMER_WHEEL_NONE)
+        this->nodes[node.next].prev = node.prev;
+
+    node.scheduled = false;
+    this->scheduled_count--;
+}
+
+void HttpTimerWheel::Schedule(int fd, unsigned long timeout_ms)
+{
+    if(fd < 0)
+        return;
+
+    if((size_t)fd >= this->nodes.size())
+        this->nodes.resize(fd + 1, {HTTP_TIMER_WHEEL_NONE, HTTP_TIMER_WHEEL_NONE, 0, false});
+
+    // Ticks up to current_tick are not visited again.
+    unsigned long expiry = (HttpNowMs() + timeout_ms + HTTP_TIMER_WHEEL_TICK_MS - 1) / HTTP_TIMER_WHEEL_TICK_MS;
+    expiry = std::max(expiry, this->current_tick + 1);
+
+    // Busy connections reschedule on every event: most of them land on the same tick.
+    if(this->nodes[fd].scheduled)
+    {
+        if(this->nodes[fd].expiry == expiry)
+            return;
+
+        this->Unlink(fd);
+    }
+
+    this->nodes[fd].expiry = expiry;
+    this->Link(fd);
+}
+
+void HttpTimerWheel::Cancel(int fd)
+{
+    if(fd >= 0 && (size_t)fd < this->nodes.size() && this->nodes[fd].scheduled)
+        this->Unlink(fd);
+}
+
+int HttpTimerWheel::GetWaitMs(void) const
+{
+    if(this->scheduled_count == 0)
+        return -1;
+
+    return (int)(HTTP_TIMER_WHEEL_TICK_MS - HttpNowMs() % HTTP_TIMER_WHEEL_TICK_MS);
+}
+
+void HttpTimerWheel::Expire(std::vector<int>& expired)
+{
+    unsigned long now_tick = HttpNowMs() / HTTP_TIMER_WHEEL_TICK_MS;
+
+    // After a long wait, every slot is visited once at most.
+    unsigned long steps = std::min(now_tick - this->current_tick, (unsigned long)HTTP_TIMER_WHEEL_SLOTS);
+
+    for(unsigned long step = 1; step <= steps && this->scheduled_count > 0; step++)
+    {
+        int fd = this->slots[(this->current_tick + step) & (HTTP_TIMER_WHEEL_SLOTS - 1)];
+
+        while(fd != HTTP_TIMER_WHEEL_NONE)
+        {
+            int next = this->nodes[fd].next;
+
+            if(this->nodes[fd].expiry <= now_tick)
+            {
+                this->Unlink(fd);
+                expired.push_back(fd);
+            }
+
+            fd = next;
+        }
+    }
+
+    this->current_tick = now_tick;
+}
+
+bool HttpTimerWheel::IsEmpty(void) const
+{
+    return (this->scheduled_count == 0);
+}
+
+/******************************************/
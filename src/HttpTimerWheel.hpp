@@ -0,0 +1,70 @@
+#ifndef CPP_HTTP_TIMER_WHEEL_HPP
+#define CPP_HTTP_TIMER_WHEEL_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <vector>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_TIMER_WHEEL_TICK_MS            250         // Timer resolution.
+#define HTTP_TIMER_WHEEL_SLOTS              256         // Power of two: one revolution lasts 64 seconds.
+#define HTTP_TIMER_WHEEL_NONE               -1
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Hashed timing wheel for connection timeouts, keyed by socket descriptor. Every timer lives in
+// the slot its expiry tick hashes to, linked through a node indexed by the descriptor itself, so
+// scheduling, rescheduling and cancelling are O(1) and never allocate once the descriptor table
+// has grown to the largest socket. Timers due more than one revolution ahead just stay in their
+// slot until their tick comes. Meant to be used by the thread of a single event loop.
+class HttpTimerWheel
+{
+private:
+    typedef struct
+    {
+        int             prev        ;   // Descriptors of the neighbours within the slot (HTTP_TIMER_WHEEL_NONE: none).
+        int             next        ;
+        unsigned long   expiry      ;   // Tick the timer is due at.
+        bool            scheduled   ;
+    } HTTP_TIMER_NODE;
+
+    std::vector<HTTP_TIMER_NODE>    nodes           ;   // Indexed by descriptor.
+    std::vector<int>                slots           ;   // First descriptor of every slot.
+    unsigned long                   current_tick    ;   // Every tick up to this one has been expired.
+    unsigned long                   scheduled_count ;
+
+    void Link(int fd);
+    void Unlink(int fd);
+
+public:
+    HttpTimerWheel(void);
+
+    HttpTimerWheel(const HttpTimerWheel& obj) = delete;
+
+    // (Re)arm the timer of fd, due timeout_ms from now (rounded up to the next tick).
+    void Schedule(int fd, unsigned long timeout_ms);
+    // Disarm the timer of fd, if any.
+    void Cancel(int fd);
+
+    // Milliseconds until the next tick, or -1 (wait forever) if no timer is armed.
+    int  GetWaitMs(void) const;
+    // Disarm every timer that is due, appending its descriptor to expired.
+    void Expire(std::vector<int>& expired);
+
+    bool IsEmpty(void) const;
+};
+
+/*************************************/
+
+#endif
@@ -0,0 +1,284 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpUring.hpp"
+#include "HttpLog.hpp"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+
+/*************************************/
+
+/******************************************/
+/******** Private helper functions ********/
+/******************************************/
+
+// Ring indices are shared with the kernel: tails are published with release semantics and the
+// kernel's ones are read with acquire semantics, so that entries are never seen half-written.
+static inline unsigned LoadAcquire(const unsigned* ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static inline void StoreRelease(unsigned* ptr, unsigned value)
+{
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+static int RegisterRing(int ring_fd, unsigned opcode, void* arg, unsigned nr_args)
+{
+    return (int)syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+/******************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+HttpUring::HttpUring(void):
+    ring_fd(-1)             ,
+    enter_fd(-1)            ,
+    enter_flags(0)          ,
+    sq_ring_ptr(MAP_FAILED) ,
+    sq_ring_size(0)         ,
+    sqes(nullptr)           ,
+    sqes_size(0)            ,
+    sqe_tail(0)             ,
+    sqe_submitted(0)        ,
+    buf_ring(nullptr)       ,
+    buf_ring_size(0)        ,
+    buf_ring_mask(0)        ,
+    buf_size(0)
+{}
+
+HttpUring::~HttpUring(void)
+{
+    this->Close();
+}
+
+void HttpUring::Close(void)
+{
+    // Closing the ring cancels whatever is still in flight.
+    if(this->ring_fd >= 0)
+        close(this->ring_fd);
+
+    if(this->buf_ring != nullptr)
+        munmap(this->buf_ring, this->buf_ring_size);
+
+    if(this->sqes != nullptr)
+        munmap(this->sqes, this->sqes_size);
+
+    if(this->sq_ring_ptr != MAP_FAILED)
+        munmap(this->sq_ring_ptr, this->sq_ring_size);
+
+    this->ring_fd       = -1;
+    this->buf_ring      = nullptr;
+    this->sqes          = nullptr;
+    this->sq_ring_ptr   = MAP_FAILED;
+}
+
+int HttpUring::Init(unsigned entries)
+{
+    struct io_uring_params params;
+
+    // Completions are only reaped by the thread that submits: let the kernel skip the interrupts
+    // it would otherwise use to run their task work early. Older kernels reject both flags.
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_COOP_TASKRUN | IORING_SETUP_SINGLE_ISSUER;
+
+    this->ring_fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+
+    if(this->ring_fd < 0 && errno == EINVAL)
+    {
+        memset(&params, 0, sizeof(params));
+        this->ring_fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    }
+
+    if(this->ring_fd < 0)
+    {
+        HTTP_LOG_WNG(HTTP_URING_MSG_UNSUPPORTED, "io_uring_setup", errno);
+        return HTTP_URING_ERR_UNSUPPORTED;
+    }
+
+    if(!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_NODROP))
+    {
+        HTTP_LOG_WNG(HTTP_URING_MSG_UNSUPPORTED, "features", 0);
+        this->Close();
+        return HTTP_URING_ERR_UNSUPPORTED;
+    }
+
+    this->enter_fd = this->ring_fd;
+
+    // Both queues live in a single mapping.
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    this->sq_ring_size = (sq_size > cq_size) ? sq_size : cq_size;
+
+    this->sq_ring_ptr = mmap(nullptr, this->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ring_fd, IORING_OFF_SQ_RING);
+    if(this->sq_ring_ptr == MAP_FAILED)
+    {
+        HTTP_LOG_WNG(HTTP_URING_MSG_UNSUPPORTED, "mmap", errno);
+        this->Close();
+        return HTTP_URING_ERR_MMAP;
+    }
+
+    this->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes_ptr = mmap(nullptr, this->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ring_fd, IORING_OFF_SQES);
+    if(sqes_ptr == MAP_FAILED)
+    {
+        HTTP_LOG_WNG(HTTP_URING_MSG_UNSUPPORTED, "mmap", errno);
+        this->Close();
+        return HTTP_URING_ERR_MMAP;
+    }
+    this->sqes = (struct io_uring_sqe*)sqes_ptr;
+
+    char* ring = (char*)this->sq_ring_ptr;
+
+    this->sq_khead      = (unsigned*)(ring + params.sq_off.head);
+    this->sq_ktail      = (unsigned*)(ring + params.sq_off.tail);
+    this->sq_mask       = *(unsigned*)(ring + params.sq_off.ring_mask);
+    this->sq_entries    = *(unsigned*)(ring + params.sq_off.ring_entries);
+    this->cq_khead      = (unsigned*)(ring + params.cq_off.head);
+    this->cq_ktail      = (unsigned*)(ring + params.cq_off.tail);
+    this->cq_mask       = *(unsigned*)(ring + params.cq_off.ring_mask);
+    this->cqes          = (struct io_uring_cqe*)(ring + params.cq_off.cqes);
+
+    // SQEs are handed out in ring order, so the indirection array is an identity map set once.
+    unsigned* sq_array = (unsigned*)(ring + params.sq_off.array);
+    for(unsigned i = 0; i < this->sq_entries; i++)
+        sq_array[i] = i;
+
+    this->sqe_tail      = *this->sq_ktail;
+    this->sqe_submitted = this->sqe_tail;
+
+    // Registering the ring file saves a file table lookup on every io_uring_enter call (5.18+).
+    struct io_uring_rsrc_update ring_update = {};
+    ring_update.offset  = (unsigned)-1;
+    ring_update.data    = (unsigned long long)this->ring_fd;
+
+    if(RegisterRing(this->ring_fd, IORING_REGISTER_RING_FDS, &ring_update, 1) == 1)
+    {
+        this->enter_fd      = (int)ring_update.offset;
+        this->enter_flags   = IORING_ENTER_REGISTERED_RING;
+    }
+
+    return 0;
+}
+
+bool HttpUring::IsOpSupported(unsigned op) const
+{
+    size_t probe_len = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    std::unique_ptr<char[]> probe_storage(new char[probe_len]());
+    struct io_uring_probe* probe = (struct io_uring_probe*)probe_storage.get();
+
+    if(RegisterRing(this->ring_fd, IORING_REGISTER_PROBE, probe, 256) < 0)
+        return false;
+
+    return (op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED));
+}
+
+int HttpUring::SetupBufferRing(unsigned buf_count, unsigned buf_size, uint16_t buf_group)
+{
+    this->buf_ring_size = buf_count * sizeof(struct io_uring_buf);
+
+    void* ring_ptr = mmap(nullptr, this->buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(ring_ptr == MAP_FAILED)
+        return HTTP_URING_ERR_MMAP;
+
+    this->buf_ring = (struct io_uring_buf_ring*)ring_ptr;
+
+    struct io_uring_buf_reg buf_reg = {};
+    buf_reg.ring_addr       = (unsigned long long)ring_ptr;
+    buf_reg.ring_entries    = buf_count;
+    buf_reg.bgid            = buf_group;
+
+    // Provided buffer rings: 5.19+.
+    if(RegisterRing(this->ring_fd, IORING_REGISTER_PBUF_RING, &buf_reg, 1) < 0)
+    {
+        HTTP_LOG_WNG(HTTP_URING_MSG_UNSUPPORTED, "IORING_REGISTER_PBUF_RING", errno);
+        return HTTP_URING_ERR_BUFFER_RING;
+    }
+
+    this->buf_ring_mask = buf_count - 1;
+    this->buf_size      = buf_size;
+    this->buf_storage.reset(new char[(size_t)buf_count * buf_size]);
+
+    for(unsigned i = 0; i < buf_count; i++)
+        this->RecycleBuffer((uint16_t)i);
+
+    return 0;
+}
+
+char* HttpUring::GetBuffer(uint16_t buf_id) const
+{
+    return this->buf_storage.get() + (size_t)buf_id * this->buf_size;
+}
+
+void HttpUring::RecycleBuffer(uint16_t buf_id)
+{
+    // Entries are indexed from the start of the ring rather than through bufs: compiled as C++,
+    // the header's flexible array member is preceded by an empty struct and thus misplaced.
+    uint16_t tail = this->buf_ring->tail;
+    struct io_uring_buf* buf = (struct io_uring_buf*)this->buf_ring + (tail & this->buf_ring_mask);
+
+    buf->addr   = (unsigned long long)this->GetBuffer(buf_id);
+    buf->len    = this->buf_size;
+    buf->bid    = buf_id;
+
+    __atomic_store_n(&this->buf_ring->tail, (uint16_t)(tail + 1), __ATOMIC_RELEASE);
+}
+
+struct io_uring_sqe* HttpUring::GetSqe(void)
+{
+    if(this->sqe_tail - LoadAcquire(this->sq_khead) >= this->sq_entries)
+    {
+        this->Submit(0);
+
+        if(this->sqe_tail - LoadAcquire(this->sq_khead) >= this->sq_entries)
+            return nullptr;
+    }
+
+    struct io_uring_sqe* sqe = &this->sqes[this->sqe_tail & this->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    this->sqe_tail++;
+
+    return sqe;
+}
+
+int HttpUring::Submit(unsigned wait_nr)
+{
+    unsigned to_submit = this->sqe_tail - this->sqe_submitted;
+
+    StoreRelease(this->sq_ktail, this->sqe_tail);
+    this->sqe_submitted = this->sqe_tail;
+
+    if(to_submit == 0 && wait_nr == 0)
+        return 0;
+
+    unsigned flags = this->enter_flags | ((wait_nr > 0) ? IORING_ENTER_GETEVENTS : 0);
+
+    int submitted = (int)syscall(__NR_io_uring_enter, this->enter_fd, to_submit, wait_nr, flags, nullptr, 0);
+
+    return (submitted < 0) ? -errno : submitted;
+}
+
+struct io_uring_cqe* HttpUring::PeekCqe(void)
+{
+    unsigned head = *this->cq_khead;
+
+    if(head == LoadAcquire(this->cq_ktail))
+        return nullptr;
+
+    return &this->cqes[head & this->cq_mask];
+}
+
+void HttpUring::SeenCqe(void)
+{
+    StoreRelease(this->cq_khead, *this->cq_khead + 1);
+}
+
+/******************************************/
@@ -0,0 +1,95 @@
+#ifndef CPP_HTTP_URING_HPP
+#define CPP_HTTP_URING_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <linux/io_uring.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_URING_MSG_UNSUPPORTED          "io_uring is not available (%s, errno: %d)."
+
+#define HTTP_URING_ERR_UNSUPPORTED          -1          // Kernel lacks io_uring or one of the features required.
+#define HTTP_URING_ERR_MMAP                 -2
+#define HTTP_URING_ERR_BUFFER_RING          -3
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Minimal io_uring wrapper built on the raw system calls (no liburing): one submission and one
+// completion queue, plus an optional ring of provided buffers for receive operations, from which
+// the kernel picks a buffer only once data has actually arrived. Meant to be used by a single
+// thread.
+class HttpUring
+{
+private:
+    int ring_fd         ;
+    int enter_fd        ;   // ring_fd, or its index once the ring itself has been registered.
+    unsigned enter_flags;
+
+    // Submission queue
+    void*           sq_ring_ptr     ;
+    size_t          sq_ring_size    ;
+    unsigned*       sq_khead        ;
+    unsigned*       sq_ktail        ;
+    unsigned        sq_mask         ;
+    unsigned        sq_entries      ;
+    struct io_uring_sqe* sqes       ;
+    size_t          sqes_size       ;
+    unsigned        sqe_tail        ;   // Next SQE to be handed out.
+    unsigned        sqe_submitted   ;   // SQEs already made visible to the kernel.
+
+    // Completion queue (shares the mapping of the submission queue: IORING_FEAT_SINGLE_MMAP)
+    unsigned*       cq_khead        ;
+    unsigned*       cq_ktail        ;
+    unsigned        cq_mask         ;
+    struct io_uring_cqe* cqes       ;
+
+    // Provided buffers
+    struct io_uring_buf_ring* buf_ring;
+    size_t          buf_ring_size   ;
+    unsigned        buf_ring_mask   ;
+    unsigned        buf_size        ;
+    std::unique_ptr<char[]> buf_storage;
+
+    void Close(void);
+
+public:
+    HttpUring(void);
+    ~HttpUring(void);
+
+    HttpUring(const HttpUring& obj) = delete;
+
+    // Returns 0, or HTTP_URING_ERR_* if io_uring (or a required feature) is unavailable.
+    int Init(unsigned entries);
+    bool IsOpSupported(unsigned op) const;
+
+    // Provide buf_count (a power of two) buffers of buf_size bytes each as group buf_group.
+    int SetupBufferRing(unsigned buf_count, unsigned buf_size, uint16_t buf_group);
+    char* GetBuffer(uint16_t buf_id) const;
+    // Hand a buffer back to the kernel once its data has been consumed.
+    void RecycleBuffer(uint16_t buf_id);
+
+    // Returns a zeroed SQE, submitting pending ones first if the queue is full (nullptr if still full).
+    struct io_uring_sqe* GetSqe(void);
+    // Submit pending SQEs and wait for at least wait_nr completions. Returns a negative errno on failure.
+    int Submit(unsigned wait_nr);
+    struct io_uring_cqe* PeekCqe(void);
+    void SeenCqe(void);
+};
+
+/*************************************/
+
+#endif
@@ -0,0 +1,627 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpUringLoop.hpp"
+#include "HttpStats.hpp"
+#include "HttpLog.hpp"
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <algorithm>
+
+/*************************************/
+
+/******************************************/
+/******** Private helper functions ********/
+/******************************************/
+
+static inline uint64_t GetUserData(HTTP_URING_OP op, int fd)
+{
+    return ((uint64_t)op << 32) | (uint32_t)fd;
+}
+
+/******************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+HttpUringLoop::HttpUringLoop(const std::string path_to_resources, const HTTP_EVENT_LOOP_CONFIG& config):
+    HttpEventLoop(path_to_resources, config)    ,
+    stop_value(0)                               ,
+    stopping(false)                             ,
+    timer_timeout({})                           ,
+    timer_armed(false)
+{}
+
+HttpUringLoop::~HttpUringLoop(void)
+{
+    // Run only returns once every connection is released, this is just for loops that never ran.
+    for(std::pair<const int, std::unique_ptr<HTTP_URING_CONNECTION>>& connection : this->uring_connections)
+    {
+        connection.second.reset();
+        close(connection.first);
+        HttpStats::AddCounter(HTTP_STATS_COUNTER_CONNECTIONS_CLOSED);
+    }
+
+    this->uring_connections.clear();
+}
+
+int HttpUringLoop::InitRing(void)
+{
+    int init = this->ring.Init(HTTP_URING_LOOP_ENTRIES);
+    if(init < 0)
+        return init;
+
+    // Multishot receive came along with IORING_OP_SEND_ZC (6.0), which the probe can tell about.
+    if(!this->ring.IsOpSupported(IORING_OP_SEND_ZC))
+    {
+        HTTP_LOG_WNG(HTTP_URING_MSG_UNSUPPORTED, "IORING_RECV_MULTISHOT", 0);
+        return HTTP_URING_ERR_UNSUPPORTED;
+    }
+
+    return this->ring.SetupBufferRing(HTTP_URING_LOOP_RECV_BUFFERS, HTTP_URING_LOOP_RECV_BUFFER_LEN, HTTP_URING_LOOP_RECV_BUFFER_GROUP);
+}
+
+void HttpUringLoop::PrepareAccept(void)
+{
+    struct io_uring_sqe* sqe = this->ring.GetSqe();
+    if(sqe == nullptr)
+        return;
+
+    // A single request keeps accepting connections until it fails.
+    sqe->opcode         = IORING_OP_ACCEPT;
+    sqe->fd             = this->listen_socket;
+    sqe->ioprio         = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags   = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data      = GetUserData(HTTP_URING_OP_ACCEPT, this->listen_socket);
+}
+
+void HttpUringLoop::PrepareStop(void)
+{
+    struct io_uring_sqe* sqe = this->ring.GetSqe();
+    if(sqe == nullptr)
+        return;
+
+    sqe->opcode     = IORING_OP_READ;
+    sqe->fd         = this->stop_fd;
+    sqe->addr       = (unsigned long long)&this->stop_value;
+    sqe->len        = sizeof(this->stop_value);
+    sqe->user_data  = GetUserData(HTTP_URING_OP_STOP, this->stop_fd);
+}
+
+void HttpUringLoop::PrepareTimer(void)
+{
+    struct io_uring_sqe* sqe = this->ring.GetSqe();
+    if(sqe == nullptr)
+        return;
+
+    int wait_ms = this->idle_timers.GetWaitMs();
+
+    this->timer_timeout.tv_sec  = wait_ms / 1000;
+    this->timer_timeout.tv_nsec = (long long)(wait_ms % 1000) * 1000000LL;
+
+    // Relative timeout, not bound to any completion count.
+    sqe->opcode     = IORING_OP_TIMEOUT;
+    sqe->fd         = -1;
+    sqe->addr       = (unsigned long long)&this->timer_timeout;
+    sqe->len        = 1;
+    sqe->user_data  = GetUserData(HTTP_URING_OP_TIMER, -1);
+
+    this->timer_armed = true;
+}
+
+void HttpUringLoop::PrepareRecv(int client_socket, HTTP_URING_CONNECTION& connection)
+{
+    struct io_uring_sqe* sqe = this->ring.GetSqe();
+    if(sqe == nullptr)
+    {
+        this->CloseConnection(client_socket, connection);
+        return;
+    }
+
+    // No buffer is given: the kernel picks one from the provided ring once data is there.
+    sqe->opcode     = IORING_OP_RECV;
+    sqe->fd         = client_socket;
+    sqe->ioprio     = IORING_RECV_MULTISHOT;
+    sqe->flags      = IOSQE_BUFFER_SELECT;
+    sqe->buf_group  = HTTP_URING_LOOP_RECV_BUFFER_GROUP;
+    sqe->user_data  = GetUserData(HTTP_URING_OP_RECV, client_socket);
+
+    connection.inflight++;
+    connection.recv_armed = true;
+}
+
+void HttpUringLoop::PrepareCancelRecv(int client_socket, HTTP_URING_CONNECTION& connection)
+{
+    struct io_uring_sqe* sqe = this->ring.GetSqe();
+    if(sqe == nullptr)
+        return;
+
+    sqe->opcode     = IORING_OP_ASYNC_CANCEL;
+    sqe->fd         = -1;
+    sqe->addr       = GetUserData(HTTP_URING_OP_RECV, client_socket);
+    sqe->user_data  = GetUserData(HTTP_URING_OP_CANCEL, client_socket);
+
+    connection.inflight++;
+    connection.recv_paused = true;
+}
+
+void HttpUringLoop::PrepareChain(int client_socket, HTTP_URING_CONNECTION& connection)
+{
+    std::vector<HTTP_TX_SEGMENT>& segments = connection.tx_segments;
+    size_t index = connection.tx_index;
+    size_t iov_count = 0;
+
+    connection.chain_pending    = 0;
+    connection.chain_failed     = false;
+    connection.chain_send_len   = 0;
+    connection.chain_file_len   = 0;
+
+    // Memory segments up to the next file one (or the iovec limit) go out in a single sendmsg.
+    while(index < segments.size() && segments[index].fd < 0 && iov_count < HTTP_SERVER_MAX_IOV)
+    {
+        connection.iov[iov_count].iov_base  = (void*)segments[index].data;
+        connection.iov[iov_count].iov_len   = segments[index].length;
+        connection.chain_send_len          += segments[index].length;
+        iov_count++;
+        index++;
+    }
+
+    connection.chain_memory_end = index;
+
+    bool send_file = (index < segments.size() && segments[index].fd >= 0 && iov_count < HTTP_SERVER_MAX_IOV);
+
+    // MSG_WAITALL: a short send fails the request, which in turn cancels the rest of the chain.
+    // MSG_MORE: when a file chunk follows, small headers leave in the same segment as its first bytes.
+    if(iov_count > 0)
+    {
+        struct io_uring_sqe* sqe = this->ring.GetSqe();
+        if(sqe == nullptr)
+        {
+            this->CloseConnection(client_socket, connection);
+            return;
+        }
+
+        connection.msg              = {};
+        connection.msg.msg_iov      = connection.iov;
+        connection.msg.msg_iovlen   = iov_count;
+
+        sqe->opcode     = IORING_OP_SENDMSG;
+        sqe->fd         = client_socket;
+        sqe->addr       = (unsigned long long)&connection.msg;
+        sqe->len        = 1;
+        sqe->msg_flags  = MSG_NOSIGNAL | MSG_WAITALL | (send_file ? MSG_MORE : 0);
+        sqe->flags      = send_file ? IOSQE_IO_LINK : 0;
+        sqe->user_data  = GetUserData(HTTP_URING_OP_SEND, client_socket);
+
+        connection.chain_pending++;
+        connection.inflight++;
+    }
+
+    if(send_file)
+    {
+        HTTP_TX_SEGMENT& segment = segments[index];
+        size_t chunk_len = std::min((size_t)(segment.end - segment.offset), (size_t)HTTP_URING_LOOP_FILE_CHUNK_LEN);
+
+        if(connection.file_chunk == nullptr)
+            connection.file_chunk.reset(new char[HTTP_URING_LOOP_FILE_CHUNK_LEN]);
+
+        struct io_uring_sqe* read_sqe = this->ring.GetSqe();
+        struct io_uring_sqe* send_sqe = (read_sqe != nullptr) ? this->ring.GetSqe() : nullptr;
+        if(send_sqe == nullptr)
+        {
+            this->CloseConnection(client_socket, connection);
+            return;
+        }
+
+        // A short read breaks the link as well, so a truncated chunk is never sent.
+        read_sqe->opcode    = IORING_OP_READ;
+        read_sqe->fd        = segment.fd;
+        read_sqe->addr      = (unsigned long long)connection.file_chunk.get();
+        read_sqe->len       = chunk_len;
+        read_sqe->off       = segment.offset;
+        read_sqe->flags     = IOSQE_IO_LINK;
+        read_sqe->user_data = GetUserData(HTTP_URING_OP_FILE_READ, client_socket);
+
+        send_sqe->opcode    = IORING_OP_SEND;
+        send_sqe->fd        = client_socket;
+        send_sqe->addr      = (unsigned long long)connection.file_chunk.get();
+        send_sqe->len       = chunk_len;
+        send_sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        send_sqe->user_data = GetUserData(HTTP_URING_OP_FILE_SEND, client_socket);
+
+        connection.chain_file_len   = chunk_len;
+        connection.chain_pending   += 2;
+        connection.inflight        += 2;
+    }
+}
+
+void HttpUringLoop::HandleAccept(int result, unsigned flags)
+{
+    // The multishot accept stops on errors: arm it again.
+    if(!(flags & IORING_CQE_F_MORE) && !this->stopping)
+        this->PrepareAccept();
+
+    if(result < 0)
+    {
+        if(result != -ECONNABORTED && result != -EINTR && result != -ECANCELED)
+            HTTP_LOG_ERR(HTTP_EVENT_LOOP_MSG_ACCEPT_ERROR, -result);
+
+        return;
+    }
+
+    int client_socket = result;
+
+    if(this->stopping)
+    {
+        close(client_socket);
+        return;
+    }
+
+    if((int)this->uring_connections.size() >= this->config.max_connections)
+    {
+        HTTP_LOG_WNG(HTTP_EVENT_LOOP_MSG_TOO_MANY_CONNECTIONS, (int)this->uring_connections.size());
+        close(client_socket);
+        return;
+    }
+
+    int enable = 1;
+    setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+    std::unique_ptr<HTTP_URING_CONNECTION> connection = std::make_unique<HTTP_URING_CONNECTION>();
+    connection->http_server = this->GetServer();
+
+    HTTP_URING_CONNECTION& new_connection = *connection;
+    this->uring_connections[client_socket] = std::move(connection);
+
+    this->ScheduleIdleTimeout(client_socket);
+    this->PrepareRecv(client_socket, new_connection);
+
+    if(new_connection.closing && new_connection.inflight == 0)
+        this->ReleaseConnection(client_socket);
+}
+
+void HttpUringLoop::HandleRecv(int client_socket, int result, unsigned flags)
+{
+    std::unordered_map<int, std::unique_ptr<HTTP_URING_CONNECTION>>::iterator it = this->uring_connections.find(client_socket);
+
+    if(it == this->uring_connections.end())
+    {
+        if(flags & IORING_CQE_F_BUFFER)
+            this->ring.RecycleBuffer((uint16_t)(flags >> IORING_CQE_BUFFER_SHIFT));
+
+        return;
+    }
+
+    HTTP_URING_CONNECTION& connection = *it->second;
+    bool sending = !connection.tx_segments.empty();
+
+    if(!(flags & IORING_CQE_F_MORE))
+    {
+        connection.inflight--;
+        connection.recv_armed = false;
+    }
+
+    if(result > 0)
+    {
+        uint16_t buf_id = (uint16_t)(flags >> IORING_CQE_BUFFER_SHIFT);
+
+        if(!connection.closing)
+            this->ScheduleIdleTimeout(client_socket);
+        int feed_data = connection.closing ? 0 : connection.http_server->FeedData(this->ring.GetBuffer(buf_id), result);
+
+        // Data has been copied: the buffer can take the next packet of any connection.
+        this->ring.RecycleBuffer(buf_id);
+
+        // The receive buffer already holds the largest request allowed, still not answered.
+        unsigned long high_water = std::max(this->config.max_request_len, (unsigned long)HTTP_SERVER_MIN_MAX_REQUEST_LEN) / 2;
+
+        if(feed_data < 0)
+        {
+            HTTP_LOG_WNG(HTTP_URING_LOOP_MSG_RX_OVERFLOW, client_socket);
+            this->CloseConnection(client_socket, connection);
+        }
+        // While responses are being sent, requests just pile up (as they would in the socket
+        // under epoll). Past the high water mark, stop receiving until the responses are out.
+        else if(sending && !connection.closing)
+        {
+            if(connection.recv_armed && !connection.recv_paused && connection.http_server->GetBufferedLength() > high_water)
+                this->PrepareCancelRecv(client_socket, connection);
+        }
+        else if(!connection.closing)
+            this->ResumeConnection(client_socket, connection);
+    }
+    else if(result == 0)
+    {
+        connection.peer_closed = true;
+
+        // Whatever was received has been answered already, unless responses are still being sent.
+        if(!sending)
+            this->CloseConnection(client_socket, connection);
+    }
+    // Out of provided buffers (the request is just armed again) or paused on purpose.
+    else if(result != -ENOBUFS && result != -ECANCELED)
+        this->CloseConnection(client_socket, connection);
+
+    if(!connection.closing && !connection.recv_armed && !connection.recv_paused && !connection.peer_closed)
+        this->PrepareRecv(client_socket, connection);
+
+    if(connection.closing && connection.inflight == 0)
+        this->ReleaseConnection(client_socket);
+}
+
+void HttpUringLoop::HandleSend(int client_socket, HTTP_URING_OP op, int result)
+{
+    std::unordered_map<int, std::unique_ptr<HTTP_URING_CONNECTION>>::iterator it = this->uring_connections.find(client_socket);
+    if(it == this->uring_connections.end())
+        return;
+
+    HTTP_URING_CONNECTION& connection = *it->second;
+
+    connection.inflight--;
+    connection.chain_pending--;
+
+    size_t expected_len = (op == HTTP_URING_OP_SEND) ? connection.chain_send_len : connection.chain_file_len;
+
+    // Links that were cancelled complete with -ECANCELED.
+    if(result < 0 || (size_t)result != expected_len)
+        connection.chain_failed = true;
+    // Slow readers are not idle as long as they keep taking data.
+    else if(!connection.closing)
+        this->ScheduleIdleTimeout(client_socket);
+
+    if(connection.chain_pending == 0 && !connection.closing)
+        this->CompleteChain(client_socket, connection);
+
+    if(connection.closing && connection.inflight == 0)
+        this->ReleaseConnection(client_socket);
+}
+
+void HttpUringLoop::HandleCancel(int client_socket)
+{
+    std::unordered_map<int, std::unique_ptr<HTTP_URING_CONNECTION>>::iterator it = this->uring_connections.find(client_socket);
+    if(it == this->uring_connections.end())
+        return;
+
+    HTTP_URING_CONNECTION& connection = *it->second;
+
+    connection.inflight--;
+
+    if(connection.closing && connection.inflight == 0)
+        this->ReleaseConnection(client_socket);
+}
+
+void HttpUringLoop::HandleTimer(void)
+{
+    this->timer_armed = false;
+
+    this->expired_sockets.clear();
+    this->idle_timers.Expire(this->expired_sockets);
+
+    for(int client_socket : this->expired_sockets)
+    {
+        std::unordered_map<int, std::unique_ptr<HTTP_URING_CONNECTION>>::iterator it = this->uring_connections.find(client_socket);
+        if(it == this->uring_connections.end())
+            continue;
+
+        HTTP_URING_CONNECTION& connection = *it->second;
+
+        HTTP_LOG_DBG(HTTP_EVENT_LOOP_MSG_IDLE_TIMEOUT, client_socket, this->GetIdleTimeout());
+        this->CloseConnection(client_socket, connection);
+
+        if(connection.inflight == 0)
+            this->ReleaseConnection(client_socket);
+    }
+}
+
+void HttpUringLoop::CompleteChain(int client_socket, HTTP_URING_CONNECTION& connection)
+{
+    if(connection.chain_failed)
+    {
+        this->CloseConnection(client_socket, connection);
+        return;
+    }
+
+    connection.tx_index = connection.chain_memory_end;
+
+    if(connection.chain_file_len > 0)
+    {
+        HTTP_TX_SEGMENT& segment = connection.tx_segments[connection.tx_index];
+
+        segment.offset += connection.chain_file_len;
+        if(segment.offset >= segment.end)
+            connection.tx_index++;
+    }
+
+    if(connection.tx_index < connection.tx_segments.size())
+    {
+        this->PrepareChain(client_socket, connection);
+        return;
+    }
+
+    // Every response is out: let the FSM carry on with whatever was received meanwhile.
+    connection.tx_segments.clear();
+    connection.http_server->CompleteWrite();
+
+    this->ResumeConnection(client_socket, connection);
+}
+
+void HttpUringLoop::ResumeConnection(int client_socket, HTTP_URING_CONNECTION& connection)
+{
+    int resume = connection.http_server->Resume(client_socket);
+
+    if(resume < 0)
+    {
+        this->CloseConnection(client_socket, connection);
+        return;
+    }
+
+    if(resume == HTTP_SERVER_IO_WAIT_WRITE)
+    {
+        connection.http_server->GetTxSegments(connection.tx_segments);
+        connection.tx_index = 0;
+
+        // Nothing to be sent after all.
+        if(connection.tx_segments.empty())
+        {
+            connection.http_server->CompleteWrite();
+            this->ResumeConnection(client_socket, connection);
+            return;
+        }
+
+        this->PrepareChain(client_socket, connection);
+        return;
+    }
+
+    // Waiting for more data: there is none to come if the peer is gone.
+    if(connection.peer_closed)
+        this->CloseConnection(client_socket, connection);
+    else if(connection.recv_paused)
+    {
+        connection.recv_paused = false;
+
+        if(!connection.recv_armed)
+            this->PrepareRecv(client_socket, connection);
+    }
+}
+
+void HttpUringLoop::CloseConnection(int client_socket, HTTP_URING_CONNECTION& connection)
+{
+    if(connection.closing)
+        return;
+
+    // Pending operations on the socket complete (or fail) right away. The descriptor itself is
+    // only closed once they are all reaped, so that it cannot be reused meanwhile.
+    connection.closing = true;
+    shutdown(client_socket, SHUT_RDWR);
+
+    this->idle_timers.Cancel(client_socket);
+}
+
+void HttpUringLoop::ReleaseConnection(int client_socket)
+{
+    std::unordered_map<int, std::unique_ptr<HTTP_URING_CONNECTION>>::iterator it = this->uring_connections.find(client_socket);
+
+    if(it != this->uring_connections.end())
+    {
+        this->ReleaseServer(it->second->http_server);
+        this->uring_connections.erase(it);
+    }
+
+    close(client_socket);
+}
+
+int HttpUringLoop::Run(void)
+{
+    if(this->InitRing() < 0)
+    {
+        HTTP_LOG_WNG(HTTP_URING_LOOP_MSG_FALLBACK);
+        return HttpEventLoop::Run();
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    this->PinToCpu();
+
+    int open_listen_socket = this->OpenListenSocket();
+    if(open_listen_socket < 0)
+        return open_listen_socket;
+
+    if(this->stop_fd < 0)
+    {
+        HTTP_LOG_ERR(HTTP_EVENT_LOOP_MSG_EPOLL_ERROR, errno);
+        return HTTP_EVENT_LOOP_ERR_EPOLL;
+    }
+
+    this->server_io_mode = HTTP_SERVER_IO_COMPLETION;
+
+    this->PrepareAccept();
+    this->PrepareStop();
+
+    HTTP_LOG_INF(HTTP_URING_LOOP_MSG_LISTENING, this->config.server_port, this->config.max_connections);
+
+    // Once stopped, keep reaping until every connection is released: the kernel may still be
+    // using their buffers until then.
+    while(!this->stopping || !this->uring_connections.empty())
+    {
+        if(!this->timer_armed && !this->stopping && !this->idle_timers.IsEmpty())
+            this->PrepareTimer();
+
+        int submit = this->ring.Submit(1);
+
+        if(submit < 0 && submit != -EINTR && submit != -EAGAIN && submit != -EBUSY)
+        {
+            HTTP_LOG_ERR(HTTP_URING_LOOP_MSG_SUBMIT_ERROR, submit);
+            return HTTP_URING_LOOP_ERR_SUBMIT;
+        }
+
+        struct io_uring_cqe* cqe;
+
+        while((cqe = this->ring.PeekCqe()) != nullptr)
+        {
+            HTTP_URING_OP   op      = (HTTP_URING_OP)(cqe->user_data >> 32);
+            int             fd      = (int)(uint32_t)cqe->user_data;
+            int             result  = cqe->res;
+            unsigned        flags   = cqe->flags;
+
+            this->ring.SeenCqe();
+
+            switch(op)
+            {
+                case HTTP_URING_OP_ACCEPT:
+                    this->HandleAccept(result, flags);
+                break;
+
+                case HTTP_URING_OP_STOP:
+                {
+                    this->stopping = true;
+
+                    std::vector<int> client_sockets;
+                    for(std::pair<const int, std::unique_ptr<HTTP_URING_CONNECTION>>& connection : this->uring_connections)
+                        client_sockets.push_back(connection.first);
+
+                    for(int client_socket : client_sockets)
+                    {
+                        HTTP_URING_CONNECTION& connection = *this->uring_connections[client_socket];
+
+                        this->CloseConnection(client_socket, connection);
+                        if(connection.inflight == 0)
+                            this->ReleaseConnection(client_socket);
+                    }
+                }
+                break;
+
+                case HTTP_URING_OP_RECV:
+                    this->HandleRecv(fd, result, flags);
+                break;
+
+                case HTTP_URING_OP_SEND:
+                case HTTP_URING_OP_FILE_READ:
+                case HTTP_URING_OP_FILE_SEND:
+                    this->HandleSend(fd, op, result);
+                break;
+
+                case HTTP_URING_OP_CANCEL:
+                    this->HandleCancel(fd);
+                break;
+
+                case HTTP_URING_OP_TIMER:
+                    this->HandleTimer();
+                break;
+
+                default:
+                break;
+            }
+        }
+    }
+
+    HTTP_LOG_INF(HTTP_EVENT_LOOP_MSG_STOPPED);
+
+    return 0;
+}
+
+/******************************************/
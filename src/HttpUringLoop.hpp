@@ -0,0 +1,140 @@
+#ifndef CPP_HTTP_URING_LOOP_HPP
+#define CPP_HTTP_URING_LOOP_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpEventLoop.hpp"
+#include "HttpUring.hpp"
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <string>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_URING_LOOP_ENTRIES                 4096        // Submission queue entries.
+#define HTTP_URING_LOOP_RECV_BUFFERS            256         // Provided receive buffers (power of two).
+#define HTTP_URING_LOOP_RECV_BUFFER_LEN         16384
+#define HTTP_URING_LOOP_RECV_BUFFER_GROUP       0
+#define HTTP_URING_LOOP_FILE_CHUNK_LEN          65536       // File bytes read (then sent) per linked chain.
+
+#define HTTP_URING_LOOP_MSG_LISTENING           "io_uring loop listening on port %d (up to %d connections)."
+#define HTTP_URING_LOOP_MSG_FALLBACK            "Falling back to the epoll event loop."
+#define HTTP_URING_LOOP_MSG_SUBMIT_ERROR        "io_uring_enter error: %d"
+#define HTTP_URING_LOOP_MSG_RX_OVERFLOW         "Closing connection %d: it sent more than fits in its receive buffer."
+
+#define HTTP_URING_LOOP_ERR_SUBMIT              -5
+
+/************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+// What a completion refers to. Stored in the upper half of the user data, the file descriptor
+// goes in the lower one.
+typedef enum
+{
+    HTTP_URING_OP_ACCEPT            = 0 ,
+    HTTP_URING_OP_STOP                  ,
+    HTTP_URING_OP_RECV                  ,
+    HTTP_URING_OP_SEND                  ,   // Memory segments (sendmsg).
+    HTTP_URING_OP_FILE_READ             ,   // File chunk read into the connection's chunk buffer...
+    HTTP_URING_OP_FILE_SEND             ,   // ... and then sent, linked to the read.
+    HTTP_URING_OP_CANCEL                ,
+    HTTP_URING_OP_TIMER                 ,   // Next tick of the idle timers.
+} HTTP_URING_OP;
+
+typedef struct
+{
+    std::unique_ptr<HttpServer>     http_server     ;
+
+    int     inflight        ;   // Operations submitted and not completed yet: the socket is closed once none is left.
+    bool    recv_armed      ;   // A multishot receive is active.
+    bool    recv_paused     ;   // Receive cancelled until pending responses are sent (too much data buffered).
+    bool    peer_closed     ;
+    bool    closing         ;
+
+    // Pending responses, sent one linked chain at a time (memory segments, then a file chunk).
+    std::vector<HTTP_TX_SEGMENT>    tx_segments     ;
+    size_t                          tx_index        ;
+    int                             chain_pending   ;
+    bool                            chain_failed    ;
+    size_t                          chain_memory_end;   // First segment not covered by the chain's sendmsg.
+    size_t                          chain_send_len  ;   // Memory bytes covered by the chain.
+    size_t                          chain_file_len  ;   // File bytes covered by the chain.
+    struct msghdr                   msg             ;
+    struct iovec                    iov[HTTP_SERVER_MAX_IOV];
+    std::unique_ptr<char[]>         file_chunk      ;
+} HTTP_URING_CONNECTION;
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Completion-based variant of HttpEventLoop: instead of being told when sockets are ready and
+// then calling recv/send/sendfile, operations are queued in an io_uring instance and their
+// results are reaped in batches, so that a single io_uring_enter call both submits a round of
+// work and waits for the next one.
+// - Connections are accepted by one multishot accept.
+// - Every connection keeps a multishot receive armed, picking its buffer from a ring of provided
+//   buffers: idle connections hold no receive memory. Data is copied into the HttpServer
+//   (HTTP_SERVER_IO_COMPLETION), whose FSMs run exactly as they do under epoll.
+// - Responses go out as linked chains: one sendmsg for header (and in-memory bodies) followed by
+//   a read of a file chunk and the send of that chunk, so each chain costs a single submission.
+// - Idle connections are expired by the timer wheel of HttpEventLoop, ticked by a timeout operation.
+// If the kernel lacks io_uring, or any of the features above, Run falls back to HttpEventLoop.
+class HttpUringLoop : public HttpEventLoop
+{
+private:
+    HttpUring ring;
+    uint64_t stop_value;
+    bool stopping;
+
+    // A single timeout operation wakes the loop up on the next tick of the idle timers, as long
+    // as any is armed.
+    struct __kernel_timespec    timer_timeout   ;
+    bool                        timer_armed     ;
+
+    std::unordered_map<int, std::unique_ptr<HTTP_URING_CONNECTION>> uring_connections;
+
+    // Used by Run
+    int  InitRing(void);
+    void PrepareAccept(void);
+    void PrepareStop(void);
+    void PrepareRecv(int client_socket, HTTP_URING_CONNECTION& connection);
+    void PrepareCancelRecv(int client_socket, HTTP_URING_CONNECTION& connection);
+    void PrepareChain(int client_socket, HTTP_URING_CONNECTION& connection);
+    void PrepareTimer(void);
+    void HandleAccept(int result, unsigned flags);
+    void HandleRecv(int client_socket, int result, unsigned flags);
+    void HandleSend(int client_socket, HTTP_URING_OP op, int result);
+    void HandleCancel(int client_socket);
+    void HandleTimer(void);
+    void CompleteChain(int client_socket, HTTP_URING_CONNECTION& connection);
+    void ResumeConnection(int client_socket, HTTP_URING_CONNECTION& connection);
+    void CloseConnection(int client_socket, HTTP_URING_CONNECTION& connection);
+    void ReleaseConnection(int client_socket);
+
+public:
+    HttpUringLoop(const std::string path_to_resources, const HTTP_EVENT_LOOP_CONFIG& config);
+    virtual ~HttpUringLoop(void);
+
+    HttpUringLoop(const HttpUringLoop& obj) = delete;
+
+    int Run(void) override;
+};
+
+/*************************************/
+
+#endif
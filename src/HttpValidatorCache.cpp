@@ -0,0 +1,160 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include "HttpValidatorCache.hpp"
+#include "HttpDate.hpp"
+#include <cstdio>
+#include <mutex>
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_VALIDATOR_LEN_ETAG         64
+#define HTTP_VALIDATOR_WEAK_PREFIX      "W/"
+
+/*************************************/
+
+/******************************************/
+/******** Private helper functions ********/
+/******************************************/
+
+static inline bool IsListSeparator(char c)
+{
+    return (c == ' ' || c == '\t' || c == ',');
+}
+
+// Opaque part of an entity tag (quotes included), without the weakness indicator.
+static std::string_view OpaqueTag(std::string_view etag)
+{
+    if(etag.substr(0, sizeof(HTTP_VALIDATOR_WEAK_PREFIX) - 1) == HTTP_VALIDATOR_WEAK_PREFIX)
+        etag.remove_prefix(sizeof(HTTP_VALIDATOR_WEAK_PREFIX) - 1);
+
+    return etag;
+}
+
+/******************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+HttpValidatorCache& HttpValidatorCache::GetInstance(void)
+{
+    static HttpValidatorCache instance;
+
+    return instance;
+}
+
+bool HttpValidatorCache::Matches(const HTTP_VALIDATORS& validators, const struct stat& file_stat)
+{
+    return  file_stat.st_dev            == validators.dev           &&
+            file_stat.st_ino            == validators.ino           &&
+            file_stat.st_size           == validators.size          &&
+            file_stat.st_mtim.tv_sec    == validators.mtime.tv_sec  &&
+            file_stat.st_mtim.tv_nsec   == validators.mtime.tv_nsec ;
+}
+
+HttpValidatorCache::validators_ptr HttpValidatorCache::Build(const struct stat& file_stat)
+{
+    std::shared_ptr<HTTP_VALIDATORS> validators = std::make_shared<HTTP_VALIDATORS>();
+
+    validators->dev     = file_stat.st_dev  ;
+    validators->ino     = file_stat.st_ino  ;
+    validators->size    = file_stat.st_size ;
+    validators->mtime   = file_stat.st_mtim ;
+
+    // Any change to the file (or its replacement by another one) gives a different tag. The
+    // nanoseconds catch rewrites within the same second, which Last-Modified cannot tell apart.
+    char etag[HTTP_VALIDATOR_LEN_ETAG];
+    int etag_len = snprintf(etag, sizeof(etag), "\"%lx-%lx-%lx.%lx\"",
+                            (unsigned long)file_stat.st_ino,
+                            (unsigned long)file_stat.st_size,
+                            (unsigned long)file_stat.st_mtim.tv_sec,
+                            (unsigned long)file_stat.st_mtim.tv_nsec);
+    validators->etag[HTTP_CONTENT_ENCODING_IDENTITY].assign(etag, etag_len);
+
+    // Compressed representations are different byte sequences, so they need tags of their own.
+    for(int encoding = HTTP_CONTENT_ENCODING_IDENTITY + 1; encoding < HTTP_CONTENT_ENCODING_COUNT; encoding++)
+        validators->etag[encoding].assign(etag, etag_len - 1).append("-").append(HttpContentEncodingName((HTTP_CONTENT_ENCODING)encoding)).append("\"");
+
+    char last_modified[HTTP_DATE_LEN + 1];
+    validators->last_modified.assign(last_modified, HttpFormatDate(file_stat.st_mtime, last_modified));
+
+    return validators;
+}
+
+std::shared_ptr<const HTTP_VALIDATORS> HttpValidatorCache::Get(const std::string& path, const struct stat& file_stat)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(this->cache_mutex);
+
+        validators_table::iterator it = this->entries.find(path);
+        if(it != this->entries.end() && Matches(*(it->second), file_stat))
+            return it->second;
+    }
+
+    // New path, or new version of the file: formatted outside the lock.
+    validators_ptr validators = Build(file_stat);
+
+    std::unique_lock<std::shared_mutex> lock(this->cache_mutex);
+
+    // Entries are tiny, so the table is just bounded instead of keeping track of their usage.
+    if(this->entries.size() >= HTTP_VALIDATOR_CACHE_MAX_ENTRIES && this->entries.find(path) == this->entries.end())
+        this->entries.clear();
+
+    this->entries[path] = validators;
+
+    return validators;
+}
+
+void HttpValidatorCache::Clear(void)
+{
+    std::unique_lock<std::shared_mutex> lock(this->cache_mutex);
+    this->entries.clear();
+}
+
+/******************************************/
+
+/**************************************/
+/******** Function definitions ********/
+/**************************************/
+
+bool HttpEntityTagListMatches(std::string_view value, std::string_view etag)
+{
+    std::string_view opaque_etag = OpaqueTag(etag);
+
+    while(!value.empty())
+    {
+        if(IsListSeparator(value.front()))
+        {
+            value.remove_prefix(1);
+            continue;
+        }
+
+        if(value.front() == '*')
+            return true;
+
+        value = OpaqueTag(value);
+
+        // Entity tags are quoted strings without escapes, which may hold commas themselves.
+        if(value.empty() || value.front() != '"')
+            return false;
+
+        std::size_t closing_quote = value.find('"', 1);
+        if(closing_quote == std::string_view::npos)
+            return false;
+
+        if(value.substr(0, closing_quote + 1) == opaque_etag)
+            return true;
+
+        value.remove_prefix(closing_quote + 1);
+    }
+
+    return false;
+}
+
+/**************************************/
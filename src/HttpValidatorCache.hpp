@@ -0,0 +1,88 @@
+#ifndef CPP_HTTP_VALIDATOR_CACHE_HPP
+#define CPP_HTTP_VALIDATOR_CACHE_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include "HttpContentEncoding.hpp"
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_VALIDATOR_CACHE_MAX_ENTRIES            4096        // Table is emptied once it grows past this many paths.
+
+/************************************/
+
+/************************************/
+/********* Type definitions *********/
+/************************************/
+
+// Validators of a given version of a file (RFC 9110 section 8.8), ready to be copied into headers.
+typedef struct
+{
+    dev_t           dev                                 ;
+    ino_t           ino                                 ;
+    off_t           size                                ;
+    struct timespec mtime                               ;
+    std::string     etag[HTTP_CONTENT_ENCODING_COUNT]   ;   // Strong entity tag of every representation (content coding), quotes included.
+    std::string     last_modified                       ;   // IMF-fixdate.
+} HTTP_VALIDATORS;
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Process-wide table of the validators of every file served, keyed by path. The caller already
+// holds fresh metadata for the file (stat), so an entry is reused as long as the inode, size and
+// modification time it was built from are still the same; otherwise it is built again.
+class HttpValidatorCache
+{
+private:
+    using validators_ptr    = std::shared_ptr<const HTTP_VALIDATORS>;
+    using validators_table  = std::unordered_map<std::string, validators_ptr>;
+
+    std::shared_mutex   cache_mutex ;
+    validators_table    entries     ;
+
+    static bool Matches(const HTTP_VALIDATORS& validators, const struct stat& file_stat);
+    static validators_ptr Build(const struct stat& file_stat);
+
+public:
+    HttpValidatorCache(void) = default;
+    HttpValidatorCache(const HttpValidatorCache& obj) = delete;
+
+    static HttpValidatorCache& GetInstance(void);
+
+    // Get the validators of the file found at path, whose current metadata is file_stat.
+    std::shared_ptr<const HTTP_VALIDATORS> Get(const std::string& path, const struct stat& file_stat);
+
+    void Clear(void);
+};
+
+/*************************************/
+
+/**************************************/
+/******** Function declarations *******/
+/**************************************/
+
+// Whether an If-None-Match value ("*" or a list of entity tags) matches etag, using the weak
+// comparison function (RFC 9110 section 8.8.3.2).
+bool HttpEntityTagListMatches(std::string_view value, std::string_view etag);
+
+/**************************************/
+
+#endif
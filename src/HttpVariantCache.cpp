@@ -0,0 +1,261 @@
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "HttpVariantCache.hpp"
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+/*************************************/
+
+/******************************************/
+/******** Private helper functions ********/
+/******************************************/
+
+// Read the whole file behind fd, whose size is expected to be size. Returns false on errors, or if
+// the file was truncated meanwhile.
+static bool ReadWholeFile(int fd, off_t size, std::string& content)
+{
+    content.resize(size);
+    size_t bytes_read = 0;
+
+    while(bytes_read < content.size())
+    {
+        ssize_t read_now = read(fd, content.data() + bytes_read, content.size() - bytes_read);
+
+        if(read_now < 0 && errno == EINTR)
+            continue;
+
+        if(read_now <= 0)
+            return false;
+
+        bytes_read += read_now;
+    }
+
+    return true;
+}
+
+/******************************************/
+
+/******************************************/
+/******** Class method definitions ********/
+/******************************************/
+
+HttpVariantCache::HttpVariantCache(unsigned long max_bytes):
+    hand(ring.end())        ,
+    used_bytes(0)           ,
+    max_bytes(max_bytes)    ,
+    stop_worker(false)
+{
+    this->worker = std::thread(&HttpVariantCache::RunWorker, this);
+}
+
+HttpVariantCache::~HttpVariantCache(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->jobs_mutex);
+        this->stop_worker = true;
+    }
+
+    this->jobs_cond.notify_one();
+
+    if(this->worker.joinable())
+        this->worker.join();
+}
+
+HttpVariantCache& HttpVariantCache::GetInstance(void)
+{
+    static HttpVariantCache instance;
+
+    return instance;
+}
+
+std::string HttpVariantCache::MakeKey(const std::string& path, HTTP_CONTENT_ENCODING encoding)
+{
+    return std::string(path).append(HttpContentEncodingSuffix(encoding));
+}
+
+bool HttpVariantCache::IsSameVersion(const HTTP_VARIANT_CACHE_ENTRY& entry, const struct stat& file_stat)
+{
+    return  file_stat.st_dev            == entry.dev            &&
+            file_stat.st_ino            == entry.ino            &&
+            file_stat.st_size           == entry.size           &&
+            file_stat.st_mtim.tv_sec    == entry.mtime.tv_sec   &&
+            file_stat.st_mtim.tv_nsec   == entry.mtime.tv_nsec  ;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Request path
+
+int HttpVariantCache::Lookup(const std::string& path, HTTP_CONTENT_ENCODING encoding, const struct stat& file_stat, std::shared_ptr<const std::string>& body)
+{
+    std::shared_lock<std::shared_mutex> lock(this->cache_mutex);
+
+    // Copies made from older versions of the file are just ignored: the new one replaces them.
+    entry_table::iterator it = this->entries.find(MakeKey(path, encoding));
+    if(it == this->entries.end() || !IsSameVersion(**(it->second), file_stat))
+        return HTTP_VARIANT_CACHE_MISS;
+
+    (*(it->second))->referenced.store(true, std::memory_order_relaxed);
+
+    if((*(it->second))->body == nullptr)
+        return HTTP_VARIANT_CACHE_NOT_SMALLER;
+
+    body = (*(it->second))->body;
+
+    return HTTP_VARIANT_CACHE_HIT;
+}
+
+void HttpVariantCache::Request(const HttpResourceResolver::root_ptr& root, const std::string& target, const std::string& path, HTTP_CONTENT_ENCODING encoding, const struct stat& file_stat)
+{
+    if((unsigned long)file_stat.st_size > HTTP_VARIANT_CACHE_MAX_SOURCE_BYTES || !HttpIsContentEncodingAvailable(encoding))
+        return;
+
+    std::string key = MakeKey(path, encoding);
+
+    {
+        std::lock_guard<std::mutex> lock(this->jobs_mutex);
+
+        // Every request for the same variant would queue it otherwise.
+        if(this->jobs.size() >= HTTP_VARIANT_CACHE_MAX_PENDING || !this->pending_keys.insert(key).second)
+            return;
+
+        this->jobs.push_back({key, root, target, path, encoding});
+    }
+
+    this->jobs_cond.notify_one();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Background compression
+
+void HttpVariantCache::RunWorker(void)
+{
+    std::unique_lock<std::mutex> lock(this->jobs_mutex);
+
+    while(true)
+    {
+        this->jobs_cond.wait(lock, [this]{ return this->stop_worker || !this->jobs.empty(); });
+
+        if(this->stop_worker)
+            return;
+
+        HTTP_VARIANT_CACHE_JOB job = std::move(this->jobs.front());
+        this->jobs.pop_front();
+
+        lock.unlock();
+        this->Compress(job);
+        lock.lock();
+
+        this->pending_keys.erase(job.key);
+    }
+}
+
+void HttpVariantCache::Compress(const HTTP_VARIANT_CACHE_JOB& job)
+{
+    // Opened just like requests open it, so that it may not lead outside the resources directory
+    // either; the stat is taken from the descriptor, so the variant is tied to the bytes read.
+    struct stat file_stat;
+    int fd = HttpResourceResolver::GetInstance().Open(job.root, job.target, job.path, file_stat);
+    if(fd < 0)
+        return;
+
+    std::string source;
+
+    bool read_file =    (unsigned long)file_stat.st_size <= HTTP_VARIANT_CACHE_MAX_SOURCE_BYTES &&
+                        ReadWholeFile(fd, file_stat.st_size, source)                        ;
+
+    close(fd);
+
+    if(!read_file)
+        return;
+
+    std::string compressed;
+
+    if(!HttpCompress(job.encoding, source, compressed))
+        return;
+
+    std::shared_ptr<const std::string> body;
+
+    if(compressed.size() < source.size())
+        body = std::make_shared<const std::string>(std::move(compressed));
+
+    this->Insert(job.key, file_stat, body);
+}
+
+void HttpVariantCache::Insert(const std::string& key, const struct stat& file_stat, const std::shared_ptr<const std::string>& body)
+{
+    entry_ptr entry = std::make_shared<HTTP_VARIANT_CACHE_ENTRY>();
+
+    entry->key      = key               ;
+    entry->body     = body              ;
+    entry->dev      = file_stat.st_dev  ;
+    entry->ino      = file_stat.st_ino  ;
+    entry->size     = file_stat.st_size ;
+    entry->mtime    = file_stat.st_mtim ;
+    entry->referenced.store(false, std::memory_order_relaxed);
+
+    unsigned long entry_bytes = key.size() + ((body != nullptr) ? body->size() : 0);
+
+    std::unique_lock<std::shared_mutex> lock(this->cache_mutex);
+
+    if(entry_bytes > this->max_bytes)
+        return;
+
+    entry_table::iterator it = this->entries.find(key);
+    if(it != this->entries.end())
+        this->EraseLocked(it->second);
+
+    this->EvictLocked(entry_bytes);
+
+    // New entries go right behind the clock hand, so they are the last ones to be checked.
+    this->entries[key]  = this->ring.insert(this->hand, entry);
+    this->used_bytes   += entry_bytes;
+}
+
+void HttpVariantCache::EraseLocked(clock_ring::iterator it)
+{
+    if(this->hand == it)
+        ++this->hand;
+
+    this->used_bytes -= (*it)->key.size() + (((*it)->body != nullptr) ? (*it)->body->size() : 0);
+    this->entries.erase((*it)->key);
+    this->ring.erase(it);
+}
+
+void HttpVariantCache::EvictLocked(unsigned long incoming_bytes)
+{
+    while(!this->ring.empty() && this->used_bytes + incoming_bytes > this->max_bytes)
+    {
+        if(this->hand == this->ring.end())
+            this->hand = this->ring.begin();
+
+        // Recently used entries get a second chance.
+        if((*this->hand)->referenced.exchange(false, std::memory_order_relaxed))
+        {
+            ++this->hand;
+            continue;
+        }
+
+        clock_ring::iterator victim = this->hand++;
+        this->EraseLocked(victim);
+    }
+}
+
+void HttpVariantCache::Clear(void)
+{
+    std::unique_lock<std::shared_mutex> lock(this->cache_mutex);
+
+    this->entries.clear();
+    this->ring.clear();
+    this->hand          = this->ring.end();
+    this->used_bytes    = 0;
+}
+
+/******************************************/
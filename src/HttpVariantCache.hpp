@@ -0,0 +1,124 @@
+#ifndef CPP_HTTP_VARIANT_CACHE_HPP
+#define CPP_HTTP_VARIANT_CACHE_HPP
+
+/************************************/
+/******** Include statements ********/
+/************************************/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <string>
+#include <list>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include "HttpContentEncoding.hpp"
+#include "HttpResourceResolver.hpp"
+
+/*************************************/
+
+/************************************/
+/********* Define statements ********/
+/************************************/
+
+#define HTTP_VARIANT_CACHE_DEFAULT_MAX_BYTES        (16UL * 1024UL * 1024UL)    // Compressed bytes kept in memory (16 MiB).
+#define HTTP_VARIANT_CACHE_MAX_SOURCE_BYTES         (1UL * 1024UL * 1024UL)     // Larger files are always sent as they are (1 MiB).
+#define HTTP_VARIANT_CACHE_MAX_PENDING              64                          // Compression jobs queued at most; more are dropped.
+
+#define HTTP_VARIANT_CACHE_HIT                      0           // Variant is ready.
+#define HTTP_VARIANT_CACHE_MISS                     1           // No variant for the current version of the file (yet).
+#define HTTP_VARIANT_CACHE_NOT_SMALLER              2           // File does not get any smaller once compressed: send it as it is.
+
+/************************************/
+
+/*************************************/
+/********** Class definition *********/
+/*************************************/
+
+// Process-wide, size-bounded cache of compressed copies (variants) of files, keyed by path and
+// content coding, each one tied to the version (inode, size, modification time) of the file it was
+// made from. Requests never compress: after a miss, a job is queued for a background thread and the
+// file is sent uncompressed meanwhile, so that later requests find the variant ready. Files that do
+// not get any smaller are remembered as well, so that they are not compressed over and over again.
+// Replacement follows the CLOCK algorithm, as in HttpFileCache.
+class HttpVariantCache
+{
+private:
+    typedef struct
+    {
+        std::string                         key             ;
+        std::shared_ptr<const std::string>  body            ;   // nullptr: not worth compressing.
+        dev_t                               dev             ;
+        ino_t                               ino             ;
+        off_t                               size            ;
+        struct timespec                     mtime           ;
+        std::atomic<bool>                   referenced      ;
+    } HTTP_VARIANT_CACHE_ENTRY;
+
+    typedef struct
+    {
+        std::string                         key         ;
+        HttpResourceResolver::root_ptr      root        ;   // Resources directory the file is opened below.
+        std::string                         target      ;   // Normalized target of the file (see HttpResourceResolver).
+        std::string                         path        ;
+        HTTP_CONTENT_ENCODING               encoding    ;
+    } HTTP_VARIANT_CACHE_JOB;
+
+    using entry_ptr     = std::shared_ptr<HTTP_VARIANT_CACHE_ENTRY>     ;
+    using clock_ring    = std::list<entry_ptr>                          ;
+    using entry_table   = std::unordered_map<std::string, clock_ring::iterator>;
+
+    std::shared_mutex       cache_mutex ;
+    entry_table             entries     ;
+    clock_ring              ring        ;
+    clock_ring::iterator    hand        ;
+    unsigned long           used_bytes  ;
+    const unsigned long     max_bytes   ;
+
+    // Background compression.
+    std::mutex                          jobs_mutex      ;
+    std::condition_variable             jobs_cond       ;
+    std::deque<HTTP_VARIANT_CACHE_JOB>  jobs            ;
+    std::unordered_set<std::string>     pending_keys    ;
+    std::thread                         worker          ;
+    bool                                stop_worker     ;
+
+    static std::string MakeKey(const std::string& path, HTTP_CONTENT_ENCODING encoding);
+    static bool IsSameVersion(const HTTP_VARIANT_CACHE_ENTRY& entry, const struct stat& file_stat);
+
+    void RunWorker(void);
+    void Compress(const HTTP_VARIANT_CACHE_JOB& job);
+    void Insert(const std::string& key, const struct stat& file_stat, const std::shared_ptr<const std::string>& body);
+    // Must be called with cache_mutex held in exclusive mode.
+    void EraseLocked(clock_ring::iterator it);
+    void EvictLocked(unsigned long incoming_bytes);
+
+public:
+    HttpVariantCache(unsigned long max_bytes = HTTP_VARIANT_CACHE_DEFAULT_MAX_BYTES);
+    virtual ~HttpVariantCache(void);
+
+    HttpVariantCache(const HttpVariantCache& obj) = delete;
+
+    static HttpVariantCache& GetInstance(void);
+
+    // Get the variant of the file found at path (whose current metadata is file_stat) compressed
+    // with encoding. Returns HTTP_VARIANT_CACHE_HIT (body is set), _MISS or _NOT_SMALLER.
+    int Lookup(const std::string& path, HTTP_CONTENT_ENCODING encoding, const struct stat& file_stat, std::shared_ptr<const std::string>& body);
+    // Queue the compression of the file found at path after a miss. It is opened below root like the
+    // file itself was (target as given by HttpResourceResolver::NormalizeTarget). Files too large for
+    // the cache and unavailable encodings are ignored, as well as requests for variants already queued.
+    void Request(const HttpResourceResolver::root_ptr& root, const std::string& target, const std::string& path, HTTP_CONTENT_ENCODING encoding, const struct stat& file_stat);
+
+    void Clear(void);
+};
+
+/*************************************/
+
+#endif
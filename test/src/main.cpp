@@ -32,7 +32,7 @@
 #define CLIENTS_OPT_LONG                    "Clients"
 #define CLIENTS_OPT_DETAIL                  "Maximum number of clients."
 #define CLIENTS_MIN_VALUE                   1
-#define CLIENTS_MAX_VALUE                   100
+#define CLIENTS_MAX_VALUE                   10000
 #define CLIENTS_DEFAULT_VALUE               3
 
 /********* Enable concurrency *********/
@@ -42,6 +42,32 @@
 #define SIMULTANEOUS_CONNS_DETAIL           "Enable concurrency."
 #define SIMULTANEOUS_CONNS_DEFAULT_VALUE    false
 
+/************* Event loop *************/
+
+#define EVENT_LOOP_CHAR                     'l'
+#define EVENT_LOOP_LONG                     "Event_loop"
+#define EVENT_LOOP_DETAIL                   "Serve every client from a single epoll-driven thread (plaintext only)."
+#define EVENT_LOOP_DEFAULT_VALUE            false
+
+#define IO_URING_CHAR                       'q'
+#define IO_URING_LONG                       "IO_uring"
+#define IO_URING_DETAIL                     "Run the event loop(s) on io_uring instead of epoll, if the kernel supports it."
+#define IO_URING_DEFAULT_VALUE              false
+
+/************** Reactors **************/
+
+#define WORKERS_OPT_CHAR                    'w'
+#define WORKERS_OPT_LONG                    "Workers"
+#define WORKERS_OPT_DETAIL                  "Number of event loop reactors, each one with its own SO_REUSEPORT listener (0: single event loop)."
+#define WORKERS_MIN_VALUE                   0
+#define WORKERS_MAX_VALUE                   1024
+#define WORKERS_DEFAULT_VALUE               0
+
+#define CORES_OPT_CHAR                      'o'
+#define CORES_OPT_LONG                      "Cores"
+#define CORES_OPT_DETAIL                    "Cores the reactors are pinned to, e.g. \"0,2,4-7\" (empty: no pinning)."
+#define CORES_DEFAULT_VALUE                 ""
+
 /********** Receive timeout (s) ******/
 #define RX_TIMEOUT_SECS_CHAR                't'
 #define RX_TIMEOUT_SECS_OPT_LONG            "RXTimeoutSecs"
@@ -74,6 +100,50 @@
 #define TX_TIMEOUT_USECS_MAX_VALUE          1000000 // 1 second
 #define TX_TIMEOUT_USECS_DEFAULT_VALUE      0
 
+/******** Keep-alive timeout (s) ******/
+#define KEEP_ALIVE_SECS_CHAR                'a'
+#define KEEP_ALIVE_SECS_OPT_LONG            "KeepAliveSecs"
+#define KEEP_ALIVE_SECS_OPT_DETAIL          "Seconds an idle persistent connection is kept open (0: no persistent connections)."
+#define KEEP_ALIVE_SECS_MIN_VALUE           0
+#define KEEP_ALIVE_SECS_MAX_VALUE           3600    // 1 hour
+#define KEEP_ALIVE_SECS_DEFAULT_VALUE       15
+
+/******* Keep-alive max requests ******/
+#define KEEP_ALIVE_REQUESTS_CHAR            'n'
+#define KEEP_ALIVE_REQUESTS_OPT_LONG        "KeepAliveRequests"
+#define KEEP_ALIVE_REQUESTS_OPT_DETAIL      "Requests served per connection before closing it (0: no limit)."
+#define KEEP_ALIVE_REQUESTS_MIN_VALUE       0
+#define KEEP_ALIVE_REQUESTS_MAX_VALUE       1000000
+#define KEEP_ALIVE_REQUESTS_DEFAULT_VALUE   1000
+
+/************* Access log *************/
+
+#define ACCESS_LOG_OPT_CHAR                 'g'
+#define ACCESS_LOG_OPT_LONG                 "Access_log"
+#define ACCESS_LOG_OPT_DETAIL               "Access log file (empty: requests are not logged)."
+#define ACCESS_LOG_DEFAULT_VALUE            ""
+
+/************ Statistics **************/
+
+#define STATS_OPT_CHAR                      'z'
+#define STATS_OPT_LONG                      "Stats"
+#define STATS_OPT_DETAIL                    "Path answered with the server statistics (empty: not served)."
+#define STATS_DEFAULT_VALUE                 ""
+
+/********** Resource manifest **********/
+
+#define MANIFEST_OPT_CHAR                   'f'
+#define MANIFEST_OPT_LONG                   "Manifest"
+#define MANIFEST_OPT_DETAIL                 "Scan the resources at startup, so that known files are served without looking them up on disk."
+#define MANIFEST_DEFAULT_VALUE              false
+
+/********** Resource watcher ***********/
+
+#define WATCH_OPT_CHAR                      'd'
+#define WATCH_OPT_LONG                      "Watch"
+#define WATCH_OPT_DETAIL                    "Watch the resources with inotify, so that changes to them are served right away."
+#define WATCH_DEFAULT_VALUE                 false
+
 /********* Secure connection *********/
 
 #define SECURE_CONN_CHAR                    's'
@@ -121,14 +191,24 @@ int main(int argc, char** argv)
     int server_port         ;
     int max_clients_num     ;
     bool concurrency_enabled;
+    bool event_loop_enabled ;
+    bool io_uring_enabled   ;
+    int workers_num         ;
     int rx_timeout_s        ;
     int rx_timeout_us       ;
     int tx_timeout          ;
     int tx_timeout_us       ;
+    int keep_alive_secs     ;
+    int keep_alive_requests ;
+    bool manifest_enabled   ;
+    bool watch_enabled      ;
     bool secure_connection  ;
     char* path_cert = (char*)calloc(1024, 1);
     char* path_pkey = (char*)calloc(1024, 1);
     char* path_to_resources = (char*)calloc(1024, 1);
+    char* core_list = (char*)calloc(1024, 1);
+    char* access_log = (char*)calloc(1024, 1);
+    char* stats_path = (char*)calloc(1024, 1);
 
     SetOptionDefinitionInt(     PORT_OPT_CHAR                   ,
                                 PORT_OPT_LONG                   ,
@@ -152,6 +232,32 @@ int main(int argc, char** argv)
                                 SIMULTANEOUS_CONNS_DEFAULT_VALUE,
                                 &concurrency_enabled            );
 
+    SetOptionDefinitionBool(    EVENT_LOOP_CHAR                 ,
+                                EVENT_LOOP_LONG                 ,
+                                EVENT_LOOP_DETAIL               ,
+                                EVENT_LOOP_DEFAULT_VALUE        ,
+                                &event_loop_enabled             );
+
+    SetOptionDefinitionBool(    IO_URING_CHAR                   ,
+                                IO_URING_LONG                   ,
+                                IO_URING_DETAIL                 ,
+                                IO_URING_DEFAULT_VALUE          ,
+                                &io_uring_enabled               );
+
+    SetOptionDefinitionInt(     WORKERS_OPT_CHAR                ,
+                                WORKERS_OPT_LONG                ,
+                                WORKERS_OPT_DETAIL              ,
+                                WORKERS_MIN_VALUE               ,
+                                WORKERS_MAX_VALUE               ,
+                                WORKERS_DEFAULT_VALUE           ,
+                                &workers_num                    );
+
+    SetOptionDefinitionStringNL(CORES_OPT_CHAR                  ,
+                                CORES_OPT_LONG                  ,
+                                CORES_OPT_DETAIL                ,
+                                CORES_DEFAULT_VALUE             ,
+                                core_list                       );
+
     SetOptionDefinitionInt(     RX_TIMEOUT_SECS_CHAR            ,
                                 RX_TIMEOUT_SECS_OPT_LONG        ,
                                 RX_TIMEOUT_SECS_OPT_DETAIL      ,
@@ -184,6 +290,46 @@ int main(int argc, char** argv)
                                 TX_TIMEOUT_USECS_DEFAULT_VALUE  ,
                                 &tx_timeout_us                  );
 
+    SetOptionDefinitionInt(     KEEP_ALIVE_SECS_CHAR            ,
+                                KEEP_ALIVE_SECS_OPT_LONG        ,
+                                KEEP_ALIVE_SECS_OPT_DETAIL      ,
+                                KEEP_ALIVE_SECS_MIN_VALUE       ,
+                                KEEP_ALIVE_SECS_MAX_VALUE       ,
+                                KEEP_ALIVE_SECS_DEFAULT_VALUE   ,
+                                &keep_alive_secs                );
+
+    SetOptionDefinitionInt(     KEEP_ALIVE_REQUESTS_CHAR        ,
+                                KEEP_ALIVE_REQUESTS_OPT_LONG    ,
+                                KEEP_ALIVE_REQUESTS_OPT_DETAIL  ,
+                                KEEP_ALIVE_REQUESTS_MIN_VALUE   ,
+                                KEEP_ALIVE_REQUESTS_MAX_VALUE   ,
+                                KEEP_ALIVE_REQUESTS_DEFAULT_VALUE,
+                                &keep_alive_requests            );
+
+    SetOptionDefinitionStringNL(ACCESS_LOG_OPT_CHAR             ,
+                                ACCESS_LOG_OPT_LONG             ,
+                                ACCESS_LOG_OPT_DETAIL           ,
+                                ACCESS_LOG_DEFAULT_VALUE        ,
+                                access_log                      );
+
+    SetOptionDefinitionStringNL(STATS_OPT_CHAR                  ,
+                                STATS_OPT_LONG                  ,
+                                STATS_OPT_DETAIL                ,
+                                STATS_DEFAULT_VALUE             ,
+                                stats_path                      );
+
+    SetOptionDefinitionBool(    MANIFEST_OPT_CHAR               ,
+                                MANIFEST_OPT_LONG               ,
+                                MANIFEST_OPT_DETAIL             ,
+                                MANIFEST_DEFAULT_VALUE          ,
+                                &manifest_enabled               );
+
+    SetOptionDefinitionBool(    WATCH_OPT_CHAR                  ,
+                                WATCH_OPT_LONG                  ,
+                                WATCH_OPT_DETAIL                ,
+                                WATCH_DEFAULT_VALUE             ,
+                                &watch_enabled                  );
+
     SetOptionDefinitionBool(    SECURE_CONN_CHAR                ,
                                 SECURE_CONN_LONG                ,
                                 SECURE_CONN_DETAIL              ,
@@ -218,6 +364,26 @@ int main(int argc, char** argv)
     SVRTY_LOG_INF("Arguments successfully parsed!");
 
     HttpInteract::SetPathToResources(path_to_resources);
+    HttpInteract::SetSecureConnection(secure_connection);
+    HttpInteract::SetIoUring(io_uring_enabled);
+    HttpInteract::SetKeepAlive(keep_alive_secs, keep_alive_requests);
+    HttpInteract::SetAccessLog(access_log);
+    HttpInteract::SetStatsPath(stats_path);
+
+    if(manifest_enabled)
+        HttpInteract::BuildResourceManifest();
+
+    if(watch_enabled)
+        HttpInteract::WatchResources();
+
+    // Fingerprinted assets (e.g. "/assets/app.3f2a1c.js") never change under the same name.
+    HttpInteract::AddCachePolicy(HTTP_CACHE_POLICY_MATCH_PATH_PREFIX, "/assets/", 31536000, HTTP_CACHE_POLICY_FLAG_IMMUTABLE);
+
+    if(workers_num > 0 || core_list[0] != '\0')
+        return HttpInteract::RunReactors(server_port, max_clients_num, workers_num, core_list);
+
+    if(event_loop_enabled || io_uring_enabled)
+        return HttpInteract::RunEventLoop(server_port, max_clients_num);
 
     ServerSocketRun(server_port             ,
                     max_clients_num         ,